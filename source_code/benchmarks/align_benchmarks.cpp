@@ -0,0 +1,350 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// boost header
+#include <boost/program_options.hpp>
+
+// BioSeqDataLib header
+#include "../libs/BioSeqDataLib/src/sequence/Sequence.hpp"
+#include "../libs/BioSeqDataLib/src/utility/SimilarityMatrix.hpp"
+#include "../libs/BioSeqDataLib/src/align/AlignmentMatrix.hpp"
+#include "../libs/BioSeqDataLib/src/align/BatchAlignment.hpp"
+#include "../libs/BioSeqDataLib/src/align/sw_striped.hpp"
+
+// benchmark header
+#include "benchmarkHelpers.hpp"
+
+namespace BSDL = BioSeqDataLib;
+namespace po = boost::program_options;
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+
+typedef BSDL::Sequence<> sequence;
+typedef BSDL::SimilarityMatrix<float> similarityMatrix;
+typedef BSDL::AlignmentMatrix<float, similarityMatrix> alignmentMatrix;
+
+const string aminoAcids = "ARNDCQEGHILKMFPSTWYV";
+
+/*
+ * creates a pair of sequences of about the given length: both contain a related region (a random protein and a copy
+ * with about 12% substitutions and 5% indels) of relatedLength residues surrounded by random flanks
+ */
+std::pair<sequence, sequence>
+syntheticPair(const size_t &length, const size_t &relatedLength, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<size_t> residue(0, aminoAcids.size() - 1);
+    std::uniform_int_distribution<int> event(0, 39);
+    string core;
+    for (size_t i = 0; i < relatedLength; ++i) {
+        core.push_back(aminoAcids[residue(rng)]);
+    }
+    string mutated;
+    for (char c : core) {
+        int e = event(rng);
+        if (e == 0) {
+            continue;
+        }
+        if (e == 1) {
+            mutated.push_back(aminoAcids[residue(rng)]);
+        }
+        mutated.push_back((e < 6) ? aminoAcids[residue(rng)] : c);
+    }
+    string flanks[4];
+    for (auto &flank : flanks) {
+        for (size_t i = 0; i < (length - relatedLength) / 2; ++i) {
+            flank.push_back(aminoAcids[residue(rng)]);
+        }
+    }
+    return std::make_pair(sequence("seq1", flanks[0] + core + flanks[1], "", ""), sequence("seq2", flanks[2] + mutated + flanks[3], "", ""));
+}
+
+/*
+ * aligns all pairs with AlignmentMatrix::sw, with and without the striped kernel, and with the score-only kernels
+ */
+void
+benchmarkPairs(const string &config, const vector<std::pair<sequence, sequence> > &pairs, const similarityMatrix &simMat, const float &gep, const unsigned int &repetitions)
+{
+    alignmentMatrix fullMatrix(gep, simMat);
+    fullMatrix.simd(false);
+    alignmentMatrix stripedMatrix(gep, simMat);
+    vector<float> fullScores(pairs.size()), stripedScores(pairs.size());
+
+    printBenchmarkResult(cout, runBenchmark("sw_full_matrix", config, repetitions, [&]() {
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            fullMatrix.sw(pairs[i].first, pairs[i].second);
+            fullMatrix.result();
+            fullScores[i] = fullMatrix.score();
+        }
+    }));
+    printBenchmarkResult(cout, runBenchmark("sw_striped_traceback", config, repetitions, [&]() {
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            stripedMatrix.sw(pairs[i].first, pairs[i].second);
+            stripedMatrix.result();
+            stripedScores[i] = stripedMatrix.score();
+        }
+    }));
+    if (fullScores != stripedScores) {
+        cout << "# " << config << ": WARNING scores of the striped and the full matrix implementation differ" << std::endl;
+    }
+
+    vector<std::pair<BSDL::SimdLevel, string> > levels;
+    if (BSDL::simdLevel() != BSDL::SimdLevel::None) {
+        levels.push_back(std::make_pair(BSDL::SimdLevel::SSE2, "sw_striped_score_sse2"));
+    }
+    if (BSDL::simdLevel() == BSDL::SimdLevel::AVX2) {
+        levels.push_back(std::make_pair(BSDL::SimdLevel::AVX2, "sw_striped_score_avx2"));
+    }
+    for (auto &level : levels) {
+        bool applicable = true;
+        BSDL::StripedSwHit hit;
+        printBenchmarkResult(cout, runBenchmark(level.second, config, repetitions, [&]() {
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                applicable = BSDL::swStripedScore(pairs[i].first, pairs[i].second, simMat, 0.0f, gep, hit, level.first) && applicable;
+            }
+        }));
+        if (!applicable) {
+            cout << "# " << config << ": " << level.second << " fell back for some pairs (scores exceed 16 bit)" << std::endl;
+        }
+    }
+}
+
+/*
+ * aligns all pairs globally with AlignmentMatrix::gotoh (full matrices), AlignmentMatrix::gotoh_linear and
+ * AlignmentMatrix::gotoh_banded
+ */
+void
+benchmarkGlobalPairs(const string &config, const vector<std::pair<sequence, sequence> > &pairs, const similarityMatrix &simMat, const float &gop, const float &gep, const unsigned int &repetitions)
+{
+    alignmentMatrix mat(gop, gep, simMat);
+    vector<float> fullScores(pairs.size()), linearScores(pairs.size());
+
+    printBenchmarkResult(cout, runBenchmark("gotoh_full_matrix", config, repetitions, [&]() {
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            mat.gotoh(pairs[i].first, pairs[i].second);
+            mat.result();
+            fullScores[i] = mat.score();
+        }
+    }));
+    printBenchmarkResult(cout, runBenchmark("gotoh_linear_space", config, repetitions, [&]() {
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            mat.gotoh_linear(pairs[i].first, pairs[i].second);
+            mat.result();
+            linearScores[i] = mat.score();
+        }
+    }));
+    if (fullScores != linearScores) {
+        cout << "# " << config << ": WARNING scores of the linear space and the full matrix implementation differ" << std::endl;
+    }
+
+    vector<float> bandedScores(pairs.size());
+    printBenchmarkResult(cout, runBenchmark("gotoh_banded", config, repetitions, [&]() {
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            mat.gotoh_banded(pairs[i].first, pairs[i].second);
+            bandedScores[i] = mat.score();
+        }
+    }));
+    if (fullScores != bandedScores) {
+        cout << "# " << config << ": WARNING scores of the banded and the full matrix implementation differ" << std::endl;
+    }
+}
+
+/*
+ * runs the nw, gotoh and sw kernels of AlignmentMatrix over pairs of different lengths, once with a single reused
+ * AlignmentMatrix (the dynamic programming matrices are only allocated for the largest pair), once with a new
+ * AlignmentMatrix for every pair and once with the score-only variants
+ */
+void
+benchmarkKernels(const string &config, const vector<std::pair<sequence, sequence> > &pairs, const similarityMatrix &simMat, const float &gop, const float &gep, const unsigned int &repetitions)
+{
+    vector<std::pair<string, std::function<void(alignmentMatrix &, const sequence &, const sequence &)> > > kernels;
+    kernels.push_back(std::make_pair("nw", [](alignmentMatrix &mat, const sequence &seq1, const sequence &seq2) { mat.nw(seq1, seq2); }));
+    kernels.push_back(std::make_pair("gotoh", [](alignmentMatrix &mat, const sequence &seq1, const sequence &seq2) { mat.gotoh(seq1, seq2); }));
+    kernels.push_back(std::make_pair("sw", [](alignmentMatrix &mat, const sequence &seq1, const sequence &seq2) { mat.sw(seq1, seq2); }));
+
+    for (auto &kernel : kernels) {
+        alignmentMatrix reused(gop, gep, simMat);
+        reused.simd(false);
+        vector<float> reusedScores(pairs.size()), freshScores(pairs.size());
+        printBenchmarkResult(cout, runBenchmark(kernel.first + "_reused_matrix", config, repetitions, [&]() {
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                kernel.second(reused, pairs[i].first, pairs[i].second);
+                reusedScores[i] = reused.score();
+            }
+        }));
+        printBenchmarkResult(cout, runBenchmark(kernel.first + "_new_matrix", config, repetitions, [&]() {
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                alignmentMatrix fresh(gop, gep, simMat);
+                fresh.simd(false);
+                kernel.second(fresh, pairs[i].first, pairs[i].second);
+                freshScores[i] = fresh.score();
+            }
+        }));
+        if (reusedScores != freshScores) {
+            cout << "# " << config << ": WARNING scores of the reused and the new matrices differ (" << kernel.first << ")" << std::endl;
+        }
+    }
+
+    // the same kernels without traceback
+    vector<std::pair<string, std::function<float(alignmentMatrix &, const sequence &, const sequence &)> > > scoreKernels;
+    scoreKernels.push_back(std::make_pair("nw", [](alignmentMatrix &mat, const sequence &seq1, const sequence &seq2) { return mat.nw_score(seq1, seq2); }));
+    scoreKernels.push_back(std::make_pair("gotoh", [](alignmentMatrix &mat, const sequence &seq1, const sequence &seq2) { return mat.gotoh_score(seq1, seq2); }));
+    scoreKernels.push_back(std::make_pair("sw", [](alignmentMatrix &mat, const sequence &seq1, const sequence &seq2) { return mat.sw_score(seq1, seq2); }));
+    for (size_t k = 0; k < scoreKernels.size(); ++k) {
+        alignmentMatrix mat(gop, gep, simMat);
+        mat.simd(false);
+        vector<float> scores(pairs.size()), fullScores(pairs.size());
+        printBenchmarkResult(cout, runBenchmark(scoreKernels[k].first + "_score_only", config, repetitions, [&]() {
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                scores[i] = scoreKernels[k].second(mat, pairs[i].first, pairs[i].second);
+            }
+        }));
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            kernels[k].second(mat, pairs[i].first, pairs[i].second);
+            fullScores[i] = mat.score();
+        }
+        if (scores != fullScores) {
+            cout << "# " << config << ": WARNING scores of the score-only and the full alignments differ (" << scoreKernels[k].first << ")" << std::endl;
+        }
+    }
+}
+
+/*
+ * aligns every query against every target with gotoh, once pair by pair with a single AlignmentMatrix and once with
+ * the BatchAligner using the given number of threads
+ */
+void
+benchmarkBatch(const string &config, const vector<sequence> &queries, const vector<sequence> &targets, const similarityMatrix &simMat, const float &gop, const float &gep, const unsigned int &nThreads, const unsigned int &repetitions)
+{
+    alignmentMatrix mat(gop, gep, simMat);
+    vector<float> scores(queries.size() * targets.size());
+    printBenchmarkResult(cout, runBenchmark("gotoh_all_vs_all_serial", config, repetitions, [&]() {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            for (size_t t = 0; t < targets.size(); ++t) {
+                mat.gotoh(queries[q], targets[t]);
+                scores[q * targets.size() + t] = mat.score();
+            }
+        }
+    }));
+
+    BSDL::BatchAligner<float, similarityMatrix> aligner(BSDL::BatchAlgorithm::Gotoh, gop, gep, simMat, nThreads);
+    BSDL::AlignmentTable<float> table;
+    printBenchmarkResult(cout, runBenchmark("gotoh_all_vs_all_batch_" + std::to_string(nThreads) + "_threads", config, repetitions, [&]() {
+        aligner.align(queries, targets, table);
+    }));
+    if (table.scores() != scores) {
+        cout << "# " << config << ": WARNING scores of the serial and the batch alignments differ" << std::endl;
+    }
+}
+
+int
+main(int argc, char *argv[]) {
+
+    vector<unsigned int> lengths;
+    unsigned int pairs;
+    unsigned int repetitions;
+    unsigned int seed;
+    unsigned int threads;
+    float gep;
+    float gop;
+    string matrixFile;
+
+    po::options_description allOpts("Benchmark of the pairwise alignment implementations of BioSeqDataLib.\n\nAllowed options are displayed below.");
+    allOpts.add_options()
+            ("help,h", "Produces this help message")
+            ("lengths,l", po::value<vector<unsigned int> >(&lengths)->multitoken()->default_value(vector<unsigned int>{100, 300, 1000, 3000}, "100 300 1000 3000"),
+             "Lengths of the synthetic sequence pairs.")
+            ("pairs", po::value<unsigned int>(&pairs)->default_value(20), "Number of sequence pairs per measured run.")
+            ("repetitions,r", po::value<unsigned int>(&repetitions)->default_value(3), "Number of measured runs per benchmark.")
+            ("seed", po::value<unsigned int>(&seed)->default_value(42), "Seed of the random number generator.")
+            ("threads,t", po::value<unsigned int>(&threads)->default_value(1), "Number of threads of the batch alignments.")
+            ("gep", po::value<float>(&gep)->default_value(-11), "Gap penalty (homogenous gap costs).")
+            ("gop", po::value<float>(&gop)->default_value(-10), "Gap opening penalty of the global alignments (gap extension penalty: -1).")
+            ("matrix,m", po::value<string>(&matrixFile)->default_value(string(ALIGN_TEST_DATA) + "/BLOSUM62.txt"), "The similarity matrix.");
+
+    try {
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(allOpts).run(), vm);
+        if (vm.count("help")) {
+            cout << allOpts << "\n";
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    }
+    catch (po::error &e) {
+        cerr << "An error occurred parsing the commandline: \n";
+        cerr << e.what() << "\n";
+        cerr << "Please use -h/--help for more information.\n";
+        return EXIT_FAILURE;
+    }
+
+    try {
+        similarityMatrix simMat(matrixFile);
+        printBenchmarkHeader(cout);
+
+        // the sequence pair of the Smith-Waterman unit tests
+        vector<std::pair<sequence, sequence> > testPairs(pairs, std::make_pair(
+            sequence("seq1", "WWWWWWWWWWQGPYELSDTLQAPVLNDEWGTEAVFELLSNAVWWWWWWWWWWWWW", "", ""),
+            sequence("seq2", "PPPPPPPPPPPQGPYELSDDTNQAPVLNDEGTEAVFELLSNAVPPPPPPPPPPPP", "", "")));
+        benchmarkPairs("unit_test_pair", testPairs, simMat, gep, repetitions);
+
+        // related: the best alignment covers 90% of the sequences, local: only 10%
+        for (auto &length : lengths) {
+            std::mt19937 rng(seed);
+            vector<std::pair<sequence, sequence> > related, local;
+            for (unsigned int i = 0; i < pairs; ++i) {
+                related.push_back(syntheticPair(length, length * 9 / 10, rng));
+                local.push_back(syntheticPair(length, length / 10, rng));
+            }
+            benchmarkPairs("related_" + std::to_string(length), related, simMat, gep, repetitions);
+            benchmarkPairs("local_" + std::to_string(length), local, simMat, gep, repetitions);
+            benchmarkGlobalPairs("related_" + std::to_string(length), related, simMat, gop, -1, repetitions);
+        }
+
+        // pairs of mixed lengths, the DP matrices of consecutive alignments have different shapes
+        std::mt19937 rng(seed);
+        vector<std::pair<sequence, sequence> > mixed;
+        for (unsigned int i = 0; i < pairs; ++i) {
+            for (auto &length : lengths) {
+                size_t len = std::uniform_int_distribution<size_t>(length / 2, length)(rng);
+                mixed.push_back(syntheticPair(len, len * 9 / 10, rng));
+            }
+        }
+        benchmarkKernels("mixed_lengths", mixed, simMat, gop, -1, repetitions);
+
+        // all-vs-all alignment of the first against the second sequences of the mixed pairs
+        vector<sequence> queries, targets;
+        for (size_t i = 0; (i < mixed.size()) && (i < 40); ++i) {
+            queries.push_back(mixed[i].first);
+            targets.push_back(mixed[i].second);
+        }
+        benchmarkBatch("mixed_all_vs_all", queries, targets, simMat, gop, -1, threads, repetitions);
+    }
+    catch (const std::exception &e) {
+        cerr << "An error occured during the benchmark run: \n";
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
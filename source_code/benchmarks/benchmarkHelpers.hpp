@@ -0,0 +1,100 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARKS_BENCHMARKHELPERS_HPP
+#define BENCHMARKS_BENCHMARKHELPERS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * timing result of one benchmark
+ */
+struct
+benchmarkResult {
+    std::string name;
+    std::string config;
+    unsigned int repetitions = 0;
+    double min_seconds = 0.0;
+    double mean_seconds = 0.0;
+};
+
+/**
+ * @brief prints the header line for benchmarkResults in tab separated format
+ */
+inline void
+printBenchmarkHeader(std::ostream &out)
+{
+    out << "# benchmark\tconfiguration\trepetitions\tmin_seconds\tmean_seconds\n";
+}
+
+/**
+ * @brief prints a benchmarkResult as tab separated line
+ */
+inline void
+printBenchmarkResult(std::ostream &out, const benchmarkResult &result)
+{
+    out << result.name << "\t" << result.config << "\t" << result.repetitions << "\t" << std::fixed << std::setprecision(6)
+        << result.min_seconds << "\t" << result.mean_seconds << std::endl;
+}
+
+/**
+ * @brief runs a benchmark several times and measures the wall time of every run
+ * @details setup is called before every run and is not part of the measured time
+ *
+ * @param name name of the benchmark
+ * @param config description of the benchmark configuration
+ * @param repetitions number of measured runs
+ * @param setup function preparing a run
+ * @param run function to measure
+ */
+template<typename SetupFunction, typename RunFunction>
+benchmarkResult
+runBenchmark(const std::string &name, const std::string &config, const unsigned int &repetitions, SetupFunction setup, RunFunction run)
+{
+    benchmarkResult result;
+    result.name = name;
+    result.config = config;
+    result.repetitions = repetitions;
+
+    double total = 0.0;
+    for (unsigned int rep = 0; rep < repetitions; ++rep) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total += seconds;
+        result.min_seconds = (rep == 0) ? seconds : std::min(result.min_seconds, seconds);
+    }
+    if (repetitions != 0) {
+        result.mean_seconds = total / repetitions;
+    }
+    return result;
+}
+
+/**
+ * @brief runs a benchmark without setup several times and measures the wall time of every run
+ */
+template<typename RunFunction>
+benchmarkResult
+runBenchmark(const std::string &name, const std::string &config, const unsigned int &repetitions, RunFunction run)
+{
+    return runBenchmark(name, config, repetitions, [](){}, run);
+}
+
+#endif //BENCHMARKS_BENCHMARKHELPERS_HPP
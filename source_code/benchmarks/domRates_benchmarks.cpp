@@ -0,0 +1,180 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// boost header
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+// BioSeqDataLib header
+#include "../libs/BioSeqDataLib/src/phylogeny/MultiLayerTree.hpp"
+#include "../libs/BioSeqDataLib/src/phylogeny/fitch.hpp"
+#include "../libs/BioSeqDataLib/src/phylogeny/dollo.hpp"
+
+//DomRates header
+#include "../src/domRates.hpp"
+#include "../src/helperStructs.hpp"
+
+// benchmark header
+#include "benchmarkHelpers.hpp"
+#include "generators.hpp"
+
+namespace BSDL = BioSeqDataLib;
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+
+/*
+ * runs all DomRates phases separately on one synthetic data set
+ */
+void
+benchmarkDataSet(const treeShape &shape, const unsigned int &nLeaves, const annotationParams &params, const unsigned int &seed, const unsigned int &repetitions, const unsigned int &nthreads, const fs::path &workDir)
+{
+    std::mt19937 rng(seed);
+    string config = treeShapeToString(shape) + "_" + std::to_string(nLeaves);
+    fs::path dataDir = workDir / config;
+    fs::create_directories(dataDir);
+
+    // generate data
+    auto synthTree = generateTree(shape, nLeaves, rng);
+    fs::path treeFile = dataDir / "tree.nwk";
+    {
+        std::ofstream treeOut(treeFile.string());
+        treeOut << toNewick(*synthTree) << "\n";
+    }
+    unsigned long long nHits = generateAnnotations(*synthTree, params, dataDir, rng);
+    cout << "# " << config << ": " << nHits << " domain hits" << std::endl;
+
+    BSDL::MultiLayerTree nTree(nStateLayers);
+
+    // the tree is read again before every run, saveDomData has to start with empty leaf states
+    std::pair<posOrderMaps, eventMaps> maps;
+    printBenchmarkResult(cout, runBenchmark("saveDomData", config, repetitions,
+        [&]() { nTree.read(treeFile.string()); },
+        [&]() { maps = saveDomData(nTree, dataDir, "OG", ".dom"); }));
+    cout << "# " << config << ": " << maps.first.domainorder.size() << " arrangements, " << maps.first.single_domainorder.size() << " single domains" << std::endl;
+
+    const BSDL::MultiLayerTree::StateMatrix leafArrangements = nTree.layer(arrangementLayer);
+    const BSDL::MultiLayerTree::StateMatrix leafSingleDomains = nTree.layer(singleDomainLayer);
+
+    printBenchmarkResult(cout, runBenchmark("fitch", config, repetitions,
+        [&]() { nTree.layer(arrangementLayer) = leafArrangements; },
+        [&]() { BSDL::fitch(nTree, arrangementLayer); }));
+    printBenchmarkResult(cout, runBenchmark("dollo", config, repetitions,
+        [&]() { nTree.layer(singleDomainLayer) = leafSingleDomains; },
+        [&]() { BSDL::dollo(nTree, singleDomainLayer); }));
+
+    eventMaps emaps;
+    std::pair<solutionTypes, eventTypes> setypes;
+    printBenchmarkResult(cout, runBenchmark("eventReconstruction", config, repetitions,
+        [&]() { emaps = maps.second; },
+        [&]() { setypes = eventReconstruction(nTree, maps.first, emaps, nthreads); }));
+
+    fs::path outFile = dataDir / "rates.txt";
+    fs::path statsFile = dataDir / "stats.txt";
+    printBenchmarkResult(cout, runBenchmark("summary", config, repetitions, [&]() {
+        summary(nTree, emaps, setypes.first, setypes.second, outFile, statsFile, "", 0, true, "domRates_benchmarks");
+    }));
+}
+
+int
+main(int argc, char *argv[]) {
+
+    vector<unsigned int> leaves;
+    vector<string> shapes;
+    unsigned int repetitions;
+    unsigned int seed;
+    unsigned int nthreads;
+    fs::path workDir;
+    bool keep;
+    annotationParams params;
+
+    po::options_description allOpts("DomRates benchmarks on synthetic trees and domain annotations.\n\nAllowed options are displayed below.");
+    allOpts.add_options()
+            ("help,h", "Produces this help message")
+            ("leaves,l", po::value<vector<unsigned int> >(&leaves)->multitoken()->default_value(vector<unsigned int>{10, 100, 1000}, "10 100 1000"),
+             "Number of leaves (including the outgroup) of the synthetic trees.")
+            ("shape", po::value<vector<string> >(&shapes)->multitoken()->default_value(vector<string>{"balanced", "caterpillar", "random"}, "balanced caterpillar random"),
+             "Shapes of the synthetic trees (balanced, caterpillar, random).")
+            ("repetitions,r", po::value<unsigned int>(&repetitions)->default_value(3), "Number of measured runs per benchmark.")
+            ("seed", po::value<unsigned int>(&seed)->default_value(42), "Seed of the random number generator.")
+            ("arrangements", po::value<unsigned int>(&params.rootArrangements)->default_value(params.rootArrangements),
+             "Number of distinct arrangements at the root (arrangement diversity).")
+            ("domains", po::value<unsigned int>(&params.domainPool)->default_value(params.domainPool), "Number of distinct domains.")
+            ("length", po::value<unsigned int>(&params.maxArrangementLength)->default_value(params.maxArrangementLength),
+             "Maximal number of domains per arrangement at the root.")
+            ("rate", po::value<double>(&params.rearrangementRate)->default_value(params.rearrangementRate),
+             "Expected rearrangement events per arrangement and unit of branch length.")
+            ("proteins", po::value<unsigned int>(&params.maxProteinsPerArrangement)->default_value(params.maxProteinsPerArrangement),
+             "Maximal number of proteins per arrangement and species.")
+            ("threads,p", po::value<unsigned int>(&nthreads)->default_value(1), "Number of threads for the event reconstruction.")
+            ("workdir,w", po::value<fs::path>(&workDir), "Directory for the synthetic data (default: temporary directory).")
+            ("keep,k", po::value<bool>(&keep)->default_value(false)->zero_tokens(), "Keep the synthetic data after the run.");
+
+    try {
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(allOpts).run(), vm);
+        if (vm.count("help")) {
+            cout << allOpts << "\n";
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    }
+    catch (po::error &e) {
+        cerr << "An error occurred parsing the commandline: \n";
+        cerr << e.what() << "\n";
+        cerr << "Please use -h/--help for more information.\n";
+        return EXIT_FAILURE;
+    }
+
+    try {
+        bool tmpDir = workDir.empty();
+        if (tmpDir) {
+            workDir = fs::temp_directory_path() / fs::unique_path("domrates_benchmarks_%%%%%%");
+        }
+        fs::create_directories(workDir);
+
+        printBenchmarkHeader(cout);
+        for (auto &shapeName : shapes) {
+            treeShape shape = treeShapeFromString(shapeName);
+            for (auto &nLeaves : leaves) {
+                benchmarkDataSet(shape, nLeaves, params, seed, repetitions, nthreads, workDir);
+            }
+        }
+
+        if (!keep) {
+            fs::remove_all(workDir);
+        }
+        else {
+            cout << "# synthetic data kept in " << workDir.string() << std::endl;
+        }
+    }
+    catch (const std::exception &e) {
+        cerr << "An error occured during the benchmark run: \n";
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,418 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "generators.hpp"
+
+using std::string;
+using std::vector;
+using std::unique_ptr;
+
+typedef vector<unsigned int> arrangement;
+
+namespace {
+
+unique_ptr<syntheticNode>
+newLeaf(const string &name)
+{
+    unique_ptr<syntheticNode> leaf(new syntheticNode());
+    leaf->name = name;
+    return leaf;
+}
+
+unique_ptr<syntheticNode>
+join(unique_ptr<syntheticNode> left, unique_ptr<syntheticNode> right)
+{
+    unique_ptr<syntheticNode> node(new syntheticNode());
+    node->children.push_back(std::move(left));
+    node->children.push_back(std::move(right));
+    return node;
+}
+
+unique_ptr<syntheticNode>
+balancedSubtree(vector<unique_ptr<syntheticNode> > &leaves)
+{
+    // splits the range of leaves in two halves until single leaves remain and joins the finished halves, the left
+    // half is finished first
+    struct range {
+        size_t from;
+        size_t to;
+        bool split;
+    };
+    vector<range> todo(1, range{0, leaves.size(), false});
+    vector<unique_ptr<syntheticNode> > finished;
+    while (!todo.empty()) {
+        range current = todo.back();
+        todo.pop_back();
+        if (current.to - current.from == 1) {
+            finished.push_back(std::move(leaves[current.from]));
+        }
+        else if (current.split) {
+            unique_ptr<syntheticNode> right = std::move(finished.back());
+            finished.pop_back();
+            finished.back() = join(std::move(finished.back()), std::move(right));
+        }
+        else {
+            size_t mid = current.from + (current.to - current.from) / 2;
+            todo.push_back(range{current.from, current.to, true});
+            todo.push_back(range{mid, current.to, false});
+            todo.push_back(range{current.from, mid, false});
+        }
+    }
+    return std::move(finished.back());
+}
+
+void
+setEdgeLengths(syntheticNode &root, std::mt19937 &rng)
+{
+    // preorder with an explicit stack
+    std::uniform_real_distribution<double> edgeDist(0.01, 1.0);
+    vector<syntheticNode *> todo(1, &root);
+    while (!todo.empty()) {
+        syntheticNode *node = todo.back();
+        todo.pop_back();
+        node->edgeLength = edgeDist(rng);
+        for (auto child = node->children.rbegin(); child != node->children.rend(); ++child) {
+            todo.push_back(child->get());
+        }
+    }
+}
+
+void
+writeNewick(const syntheticNode &root, string &out)
+{
+    // every node is visited before its children and once more after them
+    vector<std::pair<const syntheticNode *, size_t> > todo(1, std::make_pair(&root, 0));
+    while (!todo.empty()) {
+        const syntheticNode *node = todo.back().first;
+        size_t &next = todo.back().second;
+        if (next < node->children.size()) {
+            out.push_back((next == 0) ? '(' : ',');
+            todo.push_back(std::make_pair(node->children[next++].get(), 0));
+            continue;
+        }
+        if (!node->children.empty()) {
+            out.push_back(')');
+        }
+        out.append(node->name);
+        todo.pop_back();
+        if (!todo.empty()) {
+            out.append(":" + std::to_string(node->edgeLength));
+        }
+    }
+}
+
+string
+accession(const unsigned int &domain)
+{
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "PF%05u", domain);
+    return string(buf);
+}
+
+arrangement
+randomArrangement(const annotationParams &params, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<unsigned int> lenDist(1, params.maxArrangementLength);
+    std::uniform_int_distribution<unsigned int> domDist(0, params.domainPool - 1);
+    arrangement arr(lenDist(rng));
+    for (auto &dom : arr) {
+        dom = domDist(rng);
+    }
+    return arr;
+}
+
+/*
+ * applies one random rearrangement event to a set of arrangements
+ */
+void
+rearrange(vector<arrangement> &arrangements, const annotationParams &params, std::mt19937 &rng)
+{
+    // arrangement losses are as likely as the four event types creating a new arrangement, so the expected number of
+    // arrangements stays constant along a branch instead of growing exponentially with the depth of the tree
+    std::discrete_distribution<unsigned int> eventDist({1, 1, 1, 1, 4, 1});
+    std::uniform_int_distribution<unsigned int> domDist(0, params.domainPool - 1);
+    std::uniform_int_distribution<size_t> arrDist(0, arrangements.empty() ? 0 : arrangements.size() - 1);
+
+    unsigned int event = eventDist(rng);
+    if (arrangements.empty() && event != 5) {
+        return;
+    }
+    size_t pos = arrDist(rng);
+
+    switch (event) {
+        case 0: { // fusion
+            arrangement fused = arrangements[pos];
+            const arrangement &second = arrangements[arrDist(rng)];
+            fused.insert(fused.end(), second.begin(), second.end());
+            arrangements.push_back(fused);
+            break;
+        }
+        case 1: { // fission
+            if (arrangements[pos].size() < 2) {
+                return;
+            }
+            std::uniform_int_distribution<size_t> splitDist(1, arrangements[pos].size() - 1);
+            size_t split = splitDist(rng);
+            arrangement front(arrangements[pos].begin(), arrangements[pos].begin() + split);
+            arrangement back(arrangements[pos].begin() + split, arrangements[pos].end());
+            arrangements[pos] = front;
+            arrangements.push_back(back);
+            break;
+        }
+        case 2: { // terminal loss
+            if (arrangements[pos].size() < 2) {
+                return;
+            }
+            if (rng() % 2) {
+                arrangements[pos].pop_back();
+            }
+            else {
+                arrangements[pos].erase(arrangements[pos].begin());
+            }
+            break;
+        }
+        case 3: { // terminal emergence
+            arrangement extended = arrangements[pos];
+            if (rng() % 2) {
+                extended.push_back(domDist(rng));
+            }
+            else {
+                extended.insert(extended.begin(), domDist(rng));
+            }
+            arrangements.push_back(extended);
+            break;
+        }
+        case 4: { // arrangement loss (a single domain loss if the arrangement has one domain)
+            arrangements[pos] = arrangements.back();
+            arrangements.pop_back();
+            break;
+        }
+        default: { // single domain emergence
+            arrangements.push_back(arrangement(1, domDist(rng)));
+            break;
+        }
+    }
+}
+
+void
+writeLeaf(const syntheticNode &leaf, const vector<arrangement> &arrangements, const annotationParams &params, const fs::path &outDir, std::mt19937 &rng, unsigned long long &nHits)
+{
+    fs::path outFile = outDir / (leaf.name + ".dom");
+    std::ofstream out(outFile.string());
+    if (!out) {
+        throw std::runtime_error("Error: could not write synthetic annotation file " + outFile.string());
+    }
+    out << "# pfam_scan.pl, synthetic DomRates benchmark data\n";
+    out << "# <seq id> <alignment start> <alignment end> <envelope start> <envelope end> <hmm acc> <hmm name> <type> <hmm start> <hmm end> <hmm length> <bit score> <E-value> <significance> <clan>\n\n";
+
+    std::uniform_int_distribution<unsigned int> protDist(1, params.maxProteinsPerArrangement);
+    unsigned int protein = 0;
+    for (auto &arr : arrangements) {
+        unsigned int nProteins = protDist(rng);
+        for (unsigned int p = 0; p < nProteins; ++p) {
+            string protName = leaf.name + "_" + std::to_string(++protein);
+            for (size_t i = 0; i < arr.size(); ++i) {
+                size_t start = 1 + i * 60;
+                size_t end = start + 49;
+                string acc = accession(arr[i]);
+                out << protName << " " << start << " " << end << " " << start << " " << end << " " << acc << " D" << acc
+                    << " Domain 1 50 60 30.0 1e-10 1 No_clan\n";
+                ++nHits;
+            }
+        }
+    }
+}
+
+void
+evolve(const syntheticNode &root, vector<arrangement> rootArrangements, const annotationParams &params, const fs::path &outDir, std::mt19937 &rng, unsigned long long &nHits)
+{
+    // number of leaves below every node, children are counted before their parents
+    std::unordered_map<const syntheticNode *, size_t> nLeaves;
+    vector<const syntheticNode *> order(1, &root);
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (auto &child : order[i]->children) {
+            order.push_back(child.get());
+        }
+    }
+    for (auto node = order.rbegin(); node != order.rend(); ++node) {
+        size_t &count = nLeaves[*node];
+        count = (*node)->children.empty() ? 1 : 0;
+        for (auto &child : (*node)->children) {
+            count += nLeaves[child.get()];
+        }
+    }
+
+    // the child with the most leaves is evolved last and takes over the arrangements of its parent, all other children
+    // get a copy; only the arrangements of the children waiting on the stack are stored, for caterpillar trees at most
+    // two sets at a time
+    vector<std::pair<const syntheticNode *, vector<arrangement> > > todo;
+    todo.push_back(std::make_pair(&root, std::move(rootArrangements)));
+    while (!todo.empty()) {
+        const syntheticNode &node = *todo.back().first;
+        vector<arrangement> arrangements = std::move(todo.back().second);
+        todo.pop_back();
+
+        double meanEvents = params.rearrangementRate * node.edgeLength * arrangements.size();
+        unsigned int nEvents = 0;
+        if (meanEvents > 0) {
+            std::poisson_distribution<unsigned int> eventDist(meanEvents);
+            nEvents = eventDist(rng);
+        }
+        for (unsigned int e = 0; e < nEvents; ++e) {
+            rearrange(arrangements, params, rng);
+        }
+
+        if (node.children.empty()) {
+            writeLeaf(node, arrangements, params, outDir, rng, nHits);
+            continue;
+        }
+        size_t largest = 0;
+        for (size_t i = 1; i < node.children.size(); ++i) {
+            if (nLeaves[node.children[i].get()] > nLeaves[node.children[largest].get()]) {
+                largest = i;
+            }
+        }
+        size_t largestPos = todo.size();
+        todo.push_back(std::make_pair(node.children[largest].get(), vector<arrangement>()));
+        for (size_t i = node.children.size(); i-- > 0; ) {
+            if (i != largest) {
+                todo.push_back(std::make_pair(node.children[i].get(), arrangements));
+            }
+        }
+        todo[largestPos].second = std::move(arrangements);
+    }
+}
+
+}
+
+syntheticNode::~syntheticNode()
+{
+    // the children of the children are taken over before a child is deleted, so every deletion is flat
+    vector<unique_ptr<syntheticNode> > pending = std::move(children);
+    while (!pending.empty()) {
+        unique_ptr<syntheticNode> node = std::move(pending.back());
+        pending.pop_back();
+        for (auto &child : node->children) {
+            pending.push_back(std::move(child));
+        }
+        node->children.clear();
+    }
+}
+
+treeShape
+treeShapeFromString(const string &name)
+{
+    if (name == "balanced") {
+        return balanced;
+    }
+    if (name == "caterpillar") {
+        return caterpillar;
+    }
+    if (name == "random") {
+        return random_shape;
+    }
+    throw std::runtime_error("Error: unknown tree shape '" + name + "' (use balanced, caterpillar or random)");
+}
+
+string
+treeShapeToString(const treeShape &shape)
+{
+    switch (shape) {
+        case balanced:
+            return "balanced";
+        case caterpillar:
+            return "caterpillar";
+        default:
+            return "random";
+    }
+}
+
+unique_ptr<syntheticNode>
+generateTree(const treeShape &shape, const unsigned int &nLeaves, std::mt19937 &rng)
+{
+    if (nLeaves < 3) {
+        throw std::runtime_error("Error: a synthetic tree needs at least 3 leaves");
+    }
+
+    vector<unique_ptr<syntheticNode> > leaves;
+    for (unsigned int i = 1; i < nLeaves; ++i) {
+        leaves.push_back(newLeaf("L" + std::to_string(i)));
+    }
+
+    unique_ptr<syntheticNode> ingroup;
+    switch (shape) {
+        case balanced:
+            ingroup = balancedSubtree(leaves);
+            break;
+        case caterpillar:
+            ingroup = std::move(leaves[0]);
+            for (size_t i = 1; i < leaves.size(); ++i) {
+                ingroup = join(std::move(ingroup), std::move(leaves[i]));
+            }
+            break;
+        default:
+            while (leaves.size() > 1) {
+                std::uniform_int_distribution<size_t> pick(0, leaves.size() - 1);
+                size_t a = pick(rng);
+                unique_ptr<syntheticNode> left = std::move(leaves[a]);
+                leaves[a] = std::move(leaves.back());
+                leaves.pop_back();
+                std::uniform_int_distribution<size_t> pick2(0, leaves.size() - 1);
+                size_t b = pick2(rng);
+                leaves[b] = join(std::move(left), std::move(leaves[b]));
+            }
+            ingroup = std::move(leaves[0]);
+    }
+
+    unique_ptr<syntheticNode> root = join(std::move(ingroup), newLeaf("OG"));
+    setEdgeLengths(*root, rng);
+    root->edgeLength = 0.0;
+    return root;
+}
+
+string
+toNewick(const syntheticNode &root)
+{
+    string out;
+    writeNewick(root, out);
+    out.push_back(';');
+    return out;
+}
+
+unsigned long long
+generateAnnotations(const syntheticNode &root, const annotationParams &params, const fs::path &outDir, std::mt19937 &rng)
+{
+    if (params.domainPool == 0 || params.maxArrangementLength == 0 || params.maxProteinsPerArrangement == 0) {
+        throw std::runtime_error("Error: domain pool, arrangement length and proteins per arrangement have to be positive");
+    }
+    fs::create_directories(outDir);
+
+    vector<arrangement> rootArrangements;
+    for (unsigned int i = 0; i < params.rootArrangements; ++i) {
+        rootArrangements.push_back(randomArrangement(params, rng));
+    }
+
+    unsigned long long nHits = 0;
+    evolve(root, rootArrangements, params, outDir, rng, nHits);
+    return nHits;
+}
@@ -0,0 +1,105 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARKS_GENERATORS_HPP
+#define BENCHMARKS_GENERATORS_HPP
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// boost header
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+/**
+ * shapes of synthetic trees
+ */
+enum treeShape {
+    balanced, // every inner node splits its leaves in two halves
+    caterpillar, // every inner node has at least one leaf as child
+    random_shape // inner nodes join two randomly chosen subtrees
+};
+
+/**
+ * @brief parses the name of a tree shape ("balanced", "caterpillar" or "random")
+ */
+treeShape treeShapeFromString(const std::string &name);
+
+/**
+ * @brief returns the name of a tree shape
+ */
+std::string treeShapeToString(const treeShape &shape);
+
+/**
+ * node of a synthetic tree
+ */
+struct
+syntheticNode {
+    std::string name;
+    double edgeLength = 0.0;
+    std::vector<std::unique_ptr<syntheticNode> > children;
+
+    syntheticNode() = default;
+    // deletes the subtree without recursion, caterpillar trees are as deep as they have leaves
+    ~syntheticNode();
+};
+
+/**
+ * parameters of the simulated domain arrangement evolution
+ */
+struct
+annotationParams {
+    unsigned int rootArrangements = 200; // number of distinct arrangements at the root (arrangement diversity)
+    unsigned int domainPool = 500; // number of distinct domains that can be used
+    unsigned int maxArrangementLength = 6; // maximal number of domains of an arrangement at the root
+    double rearrangementRate = 0.05; // expected rearrangement events per arrangement and unit of branch length
+    unsigned int maxProteinsPerArrangement = 3; // every arrangement of a leaf is annotated in 1 to n proteins
+};
+
+/**
+ * @brief creates a strictly bifurcating tree with the given number of leaves
+ * @details the root has two children: the outgroup leaf "OG" and the ingroup containing all other leaves
+ * ("L1", "L2", ...) in the requested shape; branch lengths are drawn uniformly from [0.01,1)
+ *
+ * @param shape shape of the ingroup
+ * @param nLeaves total number of leaves including the outgroup (at least 3)
+ * @param rng random number generator
+ */
+std::unique_ptr<syntheticNode> generateTree(const treeShape &shape, const unsigned int &nLeaves, std::mt19937 &rng);
+
+/**
+ * @brief turns a synthetic tree into a string in newick format
+ */
+std::string toNewick(const syntheticNode &root);
+
+/**
+ * @brief simulates domain arrangement evolution along a tree and writes one pfam_scan file per leaf
+ * @details starting with random arrangements at the root, fusions, fissions, terminal losses, terminal emergences,
+ * losses of whole arrangements and single domain emergences are applied along every branch; the number of events on a
+ * branch is poisson distributed with mean rearrangementRate * edge length * number of arrangements; arrangement losses
+ * are as frequent as all gains together to keep the number of arrangements stable on deep trees
+ *
+ * @param root root of the tree
+ * @param params parameters of the simulation
+ * @param outDir directory the annotation files (<leaf name>.dom) are written to
+ * @param rng random number generator
+ * @return total number of domain hits written
+ */
+unsigned long long generateAnnotations(const syntheticNode &root, const annotationParams &params, const fs::path &outDir, std::mt19937 &rng);
+
+#endif //BENCHMARKS_GENERATORS_HPP
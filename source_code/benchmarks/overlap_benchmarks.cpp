@@ -0,0 +1,138 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// boost header
+#include <boost/program_options.hpp>
+
+// BioSeqDataLib header
+#include "../libs/BioSeqDataLib/src/DomainModule.hpp"
+
+// benchmark header
+#include "benchmarkHelpers.hpp"
+
+namespace BSDL = BioSeqDataLib;
+namespace po = boost::program_options;
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+
+/*
+ * creates a titin-like protein: a long chain of Ig/FN3-like repeats, each annotated by Pfam, SUPERFAMILY and Gene3D
+ * with slightly shifted boundaries, plus spurious short Pfam hits and Gene3D hits spanning two repeats
+ */
+BSDL::DomainArrangement<BSDL::Domain>
+titinLikeProtein(const unsigned int &nRepeats, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<int> shiftDist(-8, 8);
+    std::uniform_real_distribution<double> evalDist(1e-30, 1e-3);
+    std::uniform_real_distribution<double> coin(0, 1);
+
+    vector<BSDL::Domain> hits;
+    unsigned long start = 50;
+    for (unsigned int i = 0; i < nRepeats; ++i) {
+        string acc = (i % 3 == 0) ? "PF00041" : "PF07679";
+        hits.emplace_back(acc, start, start + 90, evalDist(rng), BSDL::DomainDB::pfam);
+        hits.emplace_back("SSF48726", start + 5 + shiftDist(rng), start + 95 + shiftDist(rng), evalDist(rng), BSDL::DomainDB::superfamily);
+        hits.emplace_back("G3DSA:2.60.40.10", start + 8 + shiftDist(rng), start + 92 + shiftDist(rng), evalDist(rng), BSDL::DomainDB::gene3d);
+        if (coin(rng) < 0.2) {
+            hits.emplace_back("G3DSA:2.60.40.10", start + 40, start + 140, evalDist(rng), BSDL::DomainDB::gene3d);
+        }
+        if (coin(rng) < 0.1) {
+            hits.emplace_back("PF13927", start + 60, start + 85, evalDist(rng), BSDL::DomainDB::pfam);
+        }
+        start += 95 + shiftDist(rng);
+    }
+    std::stable_sort(hits.begin(), hits.end(), [](const BSDL::Domain &a, const BSDL::Domain &b) { return a.start() < b.start(); });
+
+    BSDL::DomainArrangement<BSDL::Domain> da;
+    for (auto &hit : hits) {
+        da.push_back(hit);
+    }
+    return da;
+}
+
+int
+main(int argc, char *argv[]) {
+
+    vector<unsigned int> repeats;
+    unsigned int proteins;
+    unsigned int repetitions;
+    unsigned int seed;
+
+    po::options_description allOpts("Benchmark of the domain overlap resolution on titin-like proteins.\n\nAllowed options are displayed below.");
+    allOpts.add_options()
+            ("help,h", "Produces this help message")
+            ("repeats", po::value<vector<unsigned int> >(&repeats)->multitoken()->default_value(vector<unsigned int>{100, 300, 1000, 3000}, "100 300 1000 3000"),
+             "Number of domain repeats per protein (every repeat yields three to five hits).")
+            ("proteins", po::value<unsigned int>(&proteins)->default_value(20), "Number of proteins per measured run.")
+            ("repetitions,r", po::value<unsigned int>(&repetitions)->default_value(3), "Number of measured runs per benchmark.")
+            ("seed", po::value<unsigned int>(&seed)->default_value(42), "Seed of the random number generator.");
+
+    try {
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(allOpts).run(), vm);
+        if (vm.count("help")) {
+            cout << allOpts << "\n";
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    }
+    catch (po::error &e) {
+        cerr << "An error occurred parsing the commandline: \n";
+        cerr << e.what() << "\n";
+        cerr << "Please use -h/--help for more information.\n";
+        return EXIT_FAILURE;
+    }
+
+    const vector<BSDL::DomainDB> dbImportance = {BSDL::DomainDB::pfam, BSDL::DomainDB::superfamily, BSDL::DomainDB::gene3d, BSDL::DomainDB::unknown};
+
+    printBenchmarkHeader(cout);
+    for (auto &nRepeats : repeats) {
+        std::mt19937 rng(seed);
+        vector<BSDL::DomainArrangement<BSDL::Domain> > original;
+        size_t nHits = 0;
+        for (unsigned int i = 0; i < proteins; ++i) {
+            original.push_back(titinLikeProtein(nRepeats, rng));
+            nHits += original.back().size();
+        }
+
+        string config = std::to_string(nRepeats) + "_repeats";
+        cout << "# " << config << ": " << nHits / proteins << " hits per protein" << std::endl;
+
+        vector<BSDL::DomainArrangement<BSDL::Domain> > arrangements;
+        size_t nKept = 0;
+        printBenchmarkResult(cout, runBenchmark("solveDbOverlaps", config, repetitions,
+            [&]() { arrangements = original; },
+            [&]() {
+                for (auto &da : arrangements) {
+                    da.solveDbOverlaps(dbImportance, 10, 0.1);
+                }
+            }));
+        for (auto &da : arrangements) {
+            nKept += da.size();
+        }
+        cout << "# " << config << ": " << nKept / proteins << " domains kept per protein" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -50,6 +50,7 @@
 #include "domain/SFDomain.hpp"
 #include "domain/DomainArrangement.hpp"
 #include "domain/DomainArrangementSet.hpp"
+#include "domain/ArrangementSimilarity.hpp"
 
 
 /** @} */ // Domain module
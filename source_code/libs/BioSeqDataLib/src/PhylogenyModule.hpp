@@ -31,6 +31,8 @@
 
 #include "phylogeny/Tree.hpp"
 #include "phylogeny/PhylogeneticTree.hpp"
+#include "phylogeny/DistanceMatrix.hpp"
+#include "phylogeny/MultiLayerTree.hpp"
 
 /** @} */ // PhyloGroup
 
@@ -29,16 +29,22 @@
 #ifndef AlignmentMatrix_hpp
 #define AlignmentMatrix_hpp
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <map>
 #include <set>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include "../utility/Matrix.hpp"
 #include "../utility/MatrixStack.hpp"
 #include "../utility/SimilarityMatrix.hpp"
 #include "../utility/LineMatrix.hpp"
+#include "../utility/PackedMatrix.hpp"
 #include "EditSequence.hpp"
+#include "sw_striped.hpp"
 
 namespace BioSeqDataLib
 {
@@ -54,14 +60,20 @@ namespace BioSeqDataLib
 template<typename DataType, typename SimMat>
 class AlignmentMatrix {
 private:
-    enum class Algorithm {NW, SW, Gotoh, Raspodom_NW, Unknown}; // Class to keep track of the algorithm used
+    enum class Algorithm {NW, SW, Gotoh, Gotoh_Linear, Banded, Raspodom_NW, ScoreOnly, Unknown}; // Class to keep track of the algorithm used
 
     DataType gop_; // gap opening penalty
     DataType gep_; // gap extension penalty
     SimMat simMat_;  // the similarity matrix to use
 
-    MatrixStack<3, std::pair<DataType, char> > matrices_; // matrix for the gotoh algorithm
-    mutable Matrix<std::pair<DataType, char> > matrix_;   // matrix for nw/sw/raspodom algorithm
+    // nw/sw/gotoh: the scores are only kept for the rows needed by the recursion, the traceback for all cells
+    std::vector<DataType> scoreRows_;
+    PackedMatrix<2> trace_;      // nw/sw: the direction of every cell, see Trace
+    PackedMatrix<4> traceGotoh_; // gotoh: the direction of the match matrix and whether the gap matrices extend a gap
+
+    // directions of the traceback (bits 0-1), for gotoh the source of the match matrix. Bit 2/3 of the Gotoh
+    // traceback: the vertical/horizontal gap matrix extends an existing gap (otherwise it opens one)
+    enum Trace : unsigned char {TraceStart = 0, TraceMatch = 1, TraceVert = 2, TraceHor = 3, TraceVertExtend = 4, TraceHorExtend = 8};
 
     enum Algorithm algorithm_;  // stores the algorithm used in the last run
     size_t dim1_;   // the first dimension of the matrix
@@ -72,6 +84,19 @@ private:
     size_t best_score_y_;  // stores the ending y-coordinate of the best alignment
     size_t seq1_length_;   // length of the first sequence
     size_t seq2_length_;   // length of the second sequence
+    size_t offset1_;       // SW, position in the first sequence the matrix starts with
+    size_t offset2_;       // SW, position in the second sequence the matrix starts with
+    bool simd_;            // SW, use the striped SIMD kernel if possible
+
+    // banded / X-drop, only the cells [bandBegin_[i], bandEnd_[i]) of row i are stored, starting at bandOffset_[i]
+    std::vector<size_t> bandBegin_;
+    std::vector<size_t> bandEnd_;
+    std::vector<size_t> bandOffset_;
+    std::vector<unsigned char> bandTrace_; // traceback of the three Gotoh matrices, see band_fill_
+    // banded / X-drop, bounds of the score that can still be reached, see best_matches_. banded_ turns them into the
+    // sums of the k highest scores (see off_band_bound_), gotoh_xdrop into sums over the suffixes of the sequences
+    std::vector<DataType> bestMatch1_;
+    std::vector<DataType> bestMatch2_;
 
 
     //**********************************************************
@@ -115,6 +140,112 @@ private:
     void
     traceback_sw_() const;
 
+    /**
+     * \brief Fills the Smith-Waterman matrix for the region [begin1,end1)x[begin2,end2) of the sequences.
+     * \details Sets score_ and the end of the best alignment in the region.
+     * @return The score of the last cell of the region.
+     */
+    template<typename SeqType>
+    DataType
+    fill_sw_(const SeqType &seq1, const SeqType &seq2, size_t begin1, size_t end1, size_t begin2, size_t end2);
+
+    /**
+     * \brief Fills the band dLow <= j-i <= dHigh of the NW (affine=false) or Gotoh matrix.
+     * @return The score of the alignment.
+     */
+    template<typename SeqType>
+    DataType
+    band_fill_(const SeqType &seq1, const SeqType &seq2, long dLow, long dHigh, bool affine);
+
+    /**
+     * \brief Banded alignment, doubles the band until no alignment leaving the band can score better.
+     */
+    template<typename SeqType>
+    bool
+    banded_(const SeqType &seq1, const SeqType &seq2, size_t band, size_t maxBand, bool affine);
+
+    /**
+     * \brief Fills bestMatch1_ with the highest score every position of seq1 can reach with any position of seq2,
+     * bestMatch2_ the same for seq2.
+     */
+    template<typename SeqType>
+    void
+    best_matches_(const SeqType &seq1, const SeqType &seq2);
+
+    // characters: the best score of every pair of characters occurring in the sequences is calculated only once
+    template<typename SeqType>
+    void
+    best_matches_(const SeqType &seq1, const SeqType &seq2, std::true_type);
+
+    template<typename SeqType>
+    void
+    best_matches_(const SeqType &seq1, const SeqType &seq2, std::false_type);
+
+    /**
+     * \brief Upper bound of the score of any alignment containing at least minGaps gap positions.
+     * \details Such an alignment has at most (n+m-minGaps)/2 aligned pairs, see best_matches_. Negative gap opening
+     * costs are not counted as the end gaps of the sequences are not opened.
+     */
+    DataType
+    off_band_bound_(size_t minGaps, bool affine) const;
+
+    /**
+     * \brief Calculates the traceback of a banded or X-drop alignment ending in cell (i,j).
+     */
+    void
+    traceback_band_(size_t i, size_t j);
+
+    // Linear space Gotoh: how a sub problem is connected to the rest of the alignment.
+    // Free: no gap crosses the border, Continued: a vertical gap may be continued without opening costs,
+    // Required: the alignment has to leave the sub problem with a vertical gap (the opening costs are paid inside)
+    enum class GapBoundary {Free, Continued, Required};
+
+    /**
+     * \brief Gap opening costs of a vertical gap in column j, gaps at the ends of the sequences are not opened.
+     */
+    DataType
+    gop_v_(size_t j) const
+    {
+        return ((j == 0) || (j == dim2_)) ? 0 : gop_;
+    }
+
+    /**
+     * \brief Gap opening costs of a horizontal gap in row i, gaps at the ends of the sequences are not opened.
+     */
+    DataType
+    gop_h_(size_t i) const
+    {
+        return ((i == 0) || (i == dim1_)) ? 0 : gop_;
+    }
+
+    /**
+     * \brief Score-only Gotoh pass over the sub problem [i1,i2]x[j1,j2] keeping a single row.
+     * \details The forward pass starts in (i1,j1), the reverse pass in (i2,j2). On return best and vert contain the
+     * last row of the pass (row i2 resp. i1) in the direction of the pass, vert only the scores of paths whose last
+     * step is a vertical gap.
+     */
+    template<typename SeqType>
+    void
+    gotoh_linear_pass_(const SeqType &seq1, const SeqType &seq2, size_t i1, size_t i2, size_t j1, size_t j2, bool reverse,
+        GapBoundary boundary, std::vector<DataType> &best, std::vector<DataType> &vert) const;
+
+    /**
+     * \brief Aligns a sub problem with at most one row or few cells using the full Gotoh matrices.
+     */
+    template<typename SeqType>
+    DataType
+    gotoh_linear_block_(const SeqType &seq1, const SeqType &seq2, size_t i1, size_t i2, size_t j1, size_t j2,
+        GapBoundary start, GapBoundary end);
+
+    /**
+     * \brief Myers-Miller recursion, appends the alignment of the sub problem to the edit string.
+     * @return The score of the sub problem.
+     */
+    template<typename SeqType>
+    DataType
+    gotoh_linear_(const SeqType &seq1, const SeqType &seq2, size_t i1, size_t i2, size_t j1, size_t j2,
+        GapBoundary start, GapBoundary end);
+
     using MatchTracker = std::set<std::pair<size_t, size_t> >;
 
    /* bool
@@ -139,12 +270,18 @@ private:
             case Algorithm::Gotoh:
                 traceback_gotoh_();
                 break;
+            case Algorithm::Gotoh_Linear:
+            case Algorithm::Banded:
+                // the alignment is computed directly by gotoh_linear, the banded and the X-drop algorithms
+                break;
             /*case Algorithm::Raspodom_NW:
                 traceback_raspodom_nw_();
                 break;*/
             case Algorithm::SW:
                 traceback_sw_();
                 break;
+            case Algorithm::ScoreOnly:
+                throw std::runtime_error("no traceback available after a score-only alignment");
             default:
                 throw std::runtime_error("unknown algorithm");
         }
@@ -154,7 +291,7 @@ public:
     /**
      * Default constructor
      */
-    AlignmentMatrix(): algorithm_(Algorithm::Unknown)
+    AlignmentMatrix(): algorithm_(Algorithm::Unknown), offset1_(0), offset2_(0), simd_(true)
     {
     }
 
@@ -163,7 +300,7 @@ public:
      * @param gep    Gap extension costs
      * @param simMat Match penalty costs. Either of Type SimilarityMatrix for sequences or DSM otherwise.
      */
-    AlignmentMatrix(DataType gep, const SimMat &simMat) : gep_(gep), simMat_(simMat), algorithm_(Algorithm::Unknown)
+    AlignmentMatrix(DataType gep, const SimMat &simMat) : gep_(gep), simMat_(simMat), algorithm_(Algorithm::Unknown), offset1_(0), offset2_(0), simd_(true)
     {
     }
 
@@ -173,7 +310,7 @@ public:
      * @param gep    Gep extension pentalties
      * @param simMat Similarity matrix
      */
-    AlignmentMatrix(DataType gop, DataType gep, const SimMat &simMat) : gop_(gop), gep_(gep), simMat_(simMat), algorithm_(Algorithm::Unknown)
+    AlignmentMatrix(DataType gop, DataType gep, const SimMat &simMat) : gop_(gop), gep_(gep), simMat_(simMat), algorithm_(Algorithm::Unknown), offset1_(0), offset2_(0), simd_(true)
     {}
 
     /**
@@ -203,8 +340,87 @@ public:
     void
     gotoh(const SeqType &seq1, const SeqType &seq2);
 
+    /**
+     * \brief Run the Gotoh algorithm in linear space (Myers and Miller, 1988).
+     *
+     * Uses the same scoring as gotoh but only needs memory linear in the length of the sequences: The matrix is split at
+     * the middle row, the column in which the optimal alignment crosses it is determined by a score-only forward pass
+     * and a score-only reverse pass, and both halves are aligned recursively. The running time is about twice the one of
+     * gotoh. The score is identical, if several optimal alignments exist a different one may be returned.
+     * @param  seq1 First sequence
+     * @param  seq2 Second sequence
+     */
+    template<typename SeqType>
+    void
+    gotoh_linear(const SeqType &seq1, const SeqType &seq2);
+
+    /**
+     * \brief Run the Needleman-Wunsch algorithm restricted to a band around the diagonal.
+     *
+     * Only the cells with min(0,m-n)-w <= j-i <= max(0,m-n)+w are calculated, w being the band width. An alignment
+     * leaving the band needs at least 2(w+1)+|m-n| gap positions and therefore has fewer aligned pairs. The band width
+     * is doubled and the alignment recalculated until the score in the band is at least the best score such an
+     * alignment could reach (the gap costs plus the highest possible scores of the remaining pairs), the score is
+     * then optimal, i.e. equal to nw; with ties the returned alignment may differ. The bound is loose for distant
+     * sequences, these are usually only confirmed by a band covering the whole matrix.
+     * @param  seq1 First sequence
+     * @param  seq2 Second sequence
+     * @param  band The initial band width.
+     * @param  maxBand The maximal band width (0 = no limit).
+     * @return false if the alignment could not be confirmed with the maximal band width, i.e. a better alignment
+     * outside the band might exist.
+     */
+    template<typename SeqType>
+    bool
+    nw_banded(const SeqType &seq1, const SeqType &seq2, size_t band = 16, size_t maxBand = 0)
+    {
+        return banded_(seq1, seq2, band, maxBand, false);
+    }
+
+    /**
+     * \brief Run the Gotoh algorithm restricted to a band around the diagonal.
+     *
+     * Same band and confirmation as in nw_banded, the score of a confirmed result is then optimal, i.e. equal to
+     * gotoh; with ties the returned alignment may differ.
+     * @param  seq1 First sequence
+     * @param  seq2 Second sequence
+     * @param  band The initial band width.
+     * @param  maxBand The maximal band width (0 = no limit).
+     * @return false if the alignment could not be confirmed with the maximal band width.
+     */
+    template<typename SeqType>
+    bool
+    gotoh_banded(const SeqType &seq1, const SeqType &seq2, size_t band = 16, size_t maxBand = 0)
+    {
+        return banded_(seq1, seq2, band, maxBand, true);
+    }
+
+    /**
+     * \brief Extends an alignment from the start of both sequences using the X-drop criterion.
+     *
+     * Calculates the best scoring alignment of two prefixes with affine gap costs (every gap is opened). Cells
+     * scoring more than xDrop below the best score found so far are dropped, the calculation stops when a row has
+     * no cells left. Whenever the best extension lies inside the calculated cells, the result is identical to the
+     * one of the full matrix. A path through a dropped cell can recover and end with a higher score, the result is
+     * therefore only confirmed if no dropped cell can reach a higher score: its score plus, for the remaining
+     * positions of the sequences, the highest score each of them can reach. This bound is loose, mostly only the
+     * extensions of very similar sequences are confirmed. If no extension scores above 0 the result is empty.
+     * @param  seq1 First sequence
+     * @param  seq2 Second sequence
+     * @param  xDrop The X-drop value (positive).
+     * @return true if the result is the best extension, false if a better one through dropped cells might exist.
+     */
+    template<typename SeqType>
+    bool
+    gotoh_xdrop(const SeqType &seq1, const SeqType &seq2, DataType xDrop);
+
     /**
      * \brief Run the Smith-Waterman algorithm
+     *
+     * If the sequences consist of characters and all scores are integers, the score and the end of the best alignment
+     * are computed with the striped SIMD kernel (see swStripedHit) and the full matrix is only calculated for the
+     * region of the best alignment. Otherwise the complete matrix is calculated. If no pair of the sequences has a
+     * positive score, the score is 0 and the alignment is empty with all coordinates set to 0.
      * @param  seq1 First sequence
      * @param  seq2 Second sequence
      */
@@ -212,6 +428,54 @@ public:
     void
     sw(const SeqType &seq1, const SeqType &seq2);
 
+    /**
+     * \brief Computes only the score of the Needleman-Wunsch alignment.
+     *
+     * Only two rows of the matrix are stored and no traceback. To get the alignment of a pair (e.g. one of the best
+     * scoring ones) run nw on it afterwards, result() is not available after this function.
+     * @param  seq1 First sequence
+     * @param  seq2 Second sequence
+     * @return The score of the alignment, the same as score() after nw.
+     */
+    template<typename SeqType>
+    DataType
+    nw_score(const SeqType &seq1, const SeqType &seq2);
+
+    /**
+     * \brief Computes only the score of the Gotoh alignment.
+     *
+     * Only three rows (two of the match and one of the vertical gap matrix) are stored and no traceback, see nw_score.
+     * @param  seq1 First sequence
+     * @param  seq2 Second sequence
+     * @return The score of the alignment, the same as score() after gotoh.
+     */
+    template<typename SeqType>
+    DataType
+    gotoh_score(const SeqType &seq1, const SeqType &seq2);
+
+    /**
+     * \brief Computes only the score and the end of the best Smith-Waterman alignment.
+     *
+     * Uses the striped SIMD kernel if possible (see sw), otherwise two rows of the matrix. No traceback is stored,
+     * see nw_score.
+     * @param  seq1 First sequence
+     * @param  seq2 Second sequence
+     * @param[out] end1 The last position of the alignment in seq1 (0 if the score is 0).
+     * @param[out] end2 The last position of the alignment in seq2 (0 if the score is 0).
+     * @return The score of the alignment, the same as score() after sw.
+     */
+    template<typename SeqType>
+    DataType
+    sw_score(const SeqType &seq1, const SeqType &seq2, size_t &end1, size_t &end2);
+
+    template<typename SeqType>
+    DataType
+    sw_score(const SeqType &seq1, const SeqType &seq2)
+    {
+        size_t end1, end2;
+        return sw_score(seq1, seq2, end1, end2);
+    }
+
     /*
      * \brief Run the RASPDOM algorithm
      * @param  seq1 First sequence
@@ -265,6 +529,26 @@ public:
         return gop_;
     }
 
+    /**
+     * \brief Sets whether the Smith-Waterman algorithm may use the striped SIMD kernel (default: true).
+     * @param  use Use the kernel if possible.
+     */
+    void
+    simd(bool use)
+    {
+        simd_ = use;
+    }
+
+    /**
+     * \brief Returns whether the Smith-Waterman algorithm may use the striped SIMD kernel.
+     * @return true if the kernel is used when possible.
+     */
+    bool
+    simd() const
+    {
+        return simd_;
+    }
+
     /**
      * \brief Sets the similarity Matrix.
      * @param  mat The matrix to use.
@@ -328,262 +612,994 @@ AlignmentMatrix<DataType, SimMat>::nw(const SeqType &seq1, const SeqType &seq2)
     algorithm_ = Algorithm::NW;
     dim1_=seq1.size();
     dim2_=seq2.size();
-    size_t j;
-    matrix_.resize(dim1_+1, dim2_+1);
-    for (size_t i=0; i<dim1_; ++i)
+    size_t dim2 = dim2_+1;
+    trace_.resize(dim1_+1, dim2);
+    scoreRows_.resize(2*dim2);
+    DataType *prev = scoreRows_.data();
+    DataType *cur = prev + dim2;
+
+    // the first row and the first column consist of gaps only
+    typename PackedMatrix<2>::RowWriter firstRow(trace_.row(0));
+    for (size_t j=0; j<dim2; ++j)
     {
-        for (j=0; j<dim2_; ++j)
-            matrix_[i+1][j+1].first = simMat_.val(seq1[i],seq2[j]);
+        prev[j] = j*gep_;
+        firstRow.push(TraceHor);
     }
+    firstRow.flush();
 
-    size_t dim2 = dim2_;
-    ++dim2;
-    auto itPrev = matrix_[0].begin();
-    auto itVert = matrix_[0].begin();
-    auto it = matrix_[0].begin();
-    auto itEnd = matrix_[0].begin()+dim2;
-    char path;
-    size_t i;
-    j=0;
-    DataType score;
-    for (; it!=itEnd; ++it)
-        it->first=(j++)*gep_;
-
-    for (i=1; i <= dim1_; ++i)
+    // the neighbours of the current cell are kept in local variables, left = (i,j-1), diag = (i-1,j-1)
+    DataType score, left, diag, up;
+    unsigned int path;
+    for (size_t i=1; i <= dim1_; ++i)
     {
-        itPrev = it = matrix_[i].begin();
-        itEnd = matrix_[i].begin()+dim2;
-        itVert = matrix_[i-1].begin();
-        it->first = i*gep_;
-        ++it;
-        for (; it!=itEnd; ++it, ++itPrev)
+        const unsigned char *prevTrace = trace_.row(i-1);
+        typename PackedMatrix<2>::RowWriter writer(trace_.row(i));
+        left = cur[0] = i*gep_;
+        diag = prev[0];
+        writer.push(TraceVert);
+        for (size_t j=1; j<dim2; ++j)
         {
-            score=it->first+itVert->first;
-            path=itVert->second;
-            ++itVert;
+            up = prev[j];
+            score = diag + static_cast<DataType>(simMat_.val(seq1[i-1], seq2[j-1]));
+            diag = up;
 
             // check gaps;
-            if (itVert->first > itPrev->first)
+            if (up > left)
+                path = TraceVert;
+            else
             {
-                it->first = itVert->first;
-                it->second = 'i';
+                up = left;
+                path = TraceHor;
+            }
+            up += gep_;
+
+            // check match
+            if ((score > up) || ((score == up) && (PackedMatrix<2>::value(prevTrace, j-1) == TraceMatch)))
+            {
+                up = score;
+                path = TraceMatch;
+            }
+            left = cur[j] = up;
+            writer.push(path);
+        }
+        writer.flush();
+        std::swap(prev, cur);
+    }
+    score_ = prev[dim2_];
+}
+
+
+template<typename DataType, typename SimMat>
+void
+AlignmentMatrix<DataType, SimMat>::traceback_nw_() const
+{
+    auto &editString1 = editString_.eS1;
+    auto &editString2 = editString_.eS2;
+    editString_.start1 = 0;
+    editString_.end1 = dim1_-1;
+    editString_.start2 = 0;
+    editString_.end2 = dim2_-1;
+
+    size_t dim1 = dim1_;
+    size_t dim2 = dim2_;
+    while ((dim1 != 0) && (dim2 != 0))
+    {
+        unsigned int path = trace_.get(dim1, dim2);
+        if (path == TraceMatch)
+        {
+            --dim1;
+            --dim2;
+            editString1.push_back(dim1);
+            editString2.push_back(dim2);
+        }
+        else
+        {
+            if (path == TraceVert)
+            {
+                --dim1;
+                editString1.push_back(dim1);
+                editString2.push_back(-1);
+
             }
             else
             {
-                it->first = itPrev->first;
-                it->second = 'j';
+                --dim2;
+                editString1.push_back(-1);
+                editString2.push_back(dim2);
             }
-            it->first += gep_;
+        }
+    }
 
-            // check match
-            if ((score > it->first) || ((score == it->first) && (path=='m')))
+    // reached first position of a sequence, fill remaining length with gaps
+    editString1.reserve(editString1.size()+dim1);
+    editString2.reserve(editString2.size()+dim1);
+    while (dim1 != 0)
+    {
+        --dim1;
+        editString1.push_back(dim1);
+        editString2.push_back(-1);
+    }
+    editString1.reserve(editString1.size()+dim2);
+    editString2.reserve(editString2.size()+dim2);
+    while (dim2 != 0)
+    {
+        --dim2;
+        editString1.push_back(-1);
+        editString2.push_back(dim2);
+    }
+    std::reverse(editString1.begin(), editString1.end());
+    std::reverse(editString2.begin(), editString2.end());
+
+}
+
+
+/***************************************************
+ *                   GOTOH - Algorithm             *
+ ***************************************************/
+
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+void
+AlignmentMatrix<DataType, SimMat>::gotoh(const SeqType &seq1, const SeqType &seq2)
+{
+    isCP_ = false;
+    editString_.clear();
+    algorithm_ = Algorithm::Gotoh;
+    dim1_ = seq1.size();
+    dim2_ = seq2.size();
+    size_t dim1 = dim1_+1;
+    size_t dim2 = dim2_+1;
+    traceGotoh_.resize(dim1, dim2);
+    // the match matrix of the previous and the current row, the vertical gap matrix is updated in place and of the
+    // horizontal gap matrix only the current cell is needed
+    scoreRows_.resize(3*dim2);
+    DataType *prevM = scoreRows_.data();
+    DataType *curM = prevM + dim2;
+    DataType *vert = curM + dim2;
+    DataType hor;
+
+    DataType use_gop;
+    DataType match_score;
+    const DataType MINIMUM = (-1)*(std::numeric_limits<DataType>::max()-1000);
+    unsigned int path;
+
+    // the traceback never reaches the first row or column, their traceback is not stored
+    prevM[0] = 0;
+    vert[0] = 0;
+    for (size_t j=1; j<dim2; ++j)
+    {
+        prevM[j] = (long int)j*gep_;
+        vert[j] = MINIMUM;
+    }
+
+    for (size_t i=1; i<dim1; ++i)
+    {
+        typename PackedMatrix<4>::RowWriter writer(traceGotoh_.row(i));
+        writer.push(0);
+        hor = MINIMUM;
+        curM[0] = vert[0] = vert[0]+gep_;
+        DataType gopH = (i==(dim1-1))? 0 : gop_;
+        // left = M(i,j-1), diag = M(i-1,j-1)
+        DataType left = curM[0];
+        DataType diag = prevM[0];
+        DataType up, v;
+        for (size_t j=1; j<dim2; ++j)
+        {
+            //calculate insert value
+            match_score = diag;
+            up = diag = prevM[j];
+            v = vert[j];
+            use_gop = (j==(dim2-1))? 0 : gop_;
+            if (v > (up +use_gop))
+                path = TraceVertExtend;
+            else
+            {
+                path = 0;
+                v = up+use_gop;
+            }
+            v += gep_;
+            vert[j] = v;
+
+            //calculate deletion value
+            if (hor > (left +gopH))
+                path |= TraceHorExtend;
+            else
+                hor = left+gopH;
+            hor += gep_;
+
+            //calculate match value
+            match_score += simMat_.val(seq1[i-1], seq2[j-1]);
+            if (v > hor)
+            {
+                path |= TraceVert;
+                left = v;
+            }
+            else
+            {
+                path |= TraceHor;
+                left = hor;
+            }
+
+            if (match_score >= left)
+            {
+                path = (path & (TraceVertExtend | TraceHorExtend)) | TraceMatch;
+                left = match_score;
+            }
+            curM[j] = left;
+            writer.push(path);
+        }
+        writer.flush();
+        std::swap(prevM, curM);
+    }
+    score_ = prevM[dim2_];
+}
+
+
+
+template<typename DataType, typename SimMat>
+void
+AlignmentMatrix<DataType, SimMat>::traceback_gotoh_() const
+{
+    isCP_ = false;
+    size_t i = dim1_;
+    size_t j = dim2_;
+    editString_.start1 = 0;
+    editString_.end1 = dim1_-1;
+    editString_.start2 = 0;
+    editString_.end2 = dim2_-1;
+    auto &editString1 = editString_.eS1;
+    auto &editString2 = editString_.eS2;
+    int mat = 0;
+    while ((i!=0) && (j!=0))
+    {
+        unsigned int state = traceGotoh_.get(i, j);
+        if (mat==0)
+        {
+            if ((state & 3) == TraceMatch)
+            {
+                --i;
+                --j;
+                editString1.push_back(i);
+                editString2.push_back(j);
+            }
+            else
+            {
+                if ((state & 3) == TraceVert)
+                    mat=2;
+                else
+                    mat=1;
+            }
+        }
+        else
+        {
+            if (mat==2)
+            {
+                --i;
+                editString1.push_back(i);
+                editString2.push_back(-1);
+                if (!(state & TraceVertExtend))
+                    mat = 0;
+            }
+            else
+            {
+                --j;
+                editString1.push_back(-1);
+                editString2.push_back(j);
+                if (!(state & TraceHorExtend))
+                    mat = 0;
+            }
+        }
+    }
+
+    while (j>0)
+    {
+        --j;
+        editString1.push_back(-1);
+        editString2.push_back(j);
+    }
+    while (i>0)
+    {
+        --i;
+        editString1.push_back(i);
+        editString2.push_back(-1);
+    }
+
+    std::reverse(editString1.begin(), editString1.end());
+    std::reverse(editString2.begin(), editString2.end());
+}
+
+
+
+/***************************************************
+ *          Gotoh - Algorithm (linear space)        *
+ ***************************************************/
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+void
+AlignmentMatrix<DataType, SimMat>::gotoh_linear(const SeqType &seq1, const SeqType &seq2)
+{
+    isCP_ = false;
+    editString_.clear();
+    algorithm_ = Algorithm::Gotoh_Linear;
+    dim1_ = seq1.size();
+    dim2_ = seq2.size();
+    editString_.eS1.reserve(dim1_ + dim2_);
+    editString_.eS2.reserve(dim1_ + dim2_);
+    score_ = gotoh_linear_(seq1, seq2, 0, dim1_, 0, dim2_, GapBoundary::Free, GapBoundary::Free);
+    editString_.start1 = 0;
+    editString_.end1 = dim1_-1;
+    editString_.start2 = 0;
+    editString_.end2 = dim2_-1;
+}
+
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+void
+AlignmentMatrix<DataType, SimMat>::gotoh_linear_pass_(const SeqType &seq1, const SeqType &seq2, size_t i1, size_t i2, size_t j1, size_t j2,
+    bool reverse, GapBoundary boundary, std::vector<DataType> &best, std::vector<DataType> &vert) const
+{
+    const DataType MINIMUM = std::numeric_limits<DataType>::lowest()/4;
+    size_t nRows = i2-i1;
+    size_t nCols = j2-j1;
+    best.assign(nCols+1, MINIMUM);
+    vert.assign(nCols+1, MINIMUM);
+
+    // cell (k,l) of the pass corresponds to cell (i1+k, j1+l) of the matrix, or (i2-k, j2-l) in the reverse pass
+    best[0] = (boundary == GapBoundary::Required) ? MINIMUM : 0;
+    if (boundary == GapBoundary::Continued)
+        vert[0] = 0;
+    DataType hor = MINIMUM;
+    DataType open = gop_h_(reverse ? i2 : i1);
+    for (size_t l=1; l<=nCols; ++l)
+    {
+        hor = std::max(hor, best[l-1] + open) + gep_;
+        best[l] = hor;
+    }
+
+    for (size_t k=1; k<=nRows; ++k)
+    {
+        size_t residue1 = reverse ? i2-k : i1+k-1;
+        open = gop_h_(reverse ? i2-k : i1+k);
+        // a vertical gap may always be opened in the corner, even if the alignment has to start with it
+        DataType diag = best[0];
+        vert[0] = std::max(vert[0], ((k == 1) ? 0 : best[0]) + gop_v_(reverse ? j2 : j1)) + gep_;
+        best[0] = vert[0];
+        hor = MINIMUM;
+        for (size_t l=1; l<=nCols; ++l)
+        {
+            vert[l] = std::max(vert[l], best[l] + gop_v_(reverse ? j2-l : j1+l)) + gep_;
+            hor = std::max(hor, best[l-1] + open) + gep_;
+            DataType match = diag + simMat_.val(seq1[residue1], seq2[reverse ? j2-l : j1+l-1]);
+            diag = best[l];
+            best[l] = std::max(std::max(vert[l], hor), match);
+        }
+    }
+}
+
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+DataType
+AlignmentMatrix<DataType, SimMat>::gotoh_linear_block_(const SeqType &seq1, const SeqType &seq2, size_t i1, size_t i2, size_t j1, size_t j2,
+    GapBoundary start, GapBoundary end)
+{
+    const DataType MINIMUM = std::numeric_limits<DataType>::lowest()/4;
+    size_t nRows = i2-i1;
+    size_t nCols = j2-j1;
+    size_t width = nCols+1;
+    std::vector<DataType> best(width, MINIMUM), vert(width, MINIMUM);
+    // the traceback of the three matrices, same states as in gotoh
+    std::vector<char> traceM((nRows+1)*width), traceH((nRows+1)*width), traceV((nRows+1)*width);
+
+    best[0] = 0;
+    if (start == GapBoundary::Continued)
+        vert[0] = 0;
+    DataType hor = MINIMUM;
+    DataType open = gop_h_(i1);
+    for (size_t l=1; l<=nCols; ++l)
+    {
+        if (hor > best[l-1] + open)
+            traceH[l] = 'h';
+        else
+        {
+            traceH[l] = 'm';
+            hor = best[l-1] + open;
+        }
+        hor += gep_;
+        best[l] = hor;
+        traceM[l] = 'h';
+    }
+
+    for (size_t k=1; k<=nRows; ++k)
+    {
+        size_t i = i1+k;
+        size_t row = k*width;
+        open = gop_h_(i);
+        DataType diag = best[0];
+        if (vert[0] > best[0] + gop_v_(j1))
+            traceV[row] = 'v';
+        else
+        {
+            traceV[row] = 'm';
+            vert[0] = best[0] + gop_v_(j1);
+        }
+        vert[0] += gep_;
+        best[0] = vert[0];
+        traceM[row] = 'v';
+        hor = MINIMUM;
+        for (size_t l=1; l<=nCols; ++l)
+        {
+            DataType openV = best[l] + gop_v_(j1+l);
+            if (vert[l] > openV)
+                traceV[row+l] = 'v';
+            else
+            {
+                traceV[row+l] = 'm';
+                vert[l] = openV;
+            }
+            vert[l] += gep_;
+
+            if (hor > best[l-1] + open)
+                traceH[row+l] = 'h';
+            else
+            {
+                traceH[row+l] = 'm';
+                hor = best[l-1] + open;
+            }
+            hor += gep_;
+
+            DataType match = diag + simMat_.val(seq1[i-1], seq2[j1+l-1]);
+            diag = best[l];
+            if (vert[l] > hor)
+            {
+                traceM[row+l] = 'v';
+                best[l] = vert[l];
+            }
+            else
+            {
+                traceM[row+l] = 'h';
+                best[l] = hor;
+            }
+            if (match >= best[l])
+            {
+                traceM[row+l] = 'm';
+                best[l] = match;
+            }
+        }
+    }
+
+    DataType score = (end == GapBoundary::Required) ? vert[nCols] : best[nCols];
+    int mat = (end == GapBoundary::Required) ? 2 : 0;
+    size_t k = nRows;
+    size_t l = nCols;
+    std::vector<long int> editString1, editString2;
+    while ((k!=0) || (l!=0))
+    {
+        size_t idx = k*width+l;
+        if (mat==0)
+        {
+            char state = traceM[idx];
+            if (state=='m')
+            {
+                --k;
+                --l;
+                editString1.push_back(i1+k);
+                editString2.push_back(j1+l);
+            }
+            else
+                mat = (state=='v') ? 2 : 1;
+        }
+        else
+        {
+            char state = (mat==2) ? traceV[idx] : traceH[idx];
+            if (mat==2)
+            {
+                --k;
+                editString1.push_back(i1+k);
+                editString2.push_back(-1);
+            }
+            else
+            {
+                --l;
+                editString1.push_back(-1);
+                editString2.push_back(j1+l);
+            }
+            if (state=='m')
+                mat = 0;
+        }
+    }
+    editString_.eS1.insert(editString_.eS1.end(), editString1.rbegin(), editString1.rend());
+    editString_.eS2.insert(editString_.eS2.end(), editString2.rbegin(), editString2.rend());
+    return score;
+}
+
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+DataType
+AlignmentMatrix<DataType, SimMat>::gotoh_linear_(const SeqType &seq1, const SeqType &seq2, size_t i1, size_t i2, size_t j1, size_t j2,
+    GapBoundary start, GapBoundary end)
+{
+    // small sub problems are aligned directly, the memory needed is bounded by the number of columns
+    if ((i2-i1 <= 1) || ((i2-i1)*(j2-j1+1) <= 4096))
+        return gotoh_linear_block_(seq1, seq2, i1, i2, j1, j2, start, end);
+
+    size_t mid = (i1+i2)/2;
+    size_t nCols = j2-j1;
+    size_t split = 0;
+    bool gapJoin = false;
+    DataType score = 0;
+    {
+        std::vector<DataType> forwardBest, forwardVert, reverseBest, reverseVert;
+        gotoh_linear_pass_(seq1, seq2, i1, mid, j1, j2, false, start, forwardBest, forwardVert);
+        gotoh_linear_pass_(seq1, seq2, mid, i2, j1, j2, true, end, reverseBest, reverseVert);
+        for (size_t l=0; l<=nCols; ++l)
+        {
+            // a vertical gap crossing the middle row is opened in both passes
+            DataType joined = forwardBest[l] + reverseBest[nCols-l];
+            DataType gapJoined = forwardVert[l] + reverseVert[nCols-l] - gop_v_(j1+l);
+            if ((l == 0) || (joined > score))
+            {
+                score = joined;
+                split = l;
+                gapJoin = false;
+            }
+            if (gapJoined > score)
+            {
+                score = gapJoined;
+                split = l;
+                gapJoin = true;
+            }
+        }
+    }
+    gotoh_linear_(seq1, seq2, i1, mid, j1, j1+split, start, gapJoin ? GapBoundary::Required : GapBoundary::Free);
+    gotoh_linear_(seq1, seq2, mid, i2, j1+split, j2, gapJoin ? GapBoundary::Continued : GapBoundary::Free, end);
+    return score;
+}
+
+
+
+/***************************************************
+ *           Banded and X-drop - Algorithms         *
+ ***************************************************/
+
+// Layout of the traceback byte of a cell: the lowest two bits store the origin of the match matrix (0: match,
+// 1: vertical, 2: horizontal), the following flags whether the vertical (4) and horizontal (8) gap is extended
+// and whether the cell was dropped by the X-drop criterion (16).
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+DataType
+AlignmentMatrix<DataType, SimMat>::band_fill_(const SeqType &seq1, const SeqType &seq2, long dLow, long dHigh, bool affine)
+{
+    const DataType MINIMUM = std::numeric_limits<DataType>::lowest()/4;
+    long n = dim1_;
+    long m = dim2_;
+    bandBegin_.resize(dim1_+1);
+    bandEnd_.resize(dim1_+1);
+    bandOffset_.resize(dim1_+1);
+    size_t total = 0;
+    for (long i=0; i<=n; ++i)
+    {
+        bandBegin_[i] = std::max<long>(0, i+dLow);
+        bandEnd_[i] = std::min<long>(m, i+dHigh)+1;
+        bandOffset_[i] = total;
+        total += bandEnd_[i]-bandBegin_[i];
+    }
+    bandTrace_.resize(total);
+
+    // in-place rows, cells right of the band of the previous row are still MINIMUM as the band only moves right
+    std::vector<DataType> matM(dim2_+1, MINIMUM), matV(dim2_+1, MINIMUM);
+    matM[0] = matV[0] = 0;
+    bandTrace_[0] = 1;
+    for (size_t j=1; j<bandEnd_[0]; ++j)
+    {
+        matM[j] = j*gep_;
+        bandTrace_[j] = 2 | 8;
+    }
+
+    for (size_t i=1; i<=dim1_; ++i)
+    {
+        size_t begin = bandBegin_[i];
+        size_t end = bandEnd_[i];
+        size_t prevBegin = bandBegin_[i-1];
+        size_t prevEnd = bandEnd_[i-1];
+        unsigned char *trace = &bandTrace_[bandOffset_[i]];
+        const unsigned char *prevTrace = &bandTrace_[bandOffset_[i-1]];
+        DataType diag = MINIMUM;
+        unsigned char diagState = 1;
+        if ((begin > 0) && (begin-1 >= prevBegin))
+        {
+            diag = matM[begin-1];
+            diagState = prevTrace[begin-1-prevBegin] & 3;
+        }
+        DataType left = MINIMUM;
+        DataType hor = MINIMUM;
+        size_t j = begin;
+        if (j == 0)
+        {
+            diag = matM[0];
+            matV[0] += gep_;
+            matM[0] = affine ? matV[0] : matM[0]+gep_;
+            left = matM[0];
+            *(trace++) = 1 | 4;
+            ++j;
+        }
+        for (; j<end; ++j)
+        {
+            DataType up = matM[j];
+            DataType value;
+            unsigned char state;
+            if (affine)
+            {
+                state = 0;
+                DataType use_gop = (j == dim2_) ? 0 : gop_;
+                if (matV[j] > up + use_gop)
+                    state |= 4;
+                else
+                    matV[j] = up + use_gop;
+                matV[j] += gep_;
+
+                use_gop = (i == dim1_) ? 0 : gop_;
+                if (hor > left + use_gop)
+                    state |= 8;
+                else
+                    hor = left + use_gop;
+                hor += gep_;
+
+                DataType match = diag + simMat_.val(seq1[i-1], seq2[j-1]);
+                if (matV[j] > hor)
+                {
+                    value = matV[j];
+                    state |= 1;
+                }
+                else
+                {
+                    value = hor;
+                    state |= 2;
+                }
+                if (match >= value)
+                {
+                    value = match;
+                    state &= ~3;
+                }
+            }
+            else
+            {
+                if (up > left)
+                {
+                    value = up;
+                    state = 1;
+                }
+                else
+                {
+                    value = left;
+                    state = 2;
+                }
+                value += gep_;
+                DataType match = diag + simMat_.val(seq1[i-1], seq2[j-1]);
+                if ((match > value) || ((match == value) && (diagState == 0)))
+                {
+                    value = match;
+                    state = 0;
+                }
+            }
+            diag = up;
+            diagState = (j < prevEnd) ? (prevTrace[j-prevBegin] & 3) : 1;
+            matM[j] = left = value;
+            *(trace++) = state;
+        }
+    }
+    return matM[dim2_];
+}
+
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+bool
+AlignmentMatrix<DataType, SimMat>::banded_(const SeqType &seq1, const SeqType &seq2, size_t band, size_t maxBand, bool affine)
+{
+    isCP_ = false;
+    algorithm_ = Algorithm::Banded;
+    dim1_ = seq1.size();
+    dim2_ = seq2.size();
+    long n = dim1_;
+    long m = dim2_;
+    long width = std::max<size_t>(band, 1);
+    if (maxBand != 0)
+        width = std::min<long>(width, maxBand);
+    bool bounded = false;
+    while (true)
+    {
+        long dLow = std::min<long>(0, m-n) - width;
+        long dHigh = std::max<long>(0, m-n) + width;
+        score_ = band_fill_(seq1, seq2, dLow, dHigh, affine);
+        editString_.clear();
+        traceback_band_(dim1_, dim2_);
+        editString_.start1 = 0;
+        editString_.end1 = dim1_-1;
+        editString_.start2 = 0;
+        editString_.end2 = dim2_-1;
+        // A band covering the whole matrix is exact. Otherwise an alignment leaving the band runs through the diagonal
+        // next to it, from the diagonal d it needs |d| + |m-n-d| gap positions to reach the end.
+        if ((dLow <= -n) && (dHigh >= m))
+            return true;
+        if (!bounded)
+        {
+            // prefix sums of the scores in descending order
+            best_matches_(seq1, seq2);
+            for (auto *best : {&bestMatch1_, &bestMatch2_})
             {
-                it->first = score;
-                it->second = 'm';
+                std::sort(best->begin(), best->end(), std::greater<DataType>());
+                best->insert(best->begin(), 0);
+                for (size_t k=1; k<best->size(); ++k)
+                    (*best)[k] += (*best)[k-1];
             }
+            bounded = true;
         }
+        long minGaps = n+m;
+        if (dLow-1 >= -n)
+            minGaps = (m-n) - 2*(dLow-1);
+        if (dHigh+1 <= m)
+            minGaps = std::min(minGaps, 2*(dHigh+1) - (m-n));
+        if (score_ >= off_band_bound_(minGaps, affine))
+            return true;
+        if ((maxBand != 0) && (width >= static_cast<long>(maxBand)))
+            return false;
+        width *= 2;
+        if (maxBand != 0)
+            width = std::min<long>(width, maxBand);
     }
-    score_ = matrix_[dim1_][dim2_].first;
 }
 
 
 template<typename DataType, typename SimMat>
+template<typename SeqType>
 void
-AlignmentMatrix<DataType, SimMat>::traceback_nw_() const
+AlignmentMatrix<DataType, SimMat>::best_matches_(const SeqType &seq1, const SeqType &seq2)
 {
-    auto &editString1 = editString_.eS1;
-    auto &editString2 = editString_.eS2;
-    editString_.start1 = 0;
-    editString_.end1 = matrix_.dim1()-2;
-    editString_.start2 = 0;
-    editString_.end2 = matrix_.dim2()-2;
+    typedef typename std::decay<decltype(seq1[0])>::type Element;
+    bestMatch1_.assign(seq1.size(), std::numeric_limits<DataType>::lowest());
+    bestMatch2_.assign(seq2.size(), std::numeric_limits<DataType>::lowest());
+    best_matches_(seq1, seq2, std::is_same<Element, char>());
+}
 
-    size_t dim1 = dim1_;
-    size_t dim2 = dim2_;
-    while ((dim1 != 0) && (dim2 != 0))
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+void
+AlignmentMatrix<DataType, SimMat>::best_matches_(const SeqType &seq1, const SeqType &seq2, std::true_type)
+{
+    const size_t nChars = std::numeric_limits<unsigned char>::max()+1;
+    std::vector<bool> in1(nChars, false), in2(nChars, false);
+    for (size_t i=0; i<seq1.size(); ++i)
+        in1[static_cast<unsigned char>(seq1[i])] = true;
+    for (size_t j=0; j<seq2.size(); ++j)
+        in2[static_cast<unsigned char>(seq2[j])] = true;
+    std::vector<DataType> best1(nChars, std::numeric_limits<DataType>::lowest());
+    std::vector<DataType> best2(nChars, std::numeric_limits<DataType>::lowest());
+    for (size_t c1=0; c1<nChars; ++c1)
     {
-        if (matrix_[dim1][dim2].second == 'm')
-        {
-            --dim1;
-            --dim2;
-            editString1.push_back(dim1);
-            editString2.push_back(dim2);
-        }
-        else
+        if (!in1[c1])
+            continue;
+        for (size_t c2=0; c2<nChars; ++c2)
         {
-            if (matrix_[dim1][dim2].second == 'i')
-            {
-                --dim1;
-                editString1.push_back(dim1);
-                editString2.push_back(-1);
-
-            }
-            else
-            {
-                --dim2;
-                editString1.push_back(-1);
-                editString2.push_back(dim2);
-            }
+            if (!in2[c2])
+                continue;
+            DataType value = static_cast<DataType>(simMat_.val(static_cast<char>(c1), static_cast<char>(c2)));
+            best1[c1] = std::max(best1[c1], value);
+            best2[c2] = std::max(best2[c2], value);
         }
     }
+    for (size_t i=0; i<seq1.size(); ++i)
+        bestMatch1_[i] = best1[static_cast<unsigned char>(seq1[i])];
+    for (size_t j=0; j<seq2.size(); ++j)
+        bestMatch2_[j] = best2[static_cast<unsigned char>(seq2[j])];
+}
 
-    // reached first position of a sequence, fill remaining length with gaps
-    editString1.reserve(editString1.size()+dim1);
-    editString2.reserve(editString2.size()+dim1);
-    while (dim1 != 0)
-    {
-        --dim1;
-        editString1.push_back(dim1);
-        editString2.push_back(-1);
-    }
-    editString1.reserve(editString1.size()+dim2);
-    editString2.reserve(editString2.size()+dim2);
-    while (dim2 != 0)
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+void
+AlignmentMatrix<DataType, SimMat>::best_matches_(const SeqType &seq1, const SeqType &seq2, std::false_type)
+{
+    for (size_t i=0; i<seq1.size(); ++i)
     {
-        --dim2;
-        editString1.push_back(-1);
-        editString2.push_back(dim2);
+        for (size_t j=0; j<seq2.size(); ++j)
+        {
+            DataType value = static_cast<DataType>(simMat_.val(seq1[i], seq2[j]));
+            bestMatch1_[i] = std::max(bestMatch1_[i], value);
+            bestMatch2_[j] = std::max(bestMatch2_[j], value);
+        }
     }
-    std::reverse(editString1.begin(), editString1.end());
-    std::reverse(editString2.begin(), editString2.end());
-
 }
 
 
-/***************************************************
- *                   GOTOH - Algorithm             *
- ***************************************************/
+template<typename DataType, typename SimMat>
+DataType
+AlignmentMatrix<DataType, SimMat>::off_band_bound_(size_t minGaps, bool affine) const
+{
+    // every aligned pair less frees two positions for gaps, the bound is the maximum over the number of pairs
+    size_t total = dim1_ + dim2_;
+    size_t maxPairs = std::min(std::min(dim1_, dim2_), (total-std::min(total, minGaps))/2);
+    DataType gapScore = gep_ + ((affine && (gop_ > 0)) ? gop_ : 0);
+    DataType bound = std::numeric_limits<DataType>::lowest();
+    for (size_t k=0; k<=maxPairs; ++k)
+        bound = std::max(bound, std::min(bestMatch1_[k], bestMatch2_[k]) + static_cast<DataType>(total-2*k)*gapScore);
+    return bound;
+}
 
 
 template<typename DataType, typename SimMat>
 template<typename SeqType>
-void
-AlignmentMatrix<DataType, SimMat>::gotoh(const SeqType &seq1, const SeqType &seq2)
+bool
+AlignmentMatrix<DataType, SimMat>::gotoh_xdrop(const SeqType &seq1, const SeqType &seq2, DataType xDrop)
 {
+    const DataType MINIMUM = std::numeric_limits<DataType>::lowest()/4;
     isCP_ = false;
-    editString_.clear();
-    algorithm_ = Algorithm::Gotoh;
+    algorithm_ = Algorithm::Banded;
     dim1_ = seq1.size();
     dim2_ = seq2.size();
-    size_t dim1 = dim1_+1;
-    size_t dim2 = dim2_+1;
-    matrices_.resize(dim1, dim2);
-    Matrix<std::pair<DataType, char> > &matM = matrices_[0];
-    Matrix<std::pair<DataType, char> > &matH = matrices_[1];
-    Matrix<std::pair<DataType, char> > &matV = matrices_[2];
-    typedef typename std::vector<std::pair<DataType, char> >::iterator MatrixIterator;
-    MatrixIterator itM=matM[0].begin();
-    MatrixIterator itH=matH[0].begin();
-    MatrixIterator itV=matV[0].begin();
-    MatrixIterator itVertM, itPrevH, itVertV;
-
-    DataType use_gop;
-    DataType match_score;
-    const DataType MINIMUM = (-1)*(std::numeric_limits<DataType>::max()-1000);
-    // 0=match, 1=insert, 2=deletion
-
-    itM->first = 0;
-    itH->first = 0;
-    itV->first = 0;
-
-    for (size_t j=1; j<dim2; ++j)
+    bandBegin_.assign(dim1_+1, 0);
+    bandEnd_.assign(dim1_+1, 0);
+    bandOffset_.assign(dim1_+1, 0);
+    bandTrace_.clear();
+
+    DataType best = 0;
+    size_t bestI = 0;
+    size_t bestJ = 0;
+    std::vector<DataType> matM(dim2_+1, MINIMUM), matV(dim2_+1, MINIMUM);
+
+    // An extension leaving the live cells runs through a dropped cell first, as all other cells can only be reached
+    // through dropped ones. From cell (i,j) on, it gains at most the positive best scores of the remaining positions
+    // of either sequence (gaps do not gain anything). The highest bound of all dropped cells is kept in dropBound.
+    best_matches_(seq1, seq2);
+    for (auto *bestMatch : {&bestMatch1_, &bestMatch2_})
     {
-        (++itM)->first = (++itH)->first=(long int)j*gep_;
-        (++itV)->first = MINIMUM;
+        bestMatch->push_back(0);
+        for (size_t k=bestMatch->size()-1; k-- > 0; )
+            (*bestMatch)[k] = std::max<DataType>((*bestMatch)[k], 0) + (*bestMatch)[k+1];
     }
+    DataType gapGain = std::max<DataType>(0, gep_ + std::max<DataType>(0, gop_));
+    DataType dropBound = std::numeric_limits<DataType>::lowest();
+    auto dropped = [&](size_t i, size_t j, DataType value)
+    {
+        DataType remaining = std::min(bestMatch1_[i], bestMatch2_[j]) + static_cast<DataType>(dim1_-i+dim2_-j)*gapGain;
+        dropBound = std::max(dropBound, value + remaining);
+    };
+
+    // first row: a single horizontal gap
+    matM[0] = 0;
+    bandTrace_.push_back(1);
+    size_t liveBegin = 0;
+    size_t liveEnd = 1;
+    DataType hor = gop_;
+    for (size_t j=1; j<=dim2_; ++j)
+    {
+        hor += gep_;
+        matM[j] = hor;
+        bandTrace_.push_back(2 | ((j > 1) ? 8 : 0));
+        if (hor < best - xDrop)
+        {
+            dropped(0, j, hor);
+            matM[j] = MINIMUM;
+            bandTrace_.back() |= 16;
+            break;
+        }
+        liveEnd = j+1;
+    }
+    bandEnd_[0] = bandTrace_.size();
 
-
-    for (size_t i=1; i<dim1; ++i)
+    for (size_t i=1; (i<=dim1_) && (liveBegin < liveEnd); ++i)
     {
-        itM=matM[i].begin();
-        itPrevH=itH=matH[i].begin();
-        itV = matV[i].begin();
-        itH->first = MINIMUM;
-        itM->first = itV->first=matV[i-1][0].first+gep_;
-        itVertM=matM[i-1].begin();
-        itVertV=matV[i-1].begin();
-        ++itH;
-        ++itV;
-        for (size_t j=1; j<dim2; ++j)
+        size_t prevBegin = bandBegin_[i-1];
+        size_t prevEnd = bandEnd_[i-1];
+        size_t prevLiveEnd = liveEnd;
+        size_t begin = liveBegin;
+        bandBegin_[i] = begin;
+        bandOffset_[i] = bandTrace_.size();
+        liveBegin = dim2_+1;
+        liveEnd = 0;
+        // cells outside the range of the previous row contain values of older rows
+        DataType diag = ((begin > 0) && (begin-1 >= prevBegin)) ? matM[begin-1] : MINIMUM;
+        DataType left = MINIMUM;
+        hor = MINIMUM;
+        size_t j = begin;
+        for (; j<=dim2_; ++j)
         {
-            //calculate insert value
-            match_score=itVertM->first;
-            ++itVertM;
-            ++itVertV;
-            use_gop = (j==(dim2-1))? 0 : gop_;
-            if (itVertV->first > (itVertM->first +use_gop))
-            {
-                itV->second = 'v';
-                itV->first = itVertV->first;
-            }else
+            DataType up = (j < prevEnd) ? matM[j] : MINIMUM;
+            DataType vert = (j < prevEnd) ? matV[j] : MINIMUM;
+            DataType value;
+            unsigned char state = 0;
+            if (vert > up + gop_)
+                state |= 4;
+            else
+                vert = up + gop_;
+            vert += gep_;
+            if (hor > left + gop_)
+                state |= 8;
+            else
+                hor = left + gop_;
+            hor += gep_;
+            if (vert > hor)
             {
-                itV->second = 'm';
-                itV->first = itVertM->first+use_gop;
+                value = vert;
+                state |= 1;
             }
-            itV->first += gep_;
-
-            //calculate deletion value
-            use_gop = (i==(dim1-1))? 0 : gop_;
-            if (itPrevH->first > (itM->first +use_gop))
+            else
             {
-                itH->second = 'h';
-                itH->first = itPrevH->first;
-            } else
+                value = hor;
+                state |= 2;
+            }
+            if (j > 0)
             {
-                itH->second = 'm';
-                itH->first = itM->first+use_gop;
+                DataType match = diag + simMat_.val(seq1[i-1], seq2[j-1]);
+                if (match >= value)
+                {
+                    value = match;
+                    state &= ~3;
+                }
             }
-            itH->first += gep_;
+            diag = up;
 
-            //calculate match value
-            ++itM;
-            match_score += simMat_.val(seq1[i-1], seq2[j-1]); //itM->first;
-            if (itV->first > itH->first)
+            if (value < best - xDrop)
             {
-                itM->second = 'v';
-                itM->first = itV->first;
+                dropped(i, j, value);
+                value = vert = hor = MINIMUM;
+                state |= 16;
             }
             else
             {
-                itM->second = 'h';
-                itM->first = itH->first;
+                liveBegin = std::min(liveBegin, j);
+                liveEnd = j+1;
+                if (value > best)
+                {
+                    best = value;
+                    bestI = i;
+                    bestJ = j;
+                }
             }
-
-            if (match_score >= itM->first)
+            matM[j] = left = value;
+            matV[j] = vert;
+            bandTrace_.push_back(state);
+            // beyond the live cells of the previous row only horizontal gaps can reach a cell
+            if ((j >= prevLiveEnd) && (state & 16))
             {
-                itM->second = 'm';
-                itM->first = match_score;
+                ++j;
+                break;
             }
-            ++itH;
-            ++itPrevH;
-            ++itV;
         }
+        bandEnd_[i] = j;
     }
-    score_ = matrices_[0][dim1_][dim2_].first;
-}
 
+    score_ = best;
+    editString_.clear();
+    traceback_band_(bestI, bestJ);
+    editString_.start1 = 0;
+    editString_.end1 = (bestI == 0) ? 0 : bestI-1;
+    editString_.start2 = 0;
+    editString_.end2 = (bestJ == 0) ? 0 : bestJ-1;
+    return dropBound <= best;
+}
 
 
 template<typename DataType, typename SimMat>
 void
-AlignmentMatrix<DataType, SimMat>::traceback_gotoh_() const
+AlignmentMatrix<DataType, SimMat>::traceback_band_(size_t i, size_t j)
 {
-    isCP_ = false;
-    size_t i = dim1_;
-    size_t j = dim2_;
-    editString_.start1 = 0;
-    editString_.end1 = matrices_.dim1()-2;
-    editString_.start2 = 0;
-    editString_.end2 = matrices_.dim2()-2;
     auto &editString1 = editString_.eS1;
     auto &editString2 = editString_.eS2;
     int mat = 0;
     while ((i!=0) && (j!=0))
     {
-        char state = matrices_[mat][i][j].second;
+        const unsigned char *trace = &bandTrace_[bandOffset_[i]];
+        unsigned char state = trace[j-bandBegin_[i]];
         if (mat==0)
         {
-            if (state=='m')
+            if ((state & 3) == 0)
             {
                 --i;
                 --j;
@@ -591,32 +1607,28 @@ AlignmentMatrix<DataType, SimMat>::traceback_gotoh_() const
                 editString2.push_back(j);
             }
             else
-            {
-                if (state=='v')
-                    mat=2;
-                else
-                    mat=1;
-            }
+                mat = state & 3;
         }
         else
         {
-            if (mat==2)
+            if (mat==1)
             {
                 --i;
                 editString1.push_back(i);
                 editString2.push_back(-1);
+                if (!(state & 4))
+                    mat = 0;
             }
             else
             {
                 --j;
                 editString1.push_back(-1);
                 editString2.push_back(j);
+                if (!(state & 8))
+                    mat = 0;
             }
-            if (state=='m')
-                mat = 0;
         }
     }
-
     while (j>0)
     {
         --j;
@@ -629,7 +1641,6 @@ AlignmentMatrix<DataType, SimMat>::traceback_gotoh_() const
         editString1.push_back(i);
         editString2.push_back(-1);
     }
-
     std::reverse(editString1.begin(), editString1.end());
     std::reverse(editString2.begin(), editString2.end());
 }
@@ -669,7 +1680,10 @@ AlignmentMatrix<DataType, SimMat>::raspodom_nw(const SeqType &seq1, const SeqTyp
     j=0;
     DataType score;
     for (; it!=itEnd; ++it)
+    {
         it->first=0;
+        it->second='j';
+    }
 
     for (i=1; i <= dim1_; ++i)
     {
@@ -677,6 +1691,7 @@ AlignmentMatrix<DataType, SimMat>::raspodom_nw(const SeqType &seq1, const SeqTyp
         itEnd = matrix_[i].begin()+dim2;
         itVert = matrix_[i-1].begin();
         it->first = 0;
+        it->second = 'i';
         ++it;
         for (; it!=itEnd; ++it, ++itPrev)
         {
@@ -973,85 +1988,101 @@ AlignmentMatrix<DataType, SimMat>::sw(const SeqType &seq1, const SeqType &seq2)
     isCP_ = false;
     editString_.clear();
     algorithm_ = Algorithm::SW;
-    dim1_ = seq1.size();
-    dim2_ = seq2.size();
-    size_t j;
-    matrix_.resize(dim1_+1, dim2_+1);
-    for (size_t i=0; i<dim1_; ++i)
+
+    StripedSwHit hit;
+    if (simd_ && swStripedHit(seq1, seq2, simMat_, DataType(0), gep_, hit))
     {
-        for (j=0; j<dim2_; ++j)
-            matrix_[i+1][j+1].first = simMat_.val(seq1[i],seq2[j]);
+        // the best alignment ends in the last cell of its region
+        if (hit.score == 0)
+            score_ = fill_sw_(seq1, seq2, 0, 0, 0, 0);
+        else
+            score_ = fill_sw_(seq1, seq2, hit.start1, hit.end1+1, hit.start2, hit.end2+1);
+        best_score_x_ = dim1_;
+        best_score_y_ = dim2_;
+        return;
     }
+
+    fill_sw_(seq1, seq2, 0, seq1.size(), 0, seq2.size());
+}
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+DataType
+AlignmentMatrix<DataType, SimMat>::fill_sw_(const SeqType &seq1, const SeqType &seq2, size_t begin1, size_t end1, size_t begin2, size_t end2)
+{
+    offset1_ = begin1;
+    offset2_ = begin2;
+    dim1_ = end1 - begin1;
+    dim2_ = end2 - begin2;
     size_t dim2 = dim2_ + 1;
-    auto itPrev = matrix_[0].begin();
-    auto itVert = matrix_[0].begin();
-    auto it = matrix_[0].begin();
-    auto itEnd = matrix_[0].begin()+dim2;
-    char path;
-    size_t i;
-    DataType score;
-    for (; it!=itEnd; ++it)
+    trace_.resize(dim1_+1, dim2);
+    scoreRows_.resize(2*dim2);
+    DataType *prev = scoreRows_.data();
+    DataType *cur = prev + dim2;
+
+    typename PackedMatrix<2>::RowWriter firstRow(trace_.row(0));
+    for (size_t j=0; j<dim2; ++j)
     {
-        it->first=0;
-        it->second='o';
+        prev[j] = 0;
+        firstRow.push(TraceStart);
     }
+    firstRow.flush();
 
-    for (i=1; i <= dim1_; ++i)
+    // the best score, the first maximum in row-major order
+    score_ = 0;
+    best_score_x_ = 0;
+    best_score_y_ = 0;
+    // left = (i,j-1), diag = (i-1,j-1), see nw
+    DataType score, left, diag, up;
+    unsigned int path;
+    for (size_t i=1; i <= dim1_; ++i)
     {
-        itPrev = it = matrix_[i].begin();
-        itEnd = matrix_[i].begin()+dim2;
-        itVert = matrix_[i-1].begin();
-        it->first = 0;
-        it->second = 'o';
-        ++it;
-        for (; it!=itEnd; ++it, ++itPrev)
+        const unsigned char *prevTrace = trace_.row(i-1);
+        typename PackedMatrix<2>::RowWriter writer(trace_.row(i));
+        left = cur[0] = 0;
+        diag = prev[0];
+        writer.push(TraceStart);
+        for (size_t j=1; j<dim2; ++j)
         {
-            score=it->first+itVert->first;
-            path=itVert->second;
-            ++itVert;
+            up = prev[j];
+            score = diag + static_cast<DataType>(simMat_.val(seq1[begin1+i-1], seq2[begin2+j-1]));
+            diag = up;
 
             // check gaps;
-            if (itVert->first > itPrev->first)
-            {
-                it->first = itVert->first;
-                it->second = 'i';
-            }
+            if (up > left)
+                path = TraceVert;
             else
             {
-                it->first = itPrev->first;
-                it->second = 'j';
+                up = left;
+                path = TraceHor;
             }
-            it->first += gep_;
+            up += gep_;
 
             // check match
-            if ((score > it->first) || ((score == it->first) && (path=='m')))
+            if ((score > up) || ((score == up) && (PackedMatrix<2>::value(prevTrace, j-1) == TraceMatch)))
             {
-                it->first = score;
-                it->second = 'm';
+                up = score;
+                path = TraceMatch;
             }
 
-            if (it->first <= 0)
+            if (up <= 0)
             {
-                it->first = 0;
-                it->second = 'o';
+                up = 0;
+                path = TraceStart;
             }
-        }
-    }
-
-    // set best score
-    score_ = 0;
-    for (size_t i = 1; i <= dim1_; ++i)
-    {
-        for (size_t j = 1; j <= dim2_; ++j)
-        {
-            if (matrix_[i][j].first > score_)
+            else if (up > score_)
             {
-                score_ = matrix_[i][j].first;
+                score_ = up;
                 best_score_x_ = i;
                 best_score_y_ = j;
             }
+            left = cur[j] = up;
+            writer.push(path);
         }
+        writer.flush();
+        std::swap(prev, cur);
     }
+    return prev[dim2_];
 }
 
 template<typename DataType, typename SimMat>
@@ -1062,40 +2093,197 @@ AlignmentMatrix<DataType, SimMat>::traceback_sw_() const
     auto &editString2 = editString_.eS2;
     size_t dim1 = best_score_x_;
     size_t dim2 = best_score_y_;
-    editString_.end1 = dim1-1;
-    editString_.end2 = dim2-1;
+    // no pair scores above 0, the alignment is empty
+    if ((dim1 == 0) || (dim2 == 0))
+    {
+        editString_.clear();
+        return;
+    }
+    editString_.end1 = offset1_+dim1-1;
+    editString_.end2 = offset2_+dim2-1;
 
-    while (matrix_[dim1][dim2].second != 'o')
+    unsigned int path;
+    while ((path = trace_.get(dim1, dim2)) != TraceStart)
     {
-        if (matrix_[dim1][dim2].second == 'm')
+        if (path == TraceMatch)
         {
             --dim1;
             --dim2;
-            editString1.push_back(dim1);
-            editString2.push_back(dim2);
+            editString1.push_back(offset1_+dim1);
+            editString2.push_back(offset2_+dim2);
         }
         else
         {
-            if (matrix_[dim1][dim2].second == 'i')
+            if (path == TraceVert)
             {
                 --dim1;
-                editString1.push_back(dim1);
+                editString1.push_back(offset1_+dim1);
                 editString2.push_back(-1);
             }
             else
             {
                 --dim2;
                 editString1.push_back(-1);
-                editString2.push_back(dim2);
+                editString2.push_back(offset2_+dim2);
             }
         }
     }
-    editString_.start1=dim1;
-    editString_.start2=dim2;
+    editString_.start1=offset1_+dim1;
+    editString_.start2=offset2_+dim2;
     std::reverse(editString1.begin(), editString1.end());
     std::reverse(editString2.begin(), editString2.end());
 }
 
+
+/***************************************************
+ *               Score-only variants               *
+ ***************************************************/
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+DataType
+AlignmentMatrix<DataType, SimMat>::nw_score(const SeqType &seq1, const SeqType &seq2)
+{
+    isCP_ = false;
+    editString_.clear();
+    algorithm_ = Algorithm::ScoreOnly;
+    size_t dim1 = seq1.size();
+    size_t dim2 = seq2.size()+1;
+    scoreRows_.resize(2*dim2);
+    DataType *prev = scoreRows_.data();
+    DataType *cur = prev + dim2;
+    for (size_t j=0; j<dim2; ++j)
+        prev[j] = j*gep_;
+
+    // same recursion as nw, left = (i,j-1), diag = (i-1,j-1)
+    DataType score, left, diag, up;
+    for (size_t i=1; i <= dim1; ++i)
+    {
+        left = cur[0] = i*gep_;
+        diag = prev[0];
+        for (size_t j=1; j<dim2; ++j)
+        {
+            up = prev[j];
+            score = diag + static_cast<DataType>(simMat_.val(seq1[i-1], seq2[j-1]));
+            diag = up;
+            left = cur[j] = std::max(std::max(up, left) + gep_, score);
+        }
+        std::swap(prev, cur);
+    }
+    score_ = prev[dim2-1];
+    return score_;
+}
+
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+DataType
+AlignmentMatrix<DataType, SimMat>::gotoh_score(const SeqType &seq1, const SeqType &seq2)
+{
+    isCP_ = false;
+    editString_.clear();
+    algorithm_ = Algorithm::ScoreOnly;
+    size_t dim1 = seq1.size()+1;
+    size_t dim2 = seq2.size()+1;
+    scoreRows_.resize(3*dim2);
+    DataType *prevM = scoreRows_.data();
+    DataType *curM = prevM + dim2;
+    DataType *vert = curM + dim2;
+    const DataType MINIMUM = (-1)*(std::numeric_limits<DataType>::max()-1000);
+
+    prevM[0] = 0;
+    vert[0] = 0;
+    for (size_t j=1; j<dim2; ++j)
+    {
+        prevM[j] = (long int)j*gep_;
+        vert[j] = MINIMUM;
+    }
+
+    // same recursion as gotoh
+    for (size_t i=1; i<dim1; ++i)
+    {
+        DataType hor = MINIMUM;
+        curM[0] = vert[0] = vert[0]+gep_;
+        DataType gopH = (i==(dim1-1))? 0 : gop_;
+        DataType left = curM[0];
+        DataType diag = prevM[0];
+        DataType up, v, match_score;
+        DataType use_gop = gop_;
+        for (size_t j=1; j<dim2; ++j)
+        {
+            if (j == dim2-1)
+                use_gop = 0;
+            match_score = diag;
+            up = diag = prevM[j];
+            v = std::max(vert[j], up+use_gop) + gep_;
+            vert[j] = v;
+            hor = std::max(hor, left+gopH) + gep_;
+            match_score += simMat_.val(seq1[i-1], seq2[j-1]);
+            left = std::max(std::max(v, hor), match_score);
+            curM[j] = left;
+        }
+        std::swap(prevM, curM);
+    }
+    score_ = prevM[dim2-1];
+    return score_;
+}
+
+
+template<typename DataType, typename SimMat>
+template<typename SeqType>
+DataType
+AlignmentMatrix<DataType, SimMat>::sw_score(const SeqType &seq1, const SeqType &seq2, size_t &end1, size_t &end2)
+{
+    isCP_ = false;
+    editString_.clear();
+    algorithm_ = Algorithm::ScoreOnly;
+
+    StripedSwHit hit;
+    if (simd_ && swStripedScore(seq1, seq2, simMat_, DataType(0), gep_, hit))
+    {
+        score_ = static_cast<DataType>(hit.score);
+        end1 = (hit.score == 0) ? 0 : hit.end1;
+        end2 = (hit.score == 0) ? 0 : hit.end2;
+        return score_;
+    }
+
+    size_t dim1 = seq1.size();
+    size_t dim2 = seq2.size()+1;
+    scoreRows_.resize(2*dim2);
+    DataType *prev = scoreRows_.data();
+    DataType *cur = prev + dim2;
+    for (size_t j=0; j<dim2; ++j)
+        prev[j] = 0;
+
+    // same recursion as fill_sw_, the first maximum in row-major order is reported
+    score_ = 0;
+    end1 = end2 = 0;
+    DataType score, left, diag, up;
+    for (size_t i=1; i <= dim1; ++i)
+    {
+        left = cur[0] = 0;
+        diag = prev[0];
+        for (size_t j=1; j<dim2; ++j)
+        {
+            up = prev[j];
+            score = diag + static_cast<DataType>(simMat_.val(seq1[i-1], seq2[j-1]));
+            diag = up;
+            up = std::max(std::max(up, left) + gep_, score);
+            if (up <= 0)
+                up = 0;
+            else if (up > score_)
+            {
+                score_ = up;
+                end1 = i-1;
+                end2 = j-1;
+            }
+            left = cur[j] = up;
+        }
+        std::swap(prev, cur);
+    }
+    return score_;
+}
+
 }
 
 #endif /* AlignmentMatrix_hpp */
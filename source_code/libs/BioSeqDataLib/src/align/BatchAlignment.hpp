@@ -0,0 +1,313 @@
+/*
+ * BatchAlignment.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * \file BatchAlignment.hpp
+  * \brief Header containing the BatchAligner class to align many sequences against many sequences.
+  */
+#ifndef BatchAlignment_hpp
+#define BatchAlignment_hpp
+
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "AlignmentMatrix.hpp"
+#include "EditSequence.hpp"
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \brief The pairwise algorithms a BatchAligner can run.
+ */
+enum class BatchAlgorithm {NW, Gotoh, SW};
+
+
+/**
+ * \class AlignmentTable
+ * \brief The results of aligning every query against every target.
+ *
+ * The table is allocated once by BatchAligner::align and reused (without reallocation) by later runs of the same
+ * or a smaller size. Row q contains the results of query q, in the order in which the query set is iterated.
+ */
+template<typename DataType>
+class AlignmentTable
+{
+private:
+    size_t nQueries_;
+    size_t nTargets_;
+    std::vector<DataType> scores_;
+    std::vector<EditSequence> alignments_;
+
+public:
+    AlignmentTable() : nQueries_(0), nTargets_(0)
+    {}
+
+    /**
+     * \brief Sets the size of the table.
+     * @param nQueries The number of queries.
+     * @param nTargets The number of targets.
+     * @param withAlignments Whether to store the alignments or only the scores.
+     */
+    void
+    resize(size_t nQueries, size_t nTargets, bool withAlignments)
+    {
+        nQueries_ = nQueries;
+        nTargets_ = nTargets;
+        scores_.resize(nQueries * nTargets);
+        alignments_.resize(withAlignments ? nQueries * nTargets : 0);
+    }
+
+    size_t
+    nQueries() const
+    {
+        return nQueries_;
+    }
+
+    size_t
+    nTargets() const
+    {
+        return nTargets_;
+    }
+
+    /**
+     * \brief The score of a pair.
+     * @param query The index of the query.
+     * @param target The index of the target.
+     */
+    DataType &
+    score(size_t query, size_t target)
+    {
+        return scores_[query * nTargets_ + target];
+    }
+
+    const DataType &
+    score(size_t query, size_t target) const
+    {
+        return scores_[query * nTargets_ + target];
+    }
+
+    /**
+     * \brief The alignment of a pair, only available if the table was filled with alignments.
+     * @param query The index of the query.
+     * @param target The index of the target.
+     */
+    EditSequence &
+    alignment(size_t query, size_t target)
+    {
+        return alignments_[query * nTargets_ + target];
+    }
+
+    const EditSequence &
+    alignment(size_t query, size_t target) const
+    {
+        return alignments_[query * nTargets_ + target];
+    }
+
+    /**
+     * \brief All scores, row-major (query by query).
+     */
+    const std::vector<DataType> &
+    scores() const
+    {
+        return scores_;
+    }
+};
+
+
+/**
+ * \class BatchAligner
+ * \brief Aligns every sequence of a query set against every sequence of a target set.
+ *
+ * The pairs are distributed dynamically over the threads. Every thread owns an AlignmentMatrix (including a copy of
+ * the scoring) as workspace, whose matrices are reused for all pairs of the thread and for later calls of align, so
+ * that memory is only allocated for the largest pair a thread has seen. Without OpenMP the pairs are aligned one
+ * after another.
+ *
+ * The sets can be any container of sequences or domain arrangements (e.g. SequenceSet, std::vector) or a map from
+ * names to them (e.g. DomainArrangementSet).
+ * \tparam DataType The type of the scores.
+ * \tparam SimMat The scoring type (e.g. SimilarityMatrix or DSM).
+ */
+template<typename DataType, typename SimMat>
+class BatchAligner
+{
+private:
+    BatchAlgorithm algorithm_;
+    AlignmentMatrix<DataType, SimMat> prototype_;
+    std::vector<AlignmentMatrix<DataType, SimMat> > workspaces_;
+    unsigned int nThreads_;
+
+    template<typename SeqType>
+    static const SeqType &
+    element_(const SeqType &element)
+    {
+        return element;
+    }
+
+    template<typename Key, typename SeqType>
+    static const SeqType &
+    element_(const std::pair<const Key, SeqType> &element)
+    {
+        return element.second;
+    }
+
+    // collects pointers to the sequences of a set in iteration order
+    template<typename Set, typename SeqType>
+    static void
+    collect_(const Set &set, std::vector<const SeqType *> &elements)
+    {
+        elements.clear();
+        elements.reserve(set.size());
+        for (const auto &element : set)
+            elements.push_back(&element_(element));
+    }
+
+    // the score-only variants are used if no alignment is needed
+    template<typename SeqType>
+    void
+    align_(AlignmentMatrix<DataType, SimMat> &mat, const SeqType &seq1, const SeqType &seq2, bool withAlignment) const
+    {
+        switch (algorithm_)
+        {
+            case BatchAlgorithm::NW:
+                if (withAlignment)
+                    mat.nw(seq1, seq2);
+                else
+                    mat.nw_score(seq1, seq2);
+                break;
+            case BatchAlgorithm::Gotoh:
+                if (withAlignment)
+                    mat.gotoh(seq1, seq2);
+                else
+                    mat.gotoh_score(seq1, seq2);
+                break;
+            case BatchAlgorithm::SW:
+                if (withAlignment)
+                    mat.sw(seq1, seq2);
+                else
+                    mat.sw_score(seq1, seq2);
+                break;
+        }
+    }
+
+public:
+    /**
+     * \brief Constructor.
+     * @param algorithm The algorithm to use.
+     * @param gop Gap opening costs (only used by Gotoh).
+     * @param gep Gap extension costs.
+     * @param simMat The scoring.
+     * @param nThreads The number of threads.
+     */
+    BatchAligner(BatchAlgorithm algorithm, DataType gop, DataType gep, const SimMat &simMat, unsigned int nThreads = 1)
+        : algorithm_(algorithm), prototype_(gop, gep, simMat), nThreads_(nThreads == 0 ? 1 : nThreads)
+    {}
+
+    /**
+     * \brief Sets the number of threads.
+     */
+    void
+    threads(unsigned int nThreads)
+    {
+        nThreads_ = (nThreads == 0) ? 1 : nThreads;
+    }
+
+    unsigned int
+    threads() const
+    {
+        return nThreads_;
+    }
+
+    /**
+     * \brief Sets whether the Smith-Waterman algorithm may use the striped SIMD kernel, see AlignmentMatrix::simd.
+     */
+    void
+    simd(bool use)
+    {
+        prototype_.simd(use);
+        workspaces_.clear();
+    }
+
+    /**
+     * \brief Aligns every query against every target.
+     * @param queries The query set.
+     * @param targets The target set.
+     * @param[out] table The results, resized to queries.size() x targets.size().
+     * @param withAlignments Whether to store the alignments in the table or only the scores. Without alignments only
+     * the scores are computed (see AlignmentMatrix::nw_score), the alignment of a selected pair can be computed
+     * afterwards with AlignmentMatrix.
+     */
+    template<typename QuerySet, typename TargetSet>
+    void
+    align(const QuerySet &queries, const TargetSet &targets, AlignmentTable<DataType> &table, bool withAlignments = false)
+    {
+        typedef typename std::decay<decltype(element_(*queries.begin()))>::type SeqType;
+        std::vector<const SeqType *> querySeqs, targetSeqs;
+        collect_(queries, querySeqs);
+        collect_(targets, targetSeqs);
+        size_t nTargets = targetSeqs.size();
+        size_t nPairs = querySeqs.size() * nTargets;
+        table.resize(querySeqs.size(), nTargets, withAlignments);
+
+        if (workspaces_.size() < nThreads_)
+            workspaces_.resize(nThreads_, prototype_);
+
+        std::exception_ptr error;
+        #pragma omp parallel num_threads(nThreads_)
+        {
+            size_t thread = 0;
+            #ifdef _OPENMP
+            thread = omp_get_thread_num();
+            #endif
+            AlignmentMatrix<DataType, SimMat> &mat = workspaces_[thread];
+            #pragma omp for schedule(dynamic, 16)
+            for (size_t pair = 0; pair < nPairs; ++pair)
+            {
+                try
+                {
+                    size_t query = pair / nTargets;
+                    size_t target = pair % nTargets;
+                    align_(mat, *querySeqs[query], *targetSeqs[target], withAlignments);
+                    table.score(query, target) = mat.score();
+                    if (withAlignments)
+                        table.alignment(query, target) = mat.result();
+                }
+                catch (...)
+                {
+                    #pragma omp critical(BatchAligner_error)
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+}
+
+#endif /* BatchAlignment_hpp */
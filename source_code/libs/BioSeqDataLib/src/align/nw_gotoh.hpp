@@ -127,8 +127,12 @@ namespace BioSeqDataLib
 		char path;
 		size_t i, j=0;
 		DataType score;
+		// the path of the border cells is set as well, the matrix may contain values of a previous alignment
 		for (; it!=itEnd; ++it)
+		{
 			it->first=(j++)*gapPenalty;
+			it->second='j';
+		}
 
 		for (i=1; i <= dim1; ++i)
 		{
@@ -136,6 +140,7 @@ namespace BioSeqDataLib
 			itEnd = matrix[i].begin()+dim2;
 			itVert = matrix[i-1].begin();
 			it->first = i*gapPenalty;
+			it->second = 'i';
 			++it;
 			for (; it!=itEnd; ++it, ++itPrev)
 			{
@@ -377,7 +382,7 @@ namespace BioSeqDataLib
 		Matrix<std::pair<DataType, char> > &matM = matrices[0];
 		Matrix<std::pair<DataType, char> > &matH = matrices[1];
 		Matrix<std::pair<DataType, char> > &matV = matrices[2];
-		typedef typename std::vector<std::pair<DataType, char> >::iterator MatrixIterator;
+		typedef typename Matrix<std::pair<DataType, char> >::iterator MatrixIterator;
 		MatrixIterator itM=matM[0].begin();
 		MatrixIterator itH=matH[0].begin();
 		MatrixIterator itV=matV[0].begin();
@@ -493,7 +498,7 @@ namespace BioSeqDataLib
 		Matrix<std::pair<DataType, char> > &matM = matrices[0];
 		Matrix<std::pair<DataType, char> > &matH = matrices[1];
 		Matrix<std::pair<DataType, char> > &matV = matrices[2];
-		typedef typename std::vector<std::pair<DataType, char> >::iterator MatrixIterator;
+		typedef typename Matrix<std::pair<DataType, char> >::iterator MatrixIterator;
 		MatrixIterator itM=matM[0].begin();
 		MatrixIterator itH=matH[0].begin();
 		MatrixIterator itV=matV[0].begin();
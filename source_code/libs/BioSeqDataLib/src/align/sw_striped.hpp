@@ -0,0 +1,444 @@
+/*
+ * sw_striped.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file sw_striped.hpp
+ * \brief Striped SIMD Smith-Waterman score computation with runtime instruction set dispatch.
+ */
+#ifndef SRC_ALIGN_SW_STRIPED_HPP_
+#define SRC_ALIGN_SW_STRIPED_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && defined(__GNUC__)
+#define BSDL_STRIPED_SSE2
+#include <immintrin.h>
+#if defined(__AVX2__) || !defined(__clang__)
+#define BSDL_STRIPED_AVX2
+#endif
+#endif
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \brief The vector instruction sets the striped Smith-Waterman kernel can use.
+ */
+enum class SimdLevel {None, SSE2, AVX2};
+
+/**
+ * \brief Returns the best instruction set supported by the cpu the program is running on.
+ * \details The detection is done only once.
+ * @return The best supported instruction set.
+ */
+inline SimdLevel
+simdLevel()
+{
+#ifdef BSDL_STRIPED_SSE2
+	static const SimdLevel level = []() {
+		__builtin_cpu_init();
+#ifdef BSDL_STRIPED_AVX2
+		if (__builtin_cpu_supports("avx2"))
+			return SimdLevel::AVX2;
+#endif
+		return __builtin_cpu_supports("sse2") ? SimdLevel::SSE2 : SimdLevel::None;
+	}();
+	return level;
+#else
+	return SimdLevel::None;
+#endif
+}
+
+/**
+ * \brief The score and position of a local alignment.
+ * \details All positions are 0-based and inclusive.
+ */
+struct StripedSwHit
+{
+	long score;    //!< The score of the alignment
+	size_t start1; //!< Start of the alignment in sequence 1
+	size_t end1;   //!< End of the alignment in sequence 1
+	size_t start2; //!< Start of the alignment in sequence 2
+	size_t end2;   //!< End of the alignment in sequence 2
+};
+
+namespace striped
+{
+
+// scores of the 16-bit profile are restricted to +-maxProfileScore, padding columns get -maxProfileScore
+const long maxProfileScore = 16384;
+
+/**
+ * \brief A Smith-Waterman problem with the residues mapped to small integers.
+ */
+struct Problem
+{
+	std::vector<unsigned char> rows; //!< Symbols of the first sequence
+	std::vector<unsigned char> cols; //!< Symbols of the second sequence
+	std::vector<long> scores;        //!< Score of row symbol r and column symbol c at r*nColSymbols+c
+	size_t nRowSymbols;              //!< Number of distinct residues in the first sequence
+	size_t nColSymbols;              //!< Number of distinct residues in the second sequence
+	long minScore;                   //!< The smallest score in the table
+	long maxScore;                   //!< The largest score in the table
+	long gapOpen;                    //!< Positive costs of the first position of a gap
+	long gapExt;                     //!< Positive costs of every further gap position
+};
+
+/**
+ * \brief Maps the residues of a sequence to consecutive numbers.
+ * @param seq The sequence.
+ * @param symbols Residue -> number map, 256 means not yet used.
+ * @param residues The residues in the order of their numbers.
+ * @param encoded The encoded sequence.
+ */
+template<typename SeqType>
+void
+encode(const SeqType &seq, std::vector<unsigned int> &symbols, std::vector<char> &residues, std::vector<unsigned char> &encoded)
+{
+	symbols.assign(256, 256);
+	residues.clear();
+	encoded.resize(seq.size());
+	for (size_t i = 0; i < seq.size(); ++i)
+	{
+		unsigned char c = static_cast<unsigned char>(seq[i]);
+		if (symbols[c] == 256)
+		{
+			symbols[c] = residues.size();
+			residues.push_back(static_cast<char>(c));
+		}
+		encoded[i] = static_cast<unsigned char>(symbols[c]);
+	}
+}
+
+/**
+ * \brief Checks if a value is an integer and converts it.
+ */
+template<typename DataType>
+bool
+toInteger(DataType value, long &result)
+{
+	if ((std::floor(value) != value) || (std::fabs(static_cast<double>(value)) > 1e6))
+		return false;
+	result = static_cast<long>(value);
+	return true;
+}
+
+/**
+ * \brief Fills a Problem, fails if not all scores and penalties are integers.
+ */
+template<typename SeqType, typename SimMat, typename DataType>
+bool
+makeProblem(const SeqType &seq1, const SeqType &seq2, const SimMat &simMat, DataType gop, DataType gep, Problem &problem, std::true_type)
+{
+	long gapOpen, gapExt;
+	if (!toInteger(gop, gapOpen) || !toInteger(gep, gapExt))
+		return false;
+	// the kernel needs strictly positive extension costs to terminate the lazy F loop
+	problem.gapOpen = -(gapOpen + gapExt);
+	problem.gapExt = -gapExt;
+	if ((problem.gapExt <= 0) || (problem.gapOpen < problem.gapExt))
+		return false;
+
+	std::vector<unsigned int> symbols;
+	std::vector<char> rowResidues, colResidues;
+	encode(seq1, symbols, rowResidues, problem.rows);
+	encode(seq2, symbols, colResidues, problem.cols);
+	problem.nRowSymbols = rowResidues.size();
+	problem.nColSymbols = colResidues.size();
+	problem.scores.resize(problem.nRowSymbols * problem.nColSymbols);
+	problem.minScore = problem.maxScore = 0;
+	for (size_t r = 0; r < problem.nRowSymbols; ++r)
+	{
+		for (size_t c = 0; c < problem.nColSymbols; ++c)
+		{
+			long value;
+			if (!toInteger(simMat.val(rowResidues[r], colResidues[c]), value))
+				return false;
+			problem.scores[r * problem.nColSymbols + c] = value;
+			problem.minScore = std::min(problem.minScore, value);
+			problem.maxScore = std::max(problem.maxScore, value);
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Sequences that do not consist of characters (e.g. domain arrangements) are not supported.
+ */
+template<typename SeqType, typename SimMat, typename DataType>
+bool
+makeProblem(const SeqType &, const SeqType &, const SimMat &, DataType, DataType, Problem &, std::false_type)
+{
+	return false;
+}
+
+/**
+ * \brief Creates the striped query profile.
+ * \details Value k of vector s of symbol r is the score of r against column s+k*segLen.
+ */
+template<typename Cell>
+void
+buildProfile(const Problem &problem, const std::vector<unsigned char> &cols, size_t lanes, long bias, Cell padding, std::vector<Cell> &profile, size_t &segLen)
+{
+	size_t nCols = cols.size();
+	segLen = std::max<size_t>(1, (nCols + lanes - 1) / lanes);
+	size_t width = segLen * lanes;
+	profile.resize(problem.nRowSymbols * width);
+	for (size_t r = 0; r < problem.nRowSymbols; ++r)
+	{
+		const long *rowScores = problem.scores.data() + r * problem.nColSymbols;
+		Cell *out = &profile[r * width];
+		for (size_t s = 0; s < segLen; ++s)
+		{
+			for (size_t k = 0; k < lanes; ++k)
+			{
+				size_t j = s + k * segLen;
+				out[s * lanes + k] = (j < nCols) ? static_cast<Cell>(rowScores[cols[j]] + bias) : padding;
+			}
+		}
+	}
+}
+
+#ifdef BSDL_STRIPED_SSE2
+namespace sse2
+{
+
+/**
+ * \brief 16 unsigned 8-bit lanes, scores are stored with a bias.
+ */
+struct OpsU8
+{
+	typedef __m128i Vec;
+	typedef uint8_t Cell;
+	static const size_t lanes = 16;
+
+	static Cell lowCell() { return 0; }
+	static long maxCell() { return std::numeric_limits<Cell>::max(); }
+	static Vec low() { return _mm_setzero_si128(); }
+	static Vec set1(Cell c) { return _mm_set1_epi8(static_cast<char>(c)); }
+	static Vec load(const Cell *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+	static void store(Cell *p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	static Vec subs(Vec a, Vec b) { return _mm_subs_epu8(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm_max_epu8(a, b); }
+	static Vec shift(Vec v) { return _mm_slli_si128(v, 1); }
+	static Vec shiftLow(Vec v) { return shift(v); }
+	static bool anyGreater(Vec a, Vec b) { return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(a, b), _mm_setzero_si128())) != 0xFFFF; }
+	static Vec addScore(Vec h, Vec p, Vec bias) { return _mm_subs_epu8(_mm_adds_epu8(h, p), bias); }
+};
+
+/**
+ * \brief 8 signed 16-bit lanes.
+ */
+struct OpsI16
+{
+	typedef __m128i Vec;
+	typedef int16_t Cell;
+	static const size_t lanes = 8;
+
+	static Cell lowCell() { return std::numeric_limits<Cell>::min(); }
+	static long maxCell() { return std::numeric_limits<Cell>::max(); }
+	static Vec low() { return _mm_set1_epi16(lowCell()); }
+	static Vec set1(Cell c) { return _mm_set1_epi16(c); }
+	static Vec load(const Cell *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+	static void store(Cell *p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	static Vec subs(Vec a, Vec b) { return _mm_subs_epi16(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm_max_epi16(a, b); }
+	static Vec shift(Vec v) { return _mm_slli_si128(v, 2); }
+	static Vec shiftLow(Vec v) { return _mm_insert_epi16(shift(v), lowCell(), 0); }
+	static bool anyGreater(Vec a, Vec b) { return _mm_movemask_epi8(_mm_cmpgt_epi16(a, b)) != 0; }
+	static Vec addScore(Vec h, Vec p, Vec) { return _mm_max_epi16(_mm_adds_epi16(h, p), _mm_setzero_si128()); }
+};
+
+#include "sw_striped_kernel.hpp"
+
+} // sse2 namespace
+#endif
+
+#ifdef BSDL_STRIPED_AVX2
+#ifndef __AVX2__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2
+{
+
+// shifts the whole 256 bit register by N bytes towards the higher lanes
+template<int N>
+inline __m256i
+shiftBytes(__m256i v)
+{
+	return _mm256_alignr_epi8(v, _mm256_permute2x128_si256(v, v, 0x08), 16 - N);
+}
+
+/**
+ * \brief 32 unsigned 8-bit lanes, scores are stored with a bias.
+ */
+struct OpsU8
+{
+	typedef __m256i Vec;
+	typedef uint8_t Cell;
+	static const size_t lanes = 32;
+
+	static Cell lowCell() { return 0; }
+	static long maxCell() { return std::numeric_limits<Cell>::max(); }
+	static Vec low() { return _mm256_setzero_si256(); }
+	static Vec set1(Cell c) { return _mm256_set1_epi8(static_cast<char>(c)); }
+	static Vec load(const Cell *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+	static void store(Cell *p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+	static Vec subs(Vec a, Vec b) { return _mm256_subs_epu8(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm256_max_epu8(a, b); }
+	static Vec shift(Vec v) { return shiftBytes<1>(v); }
+	static Vec shiftLow(Vec v) { return shift(v); }
+	static bool anyGreater(Vec a, Vec b) { return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_subs_epu8(a, b), _mm256_setzero_si256())) != -1; }
+	static Vec addScore(Vec h, Vec p, Vec bias) { return _mm256_subs_epu8(_mm256_adds_epu8(h, p), bias); }
+};
+
+/**
+ * \brief 16 signed 16-bit lanes.
+ */
+struct OpsI16
+{
+	typedef __m256i Vec;
+	typedef int16_t Cell;
+	static const size_t lanes = 16;
+
+	static Cell lowCell() { return std::numeric_limits<Cell>::min(); }
+	static long maxCell() { return std::numeric_limits<Cell>::max(); }
+	static Vec low() { return _mm256_set1_epi16(lowCell()); }
+	static Vec set1(Cell c) { return _mm256_set1_epi16(c); }
+	static Vec load(const Cell *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+	static void store(Cell *p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+	static Vec subs(Vec a, Vec b) { return _mm256_subs_epi16(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm256_max_epi16(a, b); }
+	static Vec shift(Vec v) { return shiftBytes<2>(v); }
+	static Vec shiftLow(Vec v) { return _mm256_insert_epi16(shift(v), lowCell(), 0); }
+	static bool anyGreater(Vec a, Vec b) { return _mm256_movemask_epi8(_mm256_cmpgt_epi16(a, b)) != 0; }
+	static Vec addScore(Vec h, Vec p, Vec) { return _mm256_max_epi16(_mm256_adds_epi16(h, p), _mm256_setzero_si256()); }
+};
+
+#include "sw_striped_kernel.hpp"
+
+} // avx2 namespace
+#ifndef __AVX2__
+#pragma GCC pop_options
+#endif
+#endif
+
+/**
+ * \brief Runs the kernel of the given instruction set.
+ */
+inline bool
+run(const Problem &problem, const std::vector<unsigned char> &rows, const std::vector<unsigned char> &cols, SimdLevel level, StripedSwHit &hit)
+{
+	switch (level)
+	{
+#ifdef BSDL_STRIPED_AVX2
+		case SimdLevel::AVX2:
+			return avx2::run(problem, rows, cols, hit);
+#endif
+#ifdef BSDL_STRIPED_SSE2
+		case SimdLevel::SSE2:
+			return sse2::run(problem, rows, cols, hit);
+#endif
+		default:
+			return false;
+	}
+}
+
+/**
+ * \brief True if the elements of the sequence type are characters.
+ */
+template<typename SeqType>
+struct hasCharResidues : std::integral_constant<bool,
+	std::is_integral<typename std::decay<decltype(std::declval<const SeqType &>()[0])>::type>::value &&
+	(sizeof(typename std::decay<decltype(std::declval<const SeqType &>()[0])>::type) == 1)>
+{};
+
+} // striped namespace
+
+/**
+ * \brief Computes the score and the end of the best local alignment with the striped SIMD kernel.
+ * \details The kernel uses 8-bit saturating arithmetic and switches to 16-bit if the score gets too large. It is only
+ * applicable to sequences of characters, integer scores and penalties and gap extension penalties below zero.
+ * Gaps of length k cost gop + k*gep, the same as in the Gotoh algorithm. The Smith-Waterman algorithm with homogenous
+ * gap costs corresponds to gop = 0. If several cells have the best score, the first one in row-major order is reported.
+ * @param seq1 The first sequence.
+ * @param seq2 The second sequence.
+ * @param simMat The similarity matrix.
+ * @param gop The gap opening penalty.
+ * @param gep The gap extension penalty.
+ * @param[out] hit The score and the end positions of the best alignment, start1/start2 are not set.
+ * @param level The instruction set to use, by default the best one supported by the cpu.
+ * @return False if the kernel is not applicable, the content of hit is undefined in this case.
+ */
+template<typename SeqType, typename SimMat, typename DataType>
+bool
+swStripedScore(const SeqType &seq1, const SeqType &seq2, const SimMat &simMat, DataType gop, DataType gep, StripedSwHit &hit, SimdLevel level = simdLevel())
+{
+	striped::Problem problem;
+	if (!striped::makeProblem(seq1, seq2, simMat, gop, gep, problem, striped::hasCharResidues<SeqType>()))
+		return false;
+	return striped::run(problem, problem.rows, problem.cols, level, hit);
+}
+
+/**
+ * \brief Computes score, start and end of the best local alignment with the striped SIMD kernel.
+ * \details A second run of the kernel on the reversed prefixes of both sequences ending at the best cell determines
+ * the start of the alignment. The full dynamic programming matrix is then only needed for the region
+ * [start1,end1]x[start2,end2] to compute the traceback. See swStripedScore for the restrictions.
+ * @param seq1 The first sequence.
+ * @param seq2 The second sequence.
+ * @param simMat The similarity matrix.
+ * @param gop The gap opening penalty.
+ * @param gep The gap extension penalty.
+ * @param[out] hit The score and the region of the best alignment. All positions are 0 if the score is 0.
+ * @param level The instruction set to use, by default the best one supported by the cpu.
+ * @return False if the kernel is not applicable, the content of hit is undefined in this case.
+ */
+template<typename SeqType, typename SimMat, typename DataType>
+bool
+swStripedHit(const SeqType &seq1, const SeqType &seq2, const SimMat &simMat, DataType gop, DataType gep, StripedSwHit &hit, SimdLevel level = simdLevel())
+{
+	striped::Problem problem;
+	if (!striped::makeProblem(seq1, seq2, simMat, gop, gep, problem, striped::hasCharResidues<SeqType>()))
+		return false;
+	if (!striped::run(problem, problem.rows, problem.cols, level, hit))
+		return false;
+	if (hit.score == 0)
+		return true;
+
+	std::vector<unsigned char> revRows(problem.rows.rend() - (hit.end1 + 1), problem.rows.rend());
+	std::vector<unsigned char> revCols(problem.cols.rend() - (hit.end2 + 1), problem.cols.rend());
+	StripedSwHit revHit;
+	if (!striped::run(problem, revRows, revCols, level, revHit) || (revHit.score != hit.score))
+		return false;
+	hit.start1 = hit.end1 - revHit.end1;
+	hit.start2 = hit.end2 - revHit.end2;
+	return true;
+}
+
+} // BioSeqDataLib namespace
+
+#endif /* SRC_ALIGN_SW_STRIPED_HPP_ */
@@ -0,0 +1,164 @@
+/*
+ * sw_striped_kernel.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file sw_striped_kernel.hpp
+ * \brief The instruction set independent part of the striped Smith-Waterman kernel.
+ * \details This file has no include guard on purpose. It is included by sw_striped.hpp once for every supported
+ * instruction set, each time inside a different namespace and with different compiler target options, so that the
+ * same kernel is compiled for SSE2 and AVX2. Do not include it directly.
+ */
+
+/**
+ * \brief Striped Smith-Waterman score computation (Farrar, 2007).
+ * \details The columns (second sequence) are distributed over the vector lanes in a striped fashion, the rows (first
+ * sequence) are processed one after another. Only two rows of H values and one row of E values are kept. The first
+ * maximum in row-major order is reported, the same cell the full matrix implementation chooses.
+ * \tparam Ops The vector operations (element type, number of lanes, saturating arithmetic). Shifting moves every
+ * element one lane up, shift inserts 0 (H) and shiftLow the smallest value (E and F) into the first lane.
+ * @param profile The query profile, segLen*Ops::lanes values per row symbol.
+ * @param segLen The number of vectors per row.
+ * @param rows The row symbols.
+ * @param nRows The number of rows.
+ * @param nCols The number of columns.
+ * @param gapOpen The costs (positive) of the first position of a gap.
+ * @param gapExt The costs (positive) of every further position of a gap.
+ * @param bias The value added to every score of the profile (only for unsigned elements).
+ * @param limit The largest score that can be computed without saturating.
+ * @param[out] hit The score and the end coordinates of the best local alignment.
+ * @return False if the score exceeded the limit of the element type, true otherwise.
+ */
+template<typename Ops>
+bool
+stripedSw(const typename Ops::Cell *profile, size_t segLen, const unsigned char *rows, size_t nRows, size_t nCols,
+	long gapOpen, long gapExt, long bias, long limit, StripedSwHit &hit)
+{
+	typedef typename Ops::Cell Cell;
+	typedef typename Ops::Vec Vec;
+	const size_t lanes = Ops::lanes;
+	const size_t width = segLen * lanes;
+
+	std::vector<Cell> hBuffer1(width, 0);
+	std::vector<Cell> hBuffer2(width, 0);
+	std::vector<Cell> eBuffer(width, Ops::lowCell());
+	Cell *hStore = hBuffer1.data();
+	Cell *hLoad = hBuffer2.data();
+	Cell *e = eBuffer.data();
+	Cell rowValues[lanes];
+
+	const Vec vGapOpen = Ops::set1(static_cast<Cell>(std::min<long>(gapOpen, Ops::maxCell())));
+	const Vec vGapExt = Ops::set1(static_cast<Cell>(std::min<long>(gapExt, Ops::maxCell())));
+	const Vec vBias = Ops::set1(static_cast<Cell>(bias));
+
+	hit.score = 0;
+	hit.start1 = hit.end1 = hit.start2 = hit.end2 = 0;
+	for (size_t i = 0; i < nRows; ++i)
+	{
+		const Cell *rowProfile = profile + rows[i] * width;
+		Vec vF = Ops::low();
+		Vec vH = Ops::shift(Ops::load(hStore + (segLen - 1) * lanes));
+		std::swap(hStore, hLoad);
+
+		for (size_t s = 0; s < segLen; ++s)
+		{
+			vH = Ops::addScore(vH, Ops::load(rowProfile + s * lanes), vBias);
+			Vec vE = Ops::load(e + s * lanes);
+			vH = Ops::max(vH, vE);
+			vH = Ops::max(vH, vF);
+			Ops::store(hStore + s * lanes, vH);
+
+			vH = Ops::subs(vH, vGapOpen);
+			vE = Ops::max(Ops::subs(vE, vGapExt), vH);
+			Ops::store(e + s * lanes, vE);
+			vF = Ops::max(Ops::subs(vF, vGapExt), vH);
+			vH = Ops::load(hLoad + s * lanes);
+		}
+
+		// lazy F loop: propagate gaps crossing the segment borders
+		vF = Ops::shiftLow(vF);
+		size_t s = 0;
+		while (Ops::anyGreater(vF, Ops::subs(Ops::load(hStore + s * lanes), vGapOpen)))
+		{
+			Vec vH2 = Ops::max(Ops::load(hStore + s * lanes), vF);
+			Ops::store(hStore + s * lanes, vH2);
+			Ops::store(e + s * lanes, Ops::max(Ops::load(e + s * lanes), Ops::subs(vH2, vGapOpen)));
+			vF = Ops::subs(vF, vGapExt);
+			if (++s == segLen)
+			{
+				s = 0;
+				vF = Ops::shiftLow(vF);
+			}
+		}
+
+		Vec vMax = Ops::low();
+		for (s = 0; s < segLen; ++s)
+			vMax = Ops::max(vMax, Ops::load(hStore + s * lanes));
+		Ops::store(rowValues, vMax);
+		long rowMax = *std::max_element(rowValues, rowValues + lanes);
+		if (rowMax > hit.score)
+		{
+			if (rowMax > limit)
+				return false;
+			hit.score = rowMax;
+			hit.end1 = i;
+			hit.end2 = nCols;
+			for (s = 0; s < segLen; ++s)
+			{
+				for (size_t k = 0; k < lanes; ++k)
+				{
+					size_t j = s + k * segLen;
+					if ((j < hit.end2) && (hStore[s * lanes + k] == rowMax))
+						hit.end2 = j;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Runs the 8-bit kernel and, if the score is too large, the 16-bit kernel.
+ * @param problem The encoded scores and gap costs.
+ * @param rows The row symbols.
+ * @param cols The column symbols.
+ * @param[out] hit The score and the end coordinates of the best local alignment.
+ * @return False if the scores cannot be computed with 16-bit integers.
+ */
+inline bool
+run(const Problem &problem, const std::vector<unsigned char> &rows, const std::vector<unsigned char> &cols, StripedSwHit &hit)
+{
+	size_t segLen;
+	long bias = -problem.minScore;
+	if (problem.maxScore + bias < 255)
+	{
+		std::vector<OpsU8::Cell> profile;
+		buildProfile<OpsU8::Cell>(problem, cols, OpsU8::lanes, bias, 0, profile, segLen);
+		long limit = 255 - (problem.maxScore + bias);
+		if (stripedSw<OpsU8>(profile.data(), segLen, rows.data(), rows.size(), cols.size(), problem.gapOpen, problem.gapExt, bias, limit, hit))
+			return true;
+	}
+	if ((problem.minScore >= -maxProfileScore) && (problem.maxScore <= maxProfileScore))
+	{
+		std::vector<OpsI16::Cell> profile;
+		buildProfile<OpsI16::Cell>(problem, cols, OpsI16::lanes, 0, -maxProfileScore, profile, segLen);
+		long limit = OpsI16::maxCell() - problem.maxScore;
+		return stripedSw<OpsI16>(profile.data(), segLen, rows.data(), rows.size(), cols.size(), problem.gapOpen, problem.gapExt, 0, limit, hit);
+	}
+	return false;
+}
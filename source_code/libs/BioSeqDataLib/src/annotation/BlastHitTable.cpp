@@ -0,0 +1,451 @@
+/*
+ * BlastHitTable.cpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BlastHitTable.hpp"
+
+// C++ header
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+// boost header
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace BioSeqDataLib
+{
+
+namespace
+{
+
+bool
+parseUnsigned(const char *begin, const char *end, uint32_t &value)
+{
+	if (begin == end)
+		return false;
+	uint64_t tmp = 0;
+	for (; begin != end; ++begin)
+	{
+		if ((*begin < '0') || (*begin > '9'))
+			return false;
+		tmp = tmp*10 + (*begin-'0');
+		if (tmp > 0xFFFFFFFFULL)
+			return false;
+	}
+	value = static_cast<uint32_t>(tmp);
+	return true;
+}
+
+// the field is copied, as strtod might read behind the end of a memory mapped file
+bool
+parseDouble(const char *begin, const char *end, double &value)
+{
+	char buffer[64];
+	size_t length = end-begin;
+	if ((length == 0) || (length >= sizeof(buffer)))
+		return false;
+	memcpy(buffer, begin, length);
+	buffer[length] = '\0';
+	char *stop;
+	value = strtod(buffer, &stop);
+	return stop == buffer + length;
+}
+
+// converts a 1-based range into a 0-based range with start <= end, returns true if the range was reversed
+bool
+position(uint32_t &start, uint32_t &end)
+{
+	--start;
+	--end;
+	if (start > end)
+	{
+		std::swap(start, end);
+		return true;
+	}
+	return false;
+}
+
+template<typename T>
+void
+permute(std::vector<T> &column, const std::vector<uint64_t> &newPos)
+{
+	std::vector<T> tmp(column.size());
+	for (size_t i=0; i<column.size(); ++i)
+		tmp[newPos[i]] = column[i];
+	column.swap(tmp);
+}
+
+}
+
+
+const uint32_t BlastHitTable::npos;
+
+size_t
+BlastHitTable::RefHash::operator()(boost::string_ref str) const
+{
+	// FNV-1a
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (char c : str)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 0x100000001b3ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+uint32_t
+BlastHitTable::NameTable::intern(boost::string_ref name)
+{
+	auto it = ids.find(name);
+	if (it != ids.end())
+		return it->second;
+	uint32_t id = static_cast<uint32_t>(names.size());
+	names.emplace_back(name.data(), name.size());
+	ids.emplace(boost::string_ref(names.back()), id);
+	return id;
+}
+
+BlastHitTable::BlastHitTable() : queryOffsets_(1, 0)
+{}
+
+void
+BlastHitTable::clear_()
+{
+	queries_.clear();
+	subjects_.clear();
+	resize_(0);
+	queryOffsets_.assign(1, 0);
+}
+
+void
+BlastHitTable::read(const std::string &blastFile, size_t maxHits)
+{
+	boost::filesystem::path path(blastFile);
+	if ((path.extension() == ".gz") || (path.extension() == ".bz2"))
+	{
+		AlgorithmPack::Input inS(path);
+		std::ostringstream content;
+		content << inS.get().rdbuf();
+		inS.close();
+		std::string data = content.str();
+		read_(data.data(), data.size(), maxHits, blastFile);
+		return;
+	}
+	boost::iostreams::mapped_file_source file;
+	try
+	{
+		if (boost::filesystem::file_size(path) != 0)
+			file.open(blastFile);
+	}
+	catch (std::exception &e)
+	{
+		throw std::runtime_error("Error: A problem occurred opening '" + blastFile + "'.");
+	}
+	read_(file.data(), file.size(), maxHits, blastFile);
+}
+
+void
+BlastHitTable::parse(const char *data, size_t size, size_t maxHits)
+{
+	read_(data, size, maxHits, "");
+}
+
+void
+BlastHitTable::read_(const char *data, size_t size, size_t maxHits, const std::string &name)
+{
+	clear_();
+	// the hits of the current query, only needed when the best hits are selected
+	std::vector<Row> block;
+	auto flush = [&]()
+	{
+		if (block.size() > maxHits)
+			selectBest_(block, maxHits);
+		for (const Row &row : block)
+			append_(row);
+		block.clear();
+	};
+
+	const char *end = data + size;
+	const char *lineBegin = data;
+	uint32_t currentQuery = npos;
+	size_t lineN = 0;
+	Row row;
+	const char *fields[13];
+	while (lineBegin < end)
+	{
+		const char *lineEnd = static_cast<const char *>(memchr(lineBegin, '\n', end-lineBegin));
+		if (lineEnd == nullptr)
+			lineEnd = end;
+		const char *next = lineEnd+1;
+		++lineN;
+		if ((lineEnd != lineBegin) && (*(lineEnd-1) == '\r'))
+			--lineEnd;
+		if ((lineEnd == lineBegin) || (*lineBegin == '#'))
+		{
+			lineBegin = next;
+			continue;
+		}
+
+		// the start of the first 12 columns and the end of the 12th one
+		size_t nFields = 1;
+		fields[0] = lineBegin;
+		for (const char *pos = lineBegin; nFields < 13; ++nFields)
+		{
+			pos = static_cast<const char *>(memchr(pos, '\t', lineEnd-pos));
+			if (pos == nullptr)
+				break;
+			fields[nFields] = ++pos;
+		}
+		if (nFields < 12)
+			throw std::runtime_error("Error parsing line: " + std::to_string(lineN) + " of file: " + name);
+		if (nFields == 12)
+			fields[12] = lineEnd+1;
+
+		double value = 0;
+		bool valid = parseUnsigned(fields[3], fields[4]-1, row.alignmentLength);
+		valid = valid && parseUnsigned(fields[4], fields[5]-1, row.nMismatches);
+		valid = valid && parseUnsigned(fields[5], fields[6]-1, row.nGapOpenings);
+		valid = valid && parseUnsigned(fields[6], fields[7]-1, row.queryStart) && (row.queryStart != 0);
+		valid = valid && parseUnsigned(fields[7], fields[8]-1, row.queryEnd) && (row.queryEnd != 0);
+		valid = valid && parseUnsigned(fields[8], fields[9]-1, row.subjectStart) && (row.subjectStart != 0);
+		valid = valid && parseUnsigned(fields[9], fields[10]-1, row.subjectEnd) && (row.subjectEnd != 0);
+		valid = valid && parseDouble(fields[2], fields[3]-1, value);
+		row.percentIdentity = static_cast<float>(value);
+		valid = valid && parseDouble(fields[10], fields[11]-1, row.eValue);
+		valid = valid && parseDouble(fields[11], fields[12]-1, value);
+		row.bitScore = static_cast<float>(value);
+		if (!valid)
+			throw std::runtime_error("Error parsing line: " + std::to_string(lineN) + " of file: " + name);
+		row.strands = 0;
+		if (position(row.queryStart, row.queryEnd))
+			row.strands |= 1;
+		if (position(row.subjectStart, row.subjectEnd))
+			row.strands |= 2;
+
+		boost::string_ref queryName(fields[0], fields[1]-fields[0]-1);
+		if ((currentQuery == npos) || (queryName != queries_.names[currentQuery]))
+		{
+			flush();
+			currentQuery = queries_.intern(queryName);
+		}
+		row.query = currentQuery;
+		row.subject = subjects_.intern(boost::string_ref(fields[1], fields[2]-fields[1]-1));
+		if (maxHits == 0)
+			append_(row);
+		else
+			block.push_back(row);
+		lineBegin = next;
+	}
+	flush();
+	group_();
+
+	// a query occurring in several places of the file may still have too many hits
+	if (maxHits == 0)
+		return;
+	size_t pos = 0;
+	for (size_t queryId=0; queryId<nQueries(); ++queryId)
+	{
+		size_t begin = queryOffsets_[queryId];
+		size_t stop = queryOffsets_[queryId+1];
+		if (stop-begin > maxHits)
+		{
+			for (size_t i=begin; i<stop; ++i)
+				block.push_back(row_(i));
+			selectBest_(block, maxHits);
+			for (const Row &best : block)
+				set_(pos++, best);
+			block.clear();
+		}
+		else
+		{
+			for (size_t i=begin; i<stop; ++i, ++pos)
+				if (pos != i)
+					set_(pos, row_(i));
+		}
+		queryOffsets_[queryId] = pos - std::min(stop-begin, maxHits);
+	}
+	queryOffsets_.back() = pos;
+	resize_(pos);
+}
+
+void
+BlastHitTable::append_(const Row &row)
+{
+	query_.push_back(row.query);
+	subject_.push_back(row.subject);
+	percentIdentity_.push_back(row.percentIdentity);
+	alignmentLength_.push_back(row.alignmentLength);
+	nMismatches_.push_back(row.nMismatches);
+	nGapOpenings_.push_back(row.nGapOpenings);
+	queryStart_.push_back(row.queryStart);
+	queryEnd_.push_back(row.queryEnd);
+	subjectStart_.push_back(row.subjectStart);
+	subjectEnd_.push_back(row.subjectEnd);
+	strands_.push_back(row.strands);
+	eValue_.push_back(row.eValue);
+	bitScore_.push_back(row.bitScore);
+}
+
+BlastHitTable::Row
+BlastHitTable::row_(size_t hit) const
+{
+	Row row;
+	row.query = query_[hit];
+	row.subject = subject_[hit];
+	row.percentIdentity = percentIdentity_[hit];
+	row.alignmentLength = alignmentLength_[hit];
+	row.nMismatches = nMismatches_[hit];
+	row.nGapOpenings = nGapOpenings_[hit];
+	row.queryStart = queryStart_[hit];
+	row.queryEnd = queryEnd_[hit];
+	row.subjectStart = subjectStart_[hit];
+	row.subjectEnd = subjectEnd_[hit];
+	row.strands = strands_[hit];
+	row.eValue = eValue_[hit];
+	row.bitScore = bitScore_[hit];
+	return row;
+}
+
+void
+BlastHitTable::set_(size_t hit, const Row &row)
+{
+	query_[hit] = row.query;
+	subject_[hit] = row.subject;
+	percentIdentity_[hit] = row.percentIdentity;
+	alignmentLength_[hit] = row.alignmentLength;
+	nMismatches_[hit] = row.nMismatches;
+	nGapOpenings_[hit] = row.nGapOpenings;
+	queryStart_[hit] = row.queryStart;
+	queryEnd_[hit] = row.queryEnd;
+	subjectStart_[hit] = row.subjectStart;
+	subjectEnd_[hit] = row.subjectEnd;
+	strands_[hit] = row.strands;
+	eValue_[hit] = row.eValue;
+	bitScore_[hit] = row.bitScore;
+}
+
+void
+BlastHitTable::resize_(size_t n)
+{
+	query_.resize(n);
+	subject_.resize(n);
+	percentIdentity_.resize(n);
+	alignmentLength_.resize(n);
+	nMismatches_.resize(n);
+	nGapOpenings_.resize(n);
+	queryStart_.resize(n);
+	queryEnd_.resize(n);
+	subjectStart_.resize(n);
+	subjectEnd_.resize(n);
+	strands_.resize(n);
+	eValue_.resize(n);
+	bitScore_.resize(n);
+}
+
+void
+BlastHitTable::group_()
+{
+	queryOffsets_.assign(nQueries()+1, 0);
+	for (uint32_t queryId : query_)
+		++queryOffsets_[queryId+1];
+	for (size_t i=1; i<queryOffsets_.size(); ++i)
+		queryOffsets_[i] += queryOffsets_[i-1];
+
+	// the queries are numbered in the order of their first occurrence, so the hits are grouped if the ids never decrease
+	if (std::is_sorted(query_.begin(), query_.end()))
+		return;
+	std::vector<uint64_t> pos(queryOffsets_.begin(), queryOffsets_.end()-1);
+	std::vector<uint64_t> newPos(query_.size());
+	for (size_t i=0; i<query_.size(); ++i)
+		newPos[i] = pos[query_[i]]++;
+	permute(query_, newPos);
+	permute(subject_, newPos);
+	permute(percentIdentity_, newPos);
+	permute(alignmentLength_, newPos);
+	permute(nMismatches_, newPos);
+	permute(nGapOpenings_, newPos);
+	permute(queryStart_, newPos);
+	permute(queryEnd_, newPos);
+	permute(subjectStart_, newPos);
+	permute(subjectEnd_, newPos);
+	permute(strands_, newPos);
+	permute(eValue_, newPos);
+	permute(bitScore_, newPos);
+}
+
+void
+BlastHitTable::selectBest_(std::vector<Row> &rows, size_t maxHits)
+{
+	std::vector<size_t> order(rows.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&rows](size_t a, size_t b)
+	{
+		if (rows[a].bitScore != rows[b].bitScore)
+			return rows[a].bitScore > rows[b].bitScore;
+		return rows[a].eValue < rows[b].eValue;
+	});
+	order.resize(maxHits);
+	std::sort(order.begin(), order.end());
+	std::vector<Row> best;
+	best.reserve(maxHits);
+	for (size_t i : order)
+		best.push_back(rows[i]);
+	rows.swap(best);
+}
+
+size_t
+BlastHitTable::memoryUsage() const
+{
+	size_t bytes = query_.capacity() * sizeof(uint32_t) + subject_.capacity() * sizeof(uint32_t);
+	bytes += percentIdentity_.capacity() * sizeof(float) + bitScore_.capacity() * sizeof(float);
+	bytes += (alignmentLength_.capacity() + nMismatches_.capacity() + nGapOpenings_.capacity()) * sizeof(uint32_t);
+	bytes += (queryStart_.capacity() + queryEnd_.capacity() + subjectStart_.capacity() + subjectEnd_.capacity()) * sizeof(uint32_t);
+	bytes += strands_.capacity() + eValue_.capacity() * sizeof(double) + queryOffsets_.capacity() * sizeof(uint64_t);
+	for (const std::string &name : queries_.names)
+		bytes += name.capacity();
+	for (const std::string &name : subjects_.names)
+		bytes += name.capacity();
+	return bytes;
+}
+
+BlastHit
+BlastHitTable::hit(size_t hit) const
+{
+	BlastHit blastHit;
+	blastHit.queryID = queries_.names[query_[hit]];
+	blastHit.subjectID = subjects_.names[subject_[hit]];
+	blastHit.percentIdentity = percentIdentity_[hit];
+	blastHit.alignmentLength = alignmentLength_[hit];
+	blastHit.nMismatches = nMismatches_[hit];
+	blastHit.nGapOpenings = nGapOpenings_[hit];
+	blastHit.queryStart = queryStart_[hit];
+	blastHit.queryEnd = queryEnd_[hit];
+	blastHit.queryStrand = queryStrand(hit);
+	blastHit.subjectStart = subjectStart_[hit];
+	blastHit.subjectEnd = subjectEnd_[hit];
+	blastHit.subjectStrand = subjectStrand(hit);
+	blastHit.eValue = eValue_[hit];
+	blastHit.HSPBitScore = bitScore_[hit];
+	return blastHit;
+}
+
+} /* namespace BioSeqDataLib */
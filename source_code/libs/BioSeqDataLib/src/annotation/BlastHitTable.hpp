@@ -0,0 +1,390 @@
+/*
+ * BlastHitTable.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file BlastHitTable.hpp
+ * \brief File containing the BlastHitTable class.
+ */
+#ifndef BLASTHITTABLE_HPP_
+#define BLASTHITTABLE_HPP_
+
+// C++ header
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// boost header
+#include <boost/utility/string_ref.hpp>
+
+// BioSeqDataLib header
+#include "BlastHit.hpp"
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \brief Stores the hits of a tabular BLAST output (-outfmt 6 or 7) column by column.
+ *
+ * Every column is stored in its own array and the query and subject names are stored only once, a hit is referred to
+ * by its position in the table. The values are the same as in BlastHit: positions are 0-based and the start is always
+ * smaller than the end, the strand tells which way round the alignment was given.
+ *
+ * The hits are grouped by query: the queries are numbered in the order of their first appearance and the hits of query
+ * q are [hitsBegin(q), hitsEnd(q)) in the order of the file. Optionally only the best hits of every query (highest bit
+ * score, then lowest e-value) are kept. As BLAST writes all hits of a query together, this selection is done while
+ * reading so that the other hits are never stored. Queries occurring in several places of the file (e.g. concatenated
+ * outputs) are filtered again at the end.
+ */
+class BlastHitTable
+{
+public:
+	/**
+	 * \brief The value returned for names that do not exist.
+	 */
+	static const uint32_t npos = 0xFFFFFFFF;
+
+private:
+	struct Row
+	{
+		uint32_t query;
+		uint32_t subject;
+		float percentIdentity;
+		uint32_t alignmentLength;
+		uint32_t nMismatches;
+		uint32_t nGapOpenings;
+		uint32_t queryStart;
+		uint32_t queryEnd;
+		uint32_t subjectStart;
+		uint32_t subjectEnd;
+		uint8_t strands;
+		double eValue;
+		float bitScore;
+	};
+
+	struct RefHash
+	{
+		size_t
+		operator()(boost::string_ref str) const;
+	};
+
+	// the names, the deque keeps them at a fixed address for the references used as keys, a copy therefore needs
+	// new keys referring to its own names
+	struct NameTable
+	{
+		std::deque<std::string> names;
+		std::unordered_map<boost::string_ref, uint32_t, RefHash> ids;
+
+		NameTable() = default;
+
+		NameTable(const NameTable &other) : names(other.names), ids()
+		{
+			rebuild_();
+		}
+
+		NameTable(NameTable &&other) = default;
+
+		NameTable &
+		operator=(const NameTable &other)
+		{
+			if (this != &other)
+			{
+				ids.clear();
+				names = other.names;
+				rebuild_();
+			}
+			return *this;
+		}
+
+		NameTable &
+		operator=(NameTable &&other) = default;
+
+		void
+		rebuild_()
+		{
+			ids.reserve(names.size());
+			for (size_t i=0; i<names.size(); ++i)
+				ids.emplace(boost::string_ref(names[i]), static_cast<uint32_t>(i));
+		}
+
+		uint32_t
+		intern(boost::string_ref name);
+
+		uint32_t
+		find(boost::string_ref name) const
+		{
+			auto it = ids.find(name);
+			return (it == ids.end()) ? npos : it->second;
+		}
+
+		void
+		clear()
+		{
+			ids.clear();
+			names.clear();
+		}
+	};
+
+	NameTable queries_;
+	NameTable subjects_;
+
+	std::vector<uint32_t> query_;
+	std::vector<uint32_t> subject_;
+	std::vector<float> percentIdentity_;
+	std::vector<uint32_t> alignmentLength_;
+	std::vector<uint32_t> nMismatches_;
+	std::vector<uint32_t> nGapOpenings_;
+	std::vector<uint32_t> queryStart_;
+	std::vector<uint32_t> queryEnd_;
+	std::vector<uint32_t> subjectStart_;
+	std::vector<uint32_t> subjectEnd_;
+	// bit 0: query on the minus strand, bit 1: subject on the minus strand
+	std::vector<uint8_t> strands_;
+	std::vector<double> eValue_;
+	std::vector<float> bitScore_;
+
+	// the hits of query q are [queryOffsets_[q], queryOffsets_[q+1])
+	std::vector<uint64_t> queryOffsets_;
+
+	void
+	clear_();
+
+	void
+	read_(const char *data, size_t size, size_t maxHits, const std::string &name);
+
+	void
+	append_(const Row &row);
+
+	Row
+	row_(size_t hit) const;
+
+	void
+	set_(size_t hit, const Row &row);
+
+	void
+	resize_(size_t n);
+
+	void
+	group_();
+
+	static void
+	selectBest_(std::vector<Row> &rows, size_t maxHits);
+
+public:
+	BlastHitTable();
+
+	/**
+	 * \brief Reads a tabular BLAST output, previous content is removed.
+	 * @param blastFile The file, it may be compressed (gz, bz2).
+	 * @param maxHits If not 0, only the best maxHits hits of every query are kept.
+	 * @throw std::runtime_error if the file cannot be opened or a line cannot be parsed.
+	 */
+	void
+	read(const std::string &blastFile, size_t maxHits = 0);
+
+	/**
+	 * \brief Parses a tabular BLAST output in memory, previous content is removed.
+	 * @param data The data.
+	 * @param size The size of the data.
+	 * @param maxHits If not 0, only the best maxHits hits of every query are kept.
+	 * @throw std::runtime_error if a line cannot be parsed.
+	 */
+	void
+	parse(const char *data, size_t size, size_t maxHits = 0);
+
+	/**
+	 * \brief Returns the number of hits.
+	 */
+	size_t
+	size() const
+	{
+		return query_.size();
+	}
+
+	bool
+	empty() const
+	{
+		return query_.empty();
+	}
+
+	/**
+	 * \brief Returns the number of bytes used by the columns.
+	 */
+	size_t
+	memoryUsage() const;
+
+	size_t
+	nQueries() const
+	{
+		return queries_.names.size();
+	}
+
+	const std::string &
+	queryName(uint32_t queryId) const
+	{
+		return queries_.names[queryId];
+	}
+
+	/**
+	 * \brief Returns the id of a query or npos.
+	 * @param name The query name.
+	 */
+	uint32_t
+	queryId(const std::string &name) const
+	{
+		return queries_.find(name);
+	}
+
+	/**
+	 * \brief Returns the first hit of a query.
+	 */
+	size_t
+	hitsBegin(uint32_t queryId) const
+	{
+		return queryOffsets_[queryId];
+	}
+
+	/**
+	 * \brief Returns the position behind the last hit of a query.
+	 */
+	size_t
+	hitsEnd(uint32_t queryId) const
+	{
+		return queryOffsets_[queryId+1];
+	}
+
+	size_t
+	nSubjects() const
+	{
+		return subjects_.names.size();
+	}
+
+	const std::string &
+	subjectName(uint32_t subjectId) const
+	{
+		return subjects_.names[subjectId];
+	}
+
+	/**
+	 * \brief Returns the id of a subject or npos.
+	 * @param name The subject name.
+	 */
+	uint32_t
+	subjectId(const std::string &name) const
+	{
+		return subjects_.find(name);
+	}
+
+	uint32_t
+	query(size_t hit) const
+	{
+		return query_[hit];
+	}
+
+	uint32_t
+	subject(size_t hit) const
+	{
+		return subject_[hit];
+	}
+
+	float
+	percentIdentity(size_t hit) const
+	{
+		return percentIdentity_[hit];
+	}
+
+	uint32_t
+	alignmentLength(size_t hit) const
+	{
+		return alignmentLength_[hit];
+	}
+
+	uint32_t
+	nMismatches(size_t hit) const
+	{
+		return nMismatches_[hit];
+	}
+
+	uint32_t
+	nGapOpenings(size_t hit) const
+	{
+		return nGapOpenings_[hit];
+	}
+
+	uint32_t
+	queryStart(size_t hit) const
+	{
+		return queryStart_[hit];
+	}
+
+	uint32_t
+	queryEnd(size_t hit) const
+	{
+		return queryEnd_[hit];
+	}
+
+	char
+	queryStrand(size_t hit) const
+	{
+		return (strands_[hit] & 1) ? '-' : '+';
+	}
+
+	uint32_t
+	subjectStart(size_t hit) const
+	{
+		return subjectStart_[hit];
+	}
+
+	uint32_t
+	subjectEnd(size_t hit) const
+	{
+		return subjectEnd_[hit];
+	}
+
+	char
+	subjectStrand(size_t hit) const
+	{
+		return (strands_[hit] & 2) ? '-' : '+';
+	}
+
+	double
+	eValue(size_t hit) const
+	{
+		return eValue_[hit];
+	}
+
+	float
+	bitScore(size_t hit) const
+	{
+		return bitScore_[hit];
+	}
+
+	/**
+	 * \brief Converts a hit into a BlastHit.
+	 * @param hit The position of the hit.
+	 */
+	BlastHit
+	hit(size_t hit) const;
+};
+
+} /* namespace BioSeqDataLib */
+
+#endif /* BLASTHITTABLE_HPP_ */
@@ -0,0 +1,224 @@
+/*
+ * FeatureIndex.cpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FeatureIndex.hpp"
+
+// C++ header
+#include <algorithm>
+
+namespace BioSeqDataLib
+{
+
+const uint32_t FeatureIndex::npos;
+
+FeatureIndex::FeatureIndex() : reader_(), seqIds_(), seqIdMap_(), types_(), typeMap_(), typeCounts_(), entries_(), seqOffsets_(1, 0), rootLevels_()
+{}
+
+void
+FeatureIndex::read(const std::string &gffFile)
+{
+	reader_.open(gffFile);
+	read_();
+}
+
+void
+FeatureIndex::read(const char *data, size_t size)
+{
+	reader_.open(data, size);
+	read_();
+}
+
+void
+FeatureIndex::read_()
+{
+	seqIds_.clear();
+	seqIdMap_.clear();
+	types_.clear();
+	typeMap_.clear();
+	typeCounts_.clear();
+	entries_.clear();
+
+	// the names repeat, only a change of the sequence or type since the line before needs a lookup
+	std::vector<Entry> entries;
+	std::vector<uint32_t> entrySeqs;
+	GffRecord record;
+	uint32_t lastSeq = npos;
+	uint32_t lastType = npos;
+	while (reader_.next(record))
+	{
+		boost::string_ref seqName = record.seqId();
+		if ((lastSeq == npos) || (seqName != seqIds_[lastSeq]))
+		{
+			auto it = seqIdMap_.emplace(seqName.to_string(), static_cast<uint32_t>(seqIds_.size())).first;
+			if (it->second == seqIds_.size())
+				seqIds_.push_back(it->first);
+			lastSeq = it->second;
+		}
+		boost::string_ref typeName = record.type();
+		if ((lastType == npos) || (typeName != types_[lastType]))
+		{
+			auto it = typeMap_.emplace(typeName.to_string(), static_cast<uint32_t>(types_.size())).first;
+			if (it->second == types_.size())
+			{
+				types_.push_back(it->first);
+				typeCounts_.push_back(0);
+			}
+			lastType = it->second;
+		}
+		uint32_t type = lastType;
+		++typeCounts_[type];
+
+		Entry entry;
+		entry.start = record.start();
+		entry.end = record.end()+1;
+		entry.maxEnd = entry.end;
+		entry.offset = record.line().data() - reader_.data();
+		entry.length = static_cast<uint32_t>(record.line().size());
+		entry.type = type;
+		entries.push_back(entry);
+		entrySeqs.push_back(lastSeq);
+	}
+
+	// grouped by sequence in the order of the file, then sorted by start
+	seqOffsets_.assign(seqIds_.size()+1, 0);
+	for (uint32_t seq : entrySeqs)
+		++seqOffsets_[seq+1];
+	for (size_t i=1; i<seqOffsets_.size(); ++i)
+		seqOffsets_[i] += seqOffsets_[i-1];
+	std::vector<uint64_t> pos(seqOffsets_.begin(), seqOffsets_.end()-1);
+	entries_.resize(entries.size());
+	for (size_t i=0; i<entries.size(); ++i)
+		entries_[pos[entrySeqs[i]]++] = entries[i];
+
+	rootLevels_.resize(seqIds_.size());
+	for (size_t i=0; i<seqIds_.size(); ++i)
+	{
+		Entry *begin = entries_.data() + seqOffsets_[i];
+		Entry *end = entries_.data() + seqOffsets_[i+1];
+		std::stable_sort(begin, end, [](const Entry &a, const Entry &b) { return a.start < b.start; });
+		rootLevels_[i] = buildTree_(begin, end-begin);
+	}
+}
+
+// Node i of level k has the k lowest bits set and its children are i-2^(k-1) and i+2^(k-1). Nodes behind the end of the
+// array are missing, their maximum is the one of the last existing node at the same level.
+int
+FeatureIndex::buildTree_(Entry *entries, size_t n)
+{
+	if (n == 0)
+		return -1;
+	size_t lastI = 0;
+	uint64_t last = 0;
+	for (size_t i=0; i<n; i+=2)
+	{
+		lastI = i;
+		last = entries[i].maxEnd = entries[i].end;
+	}
+	int k = 1;
+	for (; (size_t(1) << k) <= n; ++k)
+	{
+		size_t x = size_t(1) << (k-1);
+		size_t step = x << 2;
+		for (size_t i=(x<<1)-1; i<n; i+=step)
+		{
+			uint64_t left = entries[i-x].maxEnd;
+			uint64_t right = (i+x < n) ? entries[i+x].maxEnd : last;
+			entries[i].maxEnd = std::max(entries[i].end, std::max(left, right));
+		}
+		lastI = ((lastI >> k) & 1) ? lastI-x : lastI+x;
+		if ((lastI < n) && (entries[lastI].maxEnd > last))
+			last = entries[lastI].maxEnd;
+	}
+	return k-1;
+}
+
+GffRecord
+FeatureIndex::record(size_t feature) const
+{
+	GffRecord record;
+	record.parse(boost::string_ref(reader_.data() + entries_[feature].offset, entries_[feature].length));
+	return record;
+}
+
+void
+FeatureIndex::overlap(uint32_t seqId, size_t start, size_t end, std::vector<size_t> &hits, uint32_t type) const
+{
+	hits.clear();
+	if ((seqId >= seqIds_.size()) || (rootLevels_[seqId] < 0))
+		return;
+	const Entry *entries = entries_.data() + seqOffsets_[seqId];
+	size_t n = seqOffsets_[seqId+1] - seqOffsets_[seqId];
+	uint64_t queryEnd = static_cast<uint64_t>(end)+1;
+	auto report = [&](size_t i)
+	{
+		if ((start < entries[i].end) && ((type == npos) || (entries[i].type == type)))
+			hits.push_back(seqOffsets_[seqId] + i);
+	};
+
+	struct Node
+	{
+		size_t x;
+		int k;
+		bool leftDone;
+	};
+	Node stack[128];
+	int top = 0;
+	stack[top++] = {(size_t(1) << rootLevels_[seqId]) - 1, rootLevels_[seqId], false};
+	while (top != 0)
+	{
+		Node node = stack[--top];
+		if (node.k <= 3)
+		{
+			// small subtrees are scanned
+			size_t i = (node.x >> node.k) << node.k;
+			size_t stop = std::min(n, i + (size_t(1) << (node.k+1)) - 1);
+			for (; (i<stop) && (entries[i].start < queryEnd); ++i)
+				report(i);
+		}
+		else if (!node.leftDone)
+		{
+			size_t left = node.x - (size_t(1) << (node.k-1));
+			stack[top++] = {node.x, node.k, true};
+			if ((left >= n) || (entries[left].maxEnd > start))
+				stack[top++] = {left, node.k-1, false};
+		}
+		else if ((node.x < n) && (entries[node.x].start < queryEnd))
+		{
+			report(node.x);
+			stack[top++] = {node.x + (size_t(1) << (node.k-1)), node.k-1, false};
+		}
+	}
+	std::sort(hits.begin(), hits.end());
+}
+
+std::vector<size_t>
+FeatureIndex::overlap(const std::string &seqName, size_t start, size_t end, const std::string &type) const
+{
+	std::vector<size_t> hits;
+	uint32_t typeId = npos;
+	if (!type.empty())
+	{
+		typeId = this->type(type);
+		if (typeId == npos)
+			return hits;
+	}
+	overlap(seqId(seqName), start, end, hits, typeId);
+	return hits;
+}
+
+} /* namespace BioSeqDataLib */
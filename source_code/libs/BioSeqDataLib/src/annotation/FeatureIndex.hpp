@@ -0,0 +1,240 @@
+/*
+ * FeatureIndex.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file FeatureIndex.hpp
+ * \brief File containing the FeatureIndex class.
+ */
+#ifndef FEATUREINDEX_HPP_
+#define FEATUREINDEX_HPP_
+
+// C++ header
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// BioSeqDataLib header
+#include "GffReader.hpp"
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \brief Stores the features of a GFF3 file for fast overlap queries.
+ *
+ * Only the coordinates of each feature are stored together with the ids of its sequence and type, the names of the
+ * sequences and types are stored once. Everything else is parsed from the memory mapped file on request with record().
+ * The features of each sequence are sorted by their start and form an implicit interval tree (the array is the in-order
+ * traversal of a complete binary tree, every node stores the largest end of its subtree), so that overlap() does not
+ * need to look at features which cannot overlap the query. Positions are 0-based and inclusive, like in Feature.
+ *
+ * The feature ids returned by the queries are positions in this sorted order.
+ */
+class FeatureIndex
+{
+public:
+	/**
+	 * \brief The value returned for sequences and types that do not exist.
+	 */
+	static const uint32_t npos = 0xFFFFFFFF;
+
+private:
+	struct Entry
+	{
+		uint64_t start;
+		// one behind the last position
+		uint64_t end;
+		// the largest end in the subtree of this node
+		uint64_t maxEnd;
+		uint64_t offset;
+		uint32_t length;
+		uint32_t type;
+	};
+
+	GffReader reader_;
+
+	std::vector<std::string> seqIds_;
+	std::unordered_map<std::string, uint32_t> seqIdMap_;
+	std::vector<std::string> types_;
+	std::unordered_map<std::string, uint32_t> typeMap_;
+	std::vector<size_t> typeCounts_;
+
+	std::vector<Entry> entries_;
+	// the features of sequence s are entries_[seqOffsets_[s]] ... entries_[seqOffsets_[s+1]-1]
+	std::vector<uint64_t> seqOffsets_;
+	// the level of the root of the tree of each sequence
+	std::vector<int> rootLevels_;
+
+	void
+	read_();
+
+	static int
+	buildTree_(Entry *entries, size_t n);
+
+public:
+	FeatureIndex();
+
+	/**
+	 * \brief Reads a GFF3 file, previous content is removed.
+	 * @param gffFile The file, it may be compressed (gz, bz2).
+	 * @throw std::runtime_error if the file cannot be opened.
+	 * @throw FormatException if the file is not a valid GFF3 file.
+	 */
+	void
+	read(const std::string &gffFile);
+
+	/**
+	 * \brief Reads GFF3 data from memory, previous content is removed.
+	 * @param data The data, it is not copied and needs to exist as long as the index is used.
+	 * @param size The size of the data.
+	 * @throw FormatException if the data is not valid GFF3.
+	 */
+	void
+	read(const char *data, size_t size);
+
+	/**
+	 * \brief Returns the number of features.
+	 */
+	size_t
+	size() const
+	{
+		return entries_.size();
+	}
+
+	size_t
+	nSeqIds() const
+	{
+		return seqIds_.size();
+	}
+
+	const std::string &
+	seqIdName(uint32_t seqId) const
+	{
+		return seqIds_[seqId];
+	}
+
+	/**
+	 * \brief Returns the id of a sequence or npos.
+	 * @param name The sequence name.
+	 */
+	uint32_t
+	seqId(const std::string &name) const
+	{
+		auto it = seqIdMap_.find(name);
+		return (it == seqIdMap_.end()) ? npos : it->second;
+	}
+
+	size_t
+	nTypes() const
+	{
+		return types_.size();
+	}
+
+	const std::string &
+	typeName(uint32_t type) const
+	{
+		return types_[type];
+	}
+
+	/**
+	 * \brief Returns the id of a feature type or npos.
+	 * @param name The feature type, e.g. "mRNA".
+	 */
+	uint32_t
+	type(const std::string &name) const
+	{
+		auto it = typeMap_.find(name);
+		return (it == typeMap_.end()) ? npos : it->second;
+	}
+
+	/**
+	 * \brief Returns the number of times a type occurs.
+	 * @param name The feature type.
+	 */
+	size_t
+	counts(const std::string &name) const
+	{
+		uint32_t typeId = type(name);
+		return (typeId == npos) ? 0 : typeCounts_[typeId];
+	}
+
+	/**
+	 * \brief Returns the range of feature ids belonging to a sequence.
+	 * @param seqId The sequence id.
+	 * @return The first id and the id behind the last one.
+	 */
+	std::pair<size_t, size_t>
+	features(uint32_t seqId) const
+	{
+		return std::make_pair(seqOffsets_[seqId], seqOffsets_[seqId+1]);
+	}
+
+	size_t
+	start(size_t feature) const
+	{
+		return entries_[feature].start;
+	}
+
+	size_t
+	end(size_t feature) const
+	{
+		return entries_[feature].end-1;
+	}
+
+	uint32_t
+	featureType(size_t feature) const
+	{
+		return entries_[feature].type;
+	}
+
+	/**
+	 * \brief Parses the complete line of a feature.
+	 * @param feature The feature id.
+	 */
+	GffRecord
+	record(size_t feature) const;
+
+	/**
+	 * \brief Finds all features overlapping a region.
+	 * @param seqId The sequence id.
+	 * @param start The first position of the region.
+	 * @param end The last position of the region.
+	 * @param[out] hits The ids of the overlapping features in increasing order, previous content is removed.
+	 * @param type If not npos, only features of this type are reported.
+	 */
+	void
+	overlap(uint32_t seqId, size_t start, size_t end, std::vector<size_t> &hits, uint32_t type = npos) const;
+
+	/**
+	 * \brief Finds all features overlapping a region.
+	 * @param seqName The sequence name, no features are found if it does not exist.
+	 * @param start The first position of the region.
+	 * @param end The last position of the region.
+	 * @param type If not empty, only features of this type are reported.
+	 * @return The ids of the overlapping features in increasing order.
+	 */
+	std::vector<size_t>
+	overlap(const std::string &seqName, size_t start, size_t end, const std::string &type = "") const;
+};
+
+} /* namespace BioSeqDataLib */
+
+#endif /* FEATUREINDEX_HPP_ */
@@ -0,0 +1,261 @@
+/*
+ * GffReader.cpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GffReader.hpp"
+
+// C++ header
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+// boost header
+#include <boost/filesystem.hpp>
+
+// BioSeqDataLib header
+#include "../external/Input.hpp"
+
+namespace AP=AlgorithmPack;
+
+namespace BioSeqDataLib
+{
+
+namespace
+{
+
+size_t
+findChar(boost::string_ref str, char c, size_t pos)
+{
+	const void *hit = memchr(str.data()+pos, c, str.size()-pos);
+	return (hit == nullptr) ? boost::string_ref::npos : static_cast<const char *>(hit) - str.data();
+}
+
+bool
+parsePosition(boost::string_ref field, size_t &value)
+{
+	if (field.empty())
+		return false;
+	value = 0;
+	for (char c : field)
+	{
+		if ((c < '0') || (c > '9'))
+			return false;
+		value = value*10 + (c-'0');
+	}
+	return value != 0;
+}
+
+bool
+parseScore(boost::string_ref field, double &value)
+{
+	if ((field.size() == 1) && (field[0] == '.'))
+	{
+		value = std::numeric_limits<double>::max();
+		return true;
+	}
+	char buffer[64];
+	if (field.empty() || (field.size() >= sizeof(buffer)))
+		return false;
+	memcpy(buffer, field.data(), field.size());
+	buffer[field.size()] = '\0';
+	char *end;
+	value = strtod(buffer, &end);
+	return end == buffer + field.size();
+}
+
+}
+
+
+bool
+GffRecord::parse(boost::string_ref line)
+{
+	line_ = line;
+	boost::string_ref fields[8];
+	size_t pos = 0;
+	for (size_t i=0; i<8; ++i)
+	{
+		size_t tab = findChar(line, '\t', pos);
+		if (tab == boost::string_ref::npos)
+			return false;
+		fields[i] = line.substr(pos, tab-pos);
+		pos = tab+1;
+	}
+	seqId_ = fields[0];
+	source_ = fields[1];
+	type_ = fields[2];
+	attributes_ = line.substr(pos);
+	if (!parsePosition(fields[3], start_) || !parsePosition(fields[4], end_) || !parseScore(fields[5], score_) || fields[6].empty() || fields[7].empty())
+		return false;
+	--start_;
+	--end_;
+	strand_ = fields[6][0];
+	if (fields[7][0] == '.')
+		phase_ = -1;
+	else if ((fields[7][0] >= '0') && (fields[7][0] <= '2'))
+		phase_ = fields[7][0] - '0';
+	else
+		return false;
+	return true;
+}
+
+bool
+GffRecord::findAttribute(boost::string_ref key, boost::string_ref &value) const
+{
+	size_t pos = 0;
+	while (pos < attributes_.size())
+	{
+		size_t end = findChar(attributes_, ';', pos);
+		if (end == boost::string_ref::npos)
+			end = attributes_.size();
+		boost::string_ref pair = attributes_.substr(pos, end-pos);
+		if ((pair.size() > key.size()+1) && (pair[key.size()] == '=') && pair.starts_with(key))
+		{
+			value = pair.substr(key.size()+1);
+			return true;
+		}
+		pos = end+1;
+	}
+	return false;
+}
+
+boost::string_ref
+GffRecord::attribute(boost::string_ref key) const
+{
+	boost::string_ref value;
+	if (!findAttribute(key, value))
+		throw std::out_of_range("Attribute '" + key.to_string() + "' does not exist.");
+	return value;
+}
+
+std::vector<boost::string_ref>
+GffRecord::parents() const
+{
+	std::vector<boost::string_ref> parents;
+	boost::string_ref value;
+	if (!findAttribute("Parent", value))
+		return parents;
+	size_t pos = 0;
+	while (true)
+	{
+		size_t end = findChar(value, ',', pos);
+		if (end == boost::string_ref::npos)
+		{
+			parents.push_back(value.substr(pos));
+			break;
+		}
+		parents.push_back(value.substr(pos, end-pos));
+		pos = end+1;
+	}
+	return parents;
+}
+
+
+void
+GffReader::open(const std::string &gffFile)
+{
+	close();
+	name_ = gffFile;
+	boost::filesystem::path path(gffFile);
+	if ((path.extension() == ".gz") || (path.extension() == ".bz2"))
+	{
+		AP::Input gffS(path);
+		std::ostringstream content;
+		content << gffS.get().rdbuf();
+		gffS.close();
+		buffer_ = content.str();
+		data_ = buffer_.data();
+		size_ = buffer_.size();
+	}
+	else
+	{
+		try
+		{
+			if (boost::filesystem::file_size(path) != 0)
+				file_.open(gffFile);
+		}
+		catch (std::exception &e)
+		{
+			throw std::runtime_error("Error: A problem occurred opening '" + gffFile + "'.");
+		}
+		data_ = file_.data();
+		size_ = file_.size();
+	}
+	start_();
+}
+
+void
+GffReader::open(const char *data, size_t size)
+{
+	close();
+	data_ = data;
+	size_ = size;
+	start_();
+}
+
+void
+GffReader::close()
+{
+	if (file_.is_open())
+		file_.close();
+	std::string().swap(buffer_);
+	name_.clear();
+	data_ = nullptr;
+	size_ = pos_ = lineNumber_ = 0;
+}
+
+void
+GffReader::start_()
+{
+	const char *header = "##gff-version 3";
+	size_t length = strlen(header);
+	if ((size_ < length) || (memcmp(data_, header, length) != 0))
+		throw FormatException("The file " + name_ + " does not contain the gff version header 3");
+	const char *lineEnd = static_cast<const char *>(memchr(data_, '\n', size_));
+	pos_ = (lineEnd == nullptr) ? size_ : lineEnd - data_ + 1;
+	lineNumber_ = 1;
+}
+
+bool
+GffReader::next(GffRecord &record)
+{
+	while (pos_ < size_)
+	{
+		const char *begin = data_ + pos_;
+		const char *lineEnd = static_cast<const char *>(memchr(begin, '\n', size_-pos_));
+		if (lineEnd == nullptr)
+			lineEnd = data_ + size_;
+		pos_ = lineEnd - data_ + 1;
+		++lineNumber_;
+		if ((lineEnd != begin) && (*(lineEnd-1) == '\r'))
+			--lineEnd;
+		if ((lineEnd == begin) || (*begin == '#'))
+		{
+			if ((lineEnd-begin >= 7) && (memcmp(begin, "##FASTA", 7) == 0))
+				pos_ = size_;
+			continue;
+		}
+		if (!record.parse(boost::string_ref(begin, lineEnd-begin)))
+			throw FormatException("Error: Line " + std::to_string(lineNumber_) + " of " + (name_.empty() ? std::string("the gff data") : "file " + name_) + " is not a valid feature.");
+		return true;
+	}
+	return false;
+}
+
+} /* namespace BioSeqDataLib */
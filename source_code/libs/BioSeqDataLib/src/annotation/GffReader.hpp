@@ -0,0 +1,289 @@
+/*
+ * GffReader.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file GffReader.hpp
+ * \brief File containing the GffRecord and GffReader classes to stream through GFF3 files.
+ */
+#ifndef GFFREADER_HPP_
+#define GFFREADER_HPP_
+
+// C++ header
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// boost header
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/utility/string_ref.hpp>
+
+// BioSeqDataLib header
+#include "Feature.hpp"
+#include "../utility/Exceptions.hpp"
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \brief A single line of a GFF3 file which refers to the text of the line.
+ *
+ * The columns are split and the positions, score, strand and phase are converted when the line is parsed, the
+ * attributes are only searched when they are requested. Positions are 0-based and inclusive, like in Feature. The
+ * record stays valid as long as the text it was parsed from.
+ */
+class GffRecord
+{
+private:
+	boost::string_ref line_;
+	boost::string_ref seqId_;
+	boost::string_ref source_;
+	boost::string_ref type_;
+	boost::string_ref attributes_;
+	size_t start_;
+	size_t end_;
+	double score_;
+	char strand_;
+	short phase_;
+
+public:
+	GffRecord() : start_(0), end_(0), score_(0), strand_('.'), phase_(-1)
+	{}
+
+	/**
+	 * \brief Parses a line.
+	 * @param line The line without the line break.
+	 * @return False if the line is not a valid feature line.
+	 */
+	bool
+	parse(boost::string_ref line);
+
+	boost::string_ref
+	line() const
+	{
+		return line_;
+	}
+
+	boost::string_ref
+	seqId() const
+	{
+		return seqId_;
+	}
+
+	boost::string_ref
+	source() const
+	{
+		return source_;
+	}
+
+	boost::string_ref
+	type() const
+	{
+		return type_;
+	}
+
+	size_t
+	start() const
+	{
+		return start_;
+	}
+
+	size_t
+	end() const
+	{
+		return end_;
+	}
+
+	/**
+	 * \brief Returns the score, std::numeric_limits<double>::max() if no score is given.
+	 */
+	double
+	score() const
+	{
+		return score_;
+	}
+
+	char
+	strand() const
+	{
+		return strand_;
+	}
+
+	/**
+	 * \brief Returns the phase, -1 if no phase is given.
+	 */
+	short
+	phase() const
+	{
+		return phase_;
+	}
+
+	/**
+	 * \brief Returns the unparsed attribute column.
+	 */
+	boost::string_ref
+	attributes() const
+	{
+		return attributes_;
+	}
+
+	/**
+	 * \brief Searches an attribute.
+	 * @param key The name of the attribute.
+	 * @param[out] value The value of the attribute.
+	 * @return True if the attribute exists.
+	 */
+	bool
+	findAttribute(boost::string_ref key, boost::string_ref &value) const;
+
+	/**
+	 * \brief Returns the value of an attribute.
+	 * @param key The name of the attribute.
+	 * @throw std::out_of_range if the attribute does not exist.
+	 */
+	boost::string_ref
+	attribute(boost::string_ref key) const;
+
+	bool
+	hasAttribute(boost::string_ref key) const
+	{
+		boost::string_ref value;
+		return findAttribute(key, value);
+	}
+
+	/**
+	 * \brief Returns the values of the Parent attribute.
+	 */
+	std::vector<boost::string_ref>
+	parents() const;
+
+	/**
+	 * \brief Converts the record into a Feature with all attributes parsed.
+	 */
+	Feature
+	feature() const
+	{
+		return Feature(line_.to_string());
+	}
+};
+
+
+/**
+ * \brief Reads a GFF3 file line by line without storing it.
+ *
+ * Uncompressed files are memory mapped, gz and bz2 compressed files are decompressed into memory first. Comments,
+ * directives and empty lines are skipped and reading stops at the ##FASTA directive.
+ * \code
+ * GffReader reader("genes.gff");
+ * GffRecord record;
+ * while (reader.next(record))
+ *     if (record.type() == "mRNA")
+ *         std::cout << record.attribute("ID") << "\n";
+ * \endcode
+ */
+class GffReader
+{
+private:
+	std::string name_;
+	boost::iostreams::mapped_file_source file_;
+	std::string buffer_;
+	const char *data_;
+	size_t size_;
+	size_t pos_;
+	size_t lineNumber_;
+
+	void
+	start_();
+
+public:
+	GffReader() : name_(), file_(), buffer_(), data_(nullptr), size_(0), pos_(0), lineNumber_(0)
+	{}
+
+	/**
+	 * \brief Constructor opening a file.
+	 * @param gffFile The GFF3 file.
+	 */
+	explicit GffReader(const std::string &gffFile) : GffReader()
+	{
+		open(gffFile);
+	}
+
+	GffReader(const GffReader &) = delete;
+	GffReader &operator=(const GffReader &) = delete;
+
+	/**
+	 * \brief Opens a file.
+	 * @param gffFile The GFF3 file, it may be compressed (gz, bz2).
+	 * @throw std::runtime_error if the file cannot be opened.
+	 * @throw FormatException if the file does not start with the gff version 3 header.
+	 */
+	void
+	open(const std::string &gffFile);
+
+	/**
+	 * \brief Reads GFF3 data from memory, the data is not copied.
+	 * @param data The data.
+	 * @param size The size of the data.
+	 * @throw FormatException if the data does not start with the gff version 3 header.
+	 */
+	void
+	open(const char *data, size_t size);
+
+	/**
+	 * \brief Closes the file.
+	 */
+	void
+	close();
+
+	/**
+	 * \brief Reads the next feature.
+	 * @param[out] record The feature, it refers to memory owned by the reader.
+	 * @return False if the end of the features has been reached.
+	 * @throw FormatException if the line has not the nine columns of a feature.
+	 */
+	bool
+	next(GffRecord &record);
+
+	/**
+	 * \brief Returns the number of the line read last (1-based).
+	 */
+	size_t
+	lineNumber() const
+	{
+		return lineNumber_;
+	}
+
+	/**
+	 * \brief Returns the start of the data.
+	 */
+	const char *
+	data() const
+	{
+		return data_;
+	}
+
+	size_t
+	size() const
+	{
+		return size_;
+	}
+};
+
+} /* namespace BioSeqDataLib */
+
+#endif /* GFFREADER_HPP_ */
@@ -0,0 +1,473 @@
+/*
+ * InternedOrthologySet.cpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "InternedOrthologySet.hpp"
+
+// C++ header
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+
+// boost header
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace BioSeqDataLib
+{
+
+namespace
+{
+
+uint64_t
+mix(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+// FNV-1a
+uint64_t
+stringHash(const char *str, size_t length)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i=0; i<length; ++i)
+	{
+		hash ^= static_cast<unsigned char>(str[i]);
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+// the hash of a sequence depends on its species, the same name can be used in different species
+uint64_t
+sequenceHash(uint64_t nameHash, uint32_t species)
+{
+	return mix(nameHash + (static_cast<uint64_t>(species)+1) * 0x9e3779b97f4a7c15ULL);
+}
+
+struct ChunkLine
+{
+	const char *group;
+	uint32_t groupLength;
+	uint32_t nEntries;
+	uint64_t groupHash;
+};
+
+struct ChunkEntry
+{
+	const char *name;
+	uint32_t length;
+	uint32_t species;
+	uint64_t hash;
+};
+
+// the result of parsing a part of the file, species are numbered in the order of the chunk
+struct Chunk
+{
+	std::vector<std::string> species;
+	std::unordered_map<std::string, uint32_t> speciesIds;
+	std::vector<ChunkLine> lines;
+	std::vector<ChunkEntry> entries;
+};
+
+const char *
+lineEnd(const char *pos, const char *end)
+{
+	const char *next = static_cast<const char *>(memchr(pos, '\n', end-pos));
+	return (next == nullptr) ? end : next;
+}
+
+// calls f(tokenBegin, tokenEnd) for all non-empty tokens of [begin, end) separated by delimiter
+template<typename TokenFunction>
+void
+forEachToken(const char *begin, const char *end, char delimiter, TokenFunction f)
+{
+	while (begin < end)
+	{
+		const char *tokenEnd = static_cast<const char *>(memchr(begin, delimiter, end-begin));
+		if (tokenEnd == nullptr)
+			tokenEnd = end;
+		if (tokenEnd != begin)
+			f(begin, tokenEnd);
+		begin = tokenEnd+1;
+	}
+}
+
+void
+addEntry(Chunk &chunk, uint32_t species, const char *begin, const char *end)
+{
+	chunk.entries.push_back(ChunkEntry{begin, static_cast<uint32_t>(end-begin), species, stringHash(begin, end-begin)});
+	++chunk.lines.back().nEntries;
+}
+
+// line: group: species|name species|name ...
+void
+parseOrthoMCL(const char *begin, const char *end, Chunk &chunk)
+{
+	while (begin < end)
+	{
+		const char *next = lineEnd(begin, end);
+		const char *stop = ((next != begin) && (*(next-1) == '\r')) ? next-1 : next;
+		bool first = true;
+		forEachToken(begin, stop, ' ', [&](const char *tokenBegin, const char *tokenEnd)
+		{
+			if (first)
+			{
+				// the group name is followed by a colon
+				uint32_t length = static_cast<uint32_t>(tokenEnd-tokenBegin-1);
+				chunk.lines.push_back(ChunkLine{tokenBegin, length, 0, stringHash(tokenBegin, length)});
+				first = false;
+				return;
+			}
+			const char *bar = static_cast<const char *>(memchr(tokenBegin, '|', tokenEnd-tokenBegin));
+			const char *speciesEnd = (bar == nullptr) ? tokenEnd : bar;
+			const char *nameBegin = (bar == nullptr) ? tokenBegin : bar+1;
+			std::string species(tokenBegin, speciesEnd);
+			auto it = chunk.speciesIds.find(species);
+			if (it == chunk.speciesIds.end())
+			{
+				it = chunk.speciesIds.emplace(species, static_cast<uint32_t>(chunk.species.size())).first;
+				chunk.species.push_back(species);
+			}
+			addEntry(chunk, it->second, nameBegin, tokenEnd);
+		});
+		begin = next+1;
+	}
+}
+
+// line: nSpecies nGenes connectivity names of species 1 ... names of species n, names are separated by ',' and a
+// species without sequences is marked by '*'
+void
+parseProteinortho(const char *begin, const char *end, size_t nSpecies, Chunk &chunk)
+{
+	while (begin < end)
+	{
+		const char *next = lineEnd(begin, end);
+		const char *stop = ((next != begin) && (*(next-1) == '\r')) ? next-1 : next;
+		chunk.lines.push_back(ChunkLine{nullptr, 0, 0, 0});
+		size_t column = 0;
+		forEachToken(begin, stop, '\t', [&](const char *tokenBegin, const char *tokenEnd)
+		{
+			if ((column >= 3) && (column-3 < nSpecies) && !((tokenEnd-tokenBegin == 1) && (*tokenBegin == '*')))
+			{
+				uint32_t species = static_cast<uint32_t>(column-3);
+				forEachToken(tokenBegin, tokenEnd, ',', [&](const char *nameBegin, const char *nameEnd)
+				{
+					addEntry(chunk, species, nameBegin, nameEnd);
+				});
+			}
+			++column;
+		});
+		begin = next+1;
+	}
+}
+
+// inserts the index of an element with the given hash into a table, growing it if necessary
+template<typename EqualFunction>
+uint32_t
+intern(std::vector<uint32_t> &table, std::vector<uint64_t> &hashes, uint64_t hash, EqualFunction equal)
+{
+	if (2*(hashes.size()+1) > table.size())
+	{
+		size_t tableSize = (table.empty()) ? 64 : 2*table.size();
+		table.assign(tableSize, InternedOrthologySet::npos);
+		for (uint32_t i=0; i<hashes.size(); ++i)
+		{
+			size_t slot = hashes[i] & (tableSize-1);
+			while (table[slot] != InternedOrthologySet::npos)
+				slot = (slot+1) & (tableSize-1);
+			table[slot] = i;
+		}
+	}
+	size_t mask = table.size()-1;
+	size_t slot = hash & mask;
+	while (table[slot] != InternedOrthologySet::npos)
+	{
+		if ((hashes[table[slot]] == hash) && equal(table[slot]))
+			return table[slot];
+		slot = (slot+1) & mask;
+	}
+	table[slot] = static_cast<uint32_t>(hashes.size());
+	hashes.push_back(hash);
+	return InternedOrthologySet::npos;
+}
+
+template<typename EqualFunction>
+uint32_t
+lookup(const std::vector<uint32_t> &table, const std::vector<uint64_t> &hashes, uint64_t hash, EqualFunction equal)
+{
+	if (table.empty())
+		return InternedOrthologySet::npos;
+	size_t mask = table.size()-1;
+	size_t slot = hash & mask;
+	while (table[slot] != InternedOrthologySet::npos)
+	{
+		if ((hashes[table[slot]] == hash) && equal(table[slot]))
+			return table[slot];
+		slot = (slot+1) & mask;
+	}
+	return InternedOrthologySet::npos;
+}
+
+}
+
+
+const uint32_t InternedOrthologySet::npos;
+
+InternedOrthologySet::InternedOrthologySet(unsigned int nThreads) : nThreads_((nThreads == 0) ? 1 : nThreads)
+{
+	clear_();
+}
+
+void
+InternedOrthologySet::clear_()
+{
+	species_.clear();
+	speciesIds_.clear();
+	seqNames_.clear();
+	seqSpecies_.clear();
+	seqGroup_.clear();
+	seqHashes_.clear();
+	seqTable_.clear();
+	groupNames_.clear();
+	groupHashes_.clear();
+	groupTable_.clear();
+	groupOffsets_.assign(1, 0);
+	members_.clear();
+}
+
+uint32_t
+InternedOrthologySet::internSequence_(uint32_t species, const char *name, size_t length, uint64_t hash)
+{
+	uint64_t seqHash = sequenceHash(hash, species);
+	uint32_t id = intern(seqTable_, seqHashes_, seqHash, [&](uint32_t i) { return (seqSpecies_[i] == species) && (seqNames_[i].compare(0, std::string::npos, name, length) == 0); });
+	if (id != npos)
+		return id;
+	seqNames_.emplace_back(name, length);
+	seqSpecies_.push_back(species);
+	seqGroup_.push_back(npos);
+	return static_cast<uint32_t>(seqNames_.size()-1);
+}
+
+uint32_t
+InternedOrthologySet::internGroup_(const char *name, size_t length, uint64_t hash)
+{
+	uint64_t groupHash = mix(hash);
+	uint32_t id = intern(groupTable_, groupHashes_, groupHash, [&](uint32_t i) { return groupNames_[i].compare(0, std::string::npos, name, length) == 0; });
+	if (id != npos)
+		return id;
+	groupNames_.emplace_back(name, length);
+	return static_cast<uint32_t>(groupNames_.size()-1);
+}
+
+uint32_t
+InternedOrthologySet::findSequence_(uint32_t species, const char *name, size_t length) const
+{
+	return lookup(seqTable_, seqHashes_, sequenceHash(stringHash(name, length), species), [&](uint32_t i) { return (seqSpecies_[i] == species) && (seqNames_[i].compare(0, std::string::npos, name, length) == 0); });
+}
+
+void
+InternedOrthologySet::read(const std::string &orthoFile)
+{
+	boost::filesystem::path path(orthoFile);
+	if ((path.extension() == ".gz") || (path.extension() == ".bz2"))
+	{
+		AP::Input orthoS(path);
+		std::ostringstream content;
+		content << orthoS.get().rdbuf();
+		orthoS.close();
+		std::string data = content.str();
+		read_(data.data(), data.size());
+		return;
+	}
+	boost::iostreams::mapped_file_source file;
+	try
+	{
+		if (boost::filesystem::file_size(path) != 0)
+			file.open(orthoFile);
+	}
+	catch (std::exception &e)
+	{
+		throw std::runtime_error("Error: A problem occurred opening '" + orthoFile + "'.");
+	}
+	read_(file.data(), file.size());
+}
+
+void
+InternedOrthologySet::read_(const char *data, size_t size)
+{
+	clear_();
+	if (size == 0)
+		return;
+	const char *end = data + size;
+	const char *begin = data;
+	bool proteinortho = (data[0] == '#');
+	std::vector<uint32_t> headerSpecies;
+	if (proteinortho)
+	{
+		const char *headerEnd = lineEnd(begin, end);
+		const char *stop = ((headerEnd != begin) && (*(headerEnd-1) == '\r')) ? headerEnd-1 : headerEnd;
+		size_t column = 0;
+		forEachToken(begin, stop, '\t', [&](const char *tokenBegin, const char *tokenEnd)
+		{
+			if (column++ < 3)
+				return;
+			std::string name(tokenBegin, tokenEnd);
+			auto it = speciesIds_.emplace(name, static_cast<uint32_t>(species_.size())).first;
+			if (it->second == species_.size())
+				species_.push_back(name);
+			headerSpecies.push_back(it->second);
+		});
+		begin = (headerEnd == end) ? end : headerEnd+1;
+	}
+
+	// chunks of complete lines, at least 64 kB
+	size_t nChunks = std::min<size_t>(nThreads_ * 16, (end-begin) / (1 << 16) + 1);
+	std::vector<const char *> starts(1, begin);
+	for (size_t i=1; i<nChunks; ++i)
+	{
+		const char *pos = begin + (end-begin) * i / nChunks;
+		if (pos < starts.back())
+			continue;
+		pos = lineEnd(pos, end);
+		if (pos != end)
+			starts.push_back(pos+1);
+	}
+	starts.push_back(end);
+	nChunks = starts.size()-1;
+
+	std::vector<Chunk> chunks(nChunks);
+	std::exception_ptr error;
+	#pragma omp parallel for schedule(dynamic) num_threads(nThreads_)
+	for (size_t i=0; i<nChunks; ++i)
+	{
+		try
+		{
+			if (proteinortho)
+				parseProteinortho(starts[i], starts[i+1], headerSpecies.size(), chunks[i]);
+			else
+				parseOrthoMCL(starts[i], starts[i+1], chunks[i]);
+		}
+		catch (...)
+		{
+			#pragma omp critical(InternedOrthologySet_error)
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+
+	// the insertion is sequential to number everything in the order of the file
+	size_t nEntries = 0;
+	for (const Chunk &chunk : chunks)
+		nEntries += chunk.entries.size();
+	std::vector<uint32_t> entryGroups;
+	std::vector<uint32_t> entrySeqs;
+	entryGroups.reserve(nEntries);
+	entrySeqs.reserve(nEntries);
+	size_t lineN = 0;
+	for (Chunk &chunk : chunks)
+	{
+		std::vector<uint32_t> speciesMap = headerSpecies;
+		if (!proteinortho)
+		{
+			for (const std::string &name : chunk.species)
+			{
+				auto it = speciesIds_.emplace(name, static_cast<uint32_t>(species_.size())).first;
+				if (it->second == species_.size())
+					species_.push_back(name);
+				speciesMap.push_back(it->second);
+			}
+		}
+		size_t entryId = 0;
+		for (const ChunkLine &line : chunk.lines)
+		{
+			++lineN;
+			if (line.nEntries == 0)
+				continue;
+			uint32_t groupId;
+			if (proteinortho)
+			{
+				std::string name = std::to_string(lineN);
+				groupId = internGroup_(name.data(), name.size(), stringHash(name.data(), name.size()));
+			}
+			else
+				groupId = internGroup_(line.group, line.groupLength, line.groupHash);
+			for (size_t i=0; i<line.nEntries; ++i, ++entryId)
+			{
+				const ChunkEntry &entry = chunk.entries[entryId];
+				uint32_t seqId = internSequence_(speciesMap[entry.species], entry.name, entry.length, entry.hash);
+				seqGroup_[seqId] = groupId;
+				entryGroups.push_back(groupId);
+				entrySeqs.push_back(seqId);
+			}
+		}
+		chunk = Chunk();
+	}
+
+	// the members of the groups, a stable counting sort keeps the order of the file
+	groupOffsets_.assign(groupNames_.size()+1, 0);
+	for (uint32_t groupId : entryGroups)
+		++groupOffsets_[groupId+1];
+	for (size_t i=1; i<groupOffsets_.size(); ++i)
+		groupOffsets_[i] += groupOffsets_[i-1];
+	std::vector<uint64_t> pos(groupOffsets_.begin(), groupOffsets_.end()-1);
+	members_.resize(entrySeqs.size());
+	for (size_t i=0; i<entrySeqs.size(); ++i)
+		members_[pos[entryGroups[i]]++] = entrySeqs[i];
+}
+
+uint32_t
+InternedOrthologySet::sequenceId(const std::string &species, const std::string &seqID) const
+{
+	uint32_t speciesId = this->speciesId(species);
+	if (speciesId == npos)
+		return npos;
+	return findSequence_(speciesId, seqID.data(), seqID.size());
+}
+
+uint32_t
+InternedOrthologySet::groupId(const std::string &name) const
+{
+	return lookup(groupTable_, groupHashes_, mix(stringHash(name.data(), name.size())), [&](uint32_t i) { return groupNames_[i] == name; });
+}
+
+uint32_t
+InternedOrthologySet::find(const std::string &species, const std::string &seqID) const
+{
+	uint32_t seqId = sequenceId(species, seqID);
+	return (seqId == npos) ? npos : seqGroup_[seqId];
+}
+
+OrthoGroup
+InternedOrthologySet::orthoGroup(uint32_t groupId) const
+{
+	OrthoGroup group;
+	for (const uint32_t *it=groupBegin(groupId); it!=groupEnd(groupId); ++it)
+		group[species_[seqSpecies_[*it]]].push_back(seqNames_[*it]);
+	return group;
+}
+
+} /* namespace BioSeqDataLib */
@@ -0,0 +1,264 @@
+/*
+ * InternedOrthologySet.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file InternedOrthologySet.hpp
+ * \brief File containing the InternedOrthologySet class.
+ */
+#ifndef INTERNEDORTHOLOGYSET_HPP_
+#define INTERNEDORTHOLOGYSET_HPP_
+
+// C++ header
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// BioSeqDataLib headers
+#include "OrthologySet.hpp"
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \brief Class to store large sets of orthology groups.
+ *
+ * In contrast to OrthologySet, every species, sequence and group is stored only once and referred to by a dense
+ * integer id. The ids are given in the order of the first occurrence in the file. The members of all groups are
+ * stored in one array (compressed sparse row format): the sequence ids of group g are [groupBegin(g), groupEnd(g)) in
+ * the order of the file. The sequences and groups are found by open addressing hash tables. find() looks up the
+ * species id in a hash map and then probes the sequence table with a hash of the sequence name and the species id,
+ * instead of the two nested std::map lookups of OrthologySet.
+ *
+ * Proteinortho and OrthoMCL files are read like in OrthologySet. The lines are split and hashed in parallel, only the
+ * insertion into the tables is done sequentially, so that the ids do not depend on the number of threads.
+ */
+class InternedOrthologySet
+{
+public:
+	/**
+	 * \brief The value returned for species, sequences and groups that do not exist.
+	 */
+	static const uint32_t npos = 0xFFFFFFFF;
+
+private:
+	unsigned int nThreads_;
+
+	std::vector<std::string> species_;
+	std::unordered_map<std::string, uint32_t> speciesIds_;
+
+	std::vector<std::string> seqNames_;
+	std::vector<uint32_t> seqSpecies_;
+	std::vector<uint32_t> seqGroup_;
+	std::vector<uint64_t> seqHashes_;
+	std::vector<uint32_t> seqTable_;
+
+	std::vector<std::string> groupNames_;
+	std::vector<uint64_t> groupHashes_;
+	std::vector<uint32_t> groupTable_;
+	// the members of group g are members_[groupOffsets_[g]] ... members_[groupOffsets_[g+1]-1]
+	std::vector<uint64_t> groupOffsets_;
+	std::vector<uint32_t> members_;
+
+	void
+	clear_();
+
+	void
+	read_(const char *data, size_t size);
+
+	uint32_t
+	internSequence_(uint32_t species, const char *name, size_t length, uint64_t hash);
+
+	uint32_t
+	internGroup_(const char *name, size_t length, uint64_t hash);
+
+	uint32_t
+	findSequence_(uint32_t species, const char *name, size_t length) const;
+
+public:
+	/**
+	 * \brief Constructor
+	 * @param nThreads The number of threads used to read a file.
+	 */
+	explicit InternedOrthologySet(unsigned int nThreads = 1);
+
+	/**
+	 * \brief Reads an orthology file in Proteinortho or OrthoMCL format, previous content is removed.
+	 * @param orthoFile The file containing the orthology data, it may be compressed (gz, bz2).
+	 * @throw std::runtime_error if the file cannot be opened.
+	 */
+	void
+	read(const std::string &orthoFile);
+
+	/**
+	 * \brief Reads orthology data in Proteinortho or OrthoMCL format from memory, previous content is removed.
+	 * @param data The data.
+	 * @param size The size of the data.
+	 */
+	void
+	read(const char *data, size_t size)
+	{
+		read_(data, size);
+	}
+
+	/**
+	 * \brief Sets the number of threads.
+	 */
+	void
+	threads(unsigned int nThreads)
+	{
+		nThreads_ = (nThreads == 0) ? 1 : nThreads;
+	}
+
+	size_t
+	nSpecies() const
+	{
+		return species_.size();
+	}
+
+	const std::string &
+	species(uint32_t speciesId) const
+	{
+		return species_[speciesId];
+	}
+
+	/**
+	 * \brief Returns the id of a species or npos.
+	 * @param name The species name.
+	 */
+	uint32_t
+	speciesId(const std::string &name) const
+	{
+		auto it = speciesIds_.find(name);
+		return (it == speciesIds_.end()) ? npos : it->second;
+	}
+
+	/**
+	 * \brief Returns the names of all species, like OrthologySet::speciesSet().
+	 */
+	std::set<std::string>
+	speciesSet() const
+	{
+		return std::set<std::string>(species_.begin(), species_.end());
+	}
+
+	size_t
+	nSequences() const
+	{
+		return seqNames_.size();
+	}
+
+	const std::string &
+	sequenceName(uint32_t seqId) const
+	{
+		return seqNames_[seqId];
+	}
+
+	uint32_t
+	sequenceSpecies(uint32_t seqId) const
+	{
+		return seqSpecies_[seqId];
+	}
+
+	/**
+	 * \brief Returns the id of a sequence or npos.
+	 * @param species The species name.
+	 * @param seqID The sequence name.
+	 */
+	uint32_t
+	sequenceId(const std::string &species, const std::string &seqID) const;
+
+	size_t
+	nGroups() const
+	{
+		return groupNames_.size();
+	}
+
+	const std::string &
+	groupName(uint32_t groupId) const
+	{
+		return groupNames_[groupId];
+	}
+
+	/**
+	 * \brief Returns the id of a group or npos.
+	 * @param name The group name.
+	 */
+	uint32_t
+	groupId(const std::string &name) const;
+
+	/**
+	 * \brief Returns the number of sequences in a group.
+	 */
+	size_t
+	groupSize(uint32_t groupId) const
+	{
+		return groupOffsets_[groupId+1] - groupOffsets_[groupId];
+	}
+
+	/**
+	 * \brief Returns a pointer to the first sequence id of a group.
+	 */
+	const uint32_t *
+	groupBegin(uint32_t groupId) const
+	{
+		return members_.data() + groupOffsets_[groupId];
+	}
+
+	/**
+	 * \brief Returns a pointer behind the last sequence id of a group.
+	 */
+	const uint32_t *
+	groupEnd(uint32_t groupId) const
+	{
+		return members_.data() + groupOffsets_[groupId+1];
+	}
+
+	/**
+	 * \brief Returns the group of a sequence.
+	 * \details A sequence listed in several groups belongs to the last one, like in OrthologySet.
+	 * @param seqId The sequence id.
+	 */
+	uint32_t
+	group(uint32_t seqId) const
+	{
+		return seqGroup_[seqId];
+	}
+
+	/**
+	 * \brief Returns the group of a sequence or npos if the sequence is not part of the set.
+	 * \details Needs a lookup of the species and a probe sequence in the sequence table.
+	 * @param species The species name.
+	 * @param seqID The sequence name.
+	 */
+	uint32_t
+	find(const std::string &species, const std::string &seqID) const;
+
+	/**
+	 * \brief Converts a group into the representation used by OrthologySet.
+	 * @param groupId The group id.
+	 */
+	OrthoGroup
+	orthoGroup(uint32_t groupId) const;
+};
+
+} /* namespace BioSeqDataLib */
+
+#endif /* INTERNEDORTHOLOGYSET_HPP_ */
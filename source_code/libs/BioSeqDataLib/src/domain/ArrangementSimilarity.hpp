@@ -0,0 +1,417 @@
+/*
+ * ArrangementSimilarity.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file ArrangementSimilarity.hpp
+ * \brief Header containing the ArrangementSimilarity class to compare many domain arrangements.
+ */
+#ifndef ARRANGEMENTSIMILARITY_HPP_
+#define ARRANGEMENTSIMILARITY_HPP_
+
+// C++ header
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// BioSeqDataLib header
+#include "DomainArrangement.hpp"
+#include "DomainArrangementSet.hpp"
+#include "../utility/DSM.hpp"
+
+namespace BioSeqDataLib
+{
+
+/** \addtogroup DomainGroup
+ *  @{
+ */
+
+/**
+ * \brief An arrangement found by a similarity search of ArrangementSimilarity.
+ */
+struct ArrangementHit
+{
+	size_t index;     //!< The index of the arrangement.
+	float similarity; //!< The cos similarity to the query.
+};
+
+/**
+ * \brief A pair of similar arrangements found by ArrangementSimilarity::allPairs.
+ */
+struct ArrangementPair
+{
+	size_t first;     //!< The index of the first arrangement.
+	size_t second;    //!< The index of the second arrangement (first < second).
+	float similarity; //!< The cos similarity of the two arrangements.
+};
+
+
+/**
+ * \brief Computes the cos similarity (see cos()) between many domain arrangements.
+ *
+ * Every arrangement is stored once as sparse vector: the dense DSM ids of its domains and, for every domain u with a
+ * positive similarity to one of them, the weight max(DSM(d,u)) over the domains d of the arrangement. The cos score
+ * of two arrangements only uses the weights of the domains occurring in one of them, exactly as cos() does, and is
+ * computed by merging the sorted vectors.
+ *
+ * The similarity searches only compare arrangements sharing at least one domain with a positive weight, found with
+ * inverted indices. All other pairs have a score of 0 and are not reported. The queries are processed in blocks
+ * distributed over the threads.
+ */
+class ArrangementSimilarity
+{
+private:
+	DSM dsm_;
+
+	// the positive similarities of every domain (both halves of the DSM), CSR format
+	std::vector<size_t> neighbourStart_;
+	std::vector<int> neighbourIDs_;
+	std::vector<float> neighbourValues_;
+
+	// the arrangements: the sorted ids of the domains and the sparse weight vectors, CSR format
+	std::vector<size_t> domStart_;
+	std::vector<int> domIDs_;
+	std::vector<size_t> vecStart_;
+	std::vector<int> vecIDs_;
+	std::vector<float> vecWeights_;
+
+	// inverted indices: the arrangements containing a domain, the arrangements with a positive weight of a domain
+	std::vector<size_t> domIndexStart_;
+	std::vector<size_t> domIndex_;
+	std::vector<size_t> vecIndexStart_;
+	std::vector<size_t> vecIndex_;
+	size_t indexedSize_;
+
+	static void
+	invert_(const std::vector<size_t> &start, const std::vector<int> &ids, int nDomains, std::vector<size_t> &indexStart, std::vector<size_t> &index)
+	{
+		indexStart.assign(nDomains+1, 0);
+		for (int id : ids)
+			++indexStart[id+1];
+		for (int i=0; i<nDomains; ++i)
+			indexStart[i+1] += indexStart[i];
+		index.resize(ids.size());
+		std::vector<size_t> pos(indexStart.begin(), indexStart.end()-1);
+		for (size_t a=0; a+1<start.size(); ++a)
+		{
+			for (size_t k=start[a]; k<start[a+1]; ++k)
+				index[pos[ids[k]]++] = a;
+		}
+	}
+
+	void
+	buildIndex_()
+	{
+		if (indexedSize_ == size())
+			return;
+		invert_(domStart_, domIDs_, dsm_.nDomains(), domIndexStart_, domIndex_);
+		invert_(vecStart_, vecIDs_, dsm_.nDomains(), vecIndexStart_, vecIndex_);
+		indexedSize_ = size();
+	}
+
+	// collects the arrangements that can have a positive similarity to arrangement a, seen is a per thread marker
+	void
+	candidates_(size_t a, std::vector<size_t> &seen, std::vector<size_t> &candidates) const
+	{
+		candidates.clear();
+		seen[a] = a;
+		for (size_t k=domStart_[a]; k<domStart_[a+1]; ++k)
+		{
+			int id = domIDs_[k];
+			for (size_t l=vecIndexStart_[id]; l<vecIndexStart_[id+1]; ++l)
+			{
+				size_t b = vecIndex_[l];
+				if (seen[b] != a)
+				{
+					seen[b] = a;
+					candidates.push_back(b);
+				}
+			}
+		}
+		for (size_t k=vecStart_[a]; k<vecStart_[a+1]; ++k)
+		{
+			int id = vecIDs_[k];
+			for (size_t l=domIndexStart_[id]; l<domIndexStart_[id+1]; ++l)
+			{
+				size_t b = domIndex_[l];
+				if (seen[b] != a)
+				{
+					seen[b] = a;
+					candidates.push_back(b);
+				}
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+	}
+
+	static bool
+	better_(const ArrangementHit &h1, const ArrangementHit &h2)
+	{
+		return (h1.similarity > h2.similarity) || ((h1.similarity == h2.similarity) && (h1.index < h2.index));
+	}
+
+public:
+	/**
+	 * \brief Constructor.
+	 * @param dsm The domain similarity matrix. Negative values (see DSM::useNegative) are treated as 0, like in cos().
+	 */
+	explicit ArrangementSimilarity(const DSM &dsm) : dsm_(dsm), domStart_(1, 0), vecStart_(1, 0), indexedSize_(0)
+	{
+		int nDomains = dsm_.nDomains();
+		neighbourStart_.assign(nDomains+1, 0);
+		dsm_.forEachValue([&](int id1, int id2, short value)
+		{
+			if (value > 0)
+			{
+				++neighbourStart_[id1+1];
+				if (id1 != id2)
+					++neighbourStart_[id2+1];
+			}
+		});
+		for (int i=0; i<nDomains; ++i)
+			neighbourStart_[i+1] += neighbourStart_[i];
+		neighbourIDs_.resize(neighbourStart_.back());
+		neighbourValues_.resize(neighbourStart_.back());
+		std::vector<size_t> pos(neighbourStart_.begin(), neighbourStart_.end()-1);
+		dsm_.forEachValue([&](int id1, int id2, short value)
+		{
+			if (value > 0)
+			{
+				neighbourIDs_[pos[id1]] = id2;
+				neighbourValues_[pos[id1]++] = value;
+				if (id1 != id2)
+				{
+					neighbourIDs_[pos[id2]] = id1;
+					neighbourValues_[pos[id2]++] = value;
+				}
+			}
+		});
+	}
+
+	/**
+	 * \brief Adds an arrangement.
+	 * @param da The domain arrangement.
+	 * @return The index of the arrangement.
+	 * @throw std::out_of_range if a domain is not contained in the DSM.
+	 */
+	template<typename DomainType>
+	size_t
+	add(const DomainArrangement<DomainType> &da)
+	{
+		std::vector<int> ids;
+		ids.reserve(da.size());
+		for (const DomainType &domain : da)
+			ids.push_back(dsm_.id(domain.accession()));
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		std::vector<std::pair<int, float> > weights;
+		for (int id : ids)
+		{
+			for (size_t k=neighbourStart_[id]; k<neighbourStart_[id+1]; ++k)
+				weights.push_back(std::make_pair(neighbourIDs_[k], neighbourValues_[k]));
+		}
+		std::sort(weights.begin(), weights.end());
+		for (size_t k=0; k<weights.size(); ++k)
+		{
+			// the largest weight of a domain is the last one
+			if ((k+1 == weights.size()) || (weights[k+1].first != weights[k].first))
+			{
+				vecIDs_.push_back(weights[k].first);
+				vecWeights_.push_back(weights[k].second);
+			}
+		}
+		vecStart_.push_back(vecIDs_.size());
+		domIDs_.insert(domIDs_.end(), ids.begin(), ids.end());
+		domStart_.push_back(domIDs_.size());
+		return size()-1;
+	}
+
+	/**
+	 * \brief Adds all arrangements of a set in the order of the set (sorted by sequence name).
+	 * @param daSet The set of domain arrangements.
+	 */
+	template<typename DomainType>
+	void
+	add(const DomainArrangementSet<DomainType> &daSet)
+	{
+		for (const auto &elem : daSet)
+			add(elem.second);
+	}
+
+	/**
+	 * \brief Returns the number of arrangements.
+	 */
+	size_t
+	size() const
+	{
+		return domStart_.size()-1;
+	}
+
+	/**
+	 * \brief Returns the cos similarity of two arrangements, the same value as cos() (up to rounding).
+	 * @param a The index of the first arrangement.
+	 * @param b The index of the second arrangement.
+	 * @return The similarity.
+	 */
+	float
+	similarity(size_t a, size_t b) const
+	{
+		size_t da = domStart_[a], daEnd = domStart_[a+1];
+		size_t db = domStart_[b], dbEnd = domStart_[b+1];
+		size_t va = vecStart_[a], vaEnd = vecStart_[a+1];
+		size_t vb = vecStart_[b], vbEnd = vecStart_[b+1];
+		float score = 0;
+		float nVec1 = 0;
+		float nVec2 = 0;
+		// iterate over the union of the domains of both arrangements
+		while ((da < daEnd) || (db < dbEnd))
+		{
+			int id;
+			if ((db == dbEnd) || ((da < daEnd) && (domIDs_[da] < domIDs_[db])))
+				id = domIDs_[da++];
+			else
+			{
+				id = domIDs_[db++];
+				if ((da < daEnd) && (domIDs_[da] == id))
+					++da;
+			}
+			while ((va < vaEnd) && (vecIDs_[va] < id))
+				++va;
+			while ((vb < vbEnd) && (vecIDs_[vb] < id))
+				++vb;
+			float w1 = ((va < vaEnd) && (vecIDs_[va] == id)) ? vecWeights_[va] : 0;
+			float w2 = ((vb < vbEnd) && (vecIDs_[vb] == id)) ? vecWeights_[vb] : 0;
+			score += w1 * w2;
+			nVec1 += w1 * w1;
+			nVec2 += w2 * w2;
+		}
+		return score/(std::sqrt(nVec1) * std::sqrt(nVec2));
+	}
+
+	/**
+	 * \brief Finds the most similar arrangements of every arrangement.
+	 * @param k The maximal number of hits per arrangement.
+	 * @param[out] hits The hits of arrangement i in hits[i], sorted by decreasing similarity (ties by index). Only
+	 * arrangements with a positive similarity are reported, the arrangement itself is excluded.
+	 * @param nThreads The number of threads.
+	 * @param blockSize The number of queries processed together by a thread.
+	 */
+	void
+	topK(size_t k, std::vector<std::vector<ArrangementHit> > &hits, unsigned int nThreads = 1, size_t blockSize = 256)
+	{
+		buildIndex_();
+		size_t n = size();
+		hits.resize(n);
+		if (blockSize == 0)
+			blockSize = 1;
+		if (nThreads == 0)
+			nThreads = 1;
+		size_t nBlocks = (n + blockSize - 1)/blockSize;
+		#pragma omp parallel num_threads(nThreads)
+		{
+			std::vector<size_t> seen(n, std::numeric_limits<size_t>::max());
+			std::vector<size_t> candidates;
+			#pragma omp for schedule(dynamic, 1)
+			for (size_t block = 0; block < nBlocks; ++block)
+			{
+				size_t end = std::min(n, (block+1)*blockSize);
+				for (size_t a = block*blockSize; a < end; ++a)
+				{
+					std::vector<ArrangementHit> &result = hits[a];
+					result.clear();
+					candidates_(a, seen, candidates);
+					for (size_t b : candidates)
+					{
+						ArrangementHit hit = {b, similarity(a, b)};
+						if (!(hit.similarity > 0))
+							continue;
+						// result is a heap with the worst hit on top
+						if (result.size() < k)
+						{
+							result.push_back(hit);
+							std::push_heap(result.begin(), result.end(), better_);
+						}
+						else if ((k != 0) && better_(hit, result.front()))
+						{
+							std::pop_heap(result.begin(), result.end(), better_);
+							result.back() = hit;
+							std::push_heap(result.begin(), result.end(), better_);
+						}
+					}
+					std::sort_heap(result.begin(), result.end(), better_);
+				}
+			}
+		}
+	}
+
+	/**
+	 * \brief Finds all pairs of similar arrangements.
+	 * @param minSimilarity The minimal similarity of a reported pair, only pairs with a positive similarity are reported.
+	 * @param[out] pairs The pairs, sorted by the first and the second index.
+	 * @param nThreads The number of threads.
+	 * @param blockSize The number of queries processed together by a thread.
+	 */
+	void
+	allPairs(float minSimilarity, std::vector<ArrangementPair> &pairs, unsigned int nThreads = 1, size_t blockSize = 256)
+	{
+		buildIndex_();
+		size_t n = size();
+		if (blockSize == 0)
+			blockSize = 1;
+		if (nThreads == 0)
+			nThreads = 1;
+		size_t nBlocks = (n + blockSize - 1)/blockSize;
+		std::vector<std::vector<ArrangementPair> > blockPairs(nBlocks);
+		#pragma omp parallel num_threads(nThreads)
+		{
+			std::vector<size_t> seen(n, std::numeric_limits<size_t>::max());
+			std::vector<size_t> candidates;
+			#pragma omp for schedule(dynamic, 1)
+			for (size_t block = 0; block < nBlocks; ++block)
+			{
+				size_t end = std::min(n, (block+1)*blockSize);
+				for (size_t a = block*blockSize; a < end; ++a)
+				{
+					candidates_(a, seen, candidates);
+					for (auto it = std::upper_bound(candidates.begin(), candidates.end(), a); it != candidates.end(); ++it)
+					{
+						float sim = similarity(a, *it);
+						if ((sim > 0) && (sim >= minSimilarity))
+							blockPairs[block].push_back(ArrangementPair{a, *it, sim});
+					}
+				}
+			}
+		}
+		pairs.clear();
+		for (const auto &block : blockPairs)
+			pairs.insert(pairs.end(), block.begin(), block.end());
+	}
+};
+
+/** @} */ // Domain module
+
+} /* namespace BioSeqDataLib */
+
+#endif /* ARRANGEMENTSIMILARITY_HPP_ */
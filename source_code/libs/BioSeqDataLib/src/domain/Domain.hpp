@@ -139,7 +139,7 @@ public:
 	 * \brief Returns the accession number
 	 * \return The accession number
 	 */
-	std::string
+	const std::string &
 	accession() const
 	{
 		return accession_;
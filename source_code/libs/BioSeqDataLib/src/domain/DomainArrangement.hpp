@@ -31,8 +31,10 @@
 
 // C++ header
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 #include <iostream>
@@ -440,6 +442,66 @@ public:
 		}
 	}
 
+	/**
+	 * \brief Returns the accessions of the collapsed arrangement without changing or copying the arrangement.
+	 * \details Consecutive repeats of the same domain are only reported once, i.e. the result is identical to the
+	 * accessions after calling collapse().
+	 * \pre Domains are sorted by starting position
+	 * @param[out] accessions Vector to store the accessions in. It is cleared first, so it can be reused.
+	 */
+	void
+	collapsedAccessions(std::vector<std::string> &accessions) const
+	{
+		accessions.clear();
+		for (size_t i=0, nDomains=domains_.size(); i<nDomains; ++i)
+		{
+			if ((i == 0) || (domains_[i-1].accession() != domains_[i].accession()))
+				accessions.push_back(domains_[i].accession());
+		}
+	}
+
+	/**
+	 * \brief Returns a hash value of the collapsed arrangement without changing or copying the arrangement.
+	 * \details Arrangements with the same collapsedAccessions have the same hash value.
+	 * \pre Domains are sorted by starting position
+	 * @return The hash value.
+	 */
+	size_t
+	collapsedHash() const
+	{
+		std::hash<std::string> strHash;
+		size_t seed = 0;
+		for (size_t i=0, nDomains=domains_.size(); i<nDomains; ++i)
+		{
+			if ((i == 0) || (domains_[i-1].accession() != domains_[i].accession()))
+				seed ^= strHash(domains_[i].accession()) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+		}
+		return seed;
+	}
+
+	/**
+	 * \brief Checks if the collapsed arrangement consists of the given accessions without changing or copying the arrangement.
+	 * \pre Domains are sorted by starting position
+	 * @param accessions The accessions to compare with.
+	 * @return true if collapsedAccessions would return the given accessions else false
+	 */
+	bool
+	collapsedEquals(const std::vector<std::string> &accessions) const
+	{
+		size_t pos = 0;
+		size_t nAccessions = accessions.size();
+		for (size_t i=0, nDomains=domains_.size(); i<nDomains; ++i)
+		{
+			if ((i == 0) || (domains_[i-1].accession() != domains_[i].accession()))
+			{
+				if ((pos == nAccessions) || (domains_[i].accession() != accessions[pos]))
+					return false;
+				++pos;
+			}
+		}
+		return pos == nAccessions;
+	}
+
 	/**
 	 * \brief Reconstructs the original domain arrangement.
 	 * This works only if the collapse function has been called with reversable set to true.
@@ -504,55 +566,100 @@ public:
 		for (auto db: dbImportance)
 			usedDbs.insert(db);
 
+		domains_.erase(std::remove_if(domains_.begin(), domains_.end(), [&usedDbs](const DomainType &dom){ return usedDbs.count(dom.db()) == 0; }), domains_.end());
+
 		size_t nDomains = domains_.size();
-		std::set<size_t> toDelete;
+		if (nDomains < 2)
+			return;
+
+		// The remaining domains are kept in a doubly linked list. Deleted domains are unlinked and only removed from
+		// domains_ once at the end. Each round checks the adjacent pairs given by the right domain of the pair and
+		// deletes all flagged domains at once. Pairs that have been checked without result and whose domains both
+		// survive stay unchanged, so after the first round of a database only the pairs newly formed by deletions
+		// need to be checked.
+		const size_t none = nDomains;
+		std::vector<size_t> prev(nDomains), next(nDomains);
 		for (size_t i=0; i<nDomains; ++i)
 		{
-			if (usedDbs.count(domains_[i].db()) == 0)
-				toDelete.insert(i);
+			prev[i] = (i == 0) ? none : i-1;
+			next[i] = i+1;
 		}
-
-		for (auto it = toDelete.rbegin(); it != toDelete.rend(); ++it)
-			domains_.erase(domains_.begin() + (*it));
-		toDelete.clear();
+		std::vector<char> deleted(nDomains, 0), queued(nDomains, 0);
+		std::vector<size_t> candidates, flagged, newPairs;
 
 		for (DomainDB db : dbImportance)
 		{
+			candidates.clear();
+			for (size_t i=0; i<nDomains; ++i)
+			{
+				if ((!deleted[i]) && (prev[i] != none))
+					candidates.push_back(i);
+			}
 
-			bool changed = true;
-			while (changed)
+			while (!candidates.empty())
 			{
-				nDomains = domains_.size();
-				for (size_t i=1; i<nDomains; ++i)
+				flagged.clear();
+				for (size_t i : candidates)
 				{
-					DomainType &dom1 = domains_[i-1];
-					DomainType &dom2 = domains_[i];
+					const DomainType &dom1 = domains_[prev[i]];
+					const DomainType &dom2 = domains_[i];
 					if (dom1.end() > dom2.start())
 					{
 						float overlap = dom1.end() - dom2.start() + 1;
 						if (((dom1.db() == db) || (dom2.db() == db)) && ((overlap > maxAbsOverlap) || ((overlap/dom1.length()) > maxFracOverlap ) || ((overlap/dom2.length()) > maxFracOverlap ) ))
 						{
+							size_t del;
 							if (dom1.db() == dom2.db())
-							{
-								if (dom1.evalue() < dom2.evalue())
-									toDelete.insert(i);
-								else
-									toDelete.insert(i-1);
-							}
+								del = (dom1.evalue() < dom2.evalue()) ? i : prev[i];
 							else
-								toDelete.insert(dom1.db() == db ? i : i-1);
+								del = (dom1.db() == db) ? i : prev[i];
+							flagged.push_back(del);
 						}
 					}
 				}
-				for (auto it = toDelete.rbegin(); it != toDelete.rend(); ++it)
-					domains_.erase(domains_.begin() + (*it));
-				if (toDelete.empty())
-					changed = false;
-				toDelete.clear();
+
+				newPairs.clear();
+				for (size_t i : flagged)
+				{
+					if (deleted[i])
+						continue;
+					deleted[i] = 1;
+					if (prev[i] != none)
+						next[prev[i]] = next[i];
+					if (next[i] != none)
+					{
+						prev[next[i]] = prev[i];
+						newPairs.push_back(next[i]);
+					}
+				}
+
+				// keep only new pairs of surviving domains, each of them once
+				candidates.clear();
+				for (size_t i : newPairs)
+				{
+					if ((!deleted[i]) && (prev[i] != none) && (!queued[i]))
+					{
+						queued[i] = 1;
+						candidates.push_back(i);
+					}
+				}
+				for (size_t i : candidates)
+					queued[i] = 0;
 			}
 		}
-	}
 
+		size_t pos = 0;
+		for (size_t i=0; i<nDomains; ++i)
+		{
+			if (!deleted[i])
+			{
+				if (pos != i)
+					domains_[pos] = std::move(domains_[i]);
+				++pos;
+			}
+		}
+		domains_.erase(domains_.begin() + pos, domains_.end());
+	}
 
 
 };
@@ -656,6 +763,7 @@ domainCounts(const DomainArrangement<DomainType> &daSet)
  * \brief Calculates the cos distance between two domain arrangements.
  * \param da1 The first domain arrangement.
  * \param da2 The second domain arrangement.
+ * \param dsm The domain similarity matrix.
  * @return The cos score.
  * \tparam DomainType The domain type
  *
@@ -672,23 +780,33 @@ cos(const DomainArrangement<DomainType> &da1, const DomainArrangement<DomainType
 	for (const DomainType &domain : da2)
 		universe.insert(domain.accession());
 
+	// the accessions are converted to DSM ids once, the O(n^2) lookups below use the ids
+	std::vector<int> ids1, ids2;
+	ids1.reserve(da1.size());
+	for (const DomainType &domain : da1)
+		ids1.push_back(dsm.id(domain.accession()));
+	ids2.reserve(da2.size());
+	for (const DomainType &domain : da2)
+		ids2.push_back(dsm.id(domain.accession()));
+
 	// create vectors
 	std::vector<float> vec1, vec2;
 	for (const std::string &dom : universe)
 	{
+		int domId = dsm.id(dom);
 		float score = 0;
 		float val;
-		for (const DomainType &domain : da1)
+		for (int id : ids1)
 		{
-			val = dsm.val(domain.accession(), dom);
+			val = dsm.val(id, domId);
 			if (val > score)
 				score =val;
 		}
 		vec1.push_back(score);
 		score = 0;
-		for (const DomainType &domain : da2)
+		for (int id : ids2)
 		{
-			val = dsm.val(domain.accession(), dom);
+			val = dsm.val(id, domId);
 			if (val > score)
 				score =val;
 		}
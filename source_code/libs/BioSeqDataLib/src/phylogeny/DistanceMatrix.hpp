@@ -0,0 +1,445 @@
+/*
+ * DistanceMatrix.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file DistanceMatrix.hpp
+ * \brief Header containing the DistanceMatrixBuilder class to compute the pairwise distances used by nj and upgma.
+ */
+#ifndef DISTANCEMATRIX_HPP_
+#define DISTANCEMATRIX_HPP_
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../utility/DSM.hpp"
+#include "../utility/TriangularMatrix.hpp"
+#include "../domain/ArrangementSimilarity.hpp"
+#include "../domain/DomainArrangementSet.hpp"
+
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \class DistanceMatrixBuilder
+ * \brief Computes all pairwise distances of a set of sequences or domain arrangements.
+ *
+ * The distances are written into a TriangularMatrix, which can be passed directly to PhylogeneticTree::nj_fast or
+ * PhylogeneticTree::upgma_fast. The matrix is filled in square tiles of tileSize x tileSize pairs, so that the data
+ * of the two row blocks of a tile stays in the cache. The tiles are distributed dynamically over the threads.
+ *
+ * The sets can be any container of sequences (e.g. SequenceSet, Alignment) or a DomainArrangementSet. The rows of the
+ * matrix are in the order in which the set is iterated, see names().
+ */
+class DistanceMatrixBuilder
+{
+private:
+	unsigned int nThreads_;
+	size_t tileSize_;
+
+	template<typename SeqType>
+	static std::string
+	name_(const SeqType &seq)
+	{
+		return seq.name();
+	}
+
+	template<typename Key, typename Value>
+	static Key
+	name_(const std::pair<const Key, Value> &element)
+	{
+		return element.first;
+	}
+
+	// number of differing and of compared columns, gaps are encoded as 0. The inner loop is written without branches
+	// to allow vectorization, its 32 bit counters are flushed before they could overflow.
+	static void
+	compareColumns_(const unsigned char *seq1, const unsigned char *seq2, size_t length, size_t &nDiff, size_t &nCompared)
+	{
+		nDiff = nCompared = 0;
+		for (size_t chunk=0; chunk<length; chunk += (size_t(1) << 30))
+		{
+			size_t chunkEnd = std::min(length, chunk + (size_t(1) << 30));
+			unsigned int diff = 0, compared = 0;
+			for (size_t pos=chunk; pos<chunkEnd; ++pos)
+			{
+				unsigned int both = (seq1[pos] != 0) & (seq2[pos] != 0);
+				compared += both;
+				diff += both & (seq1[pos] != seq2[pos]);
+			}
+			nDiff += diff;
+			nCompared += compared;
+		}
+	}
+
+	// number of shared elements of two sorted lists
+	static size_t
+	shared_(const uint64_t *list1, const uint64_t *end1, const uint64_t *list2, const uint64_t *end2)
+	{
+		size_t shared = 0;
+		while ((list1 != end1) && (list2 != end2))
+		{
+			if (*list1 < *list2)
+				++list1;
+			else if (*list2 < *list1)
+				++list2;
+			else
+			{
+				++shared;
+				++list1;
+				++list2;
+			}
+		}
+		return shared;
+	}
+
+	// resizes the matrix and calls f(thread, rowStart, rowEnd, colStart, colEnd) for every tile of the lower triangle
+	// (the cells with column >= row have to be skipped by f). The tiles are processed in parallel, thread is the number
+	// of the calling thread (< nThreads_) so that f can keep its own workspace.
+	template<typename TileFunction>
+	void
+	forEachTile_(size_t n, TriangularMatrix<float> &distMat, TileFunction f) const
+	{
+		distMat.resize(n);
+		size_t nBlocks = (n + tileSize_ - 1) / tileSize_;
+		size_t nTiles = nBlocks * (nBlocks + 1) / 2;
+		size_t tileSize = tileSize_;
+		std::exception_ptr error;
+		#pragma omp parallel num_threads(nThreads_)
+		{
+			size_t thread = 0;
+			#ifdef _OPENMP
+			thread = omp_get_thread_num();
+			#endif
+			#pragma omp for schedule(dynamic)
+			for (size_t tile=0; tile<nTiles; ++tile)
+			{
+				try
+				{
+					// tile (block1, block2) with block2 <= block1, numbered row by row
+					size_t block1 = static_cast<size_t>((std::sqrt(8.0*tile + 1) - 1) / 2);
+					while (block1*(block1+1)/2 > tile)
+						--block1;
+					while ((block1+1)*(block1+2)/2 <= tile)
+						++block1;
+					size_t block2 = tile - block1*(block1+1)/2;
+					f(thread, block1*tileSize, std::min(n, (block1+1)*tileSize), block2*tileSize, (block2+1)*tileSize);
+				}
+				catch (...)
+				{
+					#pragma omp critical(DistanceMatrixBuilder_error)
+					if (!error)
+						error = std::current_exception();
+				}
+			}
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+public:
+	/**
+	 * \brief Constructor.
+	 * @param nThreads The number of threads.
+	 * @param tileSize The number of rows (and columns) of a tile.
+	 */
+	explicit DistanceMatrixBuilder(unsigned int nThreads = 1, size_t tileSize = 64) : nThreads_((nThreads == 0) ? 1 : nThreads), tileSize_((tileSize == 0) ? 1 : tileSize)
+	{}
+
+	/**
+	 * \brief Sets the number of threads.
+	 */
+	void
+	threads(unsigned int nThreads)
+	{
+		nThreads_ = (nThreads == 0) ? 1 : nThreads;
+	}
+
+	unsigned int
+	threads() const
+	{
+		return nThreads_;
+	}
+
+	/**
+	 * \brief Sets the number of rows (and columns) of a tile.
+	 */
+	void
+	tileSize(size_t tileSize)
+	{
+		tileSize_ = (tileSize == 0) ? 1 : tileSize;
+	}
+
+	size_t
+	tileSize() const
+	{
+		return tileSize_;
+	}
+
+	/**
+	 * \brief Returns the names of the elements of a set in the order of the matrix rows.
+	 * @param set The set of sequences or domain arrangements.
+	 */
+	template<typename Set>
+	static std::vector<std::string>
+	names(const Set &set)
+	{
+		std::vector<std::string> names;
+		names.reserve(set.size());
+		for (const auto &element : set)
+			names.push_back(name_(element));
+		return names;
+	}
+
+	/**
+	 * \brief Fills a matrix with arbitrary distances.
+	 * @param n The number of elements.
+	 * @param[out] distMat The distance matrix, resized to n.
+	 * @param dist A function returning the distance of the elements i and j (j < i). It is called concurrently.
+	 */
+	template<typename Function>
+	void
+	fill(size_t n, TriangularMatrix<float> &distMat, Function dist) const
+	{
+		forEachTile_(n, distMat, [&](size_t, size_t rowStart, size_t rowEnd, size_t colStart, size_t colEnd)
+		{
+			for (size_t i=rowStart; i<rowEnd; ++i)
+			{
+				float *row = distMat.row(i);
+				size_t end = std::min(i, colEnd);
+				for (size_t j=colStart; j<end; ++j)
+					row[j] = dist(i, j);
+			}
+		});
+	}
+
+	/**
+	 * \brief Computes the p-distances of aligned sequences.
+	 *
+	 * The p-distance is the fraction of differing residues in the columns in which neither sequence has a gap ('-' or
+	 * '.'). Case is ignored. Pairs without such a column have the distance 1.
+	 * @param aln The aligned sequences, all of the same length.
+	 * @param[out] distMat The distance matrix.
+	 * @throw std::invalid_argument if the sequences differ in length.
+	 */
+	template<typename SequenceSetType>
+	void
+	pDistance(const SequenceSetType &aln, TriangularMatrix<float> &distMat) const
+	{
+		size_t n = aln.size();
+		size_t length = (n == 0) ? 0 : aln.begin()->size();
+		std::vector<unsigned char> residues(n * length);
+		size_t i = 0;
+		for (const auto &seq : aln)
+		{
+			if (seq.size() != length)
+				throw std::invalid_argument("Sequence '" + seq.name() + "' differs in length from the other aligned sequences.");
+			unsigned char *row = &residues[i*length];
+			for (size_t pos=0; pos<length; ++pos)
+			{
+				char c = seq[pos];
+				row[pos] = ((c == '-') || (c == '.')) ? 0 : static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(c)));
+			}
+			++i;
+		}
+		fill(n, distMat, [&](size_t i, size_t j)
+		{
+			size_t nDiff, nCompared;
+			compareColumns_(&residues[i*length], &residues[j*length], length, nDiff, nCompared);
+			return (nCompared == 0) ? 1.0f : static_cast<float>(nDiff) / nCompared;
+		});
+	}
+
+	/**
+	 * \brief Computes k-mer distances of unaligned sequences.
+	 *
+	 * The distance is 1 - F, with F being the number of shared k-mers (counted with multiplicity) divided by the
+	 * number of k-mers of the shorter sequence. k-mers containing gaps or characters other than letters are ignored,
+	 * case is ignored. Sequences without k-mers have the distance 1 to every other sequence.
+	 * @param set The sequences.
+	 * @param k The length of the k-mers (1-12).
+	 * @param[out] distMat The distance matrix.
+	 * @throw std::invalid_argument if k is not in the range 1-12.
+	 */
+	template<typename SequenceSetType>
+	void
+	kmerDistance(const SequenceSetType &set, unsigned int k, TriangularMatrix<float> &distMat) const
+	{
+		if ((k == 0) || (k > 12))
+			throw std::invalid_argument("The k-mer length has to be between 1 and 12.");
+		// k-mers of every sequence, 5 bits per letter
+		std::vector<uint64_t> kmers;
+		std::vector<size_t> start(1, 0);
+		start.reserve(set.size()+1);
+		uint64_t mask = (uint64_t(1) << (5*k)) - 1;
+		for (const auto &seq : set)
+		{
+			uint64_t code = 0;
+			unsigned int nValid = 0;
+			for (char c : seq.seq())
+			{
+				int letter = std::toupper(static_cast<unsigned char>(c));
+				if ((letter < 'A') || (letter > 'Z'))
+				{
+					nValid = 0;
+					continue;
+				}
+				code = ((code << 5) | static_cast<uint64_t>(letter - 'A' + 1)) & mask;
+				if (++nValid >= k)
+					kmers.push_back(code);
+			}
+			start.push_back(kmers.size());
+		}
+
+		// replace the k-mers by dense ids and store every sequence as (id, count) pairs
+		std::vector<uint64_t> dictionary(kmers);
+		std::sort(dictionary.begin(), dictionary.end());
+		dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+		size_t n = start.size()-1;
+		std::vector<uint32_t> ids, counts;
+		std::vector<size_t> idStart(1, 0);
+		idStart.reserve(n+1);
+		for (size_t i=0; i<n; ++i)
+		{
+			size_t first = ids.size();
+			for (size_t pos=start[i]; pos<start[i+1]; ++pos)
+				ids.push_back(static_cast<uint32_t>(std::lower_bound(dictionary.begin(), dictionary.end(), kmers[pos]) - dictionary.begin()));
+			std::sort(ids.begin()+first, ids.end());
+			size_t last = first;
+			for (size_t pos=first; pos<ids.size(); ++pos)
+			{
+				if ((pos != first) && (ids[pos] == ids[last-1]))
+					++counts[last-1];
+				else
+				{
+					ids[last++] = ids[pos];
+					counts.push_back(1);
+				}
+			}
+			ids.resize(last);
+			idStart.push_back(last);
+		}
+		std::vector<uint64_t>().swap(kmers);
+
+		// the counts of a row are spread into a dense table, so that every column needs only independent lookups. Every
+		// thread allocates its table once and resets only the entries of the row it spread.
+		size_t nKmers = dictionary.size();
+		std::vector<std::vector<uint32_t> > tables(nThreads_);
+		forEachTile_(n, distMat, [&](size_t thread, size_t rowStart, size_t rowEnd, size_t colStart, size_t colEnd)
+		{
+			std::vector<uint32_t> &table = tables[thread];
+			if (table.size() != nKmers)
+				table.assign(nKmers, 0);
+			for (size_t i=rowStart; i<rowEnd; ++i)
+			{
+				size_t end = std::min(i, colEnd);
+				if (colStart >= end)
+					continue;
+				for (size_t pos=idStart[i]; pos<idStart[i+1]; ++pos)
+					table[ids[pos]] = counts[pos];
+				size_t n1 = start[i+1] - start[i];
+				float *row = distMat.row(i);
+				for (size_t j=colStart; j<end; ++j)
+				{
+					size_t n2 = start[j+1] - start[j];
+					size_t shared = 0;
+					for (size_t pos=idStart[j]; pos<idStart[j+1]; ++pos)
+						shared += std::min(table[ids[pos]], counts[pos]);
+					row[j] = ((n1 == 0) || (n2 == 0)) ? 1.0f : 1.0f - static_cast<float>(shared) / std::min(n1, n2);
+				}
+				for (size_t pos=idStart[i]; pos<idStart[i+1]; ++pos)
+					table[ids[pos]] = 0;
+			}
+		});
+	}
+
+	/**
+	 * \brief Computes DSM based distances of domain arrangements.
+	 *
+	 * The distance is 1 - cos(), see ArrangementSimilarity. Arrangements without domains have the distance 1.
+	 * @param set The domain arrangements.
+	 * @param dsm The domain similarity matrix.
+	 * @param[out] distMat The distance matrix.
+	 */
+	template<typename DomainType>
+	void
+	dsmDistance(const DomainArrangementSet<DomainType> &set, const DSM &dsm, TriangularMatrix<float> &distMat) const
+	{
+		ArrangementSimilarity similarities(dsm);
+		similarities.add(set);
+		fill(similarities.size(), distMat, [&](size_t i, size_t j)
+		{
+			float similarity = similarities.similarity(i, j);
+			return std::isnan(similarity) ? 1.0f : std::max(0.0f, 1.0f - similarity);
+		});
+	}
+
+	/**
+	 * \brief Computes Jaccard distances of the domain content of domain arrangements.
+	 *
+	 * The distance is 1 - |A & B| / |A | B|, with A and B being the sets of domain accessions of the two arrangements.
+	 * Two arrangements without domains have the distance 0.
+	 * @param set The domain arrangements.
+	 * @param[out] distMat The distance matrix.
+	 */
+	template<typename DomainType>
+	void
+	jaccardDistance(const DomainArrangementSet<DomainType> &set, TriangularMatrix<float> &distMat) const
+	{
+		// sorted unique domain ids of every arrangement
+		std::map<std::string, uint64_t> ids;
+		std::vector<uint64_t> content;
+		std::vector<size_t> start(1, 0);
+		start.reserve(set.size()+1);
+		for (const auto &element : set)
+		{
+			for (const auto &domain : element.second)
+				content.push_back(ids.emplace(domain.accession(), ids.size()).first->second);
+			std::sort(content.begin()+start.back(), content.end());
+			content.erase(std::unique(content.begin()+start.back(), content.end()), content.end());
+			start.push_back(content.size());
+		}
+		fill(start.size()-1, distMat, [&](size_t i, size_t j)
+		{
+			size_t n1 = start[i+1] - start[i];
+			size_t n2 = start[j+1] - start[j];
+			if ((n1 == 0) && (n2 == 0))
+				return 0.0f;
+			const uint64_t *data = content.data();
+			size_t shared = shared_(data+start[i], data+start[i+1], data+start[j], data+start[j+1]);
+			return 1.0f - static_cast<float>(shared) / (n1 + n2 - shared);
+		});
+	}
+};
+
+}
+
+#endif /* DISTANCEMATRIX_HPP_ */
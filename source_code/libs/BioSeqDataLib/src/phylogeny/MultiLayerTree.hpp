@@ -0,0 +1,206 @@
+/*
+ * MultiLayerTree.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file MultiLayerTree.hpp
+ * \brief Header containing the MultiLayerTree.
+ */
+#ifndef MULTILAYERTREE_HPP_
+#define MULTILAYERTREE_HPP_
+
+#include <string>
+#include <vector>
+
+#include "PhylogeneticTree.hpp"
+
+namespace BioSeqDataLib
+{
+
+/** \addtogroup PhyloGroup
+ *  @{
+ */
+
+/**
+ * \brief Empty node data for trees storing their states outside of the nodes.
+ */
+struct NoNodeData
+{};
+
+/**
+ * \brief A phylogenetic tree with a single topology and several layers of states.
+ * \details Every layer is a state matrix with one row per node. Rows are indexed by the node ID as assigned
+ * while reading the tree. This allows to reconstruct different kinds of states (e.g. domain arrangements and
+ * single domains) on the same topology without keeping a copy of the tree for each of them.
+ */
+class MultiLayerTree : public PhylogeneticTree<NoNodeData>
+{
+public:
+	typedef TreeNodePhylo<NoNodeData> NodeType;
+	typedef std::vector<std::vector<int> > StateMatrix;
+
+private:
+	std::vector<StateMatrix> layers_;
+	std::vector<NodeType *> nodes_;
+
+	/**
+	 * \brief Maps the node IDs to the nodes and resizes all layers to the number of nodes.
+	 */
+	void
+	indexNodes_()
+	{
+		nodes_.clear();
+		for (auto node = this->preorderBegin(); node != this->preorderEnd(); ++node)
+		{
+			if (node->id >= nodes_.size())
+				nodes_.resize(node->id+1, nullptr);
+			nodes_[node->id] = &*node;
+		}
+		for (auto &layer : layers_)
+			layer.assign(nodes_.size(), std::vector<int>());
+	}
+
+public:
+
+	/**
+	 * \brief Standard constructor
+	 * @param nLayers The number of state layers to create.
+	 */
+	explicit MultiLayerTree(size_t nLayers = 0) : layers_(nLayers)
+	{}
+
+	/**
+	 * \brief Standard destructor
+	 */
+	virtual ~MultiLayerTree()
+	{}
+
+	/**
+	 * \brief Reads a file in newick Format.
+	 * \details All existing layers are reset to empty states for every node.
+	 * @param inFile The file to read.
+	 */
+	void
+	read(const std::string &inFile)
+	{
+		PhylogeneticTree<NoNodeData>::read(inFile);
+		indexNodes_();
+	}
+
+	/**
+	 * \brief Turns a string in newick format into a tree.
+	 * \details All existing layers are reset to empty states for every node.
+	 * @param treeLine The tree line.
+	 */
+	void
+	str2tree(const std::string &treeLine)
+	{
+		PhylogeneticTree<NoNodeData>::str2tree(treeLine);
+		indexNodes_();
+	}
+
+	/**
+	 * \brief Adds a new layer with empty states for every node.
+	 * @return The index of the new layer.
+	 */
+	size_t
+	addLayer()
+	{
+		layers_.emplace_back(nodes_.size());
+		return layers_.size()-1;
+	}
+
+	/**
+	 * \brief Returns the number of layers.
+	 * @return The number of layers.
+	 */
+	size_t
+	nLayers() const
+	{
+		return layers_.size();
+	}
+
+	/**
+	 * \brief Returns the number of nodes.
+	 * \details Node IDs run from 0 to nNodes()-1.
+	 * @return The number of nodes.
+	 */
+	size_t
+	nNodes() const
+	{
+		return nodes_.size();
+	}
+
+	/**
+	 * \brief Returns the node with the given ID.
+	 * @param id The node ID.
+	 * @return The node.
+	 */
+	NodeType &
+	node(unsigned int id)
+	{
+		return *nodes_[id];
+	}
+
+	const NodeType &
+	node(unsigned int id) const
+	{
+		return *nodes_[id];
+	}
+
+	/**
+	 * \brief Returns the state matrix of a layer.
+	 * @param l The index of the layer.
+	 * @return The state matrix, one row per node ID.
+	 */
+	StateMatrix &
+	layer(size_t l)
+	{
+		return layers_[l];
+	}
+
+	const StateMatrix &
+	layer(size_t l) const
+	{
+		return layers_[l];
+	}
+
+	/**
+	 * \brief Returns the states of a node in a layer.
+	 * @param l The index of the layer.
+	 * @param id The node ID.
+	 * @return The states of the node.
+	 */
+	std::vector<int> &
+	states(size_t l, unsigned int id)
+	{
+		return layers_[l][id];
+	}
+
+	const std::vector<int> &
+	states(size_t l, unsigned int id) const
+	{
+		return layers_[l][id];
+	}
+};
+
+/** @} */ // PhyloGroup
+
+} /* namespace BioSeqDataLib */
+
+#endif /* MULTILAYERTREE_HPP_ */
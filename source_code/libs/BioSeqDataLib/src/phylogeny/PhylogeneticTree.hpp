@@ -28,11 +28,13 @@
 #ifndef PHYLOGENYTREE_H_
 #define PHYLOGENYTREE_H_
 
+#include <algorithm>
 #include <stack>
 #include <vector>
 #include <fstream>
 
 #include "Tree.hpp"
+#include "../utility/TriangularMatrix.hpp"
 #include "../utility/stringHelpers.hpp"
 #include "../external/Input.hpp"
 
@@ -88,6 +90,29 @@ public:
 	 */
 	void nj(Matrix<float> &distMat, const std::vector<std::string> &names);
 
+	/**
+	 * \brief Calculates a phylogenetic tree using the neighbour-joining algorithm with a bounded search (RapidNJ).
+	 *
+	 * Computes the same tree as nj, but much faster for large numbers of taxa: the distances of every node are kept
+	 * sorted, so that the search for the pair to join can stop as soon as no remaining distance can beat the best pair
+	 * found so far. The row sums are updated incrementally in double precision, the edge lengths and the pairs of the
+	 * last two steps (whose values tie) use the float row sums of nj. Before that, a pair whose value ties with the
+	 * one of another pair up to rounding can be chosen differently.
+	 * @param distMat The distance matrix, only the lower triangle is used.
+	 * @param names The names to use.
+	 */
+	void nj_fast(TriangularMatrix<float> distMat, const std::vector<std::string> &names);
+
+	/**
+	 * \brief Calculates a phylogenetic tree using the fast neighbour-joining algorithm, see above.
+	 * @param distMat The distance matrix.
+	 * @param names The names to use.
+	 */
+	void nj_fast(const Matrix<float> &distMat, const std::vector<std::string> &names)
+	{
+		nj_fast(TriangularMatrix<float>(distMat), names);
+	}
+
 	/**
 	 * \brief Calculates a phylogenetic tree using the UPGMA algorithm.
 	 * @param distMat The distance matrix.
@@ -95,6 +120,29 @@ public:
 	 */
 	void upgma(Matrix<float> &distMat, const std::vector<std::string> &names);
 
+	/**
+	 * \brief Calculates a phylogenetic tree using the UPGMA (or WPGMA) algorithm with cached row minima.
+	 *
+	 * Computes the same tree as upgma, including the tie-breaking, but keeps the minimum of every row and only rescans
+	 * the rows whose minimum was affected by a join. This reduces the running time from O(n^3) to about O(n^2).
+	 * @param distMat The distance matrix, only the lower triangle is used.
+	 * @param names The names to use.
+	 * @param weighted If true, WPGMA is used (the distance to a new cluster is the mean of the distances to its two
+	 * parts instead of the mean over all members).
+	 */
+	void upgma_fast(TriangularMatrix<float> distMat, const std::vector<std::string> &names, bool weighted = false);
+
+	/**
+	 * \brief Calculates a phylogenetic tree using the fast UPGMA algorithm, see above.
+	 * @param distMat The distance matrix.
+	 * @param names The names to use.
+	 * @param weighted If true, WPGMA is used.
+	 */
+	void upgma_fast(const Matrix<float> &distMat, const std::vector<std::string> &names, bool weighted = false)
+	{
+		upgma_fast(TriangularMatrix<float>(distMat), names, weighted);
+	}
+
 	/**
 	 * \brief Turns the tree into a newick string.
 	 * @return The tree in string format.
@@ -240,6 +288,186 @@ PhylogeneticTree<DataType>::nj(Matrix<float> &distMat, const std::vector<std::st
 	isRooted_=false;
 }
 
+template<typename DataType>
+void
+PhylogeneticTree<DataType>::nj_fast(TriangularMatrix<float> distMat, const std::vector<std::string> &names)
+{
+	this->root_=nullptr;
+	size_t nTaxa = names.size();
+	size_t nToDo = nTaxa;
+	size_t i,j, minI=0, minJ=0;
+	float minVal;
+	std::vector<TreeNodePhylo<DataType> *> nodes(nTaxa);
+	TreeNodePhylo<DataType> *tmpNode = nullptr;
+	for (i=0; i<nTaxa; ++i)
+	{
+		nodes[i]= new TreeNodePhylo<DataType>();
+		nodes[i]->name = names[i];
+		nodes[i]->id = i;
+	}
+
+	// Every node has a row with the distances to all nodes that existed when it was created, sorted by distance. This
+	// way every pair is stored in the row of the younger node. Entries of nodes joined since then are invalid.
+	struct Entry
+	{
+		float dist;
+		size_t id;
+		bool operator<(const Entry &other) const
+		{
+			return (dist < other.dist) || ((dist == other.dist) && (id < other.id));
+		}
+	};
+	std::vector<std::vector<Entry> > rows(nTaxa);
+	std::vector<size_t> rowStart(nTaxa, 0); // the entries before rowStart are known to be invalid
+	std::vector<size_t> created(nTaxa);
+	std::vector<double> sums(nTaxa, 0);
+	std::vector<float> r(nTaxa);
+	std::vector<size_t> active(nTaxa);
+	for (i=0; i<nTaxa; ++i)
+	{
+		active[i] = i;
+		created[i] = i;
+		const float *distRow = distMat.row(i);
+		rows[i].resize(i);
+		for (j=0; j<i; ++j)
+		{
+			rows[i][j] = Entry{distRow[j], j};
+			sums[i] += distRow[j];
+			sums[j] += distRow[j];
+		}
+		std::sort(rows[i].begin(), rows[i].end());
+	}
+	size_t clock = nTaxa;
+	size_t lastCompaction = nTaxa;
+	auto valid = [&](size_t k, size_t row) { return (nodes[k] != nullptr) && (created[k] < created[row]); };
+	// r of a node summed up in float in the same order as in nj
+	auto njR = [&](size_t k)
+	{
+		float sum = 0;
+		for (size_t l : active)
+			if (l != k)
+				sum += distMat(k, l);
+		return sum / (nToDo - 2);
+	};
+
+	while (nToDo >2)
+	{
+		// calculate r
+		float rMax = -FLT_MAX;
+		for (size_t k : active)
+		{
+			r[k] = static_cast<float>(sums[k]) / (nToDo - 2);
+			rMax = std::max(rMax, r[k]);
+		}
+		if (nToDo <= 4)
+		{
+			// the values of the intermediate matrix tie (all pairs for three nodes, complementary pairs for four), only
+			// rounding decides: choose the same pair as nj
+			rMax = -FLT_MAX;
+			for (size_t k : active)
+			{
+				r[k] = njR(k);
+				rMax = std::max(rMax, r[k]);
+			}
+		}
+
+		// bounded search for the minimum of the intermediate matrix, ties are broken like in nj (smallest i, then j)
+		minVal = FLT_MAX;
+		bool found = false;
+		for (size_t row : active)
+		{
+			float rRow = r[row];
+			const std::vector<Entry> &entries = rows[row];
+			size_t &start = rowStart[row];
+			while ((start < entries.size()) && !valid(entries[start].id, row))
+				++start;
+			for (size_t pos=start; pos<entries.size(); ++pos)
+			{
+				const Entry &entry = entries[pos];
+				// r of the other node is at most rMax, no later entry can be better
+				if (entry.dist - (rRow + rMax) > minVal)
+					break;
+				if (!valid(entry.id, row))
+					continue;
+				float q = entry.dist - (rRow + r[entry.id]);
+				size_t lo = std::min(row, entry.id);
+				size_t hi = std::max(row, entry.id);
+				if (!found || (q < minVal) || ((q == minVal) && ((lo < minI) || ((lo == minI) && (hi < minJ)))))
+				{
+					found = true;
+					minVal = q;
+					minI = lo;
+					minJ = hi;
+				}
+			}
+		}
+
+		// constuct new Node, the edge lengths are calculated with the same r as in nj
+		tmpNode = new TreeNodePhylo<DataType>();
+		tmpNode->addChild(nodes[minI]);
+		tmpNode->addChild(nodes[minJ]);
+		minVal = distMat(minI, minJ);
+		r[minI] = njR(minI);
+		r[minJ] = njR(minJ);
+		nodes[minI]->edgeLength = (minVal + r[minI] - r[minJ])/2;
+		nodes[minJ]->edgeLength =  minVal - nodes[minI]->edgeLength;
+
+		nodes[minJ] = nullptr;
+		nodes[minI] = nullptr;
+		active.erase(std::find(active.begin(), active.end(), minJ));
+		std::vector<Entry>().swap(rows[minJ]);
+
+		// calculate new distances and update the row sums
+		std::vector<Entry> &newRow = rows[minI];
+		newRow.clear();
+		rowStart[minI] = 0;
+		sums[minI] = 0;
+		for (size_t k : active)
+		{
+			if (k == minI)
+				continue;
+			float dist = (distMat(k, minI) + distMat(k, minJ) - minVal)/2;
+			sums[k] += dist - distMat(k, minI) - distMat(k, minJ);
+			sums[minI] += dist;
+			distMat(k, minI) = dist;
+			newRow.push_back(Entry{dist, k});
+		}
+		std::sort(newRow.begin(), newRow.end());
+		--nToDo;
+		nodes[minI] = tmpNode;
+		created[minI] = clock++;
+
+		// remove the invalid entries whenever the number of nodes has halved
+		if (2*nToDo < lastCompaction)
+		{
+			lastCompaction = nToDo;
+			for (size_t row : active)
+			{
+				std::vector<Entry> &entries = rows[row];
+				entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry &entry) { return !valid(entry.id, row); }), entries.end());
+				rowStart[row] = 0;
+			}
+		}
+	}
+	bool first = true;
+	for (i=0; i<nTaxa; ++i)
+	{
+		if (nodes[i] != nullptr)
+		{
+			first = !first;
+			if (first)
+				minI = i;
+			else
+				minJ = i;
+		}
+	}
+
+	this->root_.reset(nodes[minJ]);
+	nodes[minJ]->addChild(nodes[minI]);
+	nodes[minI]->edgeLength=distMat(minI, minJ);
+	isRooted_=false;
+}
+
 template<typename DataType>
 void
 PhylogeneticTree<DataType>::upgma(Matrix<float> &distMat, const std::vector<std::string> &names)
@@ -324,6 +552,129 @@ PhylogeneticTree<DataType>::upgma(Matrix<float> &distMat, const std::vector<std:
 	nodes[minI]->edgeLength = minVal/2-nodes[minI]->edgeLength;
 }
 
+template<typename DataType>
+void
+PhylogeneticTree<DataType>::upgma_fast(TriangularMatrix<float> distMat, const std::vector<std::string> &names, bool weighted)
+{
+	this->root_=nullptr;
+	size_t nTaxa = names.size();
+	size_t nToDo = nTaxa;
+	std::vector<float> counts(nTaxa, 1);
+	size_t i,j, minI=0, minJ=0;
+	float minVal;
+	std::vector<TreeNodePhylo<DataType> *> nodes(nTaxa);
+	TreeNodePhylo<DataType> *tmpNode = nullptr;
+	for (i=0; i<nTaxa; ++i)
+	{
+		nodes[i]= new TreeNodePhylo<DataType>();
+		nodes[i]->edgeLength = 0;
+		nodes[i]->name = names[i];
+		nodes[i]->id = i;
+	}
+
+	// rowMin[i] is the smallest distance of row i to the nodes j<i, rowArg[i] the smallest such j (nTaxa if none)
+	std::vector<float> rowMin(nTaxa);
+	std::vector<size_t> rowArg(nTaxa);
+	auto scanRow = [&](size_t row)
+	{
+		const float *distRow = distMat.row(row);
+		float best = FLT_MAX;
+		size_t arg = nTaxa;
+		for (size_t k=0; k<row; ++k)
+		{
+			if ((nodes[k] != nullptr) && (distRow[k] < best))
+			{
+				best = distRow[k];
+				arg = k;
+			}
+		}
+		rowMin[row] = best;
+		rowArg[row] = arg;
+	};
+	for (i=0; i<nTaxa; ++i)
+		scanRow(i);
+
+	while (nToDo >2)
+	{
+		// find the minimum, ties are broken like in upgma (smallest i, then j)
+		minVal = FLT_MAX;
+		for (j=0; j<nTaxa; ++j)
+		{
+			if ((nodes[j] == nullptr) || (rowArg[j] == nTaxa))
+				continue;
+			if ((rowMin[j] < minVal) || ((rowMin[j] == minVal) && (rowArg[j] < minI)))
+			{
+				minI = rowArg[j];
+				minJ = j;
+				minVal = rowMin[j];
+			}
+		}
+		// constuct new Node
+		tmpNode = new TreeNodePhylo<DataType>();
+		tmpNode->addChild(nodes[minI]);
+		tmpNode->addChild(nodes[minJ]);
+		tmpNode->edgeLength = minVal/2;
+		nodes[minJ]->edgeLength = minVal/2-nodes[minJ]->edgeLength;
+		nodes[minI]->edgeLength = minVal/2-nodes[minI]->edgeLength;
+		nodes[minJ] = nullptr;
+		nodes[minI] = nullptr;
+
+		// calculate new distances
+		float *rowI = distMat.row(minI);
+		for (i=0; i<nTaxa; ++i)
+		{
+			if (nodes[i] == nullptr)
+				continue;
+			float &dist = (i < minI) ? rowI[i] : distMat(i, minI);
+			if (weighted)
+				dist = (dist + distMat(i, minJ))/2;
+			else
+				dist = (dist*counts[minI] + distMat(i, minJ)*counts[minJ])/(counts[minI]+counts[minJ]);
+		}
+		--nToDo;
+		counts[minI] += counts[minJ];
+		nodes[minI] = tmpNode;
+
+		// update the row minima, only rows containing minI or minJ are affected
+		scanRow(minI);
+		for (i=minI+1; i<nTaxa; ++i)
+		{
+			if (nodes[i] == nullptr)
+				continue;
+			if ((rowArg[i] == minI) || (rowArg[i] == minJ))
+				scanRow(i);
+			else
+			{
+				float dist = distMat(i, minI);
+				if ((dist < rowMin[i]) || ((dist == rowMin[i]) && (minI < rowArg[i])))
+				{
+					rowMin[i] = dist;
+					rowArg[i] = minI;
+				}
+			}
+		}
+	}
+	bool first = true;
+	for (i=0; i<nTaxa; ++i)
+	{
+		if (nodes[i] != nullptr)
+		{
+			first = !first;
+			if (first)
+				minI = i;
+			else
+				minJ = i;
+		}
+	}
+	minVal = distMat(minI, minJ);
+	this->root_.reset(new TreeNodePhylo<DataType>());
+	this->root_->addChild(nodes[minI]);
+	this->root_->addChild(nodes[minJ]);
+	nodes[minJ]->edgeLength = minVal/2-nodes[minJ]->edgeLength;
+	nodes[minI]->edgeLength = minVal/2-nodes[minI]->edgeLength;
+}
+
+
 template<typename DataType>
 std::string
 PhylogeneticTree<DataType>::str()
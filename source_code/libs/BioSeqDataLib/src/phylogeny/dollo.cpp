@@ -17,17 +17,17 @@ namespace BioSeqDataLib {
 
     /**
     * \brief Infers the state of all instances (e.g. domainArrangements) by majority rule.
-    * @param child_l vector<int> with states of one of the child nodes
-    * @param child_r vector<int> with states of the other child nodes
-    * @return Parental state based on both child states.
+    * @param children States of all child nodes (two for bifurcating nodes, more for polytomies).
+    * @return Parental state based on all child states.
     */
     vector<int>
-    parentalState2(vector<int> &child_l, vector<int> &child_r)
+    parentalState2(const vector<const vector<int> *> &children)
     {
         /*
          * The states for the instances (e.g. domainArrangements) are given as integers
          * taking only the values +1 (existent), 0 (status unclear) and -1 (not existent)
-         * Arithmetics:
+         * An instance exists in the parent if it can be found (state 1 or 0) below at least two children,
+         * its state is unclear if it is found below exactly one child. For two children this gives:
          *  1 +  1 =  1
          *  1 +  0 =  1
          * -1 + -1 = -1
@@ -37,86 +37,65 @@ namespace BioSeqDataLib {
          *
          */
 
-        vector<int> parState;
-
-        for (unsigned int i = 0; i < child_l.size(); ++i) {
-            if (child_l[i] == child_r[i] and child_l[i] != 0) {
-                parState.emplace_back(child_l[i]);
-            }
-            else if (child_l[i] == child_r[i] and child_l[i] == 0)
-            {
-                parState.emplace_back(1);
-            }
-            else {
-                if (child_l[i] + child_r[i] == -1)
-                {
-                    parState.emplace_back(0);
-                }
-                else {
-                    parState.emplace_back(child_l[i] + child_r[i]);
+        vector<int> parState(children[0]->size(), 0);
+        for (auto child : children) {
+            for (unsigned int i = 0; i < parState.size(); ++i) {
+                if ((*child)[i] != -1) {
+                    ++parState[i];
                 }
             }
         }
 
+        for (int &state : parState) {
+            state = (state >= 2) ? 1 : state - 1;
+        }
+
         return parState;
     }
 
     /**
-    * \brief Collects all children of a given node and sets all calculated states for them.
-    * @param r1Node Pointer to the node of a PhylogeneticTree (choose root to infer states for the whole tree).
-    * @return The inferred states for the given node as a vector<int>. (All states of its childrens in the PhylogeneticTree have been set)
-    * \relates TreeNodePhylo
+    * \brief Infers the states of all inner nodes of a tree according to a dollo parsimony.
+    * @param phyTree The tree to iterate over, the states of the leaves have to be set.
+    * @param states Returns the state vector (vector<int>&) of a node.
     */
-    vector<int>
-    calChildren2(TreeNodePhylo <vector<int> > *r1Node)
-    {
-        if (r1Node->isLeaf()) {
-            return r1Node->data;
-        }
-
-            auto cl = r1Node->child(0);
-            auto cr = r1Node->child(1);
-
-            cl->data = calChildren2(cl);
-            cr->data = calChildren2(cr);
-
-            return parentalState2(cl->data, cr->data);
-
+    template<typename TreeType, typename StateAccessor>
+    void dolloStates(TreeType &phyTree, StateAccessor states) {
+        // children are always visited before their parent
+        vector<const vector<int> *> childStates;
+        for (auto node = phyTree.postorderBegin(); node != phyTree.postorderEnd(); ++node) {
+            if (!node->isLeaf()) {
+                childStates.clear();
+                for (size_t c = 0; c < node->nChildren(); ++c) {
+                    childStates.push_back(&states(*node->child(c)));
+                }
+                states(*node) = parentalState2(childStates);
+            }
         }
 
-    /**
-    * \brief Calculate in a second iteration over the tree all unknown states.
-    * @param r2Node Root node of a phylogenetic tree to iterate over.
-    * \relates TreeNodePhylo
-    */
-    void calUncertainStates2(TreeNodePhylo <vector<int>> *r2Node) {
-        if (r2Node->isLeaf()) //node is leaf
-        {
-            return;
-        }
-        else if (r2Node->parent() == nullptr) //node is root
-        {
-            //set all uncertain states to -1
-            for (int &state: r2Node->data) {
-                if (state == 0) {
-                    state = -1;
+        // parents are always resolved before their children
+        for (auto node = phyTree.preorderBegin(); node != phyTree.preorderEnd(); ++node) {
+            if (node->isLeaf()) {
+                continue;
+            }
+            vector<int> &nodeStates = states(*node);
+            if (node->parent() == nullptr) {
+                //set all uncertain states to -1
+                for (int &state : nodeStates) {
+                    if (state == 0) {
+                        state = -1;
+                    }
                 }
             }
-        }
-        else {
-            //set all instances of 0 to parental state
-            for (unsigned int n = 0; n < r2Node->data.size(); ++n) {
-                if (r2Node->data[n] == 0) {
-                    r2Node->data[n] = r2Node->parent()->data[n];
+            else {
+                //set all instances of 0 to parental state
+                const vector<int> &parentStates = states(*node->parent());
+                for (unsigned int n = 0; n < nodeStates.size(); ++n) {
+                    if (nodeStates[n] == 0) {
+                        nodeStates[n] = parentStates[n];
+                    }
                 }
             }
         }
-
-        auto l_child = r2Node->child(0);
-        auto r_child = r2Node->child(1);
-        calUncertainStates2(l_child);
-        calUncertainStates2(r_child);
-
     }
 
     /**
@@ -125,11 +104,17 @@ namespace BioSeqDataLib {
     * \relates PhylogeneticTree
     */
     void dollo(PhylogeneticTree <vector<int>> &phyTree) {
-        TreeNodePhylo <vector<int>> *rootTreeNode = &phyTree.root();
-
-        rootTreeNode->data = calChildren2(rootTreeNode);
-
-        calUncertainStates2(rootTreeNode);
+        dolloStates(phyTree, [](TreeNodePhylo <vector<int>> &node) -> vector<int> & { return node.data; });
+    }
 
+    /**
+    * \brief Infers the states of inner nodes in one layer of a MultiLayerTree according to a dollo parsimony.
+    * @param phyTree The input tree. The states of the leaves have to be set in the given layer.
+    * @param layer The index of the layer to infer the states for.
+    * \relates MultiLayerTree
+    */
+    void dollo(MultiLayerTree &phyTree, size_t layer) {
+        MultiLayerTree::StateMatrix &states = phyTree.layer(layer);
+        dolloStates(phyTree, [&states](const TreeNodePhylo<NoNodeData> &node) -> vector<int> & { return states[node.id]; });
     }
 }
@@ -16,17 +16,17 @@ namespace BioSeqDataLib {
 
     /**
     * \brief Infers the state of all instances (e.g. domainArrangements) by majority rule.
-    * @param child_l vector<int> with states of one of the child nodes
-    * @param child_r vector<int> with states of the other child nodes
-    * @return Parental state based on both child states.
+    * @param children States of all child nodes (two for bifurcating nodes, more for polytomies).
+    * @return Parental state based on all child states.
     */
     vector<int>
-    parentalState(vector<int> &child_l, vector<int> &child_r)
+    parentalState(const vector<const vector<int> *> &children)
     {
         /*
          * The states for the instances (e.g. domainArrangements) are given as integers
          * taking only the values +1 (existent), 0 (status unclear) and -1 (not existent)
-         * Arithmetics:
+         * A child with state 0 supports both possibilities, so the state chosen by most children is
+         * the sign of the sum over all child states. For two children this gives:
          *  1 +  1 =  1
          *  1 +  0 =  1
          * -1 + -1 = -1
@@ -36,91 +36,84 @@ namespace BioSeqDataLib {
          *
          */
 
-        vector<int> parState;
-
-        for (unsigned int i = 0; i < child_l.size(); ++i) {
-            if (child_l[i] == child_r[i]) {
-                parState.emplace_back(child_l[i]);
-            }
-            else {
-                parState.emplace_back(child_l[i] + child_r[i]);
+        vector<int> parState(*children[0]);
+        for (unsigned int c = 1; c < children.size(); ++c) {
+            const vector<int> &child = *children[c];
+            for (unsigned int i = 0; i < parState.size(); ++i) {
+                parState[i] += child[i];
             }
         }
 
-        return parState;
-    }
-
-
-    /**
-    * \brief Collects all children of a given node and sets all calculated states for them.
-    * @param r1Node Pointer to the node of a PhylogeneticTree (choose root to infer states for the whole tree).
-    * @return The inferred states for the given node as a vector<int>. (All states of its childrens in the PhylogeneticTree have been set)
-    * \relates TreeNodePhylo
-    */
-    vector<int>
-    calChildren(TreeNodePhylo <vector<int> > *r1Node) {
-        if (r1Node->isLeaf()) {
-            return r1Node->data;
+        for (int &state : parState) {
+            state = (state > 0) - (state < 0);
         }
 
-        auto cl = r1Node->child(0);
-        auto cr = r1Node->child(1);
-
-        cl->data = calChildren(cl);
-        cr->data = calChildren(cr);
-
-        return parentalState(cl->data, cr->data);
-
+        return parState;
     }
 
 
     /**
-    * \brief Calculate in a second iteration over the tree all unknown states.
-    * @param r2Node Root node of a phylogenetic tree to iterate over.
-    * \relates TreeNodePhylo
+    * \brief Infers the states of all inner nodes of a tree according to a fitch parsimony.
+    * @param phyTree The tree to iterate over, the states of the leaves have to be set.
+    * @param states Returns the state vector (vector<int>&) of a node.
     */
-    void calUncertainStates(TreeNodePhylo <vector<int>> *r2Node) {
-        if (r2Node->isLeaf()) //node is leaf
-        {
-            return;
-        }
-        else if (r2Node->parent() == nullptr) //node is root
-        {
-            //set all uncertain states to 1
-            for (int &state: r2Node->data) {
-                if (state == 0) {
-                    state = 1;
+    template<typename TreeType, typename StateAccessor>
+    void fitchStates(TreeType &phyTree, StateAccessor states) {
+        // children are always visited before their parent
+        vector<const vector<int> *> childStates;
+        for (auto node = phyTree.postorderBegin(); node != phyTree.postorderEnd(); ++node) {
+            if (!node->isLeaf()) {
+                childStates.clear();
+                for (size_t c = 0; c < node->nChildren(); ++c) {
+                    childStates.push_back(&states(*node->child(c)));
                 }
+                states(*node) = parentalState(childStates);
             }
         }
-        else {
-            //set all instances of 0 to parental state
-            for (unsigned int n = 0; n < r2Node->data.size(); ++n) {
-                if (r2Node->data[n] == 0) {
-                    r2Node->data[n] = r2Node->parent()->data[n];
+
+        // parents are always resolved before their children
+        for (auto node = phyTree.preorderBegin(); node != phyTree.preorderEnd(); ++node) {
+            if (node->isLeaf()) {
+                continue;
+            }
+            vector<int> &nodeStates = states(*node);
+            if (node->parent() == nullptr) {
+                //set all uncertain states to 1
+                for (int &state : nodeStates) {
+                    if (state == 0) {
+                        state = 1;
+                    }
+                }
+            }
+            else {
+                //set all instances of 0 to parental state
+                const vector<int> &parentStates = states(*node->parent());
+                for (unsigned int n = 0; n < nodeStates.size(); ++n) {
+                    if (nodeStates[n] == 0) {
+                        nodeStates[n] = parentStates[n];
+                    }
                 }
             }
-
         }
-
-        auto l_child = r2Node->child(0);
-        auto r_child = r2Node->child(1);
-        calUncertainStates(l_child);
-        calUncertainStates(r_child);
-
     }
 
     /**
-     * \brief Infers all states of inner nodes of a phylogenetic tree according to a fitch parsimony.
-     * @param phyTree The input tree. Has to be a BioSeqDataLib::PhylogeneticTree with a vector<int> in the data field.
-     * \relates PhylogeneticTree
-     */
+    * \brief Infers all states of inner nodes of a phylogenetic tree according to a fitch parsimony.
+    * @param phyTree The input tree. Has to be a BioSeqDataLib::PhylogeneticTree with a vector<int> in the data field.
+    * \relates PhylogeneticTree
+    */
     void fitch(PhylogeneticTree <vector<int>> &phyTree) {
-        TreeNodePhylo <vector<int>> *rootTreeNode = &phyTree.root();
-
-        rootTreeNode->data = calChildren(rootTreeNode);
-
-        calUncertainStates(rootTreeNode);
+        fitchStates(phyTree, [](TreeNodePhylo <vector<int>> &node) -> vector<int> & { return node.data; });
+    }
 
+    /**
+    * \brief Infers the states of inner nodes in one layer of a MultiLayerTree according to a fitch parsimony.
+    * @param phyTree The input tree. The states of the leaves have to be set in the given layer.
+    * @param layer The index of the layer to infer the states for.
+    * \relates MultiLayerTree
+    */
+    void fitch(MultiLayerTree &phyTree, size_t layer) {
+        MultiLayerTree::StateMatrix &states = phyTree.layer(layer);
+        fitchStates(phyTree, [&states](const TreeNodePhylo<NoNodeData> &node) -> vector<int> & { return states[node.id]; });
     }
 }
@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "PhylogeneticTree.hpp"
+#include "MultiLayerTree.hpp"
 
 
 namespace BioSeqDataLib {
@@ -43,11 +44,20 @@ namespace BioSeqDataLib {
 
     /**
     * \brief Infers all states of inner nodes of a phylogenetic tree according to a fitch parsimony.
+    * \details Inner nodes may have any number of children (polytomies).
     * @param phyTree The input tree. Has to be a BioSeqDataLib::PhylogeneticTree with a vector<int> in the data field.
     * \relates PhylogeneticTree
     */
     void fitch(PhylogeneticTree<std::vector < int> > &phyTree);
 
+    /**
+    * \brief Infers the states of inner nodes in one layer of a MultiLayerTree according to a fitch parsimony.
+    * @param phyTree The input tree. The states of the leaves have to be set in the given layer.
+    * @param layer The index of the layer to infer the states for.
+    * \relates MultiLayerTree
+    */
+    void fitch(MultiLayerTree &phyTree, size_t layer);
+
 }
 
 #endif //FITCH_HPP
@@ -0,0 +1,403 @@
+/*
+ * CompactSequenceSet.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file CompactSequenceSet.hpp
+ * \brief Header containing the CompactSequenceSet class, a read-mostly sequence set with contiguous storage.
+ */
+#ifndef COMPACTSEQUENCESET_HPP_
+#define COMPACTSEQUENCESET_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \class CompactSequenceSet
+ * \brief A set of sequences storing all names, comments and residues in three large buffers.
+ *
+ * A SequenceSet stores every sequence as a Sequence object with its own strings, which means several heap allocations
+ * per sequence. For large collections (e.g. whole proteomes) which are only read, a CompactSequenceSet needs a
+ * fraction of the memory and is filled much faster: the strings are appended to one buffer each and an offset table
+ * marks where every string starts. The sequences are accessed by lightweight views which refer into the buffers, they
+ * stay valid until the set is changed.
+ *
+ * The fasta reader ParallelFastaReader fills a CompactSequenceSet directly. Single sequences can be converted into
+ * any sequence type with sequence().
+ */
+class CompactSequenceSet
+{
+private:
+	std::string names_;
+	std::string comments_;
+	std::string residues_;
+	// string i is [offsets[i], offsets[i+1]) of the buffer
+	std::vector<uint64_t> nameOffsets_;
+	std::vector<uint64_t> commentOffsets_;
+	std::vector<uint64_t> residueOffsets_;
+
+	// fills the buffers directly
+	friend class ParallelFastaReader;
+
+	static boost::string_ref
+	part_(const std::string &buffer, const std::vector<uint64_t> &offsets, size_t i)
+	{
+		return boost::string_ref(buffer.data() + offsets[i], offsets[i+1] - offsets[i]);
+	}
+
+	static void
+	appendOffsets_(std::vector<uint64_t> &offsets, const std::vector<uint64_t> &otherOffsets)
+	{
+		uint64_t shift = offsets.back();
+		offsets.reserve(offsets.size() + otherOffsets.size() - 1);
+		for (size_t i=1; i<otherOffsets.size(); ++i)
+			offsets.push_back(otherOffsets[i] + shift);
+	}
+
+public:
+	/**
+	 * \brief A view of a single sequence of a CompactSequenceSet.
+	 * \details The view only stores a pointer to the set and the index of the sequence.
+	 */
+	class SequenceView
+	{
+	private:
+		const CompactSequenceSet *set_;
+		size_t index_;
+
+	public:
+		SequenceView(const CompactSequenceSet *set, size_t index) : set_(set), index_(index)
+		{}
+
+		boost::string_ref
+		name() const
+		{
+			return part_(set_->names_, set_->nameOffsets_, index_);
+		}
+
+		boost::string_ref
+		comment() const
+		{
+			return part_(set_->comments_, set_->commentOffsets_, index_);
+		}
+
+		/**
+		 * \brief Returns the residues.
+		 */
+		boost::string_ref
+		seq() const
+		{
+			return part_(set_->residues_, set_->residueOffsets_, index_);
+		}
+
+		/**
+		 * \brief Returns the id, which is the position in the set.
+		 */
+		size_t
+		id() const
+		{
+			return index_;
+		}
+
+		/**
+		 * \brief Returns the number of residues.
+		 */
+		size_t
+		size() const
+		{
+			return set_->residueOffsets_[index_+1] - set_->residueOffsets_[index_];
+		}
+
+		char
+		operator[](size_t pos) const
+		{
+			return set_->residues_[set_->residueOffsets_[index_] + pos];
+		}
+	};
+
+	/**
+	 * \brief Random access iterator returning SequenceView objects.
+	 */
+	class const_iterator
+	{
+	private:
+		const CompactSequenceSet *set_;
+		size_t index_;
+
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef SequenceView value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const SequenceView *pointer;
+		typedef SequenceView reference;
+
+		const_iterator(const CompactSequenceSet *set, size_t index) : set_(set), index_(index)
+		{}
+
+		SequenceView
+		operator*() const
+		{
+			return SequenceView(set_, index_);
+		}
+
+		SequenceView
+		operator[](std::ptrdiff_t n) const
+		{
+			return SequenceView(set_, index_ + n);
+		}
+
+		const_iterator &
+		operator++()
+		{
+			++index_;
+			return *this;
+		}
+
+		const_iterator
+		operator++(int)
+		{
+			const_iterator tmp(*this);
+			++index_;
+			return tmp;
+		}
+
+		const_iterator &
+		operator--()
+		{
+			--index_;
+			return *this;
+		}
+
+		const_iterator
+		operator--(int)
+		{
+			const_iterator tmp(*this);
+			--index_;
+			return tmp;
+		}
+
+		const_iterator &
+		operator+=(std::ptrdiff_t n)
+		{
+			index_ += n;
+			return *this;
+		}
+
+		const_iterator &
+		operator-=(std::ptrdiff_t n)
+		{
+			index_ -= n;
+			return *this;
+		}
+
+		const_iterator
+		operator+(std::ptrdiff_t n) const
+		{
+			return const_iterator(set_, index_ + n);
+		}
+
+		const_iterator
+		operator-(std::ptrdiff_t n) const
+		{
+			return const_iterator(set_, index_ - n);
+		}
+
+		std::ptrdiff_t
+		operator-(const const_iterator &other) const
+		{
+			return static_cast<std::ptrdiff_t>(index_) - static_cast<std::ptrdiff_t>(other.index_);
+		}
+
+		bool operator==(const const_iterator &other) const { return index_ == other.index_; }
+		bool operator!=(const const_iterator &other) const { return index_ != other.index_; }
+		bool operator<(const const_iterator &other) const { return index_ < other.index_; }
+		bool operator>(const const_iterator &other) const { return index_ > other.index_; }
+		bool operator<=(const const_iterator &other) const { return index_ <= other.index_; }
+		bool operator>=(const const_iterator &other) const { return index_ >= other.index_; }
+	};
+
+	/**
+	 * \brief Standard constructor.
+	 */
+	CompactSequenceSet() : names_(), comments_(), residues_(), nameOffsets_(1, 0), commentOffsets_(1, 0), residueOffsets_(1, 0)
+	{}
+
+	/**
+	 * \brief Reserves space.
+	 * @param nSeqs The number of sequences.
+	 * @param nResidues The total number of residues.
+	 */
+	void
+	reserve(size_t nSeqs, size_t nResidues)
+	{
+		nameOffsets_.reserve(nSeqs+1);
+		commentOffsets_.reserve(nSeqs+1);
+		residueOffsets_.reserve(nSeqs+1);
+		residues_.reserve(nResidues);
+	}
+
+	/**
+	 * \brief Appends a sequence.
+	 * @param name The name.
+	 * @param seq The residues.
+	 * @param comment The comment.
+	 */
+	void
+	push_back(boost::string_ref name, boost::string_ref seq, boost::string_ref comment = boost::string_ref())
+	{
+		names_.append(name.data(), name.size());
+		nameOffsets_.push_back(names_.size());
+		comments_.append(comment.data(), comment.size());
+		commentOffsets_.push_back(comments_.size());
+		residues_.append(seq.data(), seq.size());
+		residueOffsets_.push_back(residues_.size());
+	}
+
+	/**
+	 * \brief Appends all sequences of another set.
+	 * @param other The other set.
+	 */
+	void
+	append(const CompactSequenceSet &other)
+	{
+		appendOffsets_(nameOffsets_, other.nameOffsets_);
+		appendOffsets_(commentOffsets_, other.commentOffsets_);
+		appendOffsets_(residueOffsets_, other.residueOffsets_);
+		names_.append(other.names_);
+		comments_.append(other.comments_);
+		residues_.append(other.residues_);
+	}
+
+	/**
+	 * \brief Frees unused capacity of the buffers.
+	 */
+	void
+	shrink_to_fit()
+	{
+		std::string(names_).swap(names_);
+		std::string(comments_).swap(comments_);
+		std::string(residues_).swap(residues_);
+		nameOffsets_.shrink_to_fit();
+		commentOffsets_.shrink_to_fit();
+		residueOffsets_.shrink_to_fit();
+	}
+
+	/**
+	 * \brief Removes all sequences.
+	 */
+	void
+	clear()
+	{
+		names_.clear();
+		comments_.clear();
+		residues_.clear();
+		nameOffsets_.assign(1, 0);
+		commentOffsets_.assign(1, 0);
+		residueOffsets_.assign(1, 0);
+	}
+
+	/**
+	 * \brief Returns the number of sequences.
+	 */
+	size_t
+	size() const
+	{
+		return nameOffsets_.size()-1;
+	}
+
+	bool
+	empty() const
+	{
+		return nameOffsets_.size() == 1;
+	}
+
+	/**
+	 * \brief Returns the total number of residues.
+	 */
+	size_t
+	nResidues() const
+	{
+		return residues_.size();
+	}
+
+	/**
+	 * \brief Returns the number of bytes used by the buffers and offset tables.
+	 */
+	size_t
+	memoryUsage() const
+	{
+		return names_.capacity() + comments_.capacity() + residues_.capacity() + (nameOffsets_.capacity() + commentOffsets_.capacity() + residueOffsets_.capacity()) * sizeof(uint64_t);
+	}
+
+	SequenceView
+	operator[](size_t i) const
+	{
+		return SequenceView(this, i);
+	}
+
+	/**
+	 * \brief Access to a sequence with range check.
+	 * @param i The position of the sequence.
+	 * @throw std::out_of_range if i is not smaller than size().
+	 */
+	SequenceView
+	at(size_t i) const
+	{
+		if (i >= size())
+			throw std::out_of_range("Sequence " + std::to_string(i) + " does not exist.");
+		return SequenceView(this, i);
+	}
+
+	const_iterator
+	begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	const_iterator
+	end() const
+	{
+		return const_iterator(this, size());
+	}
+
+	/**
+	 * \brief Converts a sequence into a sequence object, e.g. Sequence<>.
+	 * @param i The position of the sequence, it is used as id.
+	 */
+	template<typename SequenceType>
+	SequenceType
+	sequence(size_t i) const
+	{
+		SequenceView view(this, i);
+		return SequenceType(view.name().to_string(), view.seq().to_string(), "", view.comment().to_string(), i);
+	}
+};
+
+}
+
+#endif /* COMPACTSEQUENCESET_HPP_ */
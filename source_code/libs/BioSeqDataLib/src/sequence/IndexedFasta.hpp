@@ -0,0 +1,444 @@
+/*
+ * IndexedFasta.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file IndexedFasta.hpp
+ * \brief File containing the IndexedFasta class for random access to the sequences of a fasta file.
+ */
+#ifndef INDEXEDFASTA_HPP_
+#define INDEXEDFASTA_HPP_
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "../utility/Exceptions.hpp"
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \brief An entry of a fasta index, the columns of a samtools faidx (.fai) file.
+ */
+struct FastaIndexEntry
+{
+	std::string name;    //!< The name of the sequence (the header up to the first whitespace).
+	size_t length;       //!< The number of residues.
+	size_t offset;       //!< The file offset of the first residue.
+	size_t lineBases;    //!< The number of residues per line.
+	size_t lineWidth;    //!< The number of bytes per line, including the line break.
+};
+
+
+/**
+ * \class IndexedFasta
+ * \brief Random access to the sequences of a fasta file.
+ *
+ * The file is memory-mapped and the sequences are located using an index in the format of samtools faidx (a .fai
+ * file next to the fasta file). Only the requested sequences are read, the rest of the file is never touched. If no
+ * index file exists or it is older than the fasta file, the index is built in memory with a single pass over the
+ * file; writeIndex() stores it for later use.
+ *
+ * As required by the index format, all lines of a sequence except the last one have to have the same length.
+ * Compressed files are not supported.
+ */
+class IndexedFasta
+{
+private:
+	boost::filesystem::path file_;
+	std::shared_ptr<boost::iostreams::mapped_file_source> data_;
+	std::vector<FastaIndexEntry> entries_;
+	std::vector<size_t> lookup_; // open addressing hash table of entry indices, empty slots contain entries_.size()
+	std::vector<size_t> sameName_; // the next entry with the same name, entries_.size() if none
+
+	// returns the slot of a name in a lookup table, either containing its entry or empty
+	static size_t
+	slot_(const std::vector<size_t> &lookup, const std::vector<FastaIndexEntry> &entries, const std::string &name)
+	{
+		size_t mask = lookup.size()-1;
+		size_t slot = std::hash<std::string>()(name) & mask;
+		while ((lookup[slot] != entries.size()) && (entries[lookup[slot]].name != name))
+			slot = (slot+1) & mask;
+		return slot;
+	}
+
+	size_t
+	slot_(const std::string &name) const
+	{
+		return slot_(lookup_, entries_, name);
+	}
+
+	// replaces the index by the given entries, the current one is kept if building the lookup fails
+	void
+	setEntries_(std::vector<FastaIndexEntry> &entries)
+	{
+		size_t tableSize = 1;
+		while (tableSize < 2*entries.size())
+			tableSize *= 2;
+		std::vector<size_t> lookup(tableSize, entries.size());
+		std::vector<size_t> sameName(entries.size(), entries.size());
+		// the first of several sequences with the same name is used, the others are chained to it in file order
+		for (size_t i=entries.size(); i-- > 0; )
+		{
+			size_t slot = slot_(lookup, entries, entries[i].name);
+			sameName[i] = lookup[slot];
+			lookup[slot] = i;
+		}
+		entries_.swap(entries);
+		lookup_.swap(lookup);
+		sameName_.swap(sameName);
+	}
+
+	const char *
+	begin_() const
+	{
+		return (data_->size() == 0) ? nullptr : data_->data();
+	}
+
+	// builds the index with a single pass over the file
+	std::vector<FastaIndexEntry>
+	buildIndex_() const
+	{
+		std::vector<FastaIndexEntry> entries;
+		const char *pos = begin_();
+		const char *fileEnd = pos + data_->size();
+		FastaIndexEntry *entry = nullptr;
+		bool lastLine = false; // true after a line shorter than the others of the sequence
+		while (pos < fileEnd)
+		{
+			const char *lineEnd = static_cast<const char *>(memchr(pos, '\n', fileEnd-pos));
+			const char *next = (lineEnd == nullptr) ? fileEnd : lineEnd+1;
+			if (lineEnd == nullptr)
+				lineEnd = fileEnd;
+			size_t nBases = lineEnd - pos;
+			if ((nBases != 0) && (pos[nBases-1] == '\r'))
+				--nBases;
+			if (*pos == '>')
+			{
+				const char *nameEnd = pos+1;
+				while ((nameEnd != lineEnd) && !std::isspace(static_cast<unsigned char>(*nameEnd)))
+					++nameEnd;
+				entries.push_back(FastaIndexEntry{std::string(pos+1, nameEnd), 0, static_cast<size_t>(next-begin_()), 0, 0});
+				entry = &entries.back();
+				lastLine = false;
+			}
+			else if (nBases == 0)
+			{
+				if (entry != nullptr)
+					lastLine = true;
+			}
+			else
+			{
+				if (entry == nullptr)
+					throw FormatException("Error: '" + file_.string() + "' is not a fasta file.");
+				if (lastLine)
+					throw FormatException("Error: Sequence '" + entry->name + "' in '" + file_.string() + "' has lines of different length, it cannot be indexed.");
+				if (entry->lineBases == 0)
+				{
+					entry->lineBases = nBases;
+					entry->lineWidth = next - pos;
+				}
+				else if ((nBases > entry->lineBases) || (static_cast<size_t>(next-pos) > entry->lineWidth))
+					throw FormatException("Error: Sequence '" + entry->name + "' in '" + file_.string() + "' has lines of different length, it cannot be indexed.");
+				if (nBases < entry->lineBases)
+					lastLine = true;
+				entry->length += nBases;
+			}
+			pos = next;
+		}
+		return entries;
+	}
+
+	const FastaIndexEntry &
+	entry_(const std::string &name) const
+	{
+		size_t index = lookup_[slot_(name)];
+		if (index == entries_.size())
+			throw std::out_of_range("Sequence '" + name + "' not found!");
+		return entries_[index];
+	}
+
+	std::string
+	fetch_(const FastaIndexEntry &entry, size_t first, size_t last) const
+	{
+		if ((first > last) || (last >= entry.length))
+			throw std::out_of_range("Region " + std::to_string(first) + "-" + std::to_string(last) + " is not part of sequence '" + entry.name + "'.");
+		std::string residues(last-first+1, ' ');
+		const char *data = begin_();
+		size_t copied = 0;
+		size_t pos = first;
+		while (pos <= last)
+		{
+			size_t column = pos % entry.lineBases;
+			size_t n = std::min(entry.lineBases - column, last - pos + 1);
+			memcpy(&residues[copied], data + entry.offset + (pos / entry.lineBases) * entry.lineWidth + column, n);
+			copied += n;
+			pos += n;
+		}
+		return residues;
+	}
+
+public:
+	/**
+	 * \brief Constructor.
+	 * @param fastaFile The fasta file, if fastaFile.fai exists and is not older than the fasta file it is used as index.
+	 * @throw std::runtime_error if the file cannot be opened or is compressed.
+	 * @throw FormatException if the file cannot be indexed.
+	 */
+	explicit IndexedFasta(const boost::filesystem::path &fastaFile) : file_(fastaFile)
+	{
+		try
+		{
+			if (boost::filesystem::file_size(fastaFile) == 0)
+				data_ = std::make_shared<boost::iostreams::mapped_file_source>();
+			else
+				data_ = std::make_shared<boost::iostreams::mapped_file_source>(fastaFile.string());
+		}
+		catch (std::exception &e)
+		{
+			throw std::runtime_error("Error: A problem occurred opening '" + fastaFile.string() + "'.");
+		}
+		if ((data_->size() >= 2) && (static_cast<unsigned char>(data_->data()[0]) == 0x1f) && (static_cast<unsigned char>(data_->data()[1]) == 0x8b))
+			throw std::runtime_error("Error: '" + fastaFile.string() + "' is compressed, only uncompressed fasta files can be indexed.");
+		// an index older than the fasta file may not fit to it anymore and is rebuilt in memory instead
+		boost::filesystem::path indexFile(fastaFile.string() + ".fai");
+		if (boost::filesystem::exists(indexFile) && (boost::filesystem::last_write_time(indexFile) >= boost::filesystem::last_write_time(fastaFile)))
+			readIndex(indexFile);
+		else
+		{
+			std::vector<FastaIndexEntry> entries = buildIndex_();
+			setEntries_(entries);
+		}
+	}
+
+	/**
+	 * \brief Reads an index in samtools faidx format.
+	 * @param indexFile The index file.
+	 * @throw FormatException if the index does not fit to the fasta file.
+	 */
+	void
+	readIndex(const boost::filesystem::path &indexFile)
+	{
+		std::ifstream inF(indexFile.string(), std::ios::binary);
+		if (!inF)
+			throw std::runtime_error("Error: A problem occurred opening '" + indexFile.string() + "'.");
+		inF.seekg(0, std::ios::end);
+		std::string content(static_cast<size_t>(inF.tellg()), '\0');
+		inF.seekg(0);
+		inF.read(&content[0], content.size());
+		std::vector<FastaIndexEntry> entries;
+		entries.reserve(std::count(content.begin(), content.end(), '\n'));
+		const char *pos = content.c_str();
+		const char *end = pos + content.size();
+		// reads a tab or newline terminated number
+		auto number = [&]() -> size_t
+		{
+			char *numberEnd;
+			unsigned long long value = strtoull(pos, &numberEnd, 10);
+			if ((numberEnd == pos) || ((*numberEnd != '\t') && (*numberEnd != '\n') && (*numberEnd != '\r') && (*numberEnd != '\0')))
+				throw FormatException("Error: '" + indexFile.string() + "' is not a fasta index.");
+			pos = (*numberEnd == '\0') ? numberEnd : numberEnd+1;
+			return value;
+		};
+		while (pos < end)
+		{
+			const char *nameEnd = static_cast<const char *>(memchr(pos, '\t', end-pos));
+			if (nameEnd == nullptr)
+				throw FormatException("Error: '" + indexFile.string() + "' is not a fasta index.");
+			FastaIndexEntry entry;
+			entry.name.assign(pos, nameEnd);
+			pos = nameEnd+1;
+			entry.length = number();
+			entry.offset = number();
+			entry.lineBases = number();
+			entry.lineWidth = number();
+			// skip further columns (fastq indices) and line breaks
+			while ((pos < end) && (*(pos-1) != '\n'))
+				++pos;
+			while ((pos < end) && ((*pos == '\n') || (*pos == '\r')))
+				++pos;
+			size_t seqEnd = entry.offset;
+			if (entry.length != 0)
+			{
+				if ((entry.lineBases == 0) || (entry.lineWidth < entry.lineBases))
+					throw FormatException("Error: '" + indexFile.string() + "' is not a fasta index.");
+				seqEnd += ((entry.length-1) / entry.lineBases) * entry.lineWidth + (entry.length-1) % entry.lineBases + 1;
+			}
+			if ((entry.offset == 0) || (seqEnd > data_->size()))
+				throw FormatException("Error: '" + indexFile.string() + "' does not fit to '" + file_.string() + "'.");
+			entries.push_back(std::move(entry));
+		}
+		setEntries_(entries);
+	}
+
+	/**
+	 * \brief Writes the index in samtools faidx format.
+	 * @param indexFile The index file. The default is the fasta file name with the extension .fai appended.
+	 */
+	void
+	writeIndex(const boost::filesystem::path &indexFile = boost::filesystem::path()) const
+	{
+		std::string outName = indexFile.empty() ? file_.string() + ".fai" : indexFile.string();
+		std::ofstream outF(outName);
+		if (!outF)
+			throw std::runtime_error("Error: A problem occurred opening '" + outName + "'.");
+		for (const FastaIndexEntry &entry : entries_)
+			outF << entry.name << "\t" << entry.length << "\t" << entry.offset << "\t" << entry.lineBases << "\t" << entry.lineWidth << "\n";
+		if (!outF)
+			throw std::runtime_error("Error: A problem occurred writing '" + outName + "'.");
+	}
+
+	/**
+	 * \brief Returns the number of sequences.
+	 */
+	size_t
+	size() const
+	{
+		return entries_.size();
+	}
+
+	/**
+	 * \brief Checks if the file contains a sequence.
+	 * @param name The name of the sequence.
+	 */
+	bool
+	contains(const std::string &name) const
+	{
+		return lookup_[slot_(name)] != entries_.size();
+	}
+
+	/**
+	 * \brief Returns the index entry of a sequence.
+	 * @param name The name of the sequence.
+	 * @throw std::out_of_range if the sequence does not exist.
+	 */
+	const FastaIndexEntry &
+	entry(const std::string &name) const
+	{
+		return entry_(name);
+	}
+
+	/**
+	 * \brief Returns all index entries in the order of the file.
+	 */
+	const std::vector<FastaIndexEntry> &
+	entries() const
+	{
+		return entries_;
+	}
+
+	/**
+	 * \brief Returns the index entries of all sequences with the given name in the order of the file.
+	 * @param name The name of the sequences.
+	 * @return The entries, empty if the sequence does not exist.
+	 */
+	std::vector<const FastaIndexEntry *>
+	entries(const std::string &name) const
+	{
+		std::vector<const FastaIndexEntry *> found;
+		for (size_t index = lookup_[slot_(name)]; index != entries_.size(); index = sameName_[index])
+			found.push_back(&entries_[index]);
+		return found;
+	}
+
+	/**
+	 * \brief Returns the header line of a sequence without '>'.
+	 * @param entry The index entry of the sequence.
+	 */
+	std::string
+	header(const FastaIndexEntry &entry) const
+	{
+		const char *data = begin_();
+		const char *lineEnd = data + entry.offset;
+		if (*(lineEnd-1) == '\n')
+			--lineEnd;
+		const char *pos = lineEnd;
+		while ((pos != data) && (*(pos-1) != '\n'))
+			--pos;
+		if ((lineEnd != pos) && (*(lineEnd-1) == '\r'))
+			--lineEnd;
+		return std::string(pos+1, lineEnd);
+	}
+
+	/**
+	 * \brief Returns the residues of a sequence.
+	 * @param name The name of the sequence.
+	 * @throw std::out_of_range if the sequence does not exist.
+	 */
+	std::string
+	fetch(const std::string &name) const
+	{
+		return fetch(entry_(name));
+	}
+
+	/**
+	 * \brief Returns a part of a sequence.
+	 * @param name The name of the sequence.
+	 * @param first The first position (starting with 0).
+	 * @param last The last position (included), like in subseq().
+	 * @throw std::out_of_range if the sequence does not exist or the positions are outside of the sequence.
+	 */
+	std::string
+	fetch(const std::string &name, size_t first, size_t last) const
+	{
+		return fetch_(entry_(name), first, last);
+	}
+
+	/**
+	 * \brief Returns the residues of a sequence.
+	 * @param entry The index entry of the sequence, e.g. one of entries().
+	 */
+	std::string
+	fetch(const FastaIndexEntry &entry) const
+	{
+		if (entry.length == 0)
+			return "";
+		return fetch_(entry, 0, entry.length-1);
+	}
+
+	/**
+	 * \brief Returns a sequence including name and comment (the header after the first space).
+	 * @param name The name of the sequence.
+	 * @param id The id of the sequence.
+	 * @throw std::out_of_range if the sequence does not exist.
+	 */
+	template<typename SequenceType>
+	SequenceType
+	sequence(const std::string &name, size_t id = 0) const
+	{
+		std::string line = header(entry_(name));
+		size_t pos = line.find(' ');
+		std::string comment = (pos == std::string::npos) ? "" : line.substr(pos+1);
+		return SequenceType(name, fetch(name), "", std::move(comment), id);
+	}
+};
+
+}
+
+#endif /* INDEXEDFASTA_HPP_ */
@@ -0,0 +1,500 @@
+/*
+ * ParallelFastaReader.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file ParallelFastaReader.hpp
+ * \brief Header containing the ParallelFastaReader class to read large fasta files with several threads.
+ */
+#ifndef PARALLELFASTAREADER_HPP_
+#define PARALLELFASTAREADER_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+
+#include "../utility/Exceptions.hpp"
+#include "CompactSequenceSet.hpp"
+#include "SequenceSet.hpp"
+
+
+namespace BioSeqDataLib
+{
+
+/**
+ * \class ParallelFastaReader
+ * \brief Reads fasta files with several threads.
+ *
+ * The file is memory mapped and cut into chunks of about chunkSize bytes. Every cut is moved to the start of the next
+ * record (a '>' at the beginning of a line), so that the chunks can be parsed independently. The sequences of the
+ * chunks are appended to the SequenceSet in the order of the file, the result is the same as SequenceSet::read except
+ * that '\\r' of Windows line breaks is removed.
+ *
+ * The compression is recognised by the content of the file. BGZF files (bgzip, the blocked gzip format of samtools)
+ * consist of independent blocks of at most 64 kB which are inflated in parallel. Other gzip and bzip2 files can only be
+ * decompressed sequentially, they are parsed in parallel afterwards.
+ *
+ * Besides a SequenceSet, the sequences can be read into a CompactSequenceSet, which is faster and needs much less
+ * memory for large files.
+ */
+class ParallelFastaReader
+{
+private:
+	unsigned int nThreads_;
+	size_t chunkSize_;
+	static const int bufferSize_ = 1 << 16;
+
+	// position and size of a BGZF block in the compressed and in the decompressed data
+	struct BgzfBlock_
+	{
+		size_t offset;
+		size_t size;
+		size_t outOffset;
+		size_t outSize;
+	};
+
+	static uint16_t
+	readUInt16_(const unsigned char *data)
+	{
+		return static_cast<uint16_t>(data[0] | (data[1] << 8));
+	}
+
+	static uint32_t
+	readUInt32_(const unsigned char *data)
+	{
+		return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+	}
+
+	// returns the size of the BGZF block starting at data or 0 if it is not a BGZF block
+	static size_t
+	bgzfBlockSize_(const unsigned char *data, size_t size)
+	{
+		// gzip header with FEXTRA flag, the extra field contains the subfield 'BC' storing the block size - 1
+		if ((size < 18) || (data[0] != 0x1f) || (data[1] != 0x8b) || (data[2] != 8) || ((data[3] & 4) == 0))
+			return 0;
+		size_t extraLength = readUInt16_(data+10);
+		if (12 + extraLength > size)
+			return 0;
+		const unsigned char *field = data + 12;
+		const unsigned char *extraEnd = field + extraLength;
+		while (field + 4 <= extraEnd)
+		{
+			size_t fieldLength = readUInt16_(field+2);
+			if ((field[0] == 'B') && (field[1] == 'C') && (fieldLength == 2) && (field + 6 <= extraEnd))
+				return static_cast<size_t>(readUInt16_(field+4)) + 1;
+			field += 4 + fieldLength;
+		}
+		return 0;
+	}
+
+	// decompresses a complete gzip or bzip2 stream
+	template<typename Decompressor>
+	static std::string
+	decompress_(const char *data, size_t size, Decompressor decompressor)
+	{
+		std::string content;
+		boost::iostreams::filtering_streambuf<boost::iostreams::input> inBuf;
+		inBuf.push(decompressor, bufferSize_);
+		inBuf.push(boost::iostreams::array_source(data, size));
+		boost::iostreams::copy(inBuf, boost::iostreams::back_inserter(content), bufferSize_);
+		return content;
+	}
+
+	// returns the beginning of the first record starting at or after pos
+	static const char *
+	recordStart_(const char *begin, const char *pos, const char *end)
+	{
+		if (pos == begin)
+			return pos;
+		while (pos < end)
+		{
+			const char *next = static_cast<const char *>(memchr(pos, '>', end-pos));
+			if (next == nullptr)
+				return end;
+			if (*(next-1) == '\n')
+				return next;
+			pos = next+1;
+		}
+		return end;
+	}
+
+	// calls f(nameBegin, nameEnd, commentBegin, commentEnd, bodyBegin, bodyEnd) for every record of [begin, end) that
+	// is selected by seqNames, the body still contains the line breaks
+	template<typename RecordFunction>
+	static void
+	forEachRecord_(const char *begin, const char *end, const std::unordered_set<std::string> &seqNames, bool remove, RecordFunction f)
+	{
+		const char *pos = begin;
+		// lines in front of the first record are ignored
+		if ((pos < end) && (*pos != '>'))
+			pos = recordStart_(begin, pos+1, end);
+		while (pos < end)
+		{
+			const char *lineEnd = static_cast<const char *>(memchr(pos, '\n', end-pos));
+			if (lineEnd == nullptr)
+				lineEnd = end;
+			const char *headerEnd = ((lineEnd != pos) && (*(lineEnd-1) == '\r')) ? lineEnd-1 : lineEnd;
+			const char *nameEnd = static_cast<const char *>(memchr(pos, ' ', headerEnd-pos));
+			const char *commentBegin = (nameEnd == nullptr) ? headerEnd : nameEnd+1;
+			if (nameEnd == nullptr)
+				nameEnd = headerEnd;
+			const char *bodyBegin = (lineEnd == end) ? end : lineEnd+1;
+			const char *bodyEnd = recordStart_(begin, bodyBegin, end);
+			if (seqNames.empty() || ((seqNames.find(std::string(pos+1, nameEnd)) != seqNames.end()) != remove))
+				f(pos+1, nameEnd, commentBegin, headerEnd, bodyBegin, bodyEnd);
+			pos = bodyEnd;
+		}
+	}
+
+	// copies the residues of a record body without line breaks to out and returns their number
+	static size_t
+	copyResidues_(const char *bodyBegin, const char *bodyEnd, char *out)
+	{
+		size_t length = 0;
+		while (bodyBegin < bodyEnd)
+		{
+			const char *lineEnd = static_cast<const char *>(memchr(bodyBegin, '\n', bodyEnd-bodyBegin));
+			if (lineEnd == nullptr)
+				lineEnd = bodyEnd;
+			size_t lineLength = lineEnd - bodyBegin;
+			if ((lineLength != 0) && (*(lineEnd-1) == '\r'))
+				--lineLength;
+			memcpy(out + length, bodyBegin, lineLength);
+			length += lineLength;
+			bodyBegin = (lineEnd == bodyEnd) ? bodyEnd : lineEnd+1;
+		}
+		return length;
+	}
+
+	// returns the chunk borders, chunk i is [starts[i], starts[i+1])
+	std::vector<const char *>
+	chunks_(const char *data, size_t size) const
+	{
+		const char *end = data + size;
+		std::vector<const char *> starts(1, data);
+		for (size_t pos=chunkSize_; pos<size; pos+=chunkSize_)
+		{
+			const char *start = recordStart_(data, data+pos, end);
+			if (start == end)
+				break;
+			if (start != starts.back())
+				starts.push_back(start);
+			if (static_cast<size_t>(start-data) > pos)
+				pos = start-data;
+		}
+		starts.push_back(end);
+		return starts;
+	}
+
+	// calls f(i) for i in [0, n) in parallel
+	template<typename Function>
+	void
+	parallelFor_(size_t n, Function f) const
+	{
+		std::exception_ptr error;
+		#pragma omp parallel for schedule(dynamic) num_threads(nThreads_)
+		for (size_t i=0; i<n; ++i)
+		{
+			try
+			{
+				f(i);
+			}
+			catch (...)
+			{
+				#pragma omp critical(ParallelFastaReader_error)
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	// throws if not all names in seqNames are in the set starting with sequence first
+	template<typename SetType>
+	static void
+	checkNames_(std::unordered_set<std::string> &seqNames, const SetType &set, size_t first)
+	{
+		for (size_t i=first; i<set.size(); ++i)
+			seqNames.erase(std::string(set[i].name()));
+		if (!seqNames.empty())
+			throw std::runtime_error("Sequence '" + *seqNames.begin() + "' not found!");
+	}
+
+	// inflates all blocks of a BGZF file in parallel
+	std::string
+	inflateBgzf_(const char *data, size_t size) const
+	{
+		const unsigned char *uData = reinterpret_cast<const unsigned char *>(data);
+		std::vector<BgzfBlock_> blocks;
+		size_t offset = 0;
+		size_t outOffset = 0;
+		while (offset < size)
+		{
+			size_t blockSize = bgzfBlockSize_(uData + offset, size - offset);
+			if ((blockSize < 26) || (offset + blockSize > size))
+				throw FormatException("Error: Corrupt BGZF block at position " + std::to_string(offset) + ".");
+			// the last four bytes of a block contain the decompressed size
+			size_t outSize = readUInt32_(uData + offset + blockSize - 4);
+			blocks.push_back(BgzfBlock_{offset, blockSize, outOffset, outSize});
+			offset += blockSize;
+			outOffset += outSize;
+		}
+
+		std::string content(outOffset, ' ');
+		std::exception_ptr error;
+		#pragma omp parallel for schedule(dynamic, 16) num_threads(nThreads_)
+		for (size_t i=0; i<blocks.size(); ++i)
+		{
+			try
+			{
+				const BgzfBlock_ &block = blocks[i];
+				if (block.outSize == 0)
+					continue;
+				// the block is inflated directly to its final position, writing more than outSize bytes throws
+				boost::iostreams::filtering_streambuf<boost::iostreams::input> inBuf;
+				inBuf.push(boost::iostreams::gzip_decompressor(boost::iostreams::zlib::default_window_bits, bufferSize_));
+				inBuf.push(boost::iostreams::array_source(data + block.offset, block.size));
+				boost::iostreams::array_sink outBuf(&content[block.outOffset], block.outSize);
+				if (static_cast<size_t>(boost::iostreams::copy(inBuf, outBuf, bufferSize_)) != block.outSize)
+					throw FormatException("Error: Corrupt BGZF block at position " + std::to_string(block.offset) + ".");
+			}
+			catch (...)
+			{
+				#pragma omp critical(ParallelFastaReader_error)
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+		if (error)
+			std::rethrow_exception(error);
+		return content;
+	}
+
+public:
+	/**
+	 * \brief Constructor.
+	 * @param nThreads The number of threads.
+	 * @param chunkSize The approximate number of bytes parsed as one piece of work.
+	 */
+	explicit ParallelFastaReader(unsigned int nThreads = 1, size_t chunkSize = 1 << 22) : nThreads_((nThreads == 0) ? 1 : nThreads), chunkSize_((chunkSize == 0) ? 1 : chunkSize)
+	{}
+
+	/**
+	 * \brief Sets the number of threads.
+	 */
+	void
+	threads(unsigned int nThreads)
+	{
+		nThreads_ = (nThreads == 0) ? 1 : nThreads;
+	}
+
+	unsigned int
+	threads() const
+	{
+		return nThreads_;
+	}
+
+	/**
+	 * \brief Checks if data starts with a BGZF block.
+	 * @param data The data.
+	 * @param size The size of the data.
+	 */
+	static bool
+	isBgzf(const char *data, size_t size)
+	{
+		return bgzfBlockSize_(reinterpret_cast<const unsigned char *>(data), size) != 0;
+	}
+
+	/**
+	 * \brief Parses fasta formatted data and appends the sequences to a set.
+	 * @param data The data.
+	 * @param size The size of the data.
+	 * @param set The set to append the sequences to.
+	 * @param seqNames The names of the sequences to extract, all sequences are read if empty.
+	 * @param remove If true the sequences in seqNames are skipped instead of extracted.
+	 * @throw std::runtime_error if a sequence of seqNames is not found and remove is false.
+	 */
+	template<typename SequenceType>
+	void
+	parse(const char *data, size_t size, SequenceSet<SequenceType> &set, const std::vector<std::string> &seqNames = std::vector<std::string>(), bool remove = false) const
+	{
+		std::vector<const char *> starts = chunks_(data, size);
+		std::unordered_set<std::string> names(seqNames.begin(), seqNames.end());
+		std::vector<std::vector<SequenceType> > chunkSeqs(starts.size()-1);
+		parallelFor_(chunkSeqs.size(), [&](size_t i)
+		{
+			std::vector<SequenceType> &seqs = chunkSeqs[i];
+			forEachRecord_(starts[i], starts[i+1], names, remove, [&](const char *nameBegin, const char *nameEnd, const char *commentBegin, const char *commentEnd, const char *bodyBegin, const char *bodyEnd)
+			{
+				std::string residues(bodyEnd-bodyBegin, ' ');
+				residues.resize(copyResidues_(bodyBegin, bodyEnd, &residues[0]));
+				seqs.emplace_back(std::string(nameBegin, nameEnd), std::move(residues), "", std::string(commentBegin, commentEnd), 0);
+			});
+		});
+
+		size_t nSeqs = 0;
+		for (const std::vector<SequenceType> &seqs : chunkSeqs)
+			nSeqs += seqs.size();
+		size_t first = set.size();
+		set.reserve(first + nSeqs);
+		size_t seqId = first;
+		for (std::vector<SequenceType> &seqs : chunkSeqs)
+		{
+			for (SequenceType &seq : seqs)
+			{
+				seq.id(seqId++);
+				set.push_back(std::move(seq));
+			}
+			std::vector<SequenceType>().swap(seqs);
+		}
+		if (!remove && !names.empty())
+			checkNames_(names, set, first);
+	}
+
+	/**
+	 * \brief Parses fasta formatted data and appends the sequences to a CompactSequenceSet.
+	 * \details The residues of a chunk cannot be more than its bytes, so every chunk writes its residues directly to the
+	 * position of the chunk in the data. Afterwards the residues are moved together and the names, comments and offsets
+	 * of the chunks are appended.
+	 * @param data The data.
+	 * @param size The size of the data.
+	 * @param set The set to append the sequences to.
+	 * @param seqNames The names of the sequences to extract, all sequences are read if empty.
+	 * @param remove If true the sequences in seqNames are skipped instead of extracted.
+	 * @throw std::runtime_error if a sequence of seqNames is not found and remove is false.
+	 */
+	void
+	parse(const char *data, size_t size, CompactSequenceSet &set, const std::vector<std::string> &seqNames = std::vector<std::string>(), bool remove = false) const
+	{
+		std::vector<const char *> starts = chunks_(data, size);
+		std::unordered_set<std::string> names(seqNames.begin(), seqNames.end());
+		size_t nChunks = starts.size()-1;
+		size_t residueBase = set.residues_.size();
+		set.residues_.resize(residueBase + size);
+
+		// names, comments and offsets relative to the chunk
+		std::vector<CompactSequenceSet> chunkSets(nChunks);
+		parallelFor_(nChunks, [&](size_t i)
+		{
+			CompactSequenceSet &chunkSet = chunkSets[i];
+			char *residues = &set.residues_[residueBase + (starts[i]-data)];
+			uint64_t residuePos = 0;
+			forEachRecord_(starts[i], starts[i+1], names, remove, [&](const char *nameBegin, const char *nameEnd, const char *commentBegin, const char *commentEnd, const char *bodyBegin, const char *bodyEnd)
+			{
+				chunkSet.names_.append(nameBegin, nameEnd);
+				chunkSet.nameOffsets_.push_back(chunkSet.names_.size());
+				chunkSet.comments_.append(commentBegin, commentEnd);
+				chunkSet.commentOffsets_.push_back(chunkSet.comments_.size());
+				residuePos += copyResidues_(bodyBegin, bodyEnd, residues + residuePos);
+				chunkSet.residueOffsets_.push_back(residuePos);
+			});
+		});
+
+		size_t first = set.size();
+		size_t nSeqs = 0;
+		size_t nNames = 0;
+		size_t nComments = 0;
+		for (const CompactSequenceSet &chunkSet : chunkSets)
+		{
+			nSeqs += chunkSet.size();
+			nNames += chunkSet.names_.size();
+			nComments += chunkSet.comments_.size();
+		}
+		set.names_.reserve(set.names_.size() + nNames);
+		set.comments_.reserve(set.comments_.size() + nComments);
+		set.nameOffsets_.reserve(first + nSeqs + 1);
+		set.commentOffsets_.reserve(first + nSeqs + 1);
+		set.residueOffsets_.reserve(first + nSeqs + 1);
+		uint64_t residuePos = residueBase;
+		for (size_t i=0; i<nChunks; ++i)
+		{
+			CompactSequenceSet &chunkSet = chunkSets[i];
+			uint64_t nResidues = chunkSet.residueOffsets_.back();
+			memmove(&set.residues_[residuePos], &set.residues_[residueBase + (starts[i]-data)], nResidues);
+			set.names_.append(chunkSet.names_);
+			set.comments_.append(chunkSet.comments_);
+			CompactSequenceSet::appendOffsets_(set.nameOffsets_, chunkSet.nameOffsets_);
+			CompactSequenceSet::appendOffsets_(set.commentOffsets_, chunkSet.commentOffsets_);
+			CompactSequenceSet::appendOffsets_(set.residueOffsets_, chunkSet.residueOffsets_);
+			residuePos += nResidues;
+			chunkSet = CompactSequenceSet();
+		}
+		set.residues_.resize(residuePos);
+		if (!remove && !names.empty())
+			checkNames_(names, set, first);
+	}
+
+	/**
+	 * \brief Reads a fasta file and appends the sequences to a set.
+	 * @param inputF The file, it can be uncompressed, BGZF, gzip or bzip2 compressed.
+	 * @param set The set to append the sequences to, a SequenceSet or a CompactSequenceSet.
+	 * @param seqNames The names of the sequences to extract, all sequences are read if empty.
+	 * @param remove If true the sequences in seqNames are skipped instead of extracted.
+	 * @throw std::runtime_error if the file cannot be opened or a sequence of seqNames is not found and remove is false.
+	 * @throw FormatException if the file is a corrupt BGZF file.
+	 */
+	template<typename SetType>
+	void
+	read(const boost::filesystem::path &inputF, SetType &set, const std::vector<std::string> &seqNames = std::vector<std::string>(), bool remove = false) const
+	{
+		boost::iostreams::mapped_file_source file;
+		try
+		{
+			if (boost::filesystem::file_size(inputF) != 0)
+				file.open(inputF.string());
+		}
+		catch (std::exception &e)
+		{
+			throw std::runtime_error("Error: A problem occurred opening '" + inputF.string() + "'.");
+		}
+		const char *data = file.data();
+		size_t size = file.size();
+		if ((size >= 2) && (static_cast<unsigned char>(data[0]) == 0x1f) && (static_cast<unsigned char>(data[1]) == 0x8b))
+		{
+			std::string content = isBgzf(data, size) ? inflateBgzf_(data, size) : decompress_(data, size, boost::iostreams::gzip_decompressor());
+			file.close();
+			parse(content.data(), content.size(), set, seqNames, remove);
+		}
+		else if ((size >= 3) && (data[0] == 'B') && (data[1] == 'Z') && (data[2] == 'h'))
+		{
+			std::string content = decompress_(data, size, boost::iostreams::bzip2_decompressor());
+			file.close();
+			parse(content.data(), content.size(), set, seqNames, remove);
+		}
+		else
+			parse(data, size, set, seqNames, remove);
+	}
+};
+
+}
+
+#endif /* PARALLELFASTAREADER_HPP_ */
@@ -32,14 +32,17 @@
 #include <cstdlib>
 
 // C++ header
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "boost/filesystem.hpp"
 
+#include "IndexedFasta.hpp"
 #include "Sequence.hpp"
 #include "SeqFunctions.hpp"
 
@@ -263,6 +266,16 @@ public:
 	}
 
 
+	/**
+	 * \brief Reserves space for a number of sequences.
+	 * @param n The number of sequences.
+	 */
+	void
+	reserve(size_t n)
+	{
+		sequences_.reserve(n);
+	}
+
 	/**
 	 * \brief Transfers all sequences from another sequence set to the current one.
 	 * @param other The other sequence set
@@ -310,6 +323,19 @@ public:
 	virtual void
 	read(const fs::path &input_f, const std::vector<std::string> &seqNames = std::vector<std::string>(), bool remove = false, const std::string &format = "auto");
 
+	/**
+	 * \brief Reads sequences from an uncompressed fasta file using an index.
+	 * @param input_f The fasta file.
+	 * @param seqNames Sequences to extract.
+	 * @param remove instead of beeing kept, the sequences in seqNames are removed.
+	 * \details Gives the same sequences as read(input_f, seqNames, remove) but only the requested sequences are read
+	 * from the file, they are looked up in the index without going through all its entries. The index (input_f.fai in
+	 * samtools faidx format) is used if it exists and is not older than the fasta file, else it is built in memory, see
+	 * IndexedFasta.
+	 */
+	void
+	readIndexed(const fs::path &input_f, const std::vector<std::string> &seqNames, bool remove = false);
+
 	/**
 	 * \brief Writes the sequence set to a file.
 	 * @param output_f The output file.
@@ -535,6 +561,63 @@ SequenceSet<SequenceType>::read(const fs::path &inputF, const std::vector<std::s
 }
 
 
+template<typename SequenceType>
+void
+SequenceSet<SequenceType>::readIndexed(const fs::path &inputF, const std::vector<std::string> &seqNames, bool remove)
+{
+	IndexedFasta fasta(inputF);
+	std::map<std::string, short> extractNames;
+	for (size_t i=0; i<seqNames.size(); ++i)
+		extractNames[seqNames[i]]=0;
+	std::vector<const FastaIndexEntry *> entries;
+	if (extractNames.empty() || remove)
+	{
+		for (const FastaIndexEntry &entry : fasta.entries())
+			entries.push_back(&entry);
+	}
+	else
+	{
+		// the index cuts names at any whitespace but read() only at a space, the full name is taken from the header
+		std::set<std::string> indexNames;
+		for (const auto &pair : extractNames)
+			indexNames.insert(std::string(pair.first.begin(), std::find_if(pair.first.begin(), pair.first.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); })));
+		for (const std::string &name : indexNames)
+		{
+			std::vector<const FastaIndexEntry *> named = fasta.entries(name);
+			entries.insert(entries.end(), named.begin(), named.end());
+		}
+		// keep the order of the file like read()
+		std::sort(entries.begin(), entries.end(), [](const FastaIndexEntry *a, const FastaIndexEntry *b) { return a->offset < b->offset; });
+	}
+	size_t seqId = sequences_.size()-1;
+	for (const FastaIndexEntry *entry : entries)
+	{
+		std::string header = fasta.header(*entry);
+		std::string::size_type pos = header.find(' ');
+		std::string name = header.substr(0, pos);
+		std::string comment = (pos == std::string::npos) ? "" : header.substr(pos+1);
+		if (!extractNames.empty())
+		{
+			std::map<std::string, short>::iterator it = extractNames.find(name);
+			if ((it == extractNames.end()) != remove)
+				continue;
+			if (!remove)
+				++it->second;
+		}
+		sequences_.emplace_back(std::move(name), fasta.fetch(*entry), "", std::move(comment), ++seqId);
+	}
+
+	if (!remove)
+	{
+		for (auto pair : extractNames)
+		{
+			if (pair.second == 0)
+				throw std::runtime_error("Sequence '" + pair.first + "' not found!");
+		}
+	}
+}
+
+
 template<typename SequenceType>
 void
 SequenceSet<SequenceType>::_write(std::ostream &outF, const std::string &format, size_t linewidth) const
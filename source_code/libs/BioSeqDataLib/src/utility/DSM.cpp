@@ -7,13 +7,16 @@
 
 #include "DSM.hpp"
 
+// Boost header
+#include <boost/iostreams/device/mapped_file.hpp>
+
 namespace BioSeqDataLib
 {
 
 
 using namespace std;
 
-DSM::DSM() : nDomains_(0), threshold_(0), useNegative_(false)
+DSM::DSM() : nDomains_(0), rowIDs_(nullptr), colIDs_(nullptr), values_(nullptr), nValues_(0), threshold_(0), useNegative_(false), sortedRows_(true)
 {
 	// TODO Auto-generated constructor stub
 
@@ -27,97 +30,77 @@ DSM::~DSM()
 void
 DSM::read(const fs::path &inFile)
 {
-	ifstream inF(inFile.string(), ios::in | ios::binary);
-	if (inF.bad())
-		throw std::runtime_error("Error: A problem occurred opening 'inFile'.");
-
-	// read description
-	int descLen;
-	inF.read((char*)&descLen, sizeof(int));
-	description_.resize(descLen+1);
-	inF.read((char*)&description_[0], sizeof(char)*descLen);
-	description_[descLen]='\0';
-
-	// read threshold
-	inF.read((char*)&threshold_, sizeof(short));
-
-	// read domain information
-	inF.read((char*)&nDomains_, sizeof(int));
-	int totNameLength;
-	inF.read((char*)&totNameLength, sizeof(int));
-	string namesS;
-	namesS.resize(totNameLength);
-	inF.read((char*)&namesS[0], sizeof(char)*totNameLength);
-	auto tokens = split(namesS,";");
-
-	for (int i=0; i<nDomains_; ++i)
-		acc2id_.emplace(tokens[i], i);
-
-	size_t nVals;
-	inF.read((char*)&nVals, sizeof(size_t));
-	rowIDs_.resize(nDomains_);
-	colIDs_.resize(nVals);
-	values_.resize(nVals);
-	inF.read((char*)&rowIDs_[0], sizeof(int) * nDomains_);
-	inF.read((char*)&colIDs_[0], sizeof(int) * nVals);
-	inF.read((char*)&values_[0], sizeof(short) * nVals);
-	inF.close();
-}
-
-
-short
-DSM::val(const string &d1, const string &d2) const
-{
-	size_t id1, id2;
+	std::shared_ptr<boost::iostreams::mapped_file_source> file;
 	try
 	{
-		id1 = acc2id_.at(d1);
+		file = std::make_shared<boost::iostreams::mapped_file_source>(inFile.string());
 	}
-	catch (std::out_of_range &e)
+	catch (std::exception &e)
 	{
-		throw std::out_of_range("DSM: Error - " + d1 + " not contained" );
+		throw std::runtime_error("Error: A problem occurred opening '" + inFile.string() + "'.");
 	}
+	const char *pos = file->data();
+	const char *fileEnd = pos + file->size();
 
-	try
+	// returns the next n bytes of the file
+	auto next = [&](size_t n) -> const char *
 	{
-		id2 = acc2id_.at(d2);
-	}
-	catch (std::out_of_range &e)
-	{
-		throw std::out_of_range("DSM: Error - " + d2 + " not contained" );
-	}
+		if (static_cast<size_t>(fileEnd - pos) < n)
+			throw std::runtime_error("DSM: Error - '" + inFile.string() + "' is truncated.");
+		const char *current = pos;
+		pos += n;
+		return current;
+	};
+
+	// everything is parsed into locals first so that a broken file leaves the current matrix untouched
+	int descLen = load_<int>(next(sizeof(int)), 0);
+	std::string description(next(descLen), descLen);
+	description.push_back('\0');
 
-	int posR, posRN, posC;
-
-	// only one half of the matrix is stored, therefore need for checking order.
-	if (id1 < id2)
-	{
-		posR = rowIDs_[id1];
-		posRN =  (++id1 == rowIDs_.size()) ? colIDs_.size() : rowIDs_[id1];
-		posC = id2;
-	}
-	else
-	{
-		posR = rowIDs_[id2];
-		posRN =  (++id2 == rowIDs_.size()) ? colIDs_.size() : rowIDs_[id2];
-		posC = id1;
-	}
+	// read threshold
+	short threshold = load_<short>(next(sizeof(short)), 0);
 
-	// check the colIDs if value is contained.
-	for (int i=posR; i<posRN; ++i)
+	// read domain information
+	int nDomains = load_<int>(next(sizeof(int)), 0);
+	int totNameLength = load_<int>(next(sizeof(int)), 0);
+	auto tokens = split(string(next(totNameLength), totNameLength), ";");
+	if (tokens.size() < static_cast<size_t>(nDomains))
+		throw std::runtime_error("DSM: Error - '" + inFile.string() + "' contains less names than domains.");
+	std::unordered_map<std::string, int> acc2id;
+	acc2id.reserve(nDomains);
+	for (int i=0; i<nDomains; ++i)
+		acc2id.emplace(tokens[i], i);
+
+	size_t nValues = load_<size_t>(next(sizeof(size_t)), 0);
+	const char *rowIDs = next(sizeof(int) * nDomains);
+	const char *colIDs = next(sizeof(int) * nValues);
+	const char *values = next(sizeof(short) * nValues);
+
+	// files written by domainWorld store the columns of a row in increasing order, otherwise val() has to scan the rows
+	bool sortedRows = true;
+	for (int i=0; i<nDomains; ++i)
 	{
-		if (colIDs_[i] == posC)
+		int rowBegin = load_<int>(rowIDs, i);
+		size_t rowEnd = (i+1 == nDomains) ? nValues : load_<int>(rowIDs, i+1);
+		if ((rowBegin < 0) || (static_cast<size_t>(rowBegin) > rowEnd) || (rowEnd > nValues))
+			throw std::runtime_error("DSM: Error - '" + inFile.string() + "' contains invalid row positions.");
+		for (size_t j=rowBegin+1; (j<rowEnd) && sortedRows; ++j)
 		{
-			if (!useNegative_)
-				return values_[i];
-			else
-				return 2*values_[i]-100;
+			if (load_<int>(colIDs, j-1) >= load_<int>(colIDs, j))
+				sortedRows = false;
 		}
 	}
-	if (!useNegative_)
-		return 0;
-	else
-		return -100;
+
+	description_.swap(description);
+	threshold_ = threshold;
+	nDomains_ = nDomains;
+	acc2id_.swap(acc2id);
+	nValues_ = nValues;
+	rowIDs_ = rowIDs;
+	colIDs_ = colIDs;
+	values_ = values;
+	sortedRows_ = sortedRows;
+	data_ = file;
 }
 
 
@@ -13,10 +13,13 @@
 #define SRC_UTILITY_DSM_HPP_
 
 // C++ header
-#include <map>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <fstream>
 
 // Boost header
 #include <boost/filesystem.hpp>
@@ -35,6 +38,9 @@ namespace BioSeqDataLib
  * \brief Class representing a domain similarity matrix (DSM).
  *
  * The domain matrix is stored in CRS format (Compressed Row Storage) to as most values in the file will be around zero. Since the matrix is symmetric only half of it is stored.
+ *
+ * The file is memory mapped, the matrix is not copied into memory. Every domain gets a dense id (its row in the
+ * matrix), lookups by id search the columns of a row with a binary search. Copies of a DSM share the mapping.
  */
 
 class DSM
@@ -42,12 +48,25 @@ class DSM
 private:
 	std::string description_;
 	int nDomains_;
-	std::map<std::string, int> acc2id_; // stores mapping from name (e.g. PF00039) to the row/column position (e.g. 5).
-	std::vector<short> values_; // The values stored in the matrix.
-	std::vector<int> colIDs_; // The column id.
-	std::vector<int> rowIDs_; // The row id.
+	std::unordered_map<std::string, int> acc2id_; // stores mapping from name (e.g. PF00039) to the row/column position (e.g. 5).
+	std::shared_ptr<const void> data_; // keeps the mapped file alive
+	const char *rowIDs_; // The start of every row in colIDs_/values_ (int).
+	const char *colIDs_; // The column id (int).
+	const char *values_; // The values stored in the matrix (short).
+	size_t nValues_;
 	short threshold_;
 	bool useNegative_;
+	bool sortedRows_; // the column ids of every row are sorted (true for all files written by domainWorld)
+
+	// the arrays in the file are not aligned, values are read with memcpy
+	template<typename T>
+	static T
+	load_(const char *array, size_t i)
+	{
+		T value;
+		std::memcpy(&value, array + i*sizeof(T), sizeof(T));
+		return value;
+	}
 
 public:
 	/**
@@ -59,7 +78,7 @@ public:
 	 * \brief Constructor reading matrix from file.
 	 * @param inFile The input file.
 	 */
-	explicit DSM(const fs::path&inFile) : useNegative_(false)
+	explicit DSM(const fs::path&inFile) : DSM()
 	{
 		read(inFile);
 	}
@@ -69,8 +88,99 @@ public:
 	 */
 	virtual ~DSM();
 
+	/**
+	 * \brief Returns the id of a domain.
+	 * @param acc The accession of the domain.
+	 * @return The id (between 0 and nDomains()-1).
+	 * @throw std::out_of_range if the domain is not contained in the matrix.
+	 */
+	int
+	id(const std::string &acc) const
+	{
+		auto it = acc2id_.find(acc);
+		if (it == acc2id_.end())
+			throw std::out_of_range("DSM: Error - " + acc + " not contained" );
+		return it->second;
+	}
+
+	/**
+	 * \brief Returns the number of domains in the matrix.
+	 */
+	int
+	nDomains() const
+	{
+		return nDomains_;
+	}
+
+	/**
+	 * \brief Returns the matching value of two domains given by their ids.
+	 * @param id1 The id of the first domain, see id().
+	 * @param id2 The id of the second domain.
+	 * @return The matching value if stored in matrix, else 0 (-100 if negative values are used).
+	 */
+	short
+	val(int id1, int id2) const
+	{
+		// only one half of the matrix is stored, the row is the smaller id.
+		if (id1 > id2)
+			std::swap(id1, id2);
+		size_t pos = load_<int>(rowIDs_, id1);
+		size_t rowEnd = (id1+1 == nDomains_) ? nValues_ : load_<int>(rowIDs_, id1+1);
+		if (sortedRows_)
+		{
+			size_t end = rowEnd;
+			while (pos < end)
+			{
+				size_t mid = pos + (end-pos)/2;
+				if (load_<int>(colIDs_, mid) < id2)
+					pos = mid+1;
+				else
+					end = mid;
+			}
+		}
+		else
+		{
+			while ((pos < rowEnd) && (load_<int>(colIDs_, pos) != id2))
+				++pos;
+		}
+
+		if ((pos == rowEnd) || (load_<int>(colIDs_, pos) != id2))
+			return useNegative_ ? -100 : 0;
+		short value = load_<short>(values_, pos);
+		return useNegative_ ? 2*value-100 : value;
+	}
+
+	/**
+	 * \brief Calls f(id1, id2, value) for every value stored in the matrix, with id1 <= id2.
+	 * \details The value is the same as returned by val(id1, id2). Pairs that are not stored have the value 0 (-100 if
+	 * negative values are used).
+	 */
+	template<typename Function>
+	void
+	forEachValue(Function f) const
+	{
+		for (int i=0; i<nDomains_; ++i)
+		{
+			size_t rowEnd = (i+1 == nDomains_) ? nValues_ : load_<int>(rowIDs_, i+1);
+			for (size_t j=load_<int>(rowIDs_, i); j<rowEnd; ++j)
+			{
+				short value = load_<short>(values_, j);
+				f(i, load_<int>(colIDs_, j), static_cast<short>(useNegative_ ? 2*value-100 : value));
+			}
+		}
+	}
+
+	/**
+	 * \brief Returns the matching value of two domains given by their accessions.
+	 * @param d1 The first accession.
+	 * @param d2 The second accession.
+	 * @return The matching value if stored in matrix, else 0 (-100 if negative values are used).
+	 */
 	short
-	val(const std::string &d1, const std::string &d2) const;
+	val(const std::string &d1, const std::string &d2) const
+	{
+		return val(id(d1), id(d2));
+	}
 
 	/**
 	 * \brief Returns the matching value of two domains.
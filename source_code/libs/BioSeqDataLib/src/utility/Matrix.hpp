@@ -29,6 +29,7 @@
 #ifndef MATRIX_HPP_
 #define MATRIX_HPP_
 
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 
@@ -36,19 +37,113 @@
 namespace BioSeqDataLib
 {
 
+template<int n, typename DataType>
+class MatrixStack;
+
+/**
+ * \brief A non owning view of a matrix row.
+ * \details Returned by the access operator of Matrix. The view stays valid until the matrix is resized.
+ * \tparam DataType The type of the elements (const for read only access).
+ */
+template<typename DataType>
+class RowSpan
+{
+private:
+	DataType *begin_;
+	size_t size_;
+
+public:
+	typedef DataType* iterator;
+
+	RowSpan(DataType *begin, size_t size) : begin_(begin), size_(size)
+	{}
+
+	/**
+	 * \brief Access operator
+	 * @param index The column to access.
+	 * @return Reference to the field.
+	 */
+	DataType &operator[](size_t index) const
+	{
+		return begin_[index];
+	}
+
+	iterator
+	begin() const
+	{
+		return begin_;
+	}
+
+	iterator
+	end() const
+	{
+		return begin_ + size_;
+	}
+
+	DataType *
+	data() const
+	{
+		return begin_;
+	}
+
+	size_t
+	size() const
+	{
+		return size_;
+	}
+
+	bool
+	empty() const
+	{
+		return size_ == 0;
+	}
+};
+
 
 /**
  * \brief The matrix class.
- * \details Simple two dimensional matrix.
+ * \details Simple two dimensional matrix. The values are stored row-major in a single contiguous block, a row is
+ * accessed as a RowSpan. Resizing to dimensions whose product does not exceed the largest size used so far does not
+ * reallocate, which allows reusing a matrix for many alignments of different sizes.
  * \tparam The data to be stored.
  */
 template<typename DataType>
 class Matrix
 {
 private:
-	std::vector<std::vector<DataType> > matrix_;
+	std::vector<DataType> storage_;
+	DataType *data_;
+	size_t dim1_;
+	size_t dim2_;
+
+	// turns the matrix into a view of memory owned by a MatrixStack, resizing the view detaches it again
+	void
+	view_(DataType *data, size_t dim1, size_t dim2)
+	{
+		std::vector<DataType>().swap(storage_);
+		data_ = data;
+		dim1_ = dim1;
+		dim2_ = dim2;
+	}
+
+	// makes the matrix own at least n cells, the cells of a MatrixStack view are copied into its own memory first
+	void
+	detach_(size_t n)
+	{
+		if (data_ != storage_.data())
+			std::vector<DataType>(data_, data_ + dim1_*dim2_).swap(storage_);
+		if (n > storage_.size())
+			storage_.resize(n);
+		data_ = storage_.data();
+	}
+
+	template<int n, typename T>
+	friend class MatrixStack;
 
 public:
+	typedef DataType* iterator;
+	typedef const DataType* const_iterator;
+
 	/**
 	 * \brief Standard constructor
 	 */
@@ -69,6 +164,26 @@ public:
 	 */
 	Matrix(size_t dim1, size_t dim2, const DataType &init);
 
+	/**
+	 * \brief Copy constructor, copies the values.
+	 */
+	Matrix(const Matrix &other);
+
+	/**
+	 * \brief Move constructor, takes over the memory.
+	 */
+	Matrix(Matrix &&other);
+
+	/**
+	 * \brief Copy assignment, copies the values.
+	 */
+	Matrix &operator=(const Matrix &other);
+
+	/**
+	 * \brief Move assignment, takes over the memory.
+	 */
+	Matrix &operator=(Matrix &&other);
+
 	/**
 	 * \brief Standard destructor
 	 */
@@ -77,21 +192,21 @@ public:
 	/**
 	 * \brief Access operator
 	 * @param index The index to acess.
-	 * @return Reference to the field.
+	 * @return The row.
 	 */
-	std::vector<DataType> &operator[](unsigned int index)
+	RowSpan<DataType> operator[](size_t index)
 	{
-		return matrix_[index];
+		return RowSpan<DataType>(data_ + index*dim2_, dim2_);
 	}
 
 	/**
 	 * \brief Access operator
 	 * @param index The index to acess.
-	 * @return Reference to the field.
+	 * @return The row.
 	 */
-	const std::vector<DataType> &operator[](unsigned int index) const
+	RowSpan<const DataType> operator[](size_t index) const
 	{
-		return matrix_[index];
+		return RowSpan<const DataType>(data_ + index*dim2_, dim2_);
 	}
 
 	/**
@@ -101,7 +216,7 @@ public:
 	size_t
 	dim1() const
 	{
-		return matrix_.size();
+		return dim1_;
 	}
 
 	/**
@@ -111,42 +226,92 @@ public:
 	size_t
 	dim2() const
 	{
-		if (!matrix_.empty())
-			return matrix_[0].size();
-		return 0;
+		return dim2_;
+	}
+
+	/**
+	 * \brief Returns the number of cells that can be used without reallocation.
+	 * @return The number of cells.
+	 */
+	size_t
+	capacity() const
+	{
+		return storage_.size();
 	}
 
 	/**
 	 * \brief Resizes the matrix.
+	 * \details Memory is only allocated if the matrix has more cells than ever before. If one of the dimensions
+	 * changes the values of the matrix are unspecified afterwards. A matrix of a MatrixStack is detached from the stack
+	 * and gets its own memory, its values are kept if the dimensions do not change.
 	 * @param dim1 New size of the first dimension.
 	 * @param dim2 New size of the second dimension.
 	 */
 	void
 	resize(size_t dim1, size_t dim2)
 	{
-		size_t i;
-		matrix_.resize(dim1);
-		for (i=0; i<dim1; ++i)
-			matrix_[i].resize(dim2);
+		detach_(dim1*dim2);
+		dim1_ = dim1;
+		dim2_ = dim2;
+	}
+
+	/**
+	 * \brief Allocates the memory for a matrix of the given size without changing the dimensions or the values.
+	 * \details If memory is allocated for a matrix of a MatrixStack, the matrix is detached from the stack and its
+	 * values are copied into its own memory.
+	 * @param dim1 The size of the first dimension.
+	 * @param dim2 The size of the second dimension.
+	 */
+	void
+	reserve(size_t dim1, size_t dim2)
+	{
+		if (dim1*dim2 > storage_.size())
+			detach_(dim1*dim2);
+	}
+
+	/**
+	 * \brief Returns a pointer to the first cell, the cells are stored row-major.
+	 */
+	DataType *
+	data()
+	{
+		return data_;
 	}
 
-	typename std::vector<DataType>::iterator
+	const DataType *
+	data() const
+	{
+		return data_;
+	}
+
+	iterator
 	begin()
 	{
-		return matrix_.begin();
+		return data_;
 	}
 
-	typename std::vector<DataType>::iterator
+	iterator
 	it(size_t diff)
 	{
-		return (matrix_.begin()+diff);
+		return data_+diff;
 	}
 
-
-	typename std::vector<DataType>::iterator
+	iterator
 	end()
 	{
-		return matrix_.end();
+		return data_ + dim1_*dim2_;
+	}
+
+	const_iterator
+	begin() const
+	{
+		return data_;
+	}
+
+	const_iterator
+	end() const
+	{
+		return data_ + dim1_*dim2_;
 	}
 
 	/**
@@ -159,17 +324,78 @@ public:
 
 
 template<typename DataType>
-Matrix<DataType>::Matrix():matrix_()
+Matrix<DataType>::Matrix():storage_(), data_(nullptr), dim1_(0), dim2_(0)
 {}
 
 template<typename DataType>
-Matrix<DataType>::Matrix(size_t dim1, size_t dim2):matrix_(std::vector<std::vector<DataType> >(dim1, std::vector<DataType>(dim2)))
+Matrix<DataType>::Matrix(size_t dim1, size_t dim2):storage_(dim1*dim2), data_(storage_.data()), dim1_(dim1), dim2_(dim2)
 {}
 
 template<typename DataType>
-Matrix<DataType>::Matrix(size_t dim1, size_t dim2, const DataType &init):matrix_(std::vector<std::vector<DataType> >(dim1, std::vector<DataType>(dim2, init)))
+Matrix<DataType>::Matrix(size_t dim1, size_t dim2, const DataType &init):storage_(dim1*dim2, init), data_(storage_.data()), dim1_(dim1), dim2_(dim2)
 {}
 
+template<typename DataType>
+Matrix<DataType>::Matrix(const Matrix &other):storage_(other.begin(), other.end()), data_(storage_.data()), dim1_(other.dim1_), dim2_(other.dim2_)
+{}
+
+template<typename DataType>
+Matrix<DataType>::Matrix(Matrix &&other):storage_(), data_(other.data_), dim1_(other.dim1_), dim2_(other.dim2_)
+{
+	if (other.data_ == other.storage_.data())
+	{
+		storage_.swap(other.storage_);
+		data_ = storage_.data();
+	}
+	else
+	{
+		storage_.assign(other.begin(), other.end());
+		data_ = storage_.data();
+	}
+	other.data_ = nullptr;
+	other.dim1_ = other.dim2_ = 0;
+}
+
+template<typename DataType>
+Matrix<DataType> &
+Matrix<DataType>::operator=(const Matrix &other)
+{
+	if (this != &other)
+	{
+		if ((data_ != storage_.data()) && (dim1_*dim2_ == other.dim1_*other.dim2_))
+		{
+			// views keep pointing into the memory of their stack
+			std::copy(other.begin(), other.end(), data_);
+			dim1_ = other.dim1_;
+			dim2_ = other.dim2_;
+		}
+		else
+		{
+			resize(other.dim1_, other.dim2_);
+			std::copy(other.begin(), other.end(), data_);
+		}
+	}
+	return *this;
+}
+
+template<typename DataType>
+Matrix<DataType> &
+Matrix<DataType>::operator=(Matrix &&other)
+{
+	if ((this != &other) && (data_ == storage_.data()) && (other.data_ == other.storage_.data()))
+	{
+		storage_.swap(other.storage_);
+		data_ = storage_.data();
+		dim1_ = other.dim1_;
+		dim2_ = other.dim2_;
+		other.data_ = other.storage_.data();
+		other.dim1_ = other.dim2_ = 0;
+	}
+	else
+		*this = static_cast<const Matrix &>(other);
+	return *this;
+}
+
 template<typename DataType>
 Matrix<DataType>::~Matrix()
 {}
@@ -179,15 +405,7 @@ template<typename DataType>
 void
 Matrix<DataType>::fill(const DataType &value)
 {
-	size_t j;
-	size_t dim2, dim1=matrix_.size();
-	if (dim1)
-		dim2 = matrix_[0].size();
-	for (size_t i=0; i<dim1; ++i)
-	{
-		for (j=0; j<dim2; ++j)
-			matrix_[i][j] = value;
-	}
+	std::fill(begin(), end(), value);
 }
 
 } // namespace BioSeqDataLib
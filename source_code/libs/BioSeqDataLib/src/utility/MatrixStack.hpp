@@ -29,6 +29,7 @@
 #ifndef MATRIXSTACK_HPP_
 #define MATRIXSTACK_HPP_
 
+#include <algorithm>
 #include <vector>
 
 #include "Matrix.hpp"
@@ -38,6 +39,8 @@ namespace BioSeqDataLib
 
 /**
  * \brief Class to store multiple matrices.
+ * \details All matrices share a single allocation, matrix k starts directly behind matrix k-1. Like Matrix the stack
+ * only allocates memory if it has to store more cells than ever before.
  * \tparam n The number of matrices.
  * \tparam DataType The type to store.
  */
@@ -46,7 +49,19 @@ class MatrixStack
 {
 
 private:
-	std::vector<Matrix<DataType> > _stack;
+	std::vector<DataType> _storage;
+	Matrix<DataType> _stack[n];
+	size_t _dim1;
+	size_t _dim2;
+
+	// points the matrices to their part of the storage
+	void
+	_attach()
+	{
+		size_t size = _dim1*_dim2;
+		for (size_t i=0; i<n; ++i)
+			_stack[i].view_(_storage.data() + i*size, _dim1, _dim2);
+	}
 
 public:
 
@@ -70,17 +85,41 @@ public:
 	 */
 	MatrixStack(size_t dim1, size_t dim2, const DataType &init);
 
+	/**
+	 * \brief Copy constructor, copies the values.
+	 */
+	MatrixStack(const MatrixStack &other);
+
+	/**
+	 * \brief Copy assignment, copies the values.
+	 */
+	MatrixStack &operator=(const MatrixStack &other);
+
 
 	/**
 	 * \brief Resizes all matrices in the stack to the new dimensions.
+	 * \details If one of the dimensions changes the values of the matrices are unspecified afterwards.
 	 * @param dim1 New size of the first dimension.
 	 * @param dim2 New size of the second dimension.
 	 */
 	void
 	resize(size_t dim1, size_t dim2)
 	{
-		for (size_t i=0; i<n; ++i)
-			_stack[i].resize(dim1, dim2);
+		if (n*dim1*dim2 > _storage.size())
+			_storage.resize(n*dim1*dim2);
+		_dim1 = dim1;
+		_dim2 = dim2;
+		_attach();
+	}
+
+	/**
+	 * \brief Returns the number of cells (of all matrices) that can be used without reallocation.
+	 * @return The number of cells.
+	 */
+	size_t
+	capacity() const
+	{
+		return _storage.size();
 	}
 
 	/**
@@ -109,7 +148,7 @@ public:
 	 */
 	size_t dim1() const
 	{
-		return _stack[0].dim1();
+		return _dim1;
 	}
 
 	/**
@@ -118,23 +157,47 @@ public:
 	 */
 	size_t dim2() const
 	{
-		return _stack[0].dim2();
+		return _dim2;
 	}
 
 };
 
 
 template<int n, typename DataType>
-MatrixStack<n, DataType>::MatrixStack():_stack(3, Matrix<DataType>())
-{}
+MatrixStack<n, DataType>::MatrixStack():_storage(), _dim1(0), _dim2(0)
+{
+	_attach();
+}
+
+template<int n, typename DataType>
+MatrixStack<n, DataType>::MatrixStack(size_t dim1, size_t dim2):_storage(n*dim1*dim2), _dim1(dim1), _dim2(dim2)
+{
+	_attach();
+}
+
+template<int n, typename DataType>
+MatrixStack<n, DataType>::MatrixStack(size_t dim1, size_t dim2, const DataType &init) :_storage(n*dim1*dim2, init), _dim1(dim1), _dim2(dim2)
+{
+	_attach();
+}
 
 template<int n, typename DataType>
-MatrixStack<n, DataType>::MatrixStack(size_t dim1, size_t dim2):_stack(3, Matrix<DataType>(dim1, dim2))
-{}
+MatrixStack<n, DataType>::MatrixStack(const MatrixStack &other):_storage(other._storage.begin(), other._storage.begin() + n*other._dim1*other._dim2), _dim1(other._dim1), _dim2(other._dim2)
+{
+	_attach();
+}
 
 template<int n, typename DataType>
-MatrixStack<n, DataType>::MatrixStack(size_t dim1, size_t dim2, const DataType &init) :_stack(3, Matrix<DataType>(dim1, dim2, init))
-{}
+MatrixStack<n, DataType> &
+MatrixStack<n, DataType>::operator=(const MatrixStack &other)
+{
+	if (this != &other)
+	{
+		resize(other._dim1, other._dim2);
+		std::copy(other._storage.begin(), other._storage.begin() + n*_dim1*_dim2, _storage.begin());
+	}
+	return *this;
+}
 
 }
 
@@ -0,0 +1,227 @@
+/*
+ * PackedMatrix.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file PackedMatrix.hpp
+ * \brief File containing the PackedMatrix class.
+ */
+#ifndef PACKEDMATRIX_HPP_
+#define PACKEDMATRIX_HPP_
+
+#include <cstdlib>
+#include <vector>
+
+
+namespace BioSeqDataLib
+{
+
+
+/**
+ * \brief A matrix of small unsigned values packed into bytes.
+ * \details Used as traceback plane of the dynamic programming algorithms, e.g. a direction in two bits per cell. The
+ * rows are stored one after another, every row starts at a byte boundary. Like Matrix the memory is only reallocated
+ * if the matrix needs more bytes than ever before.
+ * \tparam bits The number of bits per cell (1, 2, 4 or 8).
+ */
+template<unsigned int bits>
+class PackedMatrix
+{
+	static_assert((bits == 1) || (bits == 2) || (bits == 4) || (bits == 8), "bits has to be 1, 2, 4 or 8");
+
+private:
+	std::vector<unsigned char> storage_;
+	size_t dim1_;
+	size_t dim2_;
+	size_t rowBytes_;
+
+public:
+	/// The number of cells stored in a byte.
+	static const unsigned int cellsPerByte = 8/bits;
+
+	/// The largest value a cell can store.
+	static const unsigned int mask = (1u << bits) - 1;
+
+	/**
+	 * \brief Writes the cells of a row one after another, starting with column 0.
+	 */
+	class RowWriter
+	{
+	private:
+		unsigned char *pos_;
+		unsigned char byte_;
+		unsigned int shift_;
+
+	public:
+		explicit RowWriter(unsigned char *row) : pos_(row), byte_(0), shift_(0)
+		{}
+
+		/**
+		 * \brief Appends a cell.
+		 * @param value The value of the cell.
+		 */
+		void
+		push(unsigned int value)
+		{
+			byte_ |= static_cast<unsigned char>(value << shift_);
+			shift_ += bits;
+			if (shift_ == 8)
+			{
+				*pos_++ = byte_;
+				byte_ = 0;
+				shift_ = 0;
+			}
+		}
+
+		/**
+		 * \brief Writes the last, partially filled byte. Has to be called after the last cell of the row.
+		 */
+		void
+		flush()
+		{
+			if (shift_ != 0)
+				*pos_ = byte_;
+		}
+	};
+
+	/**
+	 * \brief Standard constructor
+	 */
+	PackedMatrix() : storage_(), dim1_(0), dim2_(0), rowBytes_(0)
+	{}
+
+	/**
+	 * \brief Constructor initialising to a certain size, all cells are 0.
+	 * @param dim1 The size of the first dimension.
+	 * @param dim2 The size of the second dimension.
+	 */
+	PackedMatrix(size_t dim1, size_t dim2) : storage_(dim1*((dim2 + cellsPerByte - 1)/cellsPerByte), 0), dim1_(dim1), dim2_(dim2), rowBytes_((dim2 + cellsPerByte - 1)/cellsPerByte)
+	{}
+
+	/**
+	 * \brief Resizes the matrix.
+	 * \details Memory is only allocated if the matrix needs more bytes than ever before. If one of the dimensions
+	 * changes the values of the matrix are unspecified afterwards.
+	 * @param dim1 New size of the first dimension.
+	 * @param dim2 New size of the second dimension.
+	 */
+	void
+	resize(size_t dim1, size_t dim2)
+	{
+		dim1_ = dim1;
+		dim2_ = dim2;
+		rowBytes_ = (dim2 + cellsPerByte - 1)/cellsPerByte;
+		if (dim1*rowBytes_ > storage_.size())
+			storage_.resize(dim1*rowBytes_);
+	}
+
+	/**
+	 * \brief Returns the value of a cell.
+	 * @param i The row.
+	 * @param j The column.
+	 * @return The value.
+	 */
+	unsigned int
+	get(size_t i, size_t j) const
+	{
+		return value(row(i), j);
+	}
+
+	/**
+	 * \brief Sets the value of a cell.
+	 * @param i The row.
+	 * @param j The column.
+	 * @param value The value (at most mask).
+	 */
+	void
+	set(size_t i, size_t j, unsigned int value)
+	{
+		unsigned char &byte = row(i)[j/cellsPerByte];
+		unsigned int shift = (j%cellsPerByte)*bits;
+		byte = static_cast<unsigned char>((byte & ~(mask << shift)) | (value << shift));
+	}
+
+	/**
+	 * \brief Returns the value of a cell of a packed row.
+	 * @param row The row as returned by row().
+	 * @param j The column.
+	 * @return The value.
+	 */
+	static unsigned int
+	value(const unsigned char *row, size_t j)
+	{
+		return (row[j/cellsPerByte] >> ((j%cellsPerByte)*bits)) & mask;
+	}
+
+	/**
+	 * \brief Returns the packed bytes of a row.
+	 * @param i The row.
+	 * @return Pointer to the first byte of the row.
+	 */
+	unsigned char *
+	row(size_t i)
+	{
+		return storage_.data() + i*rowBytes_;
+	}
+
+	const unsigned char *
+	row(size_t i) const
+	{
+		return storage_.data() + i*rowBytes_;
+	}
+
+	/**
+	 *  \brief Returns the size of the first dimension.
+	 * @return The size of the first dimension.
+	 */
+	size_t
+	dim1() const
+	{
+		return dim1_;
+	}
+
+	/**
+	 *  \brief Returns the size of the second dimension.
+	 * @return The size of the second dimension.
+	 */
+	size_t
+	dim2() const
+	{
+		return dim2_;
+	}
+
+	/**
+	 * \brief Returns the number of bytes that can be used without reallocation.
+	 * @return The number of bytes.
+	 */
+	size_t
+	capacity() const
+	{
+		return storage_.size();
+	}
+};
+
+template<unsigned int bits>
+const unsigned int PackedMatrix<bits>::cellsPerByte;
+
+template<unsigned int bits>
+const unsigned int PackedMatrix<bits>::mask;
+
+} // namespace BioSeqDataLib
+
+#endif /* PACKEDMATRIX_HPP_ */
@@ -0,0 +1,204 @@
+/*
+ * TriangularMatrix.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file TriangularMatrix.hpp
+ * \brief File containing the TriangularMatrix class.
+ */
+#ifndef TRIANGULARMATRIX_HPP_
+#define TRIANGULARMATRIX_HPP_
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "Matrix.hpp"
+
+
+namespace BioSeqDataLib
+{
+
+
+/**
+ * \brief A symmetric matrix without diagonal, e.g. a distance matrix.
+ * \details Only the strictly lower triangle is stored, row after row: row i contains the cells (i,0) ... (i,i-1). A
+ * matrix of dimension n therefore needs n*(n-1)/2 cells, half of a full Matrix. Growing the matrix keeps the values
+ * of the existing rows.
+ * \tparam DataType The type of the values.
+ */
+template<typename DataType>
+class TriangularMatrix
+{
+private:
+	std::vector<DataType> values_;
+	size_t dim_;
+
+public:
+	/**
+	 * \brief Standard constructor
+	 */
+	TriangularMatrix() : values_(), dim_(0)
+	{}
+
+	/**
+	 * \brief Constructor initialising to a certain size.
+	 * @param dim The number of rows (and columns).
+	 * @param value The value of all cells.
+	 */
+	explicit TriangularMatrix(size_t dim, const DataType &value = DataType()) : values_(dim*(dim-1)/2, value), dim_(dim)
+	{}
+
+	/**
+	 * \brief Constructor copying the lower triangle of a full matrix.
+	 * @param mat The matrix, it has to be quadratic.
+	 */
+	explicit TriangularMatrix(const Matrix<DataType> &mat) : TriangularMatrix(mat.dim1())
+	{
+		for (size_t i=1; i<dim_; ++i)
+			std::copy(mat[i].begin(), mat[i].begin()+i, row(i));
+	}
+
+	TriangularMatrix(const TriangularMatrix &other) = default;
+
+	/**
+	 * \brief Move constructor, the other matrix is left empty.
+	 */
+	TriangularMatrix(TriangularMatrix &&other) noexcept : values_(std::move(other.values_)), dim_(other.dim_)
+	{
+		other.values_.clear();
+		other.dim_ = 0;
+	}
+
+	TriangularMatrix &
+	operator=(const TriangularMatrix &other) = default;
+
+	TriangularMatrix &
+	operator=(TriangularMatrix &&other) noexcept
+	{
+		values_ = std::move(other.values_);
+		dim_ = other.dim_;
+		other.values_.clear();
+		other.dim_ = 0;
+		return *this;
+	}
+
+	/**
+	 * \brief Resizes the matrix, the values of the rows that already existed are kept.
+	 * @param dim The new number of rows (and columns).
+	 * @param value The value of new cells.
+	 */
+	void
+	resize(size_t dim, const DataType &value = DataType())
+	{
+		values_.resize(dim*(dim-1)/2, value);
+		dim_ = dim;
+	}
+
+	/**
+	 * \brief Returns the position of a cell in data().
+	 * @param i The row.
+	 * @param j The column, has to be different from i.
+	 */
+	static size_t
+	index(size_t i, size_t j)
+	{
+		if (i < j)
+			std::swap(i, j);
+		return i*(i-1)/2 + j;
+	}
+
+	/**
+	 * \brief Access to the cell (i,j), which is the same as (j,i).
+	 * @param i The row.
+	 * @param j The column, has to be different from i.
+	 */
+	DataType &
+	operator()(size_t i, size_t j)
+	{
+		return values_[index(i, j)];
+	}
+
+	const DataType &
+	operator()(size_t i, size_t j) const
+	{
+		return values_[index(i, j)];
+	}
+
+	/**
+	 * \brief Returns the stored part of row i, the cells (i,0) ... (i,i-1).
+	 * @param i The row.
+	 */
+	DataType *
+	row(size_t i)
+	{
+		return values_.data() + i*(i-1)/2;
+	}
+
+	const DataType *
+	row(size_t i) const
+	{
+		return values_.data() + i*(i-1)/2;
+	}
+
+	/**
+	 * \brief Sets all cells to a value.
+	 * @param value The value.
+	 */
+	void
+	fill(const DataType &value)
+	{
+		std::fill(values_.begin(), values_.end(), value);
+	}
+
+	/**
+	 * \brief Returns the number of rows (and columns).
+	 */
+	size_t
+	dim() const
+	{
+		return dim_;
+	}
+
+	/**
+	 * \brief Returns the number of stored cells.
+	 */
+	size_t
+	size() const
+	{
+		return values_.size();
+	}
+
+	DataType *
+	data()
+	{
+		return values_.data();
+	}
+
+	const DataType *
+	data() const
+	{
+		return values_.data();
+	}
+};
+
+
+} // namespace BioSeqDataLib
+
+#endif /* TRIANGULARMATRIX_HPP_ */
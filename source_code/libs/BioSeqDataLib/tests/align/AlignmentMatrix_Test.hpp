@@ -29,6 +29,8 @@
 
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <random>
+#include <string>
 #include <utility>
 
 #include "../../src/sequence/Sequence.hpp"
@@ -146,6 +148,462 @@ BOOST_AUTO_TEST_CASE( gotoh_align_Test )
 	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS2.begin(), result.eS2.end(), expected2.begin(), expected2.end());
 }
 
+// score of an alignment with affine gap costs, gaps at the ends of the sequences have no opening costs (as in gotoh)
+float
+gotohEditScore(const BioSeqDataLib::Sequence<> &seq1, const BioSeqDataLib::Sequence<> &seq2, const BioSeqDataLib::EditSequence &es,
+	const BioSeqDataLib::SimilarityMatrix<float> &simMat, float gop, float gep)
+{
+	float score = 0;
+	size_t pos1 = 0, pos2 = 0;
+	char previous = 'm';
+	for (size_t k = 0; k < es.size(); ++k)
+	{
+		if (es.eS2[k] == -1)
+		{
+			if ((previous != 'v') && (pos2 != 0) && (pos2 != seq2.size()))
+				score += gop;
+			score += gep;
+			previous = 'v';
+			++pos1;
+		}
+		else if (es.eS1[k] == -1)
+		{
+			if ((previous != 'h') && (pos1 != 0) && (pos1 != seq1.size()))
+				score += gop;
+			score += gep;
+			previous = 'h';
+			++pos2;
+		}
+		else
+		{
+			score += simMat.val(seq1[es.eS1[k]], seq2[es.eS2[k]]);
+			previous = 'm';
+			++pos1;
+			++pos2;
+		}
+	}
+	return score;
+}
+
+BOOST_AUTO_TEST_CASE( gotoh_linear_align_Test )
+{
+	BioSeqDataLib::Sequence<> seq1("seq1", "LMLDSGSEPKLIAEPLXPQGPYELSDETLQAPVLNDEGTEAVFELLSNAVEV", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq2("seq2", "LLDSKLIAEPLPPQGPYELSDETLQAPVLNDEGTEAVFELLSNAVEVTGKEPLP", "", "test sequence");
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(-11, -1, simMat);
+	mat.gotoh(seq1, seq2);
+	float expectedScore = mat.score();
+	BioSeqDataLib::EditSequence expected = mat.result();
+
+	mat.gotoh_linear(seq1, seq2);
+	BOOST_CHECK_EQUAL(mat.score(), expectedScore);
+	auto result = mat.result();
+	BOOST_CHECK_EQUAL(result.start1, 0);
+	BOOST_CHECK_EQUAL(result.start2, 0);
+	BOOST_CHECK_EQUAL(result.end1, 51);
+	BOOST_CHECK_EQUAL(result.end2, 53);
+	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS1.begin(), result.eS1.end(), expected.eS1.begin(), expected.eS1.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS2.begin(), result.eS2.end(), expected.eS2.begin(), expected.eS2.end());
+}
+
+BOOST_AUTO_TEST_CASE( gotoh_linear_random_Test )
+{
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 400);
+	std::uniform_int_distribution<int> event(0, 9);
+
+	for (unsigned int round = 0; round < 40; ++round)
+	{
+		std::string s1, s2;
+		size_t len = length(rng);
+		for (size_t i = 0; i < len; ++i)
+			s1.push_back(alphabet[residue(rng)]);
+		// every second pair is related, with substitutions and indels
+		for (char c : s1)
+		{
+			int e = event(rng);
+			if ((round % 2) || (e == 0))
+				c = alphabet[residue(rng)];
+			if (e == 1)
+				s2.append(1 + residue(rng) % 7, alphabet[residue(rng)]);
+			if (e != 2)
+				s2.push_back(c);
+		}
+		if (s2.empty())
+			s2 = "W";
+		BioSeqDataLib::Sequence<> seq1("seq1", s1, "", "");
+		BioSeqDataLib::Sequence<> seq2("seq2", s2, "", "");
+		float gop = (round % 3 == 0) ? 0 : -10;
+		float gep = (round % 4 == 0) ? -4 : -1;
+
+		BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> reference(gop, gep, simMat);
+		reference.gotoh(seq1, seq2);
+		BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(gop, gep, simMat);
+		mat.gotoh_linear(seq1, seq2);
+		BOOST_CHECK_EQUAL(mat.score(), reference.score());
+
+		// the alignment has to contain every residue once and in order and to have the reported score
+		const BioSeqDataLib::EditSequence &result = mat.result();
+		long int next1 = 0, next2 = 0;
+		for (size_t k = 0; k < result.size(); ++k)
+		{
+			BOOST_REQUIRE((result.eS1[k] != -1) || (result.eS2[k] != -1));
+			if (result.eS1[k] != -1)
+				BOOST_REQUIRE_EQUAL(result.eS1[k], next1++);
+			if (result.eS2[k] != -1)
+				BOOST_REQUIRE_EQUAL(result.eS2[k], next2++);
+		}
+		BOOST_CHECK_EQUAL(next1, seq1.size());
+		BOOST_CHECK_EQUAL(next2, seq2.size());
+		BOOST_CHECK_EQUAL(gotohEditScore(seq1, seq2, result, simMat, gop, gep), reference.score());
+		BOOST_CHECK_EQUAL(gotohEditScore(seq1, seq2, reference.result(), simMat, gop, gep), reference.score());
+	}
+}
+
+BOOST_AUTO_TEST_CASE( banded_align_Test )
+{
+	BioSeqDataLib::Sequence<> seq1("seq1", "LMLDSGSEPKLIAEPLXPQGPYELSDETLQAPVLNDEGTEAVFELLSNAVEV", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq2("seq2", "LLDSKLIAEPLPPQGPYELSDETLQAPVLNDEGTEAVFELLSNAVEVTGKEPLP", "", "test sequence");
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(-11, -1, simMat);
+	mat.gotoh(seq1, seq2);
+	float expectedScore = mat.score();
+	BioSeqDataLib::EditSequence expected = mat.result();
+	BOOST_CHECK(mat.gotoh_banded(seq1, seq2, 1));
+	BOOST_CHECK_EQUAL(mat.score(), expectedScore);
+	auto result = mat.result();
+	BOOST_CHECK_EQUAL(result.end1, 51);
+	BOOST_CHECK_EQUAL(result.end2, 53);
+	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS1.begin(), result.eS1.end(), expected.eS1.begin(), expected.eS1.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS2.begin(), result.eS2.end(), expected.eS2.begin(), expected.eS2.end());
+
+	mat.gep(-3);
+	mat.nw(seq1, seq2);
+	expectedScore = mat.score();
+	expected = mat.result();
+	BOOST_CHECK(mat.nw_banded(seq1, seq2, 1));
+	BOOST_CHECK_EQUAL(mat.score(), expectedScore);
+	result = mat.result();
+	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS1.begin(), result.eS1.end(), expected.eS1.begin(), expected.eS1.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS2.begin(), result.eS2.end(), expected.eS2.begin(), expected.eS2.end());
+
+	// the optimal alignment shifts one sequence by 20 positions, a band of 4 cannot contain it and the score cannot be
+	// confirmed, an initial band of 32 contains it
+	BioSeqDataLib::Sequence<> seq3("seq3", "WWWWWWWWWWWWWWWWWWWWQGPYELSDETLQAPVLNDEGTEAVFE", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq4("seq4", "QGPYELSDETLQAPVLNDEGTEAVFEPPPPPPPPPPPPPPPPPPPP", "", "test sequence");
+	mat.gop(-11);
+	mat.gep(-1);
+	mat.gotoh(seq3, seq4);
+	expectedScore = mat.score();
+	BOOST_CHECK(!mat.gotoh_banded(seq3, seq4, 2, 4));
+	BOOST_CHECK_LT(mat.score(), expectedScore);
+	BOOST_CHECK(mat.gotoh_banded(seq3, seq4, 32));
+	BOOST_CHECK_EQUAL(mat.score(), expectedScore);
+}
+
+BOOST_AUTO_TEST_CASE( banded_random_Test )
+{
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 300);
+	std::uniform_int_distribution<int> event(0, 99);
+
+	for (unsigned int round = 0; round < 40; ++round)
+	{
+		std::string s1, s2;
+		size_t len = length(rng);
+		for (size_t i = 0; i < len; ++i)
+			s1.push_back(alphabet[residue(rng)]);
+		// close orthologs with 15% mutations, every fourth pair with 60%
+		int rate = (round % 4 == 0) ? 60 : 15;
+		for (char c : s1)
+		{
+			int e = event(rng);
+			if (e < rate/3)
+				continue;
+			if (e < 2*rate/3)
+				s2.push_back(alphabet[residue(rng)]);
+			s2.push_back((e < rate) ? alphabet[residue(rng)] : c);
+		}
+		if (s2.empty())
+			s2 = "W";
+		BioSeqDataLib::Sequence<> seq1("seq1", s1, "", "");
+		BioSeqDataLib::Sequence<> seq2("seq2", s2, "", "");
+		float gop = (round % 3 == 0) ? 0 : -10;
+		float gep = (round % 2 == 0) ? -2 : -1;
+
+		BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> reference(gop, gep, simMat);
+		BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(gop, gep, simMat);
+		reference.gotoh(seq1, seq2);
+		BOOST_CHECK(mat.gotoh_banded(seq1, seq2, 4));
+		BOOST_CHECK_EQUAL(mat.score(), reference.score());
+		BOOST_CHECK(mat.result().eS1 == reference.result().eS1);
+		BOOST_CHECK(mat.result().eS2 == reference.result().eS2);
+
+		reference.nw(seq1, seq2);
+		BOOST_CHECK(mat.nw_banded(seq1, seq2, 4));
+		BOOST_CHECK_EQUAL(mat.score(), reference.score());
+		BOOST_CHECK(mat.result().eS1 == reference.result().eS1);
+		BOOST_CHECK(mat.result().eS2 == reference.result().eS2);
+
+		// without dropping cells the X-drop extension is the best scoring alignment of two prefixes
+		reference.gotoh_xdrop(seq1, seq2, 1000000);
+		if (mat.gotoh_xdrop(seq1, seq2, 40))
+		{
+			BOOST_CHECK_EQUAL(mat.score(), reference.score());
+			BOOST_CHECK(mat.result().eS1 == reference.result().eS1);
+			BOOST_CHECK(mat.result().eS2 == reference.result().eS2);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( banded_bound_Test )
+{
+	// a narrow band on unrelated sequences, a confirmed result has to be the optimal one
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+	BioSeqDataLib::Sequence<> seq1("seq1", "NIIGMLTHSKCEWQPFARLVPFTIPMEGEFKKLKISYKWCHWH", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq2("seq2", "QRDDYMAFGEWCMFLNHVGCELVGVIAVVDQLNNKKILR", "", "test sequence");
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> reference(0, -2, simMat);
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(0, -2, simMat);
+	reference.gotoh(seq1, seq2);
+	BOOST_CHECK_EQUAL(reference.score(), 12);
+	BOOST_CHECK(!mat.gotoh_banded(seq1, seq2, 4, 4));
+	BOOST_CHECK_LE(mat.score(), reference.score());
+	BOOST_CHECK(mat.gotoh_banded(seq1, seq2, 4));
+	BOOST_CHECK_EQUAL(mat.score(), reference.score());
+
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::mt19937 rng(17);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 60);
+	for (unsigned int round = 0; round < 500; ++round)
+	{
+		std::string s1, s2;
+		size_t len1 = length(rng);
+		size_t len2 = length(rng);
+		for (size_t i = 0; i < len1; ++i)
+			s1.push_back(alphabet[residue(rng)]);
+		for (size_t i = 0; i < len2; ++i)
+			s2.push_back(alphabet[residue(rng)]);
+		BioSeqDataLib::Sequence<> rand1("seq1", s1, "", "");
+		BioSeqDataLib::Sequence<> rand2("seq2", s2, "", "");
+		float gop = (round % 3 == 0) ? 0 : -10;
+		float gep = (round % 2 == 0) ? -2 : -1;
+		reference.gop(gop);
+		reference.gep(gep);
+		mat.gop(gop);
+		mat.gep(gep);
+		size_t maxBand = (round % 4 == 0) ? 0 : 8;
+
+		reference.gotoh(rand1, rand2);
+		if (mat.gotoh_banded(rand1, rand2, 1, maxBand))
+			BOOST_CHECK_EQUAL(mat.score(), reference.score());
+		else
+			BOOST_CHECK_LE(mat.score(), reference.score());
+		BOOST_CHECK_EQUAL(gotohEditScore(rand1, rand2, mat.result(), simMat, gop, gep), mat.score());
+
+		reference.nw(rand1, rand2);
+		if (mat.nw_banded(rand1, rand2, 1, maxBand))
+			BOOST_CHECK_EQUAL(mat.score(), reference.score());
+		else
+			BOOST_CHECK_LE(mat.score(), reference.score());
+	}
+}
+
+BOOST_AUTO_TEST_CASE( xdrop_align_Test )
+{
+	BioSeqDataLib::Sequence<> seq1("seq1", "QGPYELSDETLQAPVLNDEGTEAVFEWWWWWWWWWWWWWWWWWWWW", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq2("seq2", "QGPYELSDDTLQAPVLNDEGTEAVFEPPPPPPPPPPPPPPPPPPPP", "", "test sequence");
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(-11, -1, simMat);
+	// the extension ends with the related region, the unrelated rest is dropped
+	BOOST_CHECK(!mat.gotoh_xdrop(seq1, seq2, 20));
+	auto result = mat.result();
+	BOOST_CHECK_EQUAL(result.start1, 0);
+	BOOST_CHECK_EQUAL(result.start2, 0);
+	BOOST_CHECK_EQUAL(result.end1, 25);
+	BOOST_CHECK_EQUAL(result.end2, 25);
+	BOOST_CHECK_EQUAL(result.size(), 26);
+	BOOST_CHECK_EQUAL(mat.score(), 131);
+
+	BioSeqDataLib::Sequence<> seq3("seq3", "QGPYELSDETLQAPVLNDEGTEAVFE", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq4("seq4", "QGPYELSDDTLQAPVLNDEGTEAVFE", "", "test sequence");
+	BOOST_CHECK(mat.gotoh_xdrop(seq3, seq4, 20));
+	BOOST_CHECK_EQUAL(mat.score(), 131);
+	BOOST_CHECK_EQUAL(mat.result().size(), 26);
+}
+
+BOOST_AUTO_TEST_CASE( xdrop_random_Test )
+{
+	// the extension is never better than the exact one and identical to it if it is confirmed
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::mt19937 rng(23);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 80);
+	std::uniform_int_distribution<int> event(0, 99);
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> reference(-10, -1, simMat);
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(-10, -1, simMat);
+	for (unsigned int round = 0; round < 200; ++round)
+	{
+		std::string s1, s2;
+		size_t len = length(rng);
+		for (size_t i = 0; i < len; ++i)
+			s1.push_back(alphabet[residue(rng)]);
+		for (char c : s1)
+			s2.push_back((event(rng) < 40) ? alphabet[residue(rng)] : c);
+		BioSeqDataLib::Sequence<> seq1("seq1", s1, "", "");
+		BioSeqDataLib::Sequence<> seq2("seq2", s2, "", "");
+		BOOST_CHECK(reference.gotoh_xdrop(seq1, seq2, 1000000));
+		for (float xDrop : {5, 10, 20})
+		{
+			if (mat.gotoh_xdrop(seq1, seq2, xDrop))
+				BOOST_CHECK_EQUAL(mat.score(), reference.score());
+			else
+				BOOST_CHECK_LE(mat.score(), reference.score());
+			// a prefix alignment ending in (end1, end2)
+			auto result = mat.result();
+			int next1 = 0, next2 = 0;
+			for (size_t k = 0; k < result.size(); ++k)
+			{
+				if (result.eS1[k] != -1)
+					BOOST_REQUIRE_EQUAL(result.eS1[k], next1++);
+				if (result.eS2[k] != -1)
+					BOOST_REQUIRE_EQUAL(result.eS2[k], next2++);
+			}
+			if (result.size() != 0)
+			{
+				BOOST_CHECK_EQUAL(next1, result.end1+1);
+				BOOST_CHECK_EQUAL(next2, result.end2+1);
+			}
+		}
+	}
+
+	// the unrelated middle part drops all cells, the path through them recovers with the identical end
+	BioSeqDataLib::Sequence<> seq5("seq5", "QGPYELSDPPPPPPWWWWWWWW", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq6("seq6", "QGPYELSDGGGGGGWWWWWWWW", "", "test sequence");
+	reference.gotoh_xdrop(seq5, seq6, 1000000);
+	BOOST_CHECK(!mat.gotoh_xdrop(seq5, seq6, 10));
+	BOOST_CHECK_LT(mat.score(), reference.score());
+
+	// no extension scores above 0
+	BioSeqDataLib::Sequence<> seq3("seq3", "WWWW", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq4("seq4", "PPPP", "", "test sequence");
+	mat.gotoh_xdrop(seq3, seq4, 20);
+	BOOST_CHECK_EQUAL(mat.score(), 0);
+	auto result = mat.result();
+	BOOST_CHECK_EQUAL(result.size(), 0);
+	BOOST_CHECK_EQUAL(result.end1, 0);
+	BOOST_CHECK_EQUAL(result.end2, 0);
+}
+
+BOOST_AUTO_TEST_CASE( reuse_matrix_Test )
+{
+	// the matrices are reused without clearing them, the results have to be the same as with fresh ones
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 120);
+
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> mat(-10, -1, simMat);
+	for (unsigned int round = 0; round < 30; ++round)
+	{
+		std::string s1, s2;
+		size_t len1 = length(rng);
+		size_t len2 = length(rng);
+		for (size_t i = 0; i < len1; ++i)
+			s1.push_back(alphabet[residue(rng)]);
+		for (size_t i = 0; i < len2; ++i)
+			s2.push_back((i < len1) && (i % 3 != 0) ? s1[i] : alphabet[residue(rng)]);
+		BioSeqDataLib::Sequence<> seq1("seq1", s1, "", "");
+		BioSeqDataLib::Sequence<> seq2("seq2", s2, "", "");
+
+		BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> fresh(-10, -1, simMat);
+		fresh.nw(seq1, seq2);
+		mat.nw(seq1, seq2);
+		BOOST_CHECK_EQUAL(mat.score(), fresh.score());
+		BOOST_CHECK(mat.result().eS1 == fresh.result().eS1);
+		BOOST_CHECK(mat.result().eS2 == fresh.result().eS2);
+
+		BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> freshGotoh(-10, -1, simMat);
+		freshGotoh.gotoh(seq1, seq2);
+		mat.gotoh(seq1, seq2);
+		BOOST_CHECK_EQUAL(mat.score(), freshGotoh.score());
+		BOOST_CHECK(mat.result().eS1 == freshGotoh.result().eS1);
+		BOOST_CHECK(mat.result().eS2 == freshGotoh.result().eS2);
+
+		BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> freshSw(-3, simMat);
+		freshSw.simd(false);
+		freshSw.sw(seq1, seq2);
+		mat.simd(false);
+		mat.gep(-3);
+		mat.sw(seq1, seq2);
+		mat.gep(-1);
+		BOOST_CHECK_EQUAL(mat.score(), freshSw.score());
+		BOOST_CHECK(mat.result().eS1 == freshSw.result().eS1);
+		BOOST_CHECK(mat.result().eS2 == freshSw.result().eS2);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( score_only_Test )
+{
+	// the score-only variants have to return the same scores (and SW end positions) as the full algorithms
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::mt19937 rng(23);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(0, 120);
+
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> full(-10, -1, simMat);
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float>> scoreOnly(-10, -1, simMat);
+	for (unsigned int round = 0; round < 40; ++round)
+	{
+		std::string s1, s2;
+		size_t len1 = length(rng);
+		size_t len2 = length(rng);
+		for (size_t i = 0; i < len1; ++i)
+			s1.push_back(alphabet[residue(rng)]);
+		for (size_t i = 0; i < len2; ++i)
+			s2.push_back((i < len1) && (i % 4 != 0) ? s1[i] : alphabet[residue(rng)]);
+		BioSeqDataLib::Sequence<> seq1("seq1", s1, "", "");
+		BioSeqDataLib::Sequence<> seq2("seq2", s2, "", "");
+
+		full.gep(-1);
+		scoreOnly.gep(-1);
+		full.nw(seq1, seq2);
+		BOOST_CHECK_EQUAL(scoreOnly.nw_score(seq1, seq2), full.score());
+		BOOST_CHECK_EQUAL(scoreOnly.score(), full.score());
+		full.gotoh(seq1, seq2);
+		BOOST_CHECK_EQUAL(scoreOnly.gotoh_score(seq1, seq2), full.score());
+
+		full.gep(-3);
+		scoreOnly.gep(-3);
+		for (bool simd : {false, true})
+		{
+			full.simd(simd);
+			scoreOnly.simd(simd);
+			full.sw(seq1, seq2);
+			size_t end1, end2;
+			BOOST_CHECK_EQUAL(scoreOnly.sw_score(seq1, seq2, end1, end2), full.score());
+			if (full.score() > 0)
+			{
+				BOOST_CHECK_EQUAL(end1, full.result().end1);
+				BOOST_CHECK_EQUAL(end2, full.result().end2);
+			}
+		}
+	}
+	BOOST_CHECK_THROW(scoreOnly.result(), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE( Gotoh_alignDomain_Test2 )
 {
 	BioSeqDataLib::Settings settings;
@@ -264,6 +722,28 @@ BOOST_AUTO_TEST_CASE(sw_align_test )
 	BOOST_CHECK_EQUAL_COLLECTIONS(result.eS2.begin(), result.eS2.end(), expected2.begin(), expected2.end());
 }
 
+BOOST_AUTO_TEST_CASE(sw_no_match_test )
+{
+	// no pair has a positive score, the alignment is empty
+	BioSeqDataLib::Sequence<> seq1("seq1", "WWWWWW", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq2("seq2", "PPPP", "", "test sequence");
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+
+	BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float> > mat(-3, simMat);
+	for (bool simd : {true, false})
+	{
+		mat.simd(simd);
+		mat.sw(seq1, seq2);
+		BOOST_CHECK_EQUAL(mat.score(), 0);
+		auto result = mat.result();
+		BOOST_CHECK_EQUAL(result.size(), 0);
+		BOOST_CHECK_EQUAL(result.start1, 0);
+		BOOST_CHECK_EQUAL(result.start2, 0);
+		BOOST_CHECK_EQUAL(result.end1, 0);
+		BOOST_CHECK_EQUAL(result.end2, 0);
+	}
+}
+
 /*
 BOOST_AUTO_TEST_CASE(raspodom_align_domain_test )
 {
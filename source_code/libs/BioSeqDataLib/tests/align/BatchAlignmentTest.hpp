@@ -0,0 +1,178 @@
+/*
+ * BatchAlignmentTest.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BATCHALIGNMENTTEST_HPP_
+#define BATCHALIGNMENTTEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+#include <map>
+#include <random>
+#include <string>
+
+#include "../../src/sequence/Sequence.hpp"
+#include "../../src/sequence/SequenceSet.hpp"
+#include "../../src/utility/SimilarityMatrix.hpp"
+#include "../../src/align/AlignmentMatrix.hpp"
+#include "../../src/align/BatchAlignment.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(BatchAlignment_Test)
+
+typedef BioSeqDataLib::SimilarityMatrix<float> BatchSimMat;
+
+BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> >
+randomSet(std::mt19937 &rng, size_t nSeqs, const std::string &prefix)
+{
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 80);
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+	for (size_t i = 0; i < nSeqs; ++i)
+	{
+		std::string seq;
+		size_t len = length(rng);
+		for (size_t j = 0; j < len; ++j)
+			seq.push_back(alphabet[residue(rng)]);
+		set.emplace_back(prefix + std::to_string(i), seq, "", "");
+	}
+	return set;
+}
+
+BOOST_AUTO_TEST_CASE( batch_sequence_Test )
+{
+	BatchSimMat simMat("../tests/align/data/BLOSUM62.txt");
+	std::mt19937 rng(5);
+	auto queries = randomSet(rng, 7, "q");
+	auto targets = randomSet(rng, 11, "t");
+
+	BioSeqDataLib::BatchAlgorithm algorithms[] = {BioSeqDataLib::BatchAlgorithm::NW, BioSeqDataLib::BatchAlgorithm::Gotoh, BioSeqDataLib::BatchAlgorithm::SW};
+	for (auto algorithm : algorithms)
+	{
+		float gop = -10;
+		float gep = (algorithm == BioSeqDataLib::BatchAlgorithm::Gotoh) ? -1 : -3;
+		BioSeqDataLib::AlignmentMatrix<float, BatchSimMat> single(gop, gep, simMat);
+		for (unsigned int nThreads : {1u, 3u})
+		{
+			BioSeqDataLib::BatchAligner<float, BatchSimMat> aligner(algorithm, gop, gep, simMat, nThreads);
+			BioSeqDataLib::AlignmentTable<float> table;
+			aligner.align(queries, targets, table, true);
+			BOOST_REQUIRE_EQUAL(table.nQueries(), queries.size());
+			BOOST_REQUIRE_EQUAL(table.nTargets(), targets.size());
+			for (size_t q = 0; q < queries.size(); ++q)
+			{
+				for (size_t t = 0; t < targets.size(); ++t)
+				{
+					if (algorithm == BioSeqDataLib::BatchAlgorithm::NW)
+						single.nw(queries[q], targets[t]);
+					else if (algorithm == BioSeqDataLib::BatchAlgorithm::Gotoh)
+						single.gotoh(queries[q], targets[t]);
+					else
+						single.sw(queries[q], targets[t]);
+					BOOST_CHECK_EQUAL(table.score(q, t), single.score());
+					BOOST_CHECK(table.alignment(q, t).eS1 == single.result().eS1);
+					BOOST_CHECK(table.alignment(q, t).eS2 == single.result().eS2);
+				}
+			}
+
+			// a second run reuses the workspaces and only computes the scores
+			BioSeqDataLib::AlignmentTable<float> scoreTable;
+			aligner.align(targets, queries, scoreTable);
+			BOOST_REQUIRE_EQUAL(scoreTable.nQueries(), targets.size());
+			BOOST_REQUIRE_EQUAL(scoreTable.nTargets(), queries.size());
+			for (size_t q = 0; q < queries.size(); ++q)
+			{
+				for (size_t t = 0; t < targets.size(); ++t)
+					BOOST_CHECK_EQUAL(scoreTable.score(t, q), table.score(q, t));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( batch_threads_Test )
+{
+	// enough pairs for every thread to get several chunks of the dynamic schedule
+	BatchSimMat simMat("../tests/align/data/BLOSUM62.txt");
+	std::mt19937 rng(13);
+	auto queries = randomSet(rng, 30, "q");
+	auto targets = randomSet(rng, 40, "t");
+
+#ifdef _OPENMP
+	size_t nUsed = 0;
+	#pragma omp parallel num_threads(4)
+	{
+		#pragma omp single
+		nUsed = omp_get_num_threads();
+	}
+	BOOST_CHECK_GT(nUsed, 1);
+#else
+	BOOST_TEST_MESSAGE("Compiled without OpenMP, the threaded alignments run serially.");
+#endif
+
+	BioSeqDataLib::BatchAligner<float, BatchSimMat> serial(BioSeqDataLib::BatchAlgorithm::Gotoh, -10, -1, simMat, 1);
+	BioSeqDataLib::AlignmentTable<float> expected;
+	serial.align(queries, targets, expected, true);
+	BioSeqDataLib::BatchAligner<float, BatchSimMat> parallel(BioSeqDataLib::BatchAlgorithm::Gotoh, -10, -1, simMat, 4);
+	BOOST_CHECK_EQUAL(parallel.threads(), 4);
+	BioSeqDataLib::AlignmentTable<float> table;
+	parallel.align(queries, targets, table, true);
+	for (size_t q = 0; q < queries.size(); ++q)
+	{
+		for (size_t t = 0; t < targets.size(); ++t)
+		{
+			BOOST_CHECK_EQUAL(table.score(q, t), expected.score(q, t));
+			BOOST_CHECK(table.alignment(q, t).eS1 == expected.alignment(q, t).eS1);
+			BOOST_CHECK(table.alignment(q, t).eS2 == expected.alignment(q, t).eS2);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( batch_map_Test )
+{
+	BatchSimMat simMat("../tests/align/data/BLOSUM62.txt");
+	std::mt19937 rng(9);
+	auto set = randomSet(rng, 5, "s");
+	std::map<std::string, BioSeqDataLib::Sequence<> > named;
+	for (const auto &seq : set)
+		named.emplace(seq.name(), seq);
+
+	BioSeqDataLib::BatchAligner<float, BatchSimMat> aligner(BioSeqDataLib::BatchAlgorithm::Gotoh, -10, -1, simMat, 2);
+	BioSeqDataLib::AlignmentTable<float> table;
+	aligner.align(named, named, table);
+	BOOST_REQUIRE_EQUAL(table.scores().size(), 25);
+
+	BioSeqDataLib::AlignmentMatrix<float, BatchSimMat> single(-10, -1, simMat);
+	size_t q = 0;
+	for (const auto &query : named)
+	{
+		size_t t = 0;
+		for (const auto &target : named)
+		{
+			single.gotoh(query.second, target.second);
+			BOOST_CHECK_EQUAL(table.score(q, t), single.score());
+			++t;
+		}
+		++q;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif /* BATCHALIGNMENTTEST_HPP_ */
@@ -0,0 +1,171 @@
+/*
+ * SwStripedTest.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TESTS_ALIGN_SWSTRIPEDTEST_HPP_
+#define TESTS_ALIGN_SWSTRIPEDTEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/sequence/Sequence.hpp"
+#include "../../src/utility/SimilarityMatrix.hpp"
+#include "../../src/align/AlignmentMatrix.hpp"
+#include "../../src/align/sw_striped.hpp"
+
+BOOST_AUTO_TEST_SUITE(SW_Striped_Test)
+
+typedef BioSeqDataLib::AlignmentMatrix<float, BioSeqDataLib::SimilarityMatrix<float> > SwMatrix;
+
+std::vector<BioSeqDataLib::SimdLevel>
+availableSimdLevels()
+{
+	std::vector<BioSeqDataLib::SimdLevel> levels;
+	if (BioSeqDataLib::simdLevel() != BioSeqDataLib::SimdLevel::None)
+		levels.push_back(BioSeqDataLib::SimdLevel::SSE2);
+	if (BioSeqDataLib::simdLevel() == BioSeqDataLib::SimdLevel::AVX2)
+		levels.push_back(BioSeqDataLib::SimdLevel::AVX2);
+	return levels;
+}
+
+std::string
+mutateSequence(const std::string &seq, const std::string &alphabet, std::mt19937 &rng)
+{
+	std::uniform_int_distribution<int> event(0, 19);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::string mutated;
+	for (char c : seq)
+	{
+		int e = event(rng);
+		if (e == 0)
+			continue;
+		if (e == 1)
+			mutated.push_back(alphabet[residue(rng)]);
+		mutated.push_back((e == 2) ? alphabet[residue(rng)] : c);
+	}
+	return mutated;
+}
+
+float
+editScore(const BioSeqDataLib::Sequence<> &seq1, const BioSeqDataLib::Sequence<> &seq2, const BioSeqDataLib::EditSequence &es, const BioSeqDataLib::SimilarityMatrix<float> &simMat, float gep)
+{
+	float score = 0;
+	for (size_t i = 0; i < es.size(); ++i)
+	{
+		if ((es.eS1[i] == -1) || (es.eS2[i] == -1))
+			score += gep;
+		else
+			score += simMat.val(seq1[es.eS1[i]], seq2[es.eS2[i]]);
+	}
+	return score;
+}
+
+BOOST_AUTO_TEST_CASE( SW_striped_example_Test )
+{
+	BioSeqDataLib::Sequence<> seq1("seq1", "WWWWWWWWWWQGPYELSDTLQAPVLNDEWGTEAVFELLSNAVWWWWWWWWWWWWW", "", "test sequence");
+	BioSeqDataLib::Sequence<> seq2("seq2", "PPPPPPPPPPPQGPYELSDDTNQAPVLNDEGTEAVFELLSNAVPPPPPPPPPPPP", "", "test sequence");
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+
+	SwMatrix mat(-3, simMat);
+	mat.simd(false);
+	mat.sw(seq1, seq2);
+	for (auto level : availableSimdLevels())
+	{
+		BioSeqDataLib::StripedSwHit hit;
+		BOOST_REQUIRE(BioSeqDataLib::swStripedHit(seq1, seq2, simMat, 0.0f, -3.0f, hit, level));
+		BOOST_CHECK_EQUAL(hit.score, mat.score());
+		BOOST_CHECK_EQUAL(hit.start1, 10);
+		BOOST_CHECK_EQUAL(hit.start2, 11);
+		BOOST_CHECK_EQUAL(hit.end1, 41);
+		BOOST_CHECK_EQUAL(hit.end2, 42);
+	}
+
+	// scores or gaps that are no integers are not supported
+	BioSeqDataLib::StripedSwHit hit;
+	BOOST_CHECK(!BioSeqDataLib::swStripedScore(seq1, seq2, simMat, 0.0f, -2.5f, hit));
+	BOOST_CHECK(!BioSeqDataLib::swStripedScore(seq1, seq2, simMat, 0.0f, 0.0f, hit));
+}
+
+BOOST_AUTO_TEST_CASE( SW_striped_random_Test )
+{
+	BioSeqDataLib::SimilarityMatrix<float> simMat("../tests/align/data/BLOSUM62.txt");
+	const std::string alphabet = "ARNDCQEGHILKMFPSTWYV";
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<size_t> residue(0, alphabet.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 300);
+
+	for (unsigned int round = 0; round < 60; ++round)
+	{
+		std::string s1;
+		size_t len = (round == 59) ? 3000 : length(rng);
+		for (size_t i = 0; i < len; ++i)
+			s1.push_back((round == 59) ? 'W' : alphabet[residue(rng)]);
+		// unrelated pairs give small scores (8-bit kernel), related pairs large ones (16-bit kernel or fallback)
+		std::string s2 = (round % 2) ? mutateSequence(s1, alphabet, rng) : std::string(length(rng), 'A');
+		if (round % 4 == 0)
+		{
+			for (auto &c : s2)
+				c = alphabet[residue(rng)];
+		}
+		BioSeqDataLib::Sequence<> seq1("seq1", s1, "", "");
+		BioSeqDataLib::Sequence<> seq2("seq2", s2, "", "");
+		float gep = (round % 3 == 0) ? -1 : -4;
+
+		SwMatrix reference(gep, simMat);
+		reference.simd(false);
+		reference.sw(seq1, seq2);
+		const BioSeqDataLib::EditSequence &expected = reference.result();
+
+		for (auto level : availableSimdLevels())
+		{
+			BioSeqDataLib::StripedSwHit hit;
+			if (!BioSeqDataLib::swStripedScore(seq1, seq2, simMat, 0.0f, gep, hit, level))
+			{
+				// only possible if the score does not fit into 16 bit
+				BOOST_CHECK_GT(reference.score(), 32000);
+				continue;
+			}
+			BOOST_CHECK_EQUAL(hit.score, reference.score());
+			if (reference.score() > 0)
+			{
+				BOOST_CHECK_EQUAL(hit.end1, expected.end1);
+				BOOST_CHECK_EQUAL(hit.end2, expected.end2);
+			}
+		}
+
+		SwMatrix mat(gep, simMat);
+		mat.sw(seq1, seq2);
+		BOOST_CHECK_EQUAL(mat.score(), reference.score());
+		if (reference.score() > 0)
+		{
+			const BioSeqDataLib::EditSequence &result = mat.result();
+			BOOST_CHECK_EQUAL(result.end1, expected.end1);
+			BOOST_CHECK_EQUAL(result.end2, expected.end2);
+			BOOST_CHECK_EQUAL(result.eS1.back(), expected.end1);
+			BOOST_CHECK_EQUAL(result.eS2.back(), expected.end2);
+			BOOST_CHECK_EQUAL(editScore(seq1, seq2, result, simMat, gep), reference.score());
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+#endif /* TESTS_ALIGN_SWSTRIPEDTEST_HPP_ */
@@ -28,5 +28,7 @@
 
 #include "NwGotohTest.hpp"
 #include "SwTest.hpp"
+#include "SwStripedTest.hpp"
 #include "msaTest.hpp"
 #include "AlignmentMatrix_Test.hpp"
+#include "BatchAlignmentTest.hpp"
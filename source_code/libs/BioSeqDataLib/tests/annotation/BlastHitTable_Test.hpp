@@ -0,0 +1,146 @@
+/*
+ * BlastHitTable_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BLASTHITTABLE_TEST_HPP_
+#define BLASTHITTABLE_TEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+#include "../../src/annotation/BlastHitTable.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(BlastHitTable_Test)
+
+
+BOOST_AUTO_TEST_CASE( BlastHitTable_TestRead)
+{
+	BioSeqDataLib::BlastHitTable table;
+	table.read("../tests/annotation/data/BlastHits.txt");
+	BOOST_CHECK_EQUAL(table.size(), 95);
+	BOOST_CHECK_EQUAL(table.nQueries(), 2);
+
+	// the same values as BlastHit
+	std::ifstream inS("../tests/annotation/data/BlastHits.txt");
+	std::string line;
+	size_t hitId = 0;
+	while (std::getline(inS, line))
+	{
+		if (line.empty() || (line[0] == '#'))
+			continue;
+		BioSeqDataLib::BlastHit expected(line);
+		BioSeqDataLib::BlastHit hit = table.hit(hitId++);
+		BOOST_CHECK_EQUAL(hit.queryID, expected.queryID);
+		BOOST_CHECK_EQUAL(hit.subjectID, expected.subjectID);
+		BOOST_CHECK_CLOSE(hit.percentIdentity, expected.percentIdentity, 0.0001);
+		BOOST_CHECK_EQUAL(hit.alignmentLength, expected.alignmentLength);
+		BOOST_CHECK_EQUAL(hit.nMismatches, expected.nMismatches);
+		BOOST_CHECK_EQUAL(hit.nGapOpenings, expected.nGapOpenings);
+		BOOST_CHECK_EQUAL(hit.queryStart, expected.queryStart);
+		BOOST_CHECK_EQUAL(hit.queryEnd, expected.queryEnd);
+		BOOST_CHECK_EQUAL(hit.queryStrand, expected.queryStrand);
+		BOOST_CHECK_EQUAL(hit.subjectStart, expected.subjectStart);
+		BOOST_CHECK_EQUAL(hit.subjectEnd, expected.subjectEnd);
+		BOOST_CHECK_EQUAL(hit.subjectStrand, expected.subjectStrand);
+		BOOST_CHECK_EQUAL(hit.eValue, expected.eValue);
+		BOOST_CHECK_EQUAL(hit.HSPBitScore, expected.HSPBitScore);
+	}
+	BOOST_CHECK_EQUAL(hitId, 95);
+	BOOST_CHECK_EQUAL(table.subjectName(table.subject(5)), "scaffold979");
+	BOOST_CHECK_EQUAL(table.subjectStrand(5), '-');
+
+	table.read("../tests/annotation/data/BlastResult.txt");
+	BOOST_CHECK_EQUAL(table.nQueries(), 2);
+	uint32_t queryId = table.queryId("gnl|em|testQuery");
+	BOOST_REQUIRE_EQUAL(queryId, 1);
+	BOOST_CHECK_EQUAL(table.hitsEnd(queryId) - table.hitsBegin(queryId), 2);
+	BOOST_CHECK_EQUAL(table.subjectName(table.subject(table.hitsBegin(queryId))), "gnl|em|test1");
+	BOOST_CHECK_EQUAL(table.queryId("gnl|em|test1"), BioSeqDataLib::BlastHitTable::npos);
+	BOOST_CHECK_THROW(table.read("../tests/annotation/data/nonexisting.txt"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( BlastHitTable_TestBest)
+{
+	// q1 occurs twice, the windows line break and the missing line break at the end are intended
+	std::string content = "# comment\n"
+			"q1\ts1\t90.0\t100\t10\t0\t1\t100\t1\t100\t1e-10\t50\r\n"
+			"q1\ts2\t90.0\t100\t10\t0\t1\t100\t200\t101\t1e-20\t80\n"
+			"q1\ts3\t90.0\t100\t10\t0\t1\t100\t1\t100\t1e-30\t80\n"
+			"\n"
+			"q2\ts1\t90.0\t100\t10\t0\t100\t1\t1\t100\t1e-5\t20\n"
+			"q1\ts4\t90.0\t100\t10\t0\t1\t100\t1\t100\t0.0\t100\textra";
+	BioSeqDataLib::BlastHitTable table;
+	table.parse(content.data(), content.size());
+	BOOST_CHECK_EQUAL(table.size(), 5);
+	BOOST_CHECK_EQUAL(table.nSubjects(), 4);
+	BOOST_CHECK_EQUAL(table.hitsEnd(0), 4);
+	BOOST_CHECK_EQUAL(table.subjectName(table.subject(3)), "s4");
+	BOOST_CHECK_EQUAL(table.queryName(table.query(4)), "q2");
+	BOOST_CHECK_EQUAL(table.queryStrand(4), '-');
+	BOOST_CHECK_EQUAL(table.queryStart(4), 0);
+	BOOST_CHECK_EQUAL(table.queryEnd(4), 99);
+	BOOST_CHECK_EQUAL(table.subjectStrand(1), '-');
+	BOOST_CHECK_EQUAL(table.subjectStart(1), 100);
+
+	table.parse(content.data(), content.size(), 2);
+	BOOST_CHECK_EQUAL(table.size(), 3);
+	BOOST_CHECK_EQUAL(table.hitsBegin(1), 2);
+	BOOST_CHECK_EQUAL(table.subjectName(table.subject(0)), "s3");
+	BOOST_CHECK_EQUAL(table.subjectName(table.subject(1)), "s4");
+	BOOST_CHECK_EQUAL(table.queryName(table.query(2)), "q2");
+
+	table.parse(content.data(), content.size(), 1);
+	BOOST_CHECK_EQUAL(table.size(), 2);
+	BOOST_CHECK_EQUAL(table.subjectName(table.subject(0)), "s4");
+
+	content = "q1\ts1\t90.0\t100\t10\t0\t1\t100\t1\t100\t1e-10\n";
+	BOOST_CHECK_THROW(table.parse(content.data(), content.size()), std::runtime_error);
+	content = "q1\ts1\t90.0\t100\t10\t0\t0\t100\t1\t100\t1e-10\t50\n";
+	BOOST_CHECK_THROW(table.parse(content.data(), content.size()), std::runtime_error);
+	table.parse(content.data(), 0);
+	BOOST_CHECK(table.empty());
+	BOOST_CHECK_EQUAL(table.nQueries(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( BlastHitTable_TestCopy)
+{
+	std::string content = "q1\ts1\t90.0\t100\t10\t0\t1\t100\t1\t100\t1e-10\t50\n"
+			"a_query_name_longer_than_sso\ta_subject_name_longer_than_sso\t90.0\t100\t10\t0\t1\t100\t1\t100\t1e-10\t50\n";
+	BioSeqDataLib::BlastHitTable *table = new BioSeqDataLib::BlastHitTable();
+	table->parse(content.data(), content.size());
+	BioSeqDataLib::BlastHitTable copy(*table);
+	BioSeqDataLib::BlastHitTable assigned;
+	assigned = *table;
+	delete table;
+	for (const BioSeqDataLib::BlastHitTable *t : {&copy, &assigned})
+	{
+		BOOST_CHECK_EQUAL(t->queryId("q1"), 0);
+		BOOST_CHECK_EQUAL(t->queryId("a_query_name_longer_than_sso"), 1);
+		BOOST_CHECK_EQUAL(t->subjectId("a_subject_name_longer_than_sso"), 1);
+		BOOST_CHECK_EQUAL(t->queryId("q2"), BioSeqDataLib::BlastHitTable::npos);
+	}
+	BioSeqDataLib::BlastHitTable moved(std::move(copy));
+	BOOST_CHECK_EQUAL(moved.subjectId("s1"), 0);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+
+#endif /* BLASTHITTABLE_TEST_HPP_ */
@@ -0,0 +1,137 @@
+/*
+ * GffReader_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GFFREADER_TEST_HPP_
+#define GFFREADER_TEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+#include "../../src/annotation/GffReader.hpp"
+#include "../../src/annotation/FeatureIndex.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(GffReader_Test)
+
+
+BOOST_AUTO_TEST_CASE( GffReader_TestRead)
+{
+	BioSeqDataLib::GffReader reader("../tests/annotation/data/Test.gff");
+	BioSeqDataLib::GffRecord record;
+	std::ifstream gffStream("../tests/annotation/data/Test.gff");
+	std::string line;
+	std::getline(gffStream, line);
+	size_t nRecords = 0;
+	while (reader.next(record))
+	{
+		std::getline(gffStream, line);
+		BioSeqDataLib::Feature feature(line);
+		BOOST_CHECK(record.feature() == feature);
+		BOOST_CHECK_EQUAL(record.seqId(), feature.seqId_);
+		BOOST_CHECK_EQUAL(record.start(), feature.start_);
+		BOOST_CHECK_EQUAL(record.end(), feature.end_);
+		BOOST_CHECK_EQUAL(record.strand(), feature.strand_);
+		BOOST_CHECK_EQUAL(record.phase(), feature.phase_);
+		BOOST_CHECK_EQUAL(record.attribute("ID"), feature.attribute("ID"));
+		BOOST_CHECK_EQUAL(record.parents().size(), feature.parents_.size());
+		++nRecords;
+	}
+	BOOST_CHECK_EQUAL(nRecords, 51);
+	BOOST_CHECK_EQUAL(reader.lineNumber(), 53);
+
+	std::string content = "##gff-version 3.1.26\r\n# comment\n\nchr1\tsrc\tmRNA\t10\t20\t0.5\t-\t.\tID=m1;Parent=g1,g2;Note=a=b\r\n##FASTA\n>chr1\nACGT\n";
+	reader.open(content.data(), content.size());
+	BOOST_REQUIRE(reader.next(record));
+	BOOST_CHECK_EQUAL(record.type(), "mRNA");
+	BOOST_CHECK_EQUAL(record.start(), 9);
+	BOOST_CHECK_EQUAL(record.end(), 19);
+	BOOST_CHECK_CLOSE(record.score(), 0.5, 0.0001);
+	BOOST_CHECK_EQUAL(record.phase(), -1);
+	BOOST_CHECK_EQUAL(record.attribute("Note"), "a=b");
+	BOOST_CHECK_EQUAL(record.attributes(), "ID=m1;Parent=g1,g2;Note=a=b");
+	BOOST_CHECK(!record.hasAttribute("Name"));
+	BOOST_CHECK_THROW(record.attribute("I"), std::out_of_range);
+	auto parents = record.parents();
+	BOOST_REQUIRE_EQUAL(parents.size(), 2);
+	BOOST_CHECK_EQUAL(parents[1], "g2");
+	BOOST_CHECK(!reader.next(record));
+
+	content = "##gff-version 3\nchr1\tsrc\tmRNA\t10\tx\t.\t-\t.\tID=m1\n";
+	reader.open(content.data(), content.size());
+	BOOST_CHECK_THROW(reader.next(record), BioSeqDataLib::FormatException);
+	content = "chr1\tsrc\tmRNA\t10\t20\t.\t-\t.\tID=m1\n";
+	BOOST_CHECK_THROW(reader.open(content.data(), content.size()), BioSeqDataLib::FormatException);
+	BOOST_CHECK_THROW(reader.open("../tests/annotation/data/nonexisting.gff"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( FeatureIndex_Test)
+{
+	BioSeqDataLib::FeatureIndex index;
+	index.read("../tests/annotation/data/Test.gff");
+	BOOST_CHECK_EQUAL(index.size(), 51);
+	BOOST_CHECK_EQUAL(index.nSeqIds(), 3);
+	BOOST_CHECK_EQUAL(index.seqIdName(1), "pbar_scf7180000348467");
+	BOOST_CHECK_EQUAL(index.counts("mRNA"), 5);
+	BOOST_CHECK_EQUAL(index.counts("tRNA"), 0);
+
+	// sorted by start
+	auto range = index.features(index.seqId("pbar_scf7180000350264"));
+	BOOST_CHECK_EQUAL(range.second - range.first, 38);
+	BOOST_CHECK_EQUAL(index.record(range.first).attribute("ID"), "PB18753");
+	for (size_t i=range.first+1; i<range.second; ++i)
+		BOOST_CHECK(index.start(i-1) <= index.start(i));
+
+	auto hits = index.overlap("pbar_scf7180000350264", 165231, 165231);
+	BOOST_REQUIRE_EQUAL(hits.size(), 4);
+	BOOST_CHECK_EQUAL(index.record(hits[3]).attribute("ID"), "PB18752-RA:cds1");
+	hits = index.overlap("pbar_scf7180000348142", 300, 400);
+	BOOST_CHECK_EQUAL(hits.size(), 5);
+	hits = index.overlap("pbar_scf7180000348142", 300, 400, "mRNA");
+	BOOST_REQUIRE_EQUAL(hits.size(), 2);
+	BOOST_CHECK_EQUAL(index.record(hits[0]).attribute("ID"), "test1");
+	BOOST_CHECK_EQUAL(index.record(hits[1]).attribute("ID"), "test2");
+	BOOST_CHECK_EQUAL(index.typeName(index.featureType(hits[1])), "mRNA");
+	BOOST_CHECK_EQUAL(index.end(hits[1]), 797);
+	BOOST_CHECK(index.overlap("pbar_scf7180000348142", 798, 1000).empty());
+	BOOST_CHECK(index.overlap("pbar_scf7180000348142", 0, 181).empty());
+	BOOST_CHECK(index.overlap("chr1", 0, 1000).empty());
+	BOOST_CHECK(index.overlap("pbar_scf7180000348142", 0, 1000, "tRNA").empty());
+
+	// compared to a linear scan
+	std::string content = "##gff-version 3\n";
+	for (size_t i=0; i<1000; ++i)
+		content += "chr\ts\tt\t" + std::to_string((i*7919)%5000+1) + "\t" + std::to_string((i*7919)%5000+1+(i*31)%300) + "\t.\t+\t.\tID=f" + std::to_string(i) + "\n";
+	index.read(content.data(), content.size());
+	std::vector<size_t> expected;
+	for (size_t start=0; start<5400; start+=97)
+	{
+		expected.clear();
+		for (size_t i=0; i<index.size(); ++i)
+			if ((index.start(i) <= start+50) && (index.end(i) >= start))
+				expected.push_back(i);
+		index.overlap(0, start, start+50, hits);
+		BOOST_CHECK(hits == expected);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+
+#endif /* GFFREADER_TEST_HPP_ */
@@ -0,0 +1,124 @@
+/*
+ * InternedOrthologySet_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef INTERNEDORTHOLOGYSET_TEST_HPP_
+#define INTERNEDORTHOLOGYSET_TEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+#include "../../src/annotation/InternedOrthologySet.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(InternedOrthologySet_Test)
+
+
+BOOST_AUTO_TEST_CASE( InternedOrthologySet_TestOrthoMCL)
+{
+	BioSeqDataLib::InternedOrthologySet set(3);
+	set.read("../tests/annotation/data/orthoMCL.txt");
+	BOOST_CHECK_EQUAL(set.nSpecies(), 2);
+	BOOST_CHECK_EQUAL(set.species(0), "pbar");
+	BOOST_CHECK_EQUAL(set.groupName(0), "2ants1000");
+
+	uint32_t groupId = set.groupId("2ants1001");
+	BOOST_REQUIRE(groupId != BioSeqDataLib::InternedOrthologySet::npos);
+	BOOST_CHECK_EQUAL(set.groupSize(groupId), 51);
+	BioSeqDataLib::OrthoGroup value = set.orthoGroup(groupId);
+	BOOST_CHECK_EQUAL(value["sinv"].size(), 50);
+	BOOST_CHECK_EQUAL(value["sinv"][0], "SINV10854-PA");
+	BOOST_CHECK_EQUAL(set.sequenceName(*set.groupBegin(groupId)), "SINV10854-PA");
+
+	groupId = set.find("sinv", "SINV16968-PA");
+	BOOST_REQUIRE(groupId != BioSeqDataLib::InternedOrthologySet::npos);
+	BOOST_CHECK_EQUAL(set.groupName(groupId), "2ants1035");
+	value = set.orthoGroup(groupId);
+	BOOST_CHECK_EQUAL(value["pbar"][0], "PB12860-RA");
+	BOOST_CHECK_EQUAL(value["pbar"].size(), 5);
+	BOOST_CHECK_EQUAL(value["sinv"].size(), 7);
+	BOOST_CHECK_EQUAL(set.find("pbar", "SINV16968-PA"), BioSeqDataLib::InternedOrthologySet::npos);
+	BOOST_CHECK_EQUAL(set.find("xxx", "SINV16968-PA"), BioSeqDataLib::InternedOrthologySet::npos);
+	BOOST_CHECK_EQUAL(set.groupId("2ants"), BioSeqDataLib::InternedOrthologySet::npos);
+
+	// the same groups as OrthologySet
+	BioSeqDataLib::OrthologySet ref;
+	ref.read("../tests/annotation/data/orthoMCL.txt");
+	for (uint32_t seqId=0; seqId<set.nSequences(); ++seqId)
+	{
+		const std::string &species = set.species(set.sequenceSpecies(seqId));
+		BOOST_CHECK_EQUAL(set.sequenceId(species, set.sequenceName(seqId)), seqId);
+		BOOST_CHECK(set.orthoGroup(set.group(seqId)) == ref.group(species, set.sequenceName(seqId)));
+	}
+	BOOST_CHECK(set.speciesSet() == ref.speciesSet());
+}
+
+BOOST_AUTO_TEST_CASE( InternedOrthologySet_TestProteinortho)
+{
+	BioSeqDataLib::InternedOrthologySet set;
+	set.read("../tests/annotation/data/proteinortho.txt");
+	BOOST_CHECK_EQUAL(set.nSpecies(), 14);
+	BOOST_CHECK_EQUAL(set.species(0), "Trichoplax_adhaerens");
+	BOOST_CHECK_EQUAL(set.speciesId("Xenopus_tropicalis"), 13);
+
+	BioSeqDataLib::OrthologySet ref;
+	ref.read("../tests/annotation/data/proteinortho.txt");
+	for (const char *name : {"1", "9"})
+	{
+		uint32_t groupId = set.groupId(name);
+		BOOST_REQUIRE(groupId != BioSeqDataLib::InternedOrthologySet::npos);
+		BOOST_CHECK(set.orthoGroup(groupId) == ref[name]);
+	}
+	BioSeqDataLib::OrthoGroup value = set.orthoGroup(set.groupId("9"));
+	BOOST_CHECK_EQUAL(value.size(), 13);
+	BOOST_CHECK_EQUAL(value["Homo_sapiens"][1], "ENSP00000431800");
+	BOOST_CHECK_EQUAL(set.groupName(set.find("Homo_sapiens", "ENSP00000431800")), "9");
+}
+
+BOOST_AUTO_TEST_CASE( InternedOrthologySet_TestMemory)
+{
+	// empty lines, windows line breaks, repeated groups and a sequence in two groups
+	std::string content = "g1: a|x a|y b|x\r\n\ng2: b|z\ng3:\ng1: a|w\ng4: b|x\n";
+	BioSeqDataLib::InternedOrthologySet set(2);
+	set.read(content.data(), content.size());
+	BOOST_CHECK_EQUAL(set.nGroups(), 3);
+	BOOST_CHECK_EQUAL(set.nSequences(), 5);
+	uint32_t g1 = set.groupId("g1");
+	BOOST_CHECK_EQUAL(set.groupSize(g1), 4);
+	BOOST_CHECK_EQUAL(set.sequenceName(set.groupBegin(g1)[3]), "w");
+	BOOST_CHECK_EQUAL(set.groupName(set.find("b", "x")), "g4");
+	BOOST_CHECK_EQUAL(set.groupName(set.find("a", "x")), "g1");
+	BOOST_CHECK_EQUAL(set.groupId("g3"), BioSeqDataLib::InternedOrthologySet::npos);
+
+	content = "# Species\tGenes\tAlg.-Conn.\ts1\ts2\n2\t2\t1\tA,B\t*\n\n1\t1\t1\t*\tC\r\n";
+	set.read(content.data(), content.size());
+	BOOST_CHECK_EQUAL(set.nGroups(), 2);
+	BOOST_CHECK_EQUAL(set.groupName(set.find("s2", "C")), "3");
+	BOOST_CHECK_EQUAL(set.groupSize(set.groupId("1")), 2);
+	BOOST_CHECK_EQUAL(set.find("s1", "C"), BioSeqDataLib::InternedOrthologySet::npos);
+
+	set.read(content.data(), 0);
+	BOOST_CHECK_EQUAL(set.nGroups(), 0);
+	BOOST_CHECK_EQUAL(set.find("s2", "C"), BioSeqDataLib::InternedOrthologySet::npos);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+
+#endif /* INTERNEDORTHOLOGYSET_TEST_HPP_ */
@@ -29,7 +29,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include "../annotation/OrthologySet_Test.hpp"
+#include "../annotation/InternedOrthologySet_Test.hpp"
+#include "../annotation/GffReader_Test.hpp"
 #include "../annotation/BlastHitTest.hpp"
+#include "../annotation/BlastHitTable_Test.hpp"
 #include "../annotation/FeatureTest.hpp"
 
 
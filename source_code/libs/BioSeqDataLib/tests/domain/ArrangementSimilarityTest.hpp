@@ -0,0 +1,134 @@
+#ifndef ARRANGEMENT_SIMILARITY_TEST_HPP_
+#define ARRANGEMENT_SIMILARITY_TEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../../src/DomainModule.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(ArrangementSimilarity_Test)
+
+std::vector<BioSeqDataLib::DomainArrangement<BioSeqDataLib::DomainExt> >
+randomArrangements(size_t n, unsigned int seed)
+{
+	const std::vector<std::string> accs = {"PF00405", "PF02458", "PF02965", "PF12279", "PF12299"};
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<size_t> acc(0, accs.size()-1);
+	std::uniform_int_distribution<size_t> length(1, 4);
+	std::vector<BioSeqDataLib::DomainArrangement<BioSeqDataLib::DomainExt> > arrangements(n);
+	for (auto &da : arrangements)
+	{
+		size_t len = length(rng);
+		for (size_t i = 0; i < len; ++i)
+		{
+			BioSeqDataLib::DomainExt dom;
+			dom.accession(accs[acc(rng)]);
+			da.push_back(dom);
+		}
+	}
+	return arrangements;
+}
+
+BOOST_AUTO_TEST_CASE( similarity_Test )
+{
+	BioSeqDataLib::DSM dsm("../tests/utility/data/DSMtest.mat");
+	auto arrangements = randomArrangements(40, 3);
+	for (bool negative : {false, true})
+	{
+		dsm.useNegative(negative);
+		BioSeqDataLib::ArrangementSimilarity engine(dsm);
+		for (const auto &da : arrangements)
+			engine.add(da);
+		BOOST_REQUIRE_EQUAL(engine.size(), arrangements.size());
+		for (size_t a = 0; a < arrangements.size(); ++a)
+		{
+			for (size_t b = 0; b < arrangements.size(); ++b)
+				BOOST_CHECK_CLOSE(engine.similarity(a, b), BioSeqDataLib::cos(arrangements[a], arrangements[b], dsm), 0.001);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( search_Test )
+{
+	BioSeqDataLib::DSM dsm("../tests/utility/data/DSMtest.mat");
+	auto arrangements = randomArrangements(100, 5);
+	BioSeqDataLib::ArrangementSimilarity engine(dsm);
+	for (const auto &da : arrangements)
+		engine.add(da);
+	size_t n = engine.size();
+
+	// brute force results
+	std::vector<std::vector<BioSeqDataLib::ArrangementHit> > expectedHits(n);
+	std::vector<BioSeqDataLib::ArrangementPair> expectedPairs;
+	for (size_t a = 0; a < n; ++a)
+	{
+		for (size_t b = 0; b < n; ++b)
+		{
+			float sim = engine.similarity(a, b);
+			if ((a != b) && (sim > 0))
+				expectedHits[a].push_back(BioSeqDataLib::ArrangementHit{b, sim});
+			if ((a < b) && (sim >= 0.5))
+				expectedPairs.push_back(BioSeqDataLib::ArrangementPair{a, b, sim});
+		}
+		std::stable_sort(expectedHits[a].begin(), expectedHits[a].end(),
+			[](const BioSeqDataLib::ArrangementHit &h1, const BioSeqDataLib::ArrangementHit &h2) { return h1.similarity > h2.similarity; });
+		if (expectedHits[a].size() > 5)
+			expectedHits[a].resize(5);
+	}
+
+#ifdef _OPENMP
+	size_t nUsed = 0;
+	#pragma omp parallel num_threads(3)
+	{
+		#pragma omp single
+		nUsed = omp_get_num_threads();
+	}
+	BOOST_CHECK_GT(nUsed, 1);
+#endif
+
+	// 100 arrangements in blocks of 16 give every thread several blocks
+	for (unsigned int nThreads : {1u, 3u, 4u})
+	{
+		std::vector<std::vector<BioSeqDataLib::ArrangementHit> > hits;
+		engine.topK(5, hits, nThreads, 16);
+		BOOST_REQUIRE_EQUAL(hits.size(), n);
+		for (size_t a = 0; a < n; ++a)
+		{
+			BOOST_REQUIRE_EQUAL(hits[a].size(), expectedHits[a].size());
+			for (size_t i = 0; i < hits[a].size(); ++i)
+			{
+				BOOST_CHECK_EQUAL(hits[a][i].index, expectedHits[a][i].index);
+				BOOST_CHECK_EQUAL(hits[a][i].similarity, expectedHits[a][i].similarity);
+			}
+		}
+
+		std::vector<BioSeqDataLib::ArrangementPair> pairs;
+		engine.allPairs(0.5, pairs, nThreads, 16);
+		BOOST_REQUIRE_EQUAL(pairs.size(), expectedPairs.size());
+		for (size_t i = 0; i < pairs.size(); ++i)
+		{
+			BOOST_CHECK_EQUAL(pairs[i].first, expectedPairs[i].first);
+			BOOST_CHECK_EQUAL(pairs[i].second, expectedPairs[i].second);
+			BOOST_CHECK_EQUAL(pairs[i].similarity, expectedPairs[i].similarity);
+		}
+	}
+
+	BioSeqDataLib::DomainArrangement<BioSeqDataLib::DomainExt> unknown;
+	BioSeqDataLib::DomainExt dom;
+	dom.accession("PF99999");
+	unknown.push_back(dom);
+	BOOST_CHECK_THROW(engine.add(unknown), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif /* ARRANGEMENT_SIMILARITY_TEST_HPP_ */
@@ -26,6 +26,8 @@
 
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <random>
+#include <set>
 
 #include "../../src/DomainModule.hpp"
 
@@ -115,6 +117,83 @@ BOOST_AUTO_TEST_CASE( DB_Overlap_Test )
 
 }
 
+/*
+ * Straightforward overlap removal used to check that solveDbOverlaps gives the same results.
+ */
+void
+referenceSolveDbOverlaps(BioSeqDataLib::DomainArrangement<BioSeqDataLib::Domain> &da, const std::vector<BioSeqDataLib::DomainDB> &dbImportance, size_t maxAbsOverlap, float maxFracOverlap)
+{
+	std::set<BioSeqDataLib::DomainDB> usedDbs(dbImportance.begin(), dbImportance.end());
+	for (size_t i=da.size(); i>0; --i)
+	{
+		if (usedDbs.count(da[i-1].db()) == 0)
+			da.erase(da.begin() + (i-1));
+	}
+
+	for (BioSeqDataLib::DomainDB db : dbImportance)
+	{
+		bool changed = true;
+		while (changed)
+		{
+			std::set<size_t> toDelete;
+			for (size_t i=1; i<da.size(); ++i)
+			{
+				const BioSeqDataLib::Domain &dom1 = da[i-1];
+				const BioSeqDataLib::Domain &dom2 = da[i];
+				if (dom1.end() > dom2.start())
+				{
+					float overlap = dom1.end() - dom2.start() + 1;
+					if (((dom1.db() == db) || (dom2.db() == db)) && ((overlap > maxAbsOverlap) || ((overlap/dom1.length()) > maxFracOverlap ) || ((overlap/dom2.length()) > maxFracOverlap ) ))
+					{
+						if (dom1.db() == dom2.db())
+							toDelete.insert((dom1.evalue() < dom2.evalue()) ? i : i-1);
+						else
+							toDelete.insert(dom1.db() == db ? i : i-1);
+					}
+				}
+			}
+			for (auto it = toDelete.rbegin(); it != toDelete.rend(); ++it)
+				da.erase(da.begin() + (*it));
+			changed = !toDelete.empty();
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( DB_Overlap_Random_Test )
+{
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<unsigned long> lenDist(5, 120);
+	std::uniform_int_distribution<unsigned long> stepDist(0, 60);
+	std::uniform_int_distribution<int> dbDist(0, 3);
+	std::uniform_real_distribution<double> evalDist(0, 1);
+	std::vector<BioSeqDataLib::DomainDB> dbs = {BioSeqDataLib::DomainDB::pfam, BioSeqDataLib::DomainDB::superfamily, BioSeqDataLib::DomainDB::gene3d, BioSeqDataLib::DomainDB::prodom};
+	std::vector<BioSeqDataLib::DomainDB> dbImportance = {BioSeqDataLib::DomainDB::pfam, BioSeqDataLib::DomainDB::superfamily, BioSeqDataLib::DomainDB::gene3d};
+
+	for (size_t nDomains : {0, 1, 2, 5, 20, 100, 500})
+	{
+		for (size_t rep=0; rep<20; ++rep)
+		{
+			BioSeqDataLib::DomainArrangement<BioSeqDataLib::Domain> da;
+			unsigned long start = 1;
+			for (size_t i=0; i<nDomains; ++i)
+			{
+				start += stepDist(rng);
+				da.emplace_back("D" + std::to_string(i), start, start + lenDist(rng), evalDist(rng), dbs[dbDist(rng)]);
+			}
+			BioSeqDataLib::DomainArrangement<BioSeqDataLib::Domain> reference = da;
+
+			da.solveDbOverlaps(dbImportance, 10, 0.10);
+			referenceSolveDbOverlaps(reference, dbImportance, 10, 0.10);
+
+			BOOST_REQUIRE_EQUAL(da.size(), reference.size());
+			for (size_t i=0; i<da.size(); ++i)
+			{
+				BOOST_CHECK_EQUAL(da[i].accession(), reference[i].accession());
+			}
+		}
+	}
+}
+
 /*
  * Check that the begin and end functions of are working properly.
  * Iterator do not need to be tested themselves as they are simply hidden STL containers.
@@ -243,6 +322,39 @@ BOOST_AUTO_TEST_CASE(Collapse_check)
 }
 
 
+BOOST_AUTO_TEST_CASE(CollapsedAccessions_check)
+{
+	BioSeqDataLib::DomainArrangement<BioSeqDataLib::Domain> da;
+	da.emplace_back("PF00007", 1, 40, 0.4, BioSeqDataLib::DomainDB::pfam);
+	da.emplace_back("PF00008", 100, 101, 0.4, BioSeqDataLib::DomainDB::pfam);
+	da.emplace_back("PF00008", 102, 104, 0.4, BioSeqDataLib::DomainDB::pfam);
+	da.emplace_back("PF00009", 1000, 3000, 0.4, BioSeqDataLib::DomainDB::pfam);
+	da.emplace_back("PF00010", 10000, 30000, 0.4, BioSeqDataLib::DomainDB::pfam);
+	da.emplace_back("PF00010", 300000, 3000000, 0.4, BioSeqDataLib::DomainDB::pfam);
+
+	std::vector<std::string> accessions = {"X"};
+	da.collapsedAccessions(accessions);
+	std::vector<std::string> expected = {"PF00007", "PF00008", "PF00009", "PF00010"};
+	BOOST_CHECK_EQUAL_COLLECTIONS(accessions.begin(), accessions.end(), expected.begin(), expected.end());
+	BOOST_CHECK_EQUAL(da.size(), 6);
+	BOOST_CHECK(da.collapsedEquals(expected));
+	BOOST_CHECK(!da.collapsedEquals({"PF00007", "PF00008", "PF00009"}));
+	BOOST_CHECK(!da.collapsedEquals({"PF00007", "PF00008", "PF00009", "PF00010", "PF00010"}));
+
+	// the hash is the same as for the collapsed arrangement
+	BioSeqDataLib::DomainArrangement<BioSeqDataLib::Domain> collapsed = da;
+	collapsed.collapse();
+	BOOST_CHECK_EQUAL(da.collapsedHash(), collapsed.collapsedHash());
+	std::swap(collapsed[0], collapsed[1]);
+	BOOST_CHECK(da.collapsedHash() != collapsed.collapsedHash());
+
+	BioSeqDataLib::DomainArrangement<BioSeqDataLib::Domain> empty;
+	empty.collapsedAccessions(accessions);
+	BOOST_CHECK(accessions.empty());
+	BOOST_CHECK(empty.collapsedEquals(accessions));
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
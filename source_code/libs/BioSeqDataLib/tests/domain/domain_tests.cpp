@@ -31,3 +31,4 @@
 #include "DomainTest.hpp"
 #include "DomainArrangementTest.hpp"
 #include "DomainArrangementSetTest.hpp"
+#include "ArrangementSimilarityTest.hpp"
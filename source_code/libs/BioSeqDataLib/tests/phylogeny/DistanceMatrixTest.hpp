@@ -0,0 +1,151 @@
+/*
+ * DistanceMatrixTest.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DistanceMatrixTEST_HPP_
+#define DistanceMatrixTEST_HPP_
+
+
+#include "../../src/phylogeny/DistanceMatrix.hpp"
+#include "../../src/phylogeny/PhylogeneticTree.hpp"
+#include "../../src/sequence/SequenceSet.hpp"
+#include "../../src/domain/DomainExt.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(DistanceMatrix_Test)
+
+BOOST_AUTO_TEST_CASE( fill_Test )
+{
+	// every tile size and thread number has to write every cell exactly
+	BioSeqDataLib::TriangularMatrix<float> distMat;
+	for (size_t tileSize : {1, 3, 64})
+	{
+		BioSeqDataLib::DistanceMatrixBuilder builder(4, tileSize);
+		builder.fill(10, distMat, [](size_t i, size_t j) { return static_cast<float>(100*i + j); });
+		BOOST_REQUIRE_EQUAL(distMat.dim(), 10);
+		for (size_t i=1; i<10; ++i)
+			for (size_t j=0; j<i; ++j)
+				BOOST_CHECK_EQUAL(distMat(i, j), 100*i + j);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( pDistance_Test )
+{
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > aln;
+	aln.emplace_back("seq1", "ACGT", "", "");
+	aln.emplace_back("seq2", "ACGA", "", "");
+	aln.emplace_back("seq3", "A-Ga", "", "");
+	aln.emplace_back("seq4", "--..", "", "");
+	BioSeqDataLib::DistanceMatrixBuilder builder(2, 2);
+	BioSeqDataLib::TriangularMatrix<float> distMat;
+	builder.pDistance(aln, distMat);
+	BOOST_CHECK_CLOSE(distMat(1, 0), 0.25, 0.001);
+	BOOST_CHECK_CLOSE(distMat(2, 0), 1.0/3, 0.001);
+	BOOST_CHECK_EQUAL(distMat(2, 1), 0);
+	BOOST_CHECK_EQUAL(distMat(3, 0), 1);
+
+	std::vector<std::string> names = BioSeqDataLib::DistanceMatrixBuilder::names(aln);
+	BOOST_CHECK_EQUAL(names[2], "seq3");
+	BioSeqDataLib::PhylogeneticTree<int> tree;
+	tree.nj_fast(std::move(distMat), names);
+	BOOST_CHECK_EQUAL(tree.root().nChildren(), 3);
+
+	aln.emplace_back("seq5", "ACG", "", "");
+	BOOST_CHECK_THROW(builder.pDistance(aln, distMat), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( kmerDistance_Test )
+{
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+	set.emplace_back("seq1", "ACGT", "", "");
+	set.emplace_back("seq2", "acg", "", "");
+	set.emplace_back("seq3", "TTTT", "", "");
+	set.emplace_back("seq4", "AC-GTT", "", "");
+	set.emplace_back("seq5", "A", "", "");
+	BioSeqDataLib::DistanceMatrixBuilder builder;
+	BioSeqDataLib::TriangularMatrix<float> distMat;
+	builder.kmerDistance(set, 2, distMat);
+	BOOST_CHECK_EQUAL(distMat(1, 0), 0);
+	BOOST_CHECK_EQUAL(distMat(2, 0), 1);
+	BOOST_CHECK_EQUAL(distMat(2, 1), 1);
+	// AC, GT, TT: two shared with seq1, one TT shared with seq3 (three times TT)
+	BOOST_CHECK_CLOSE(distMat(3, 0), 1.0/3, 0.001);
+	BOOST_CHECK_CLOSE(distMat(3, 2), 2.0/3, 0.001);
+	BOOST_CHECK_EQUAL(distMat(4, 0), 1);
+
+	// the threads reuse their k-mer tables for many tiles, left over counts would change the distances
+	for (size_t i=0; i<60; ++i)
+	{
+		std::string seq;
+		for (size_t j=0; j<5+i%17; ++j)
+			seq.push_back("ACGT"[(i*j + j/3) % 4]);
+		set.emplace_back("r" + std::to_string(i), seq, "", "");
+	}
+	BioSeqDataLib::TriangularMatrix<float> serialMat, threadMat;
+	builder.kmerDistance(set, 3, serialMat);
+	BioSeqDataLib::DistanceMatrixBuilder threaded(4, 3);
+	threaded.kmerDistance(set, 3, threadMat);
+	for (size_t i=0; i<set.size(); ++i)
+	{
+		for (size_t j=0; j<i; ++j)
+			BOOST_CHECK_EQUAL(threadMat(i, j), serialMat(i, j));
+	}
+
+	BOOST_CHECK_THROW(builder.kmerDistance(set, 13, distMat), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( domainDistance_Test )
+{
+	BioSeqDataLib::DomainArrangementSet<BioSeqDataLib::DomainExt> daSet;
+	std::vector<std::vector<std::string> > accessions = {{"PF00405", "PF02458"}, {"PF02458", "PF02965", "PF02965"}, {}, {"PF12279"}};
+	for (size_t i=0; i<accessions.size(); ++i)
+	{
+		BioSeqDataLib::DomainArrangement<BioSeqDataLib::DomainExt> da;
+		for (const std::string &acc : accessions[i])
+		{
+			BioSeqDataLib::DomainExt dom;
+			dom.accession(acc);
+			da.push_back(dom);
+		}
+		daSet.emplace("seq" + std::to_string(i), da);
+	}
+	std::vector<std::string> names = BioSeqDataLib::DistanceMatrixBuilder::names(daSet);
+	BOOST_CHECK_EQUAL(names[3], "seq3");
+
+	BioSeqDataLib::DistanceMatrixBuilder builder(3, 1);
+	BioSeqDataLib::TriangularMatrix<float> distMat;
+	builder.jaccardDistance(daSet, distMat);
+	BOOST_CHECK_CLOSE(distMat(1, 0), 2.0/3, 0.001);
+	BOOST_CHECK_EQUAL(distMat(2, 0), 1);
+	BOOST_CHECK_EQUAL(distMat(3, 1), 1);
+
+	BioSeqDataLib::DSM dsm("../tests/utility/data/DSMtest.mat");
+	builder.dsmDistance(daSet, dsm, distMat);
+	for (size_t i=1; i<names.size(); ++i)
+	{
+		for (size_t j=0; j<i; ++j)
+		{
+			float similarity = BioSeqDataLib::cos(daSet[names[i]], daSet[names[j]], dsm);
+			BOOST_CHECK_SMALL(distMat(i, j) - (std::isnan(similarity) ? 1 : std::max(0.0f, 1-similarity)), 0.0001f);
+		}
+	}
+	BOOST_CHECK_EQUAL(distMat(2, 0), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif /* DistanceMatrixTEST_HPP_ */
@@ -23,9 +23,12 @@
 #ifndef DOLLOTEST_HPP_
 #define DOLLOTEST_HPP_
 
+#include <map>
+#include <string>
 #include <vector>
 
 #include "../../src/phylogeny/PhylogeneticTree.hpp"
+#include "../../src/phylogeny/MultiLayerTree.hpp"
 #include "../../src/phylogeny/dollo.hpp"
 
 BOOST_AUTO_TEST_SUITE(Dollo_Test)
@@ -105,6 +108,82 @@ BOOST_AUTO_TEST_CASE( Dollo_Test )
         }
 }
 
+BOOST_AUTO_TEST_CASE( Dollo_MultiLayer_Test )
+{
+        std::map<std::string, std::vector<int> > leafStates;
+        leafStates["A"] = {1,-1,-1};
+        leafStates["B"] = {-1,-1,-1};
+        leafStates["C"] = {1,-1,1};
+        leafStates["D"] = {-1,-1,-1};
+        leafStates["E"] = {-1,-1,-1};
+        leafStates["F"] = {-1,1,1};
+        leafStates["G"] = {1,-1,-1};
+
+        // reference: states stored in the nodes
+        BioSeqDataLib::PhylogeneticTree<std::vector<int>> nTree;
+        nTree.str2tree("(((((A:1,B:1)AB:1,(C:1,D:1)CD:1)AC:1,E:1)AE:1,F:1)AF:1,G:1)R;");
+        for (auto aNode=nTree.preorderBegin();aNode!=nTree.preorderEnd();++aNode) {
+            if (aNode->isLeaf())
+                aNode->data = leafStates[aNode->name];
+        }
+        dollo(nTree);
+
+        // the same states in the second layer; the first layer has to stay untouched
+        BioSeqDataLib::MultiLayerTree lTree(2);
+        lTree.str2tree("(((((A:1,B:1)AB:1,(C:1,D:1)CD:1)AC:1,E:1)AE:1,F:1)AF:1,G:1)R;");
+        BOOST_CHECK_EQUAL(lTree.nLayers(), 2);
+        BOOST_CHECK_EQUAL(lTree.nNodes(), lTree.layer(1).size());
+        for (auto aNode=lTree.preorderBegin();aNode!=lTree.preorderEnd();++aNode) {
+            if (aNode->isLeaf())
+                lTree.states(1, aNode->id) = leafStates[aNode->name];
+        }
+        dollo(lTree, 1);
+
+        auto bNode=lTree.preorderBegin();
+        for (auto aNode=nTree.preorderBegin();aNode!=nTree.preorderEnd();++aNode, ++bNode) {
+            BOOST_CHECK_EQUAL(aNode->id, bNode->id);
+            BOOST_CHECK_EQUAL(&lTree.node(bNode->id), &*bNode);
+            BOOST_CHECK(lTree.states(0, bNode->id).empty());
+            BOOST_CHECK_EQUAL_COLLECTIONS(aNode->data.begin(), aNode->data.end(), lTree.states(1, bNode->id).begin(), lTree.states(1, bNode->id).end());
+        }
+}
+
+BOOST_AUTO_TEST_CASE( Dollo_Polytomy_Test )
+{
+        std::map<std::string, std::vector<int> > leafStates;
+        leafStates["A"] = {1,1,-1,-1};
+        leafStates["B"] = {1,-1,-1,-1};
+        leafStates["C"] = {-1,1,1,-1};
+        leafStates["D"] = {1,-1,-1,1};
+        std::map<std::string, std::vector<int> > expected = leafStates;
+        expected["X"] = {1,1,-1,-1};
+        expected["R"] = {1,-1,-1,-1};
+
+        // X has three children
+        BioSeqDataLib::PhylogeneticTree<std::vector<int>> nTree;
+        nTree.str2tree("((A:1,B:1,C:1)X:1,D:1)R;");
+        for (auto aNode=nTree.preorderBegin();aNode!=nTree.preorderEnd();++aNode) {
+            if (aNode->isLeaf())
+                aNode->data = leafStates[aNode->name];
+        }
+        dollo(nTree);
+
+        BioSeqDataLib::MultiLayerTree lTree(1);
+        lTree.str2tree("((A:1,B:1,C:1)X:1,D:1)R;");
+        for (auto aNode=lTree.preorderBegin();aNode!=lTree.preorderEnd();++aNode) {
+            if (aNode->isLeaf())
+                lTree.states(0, aNode->id) = leafStates[aNode->name];
+        }
+        dollo(lTree, 0);
+
+        auto bNode=lTree.preorderBegin();
+        for (auto aNode=nTree.preorderBegin();aNode!=nTree.preorderEnd();++aNode, ++bNode) {
+            const std::vector<int> &exp = expected[aNode->name];
+            BOOST_CHECK_EQUAL_COLLECTIONS(aNode->data.begin(), aNode->data.end(), exp.begin(), exp.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(lTree.states(0, bNode->id).begin(), lTree.states(0, bNode->id).end(), exp.begin(), exp.end());
+        }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif /* DolloTEST_HPP_ */
@@ -24,10 +24,42 @@
 #define PhylogeneticTreeTEST_HPP_
 
 
+#include <random>
+#include <set>
+
 #include "../../src/utility/Matrix.hpp"
 #include "../../src/phylogeny/PhylogeneticTree.hpp"
 
 
+// collects the leaves below every node except the root, leaf sets containing the first leaf are stored as their
+// complement so that the splits of differently rooted trees can be compared
+template<typename NodeType>
+std::set<std::string>
+collectSplits(const NodeType &node, std::set<std::set<std::string> > &splits, const std::set<std::string> &all, const std::string &first)
+{
+	std::set<std::string> leaves;
+	if (node.nChildren() == 0)
+		leaves.insert(node.name);
+	for (size_t i=0; i<node.nChildren(); ++i)
+	{
+		std::set<std::string> childLeaves = collectSplits(*node.child(i), splits, all, first);
+		leaves.insert(childLeaves.begin(), childLeaves.end());
+	}
+	if (node.parent() != nullptr)
+	{
+		std::set<std::string> split;
+		if (leaves.count(first) == 0)
+			split = leaves;
+		else
+			for (const std::string &name : all)
+				if (leaves.count(name) == 0)
+					split.insert(name);
+		splits.insert(split);
+	}
+	return leaves;
+}
+
+
 BOOST_AUTO_TEST_SUITE(PhylogeneticTree_Test)
 
 // most frequently you implement test cases as a free functions with automatic registration
@@ -54,6 +86,74 @@ BOOST_AUTO_TEST_CASE( TreeNJ_Test )
 	BOOST_CHECK_EQUAL(tree.str() ,"((A:2.000000,B:1.000000):9.000000,C:3.000000,D:1.000000);");
 }
 
+BOOST_AUTO_TEST_CASE( TreeNJFast_Test )
+{
+	BioSeqDataLib::Matrix<float> distMat(4, 4);
+	distMat.fill(0);
+	std::vector<std::string> names = {"A", "B", "C", "D"};
+	distMat[0][1] = distMat[1][0] = 3;
+	distMat[0][2] = distMat[2][0] = 14;
+	distMat[0][3] = distMat[3][0] = 12;
+	distMat[1][2] = distMat[2][1] = 13;
+	distMat[1][3] = distMat[3][1] = 11;
+	distMat[2][3] = distMat[3][2] = 4;
+	BioSeqDataLib::PhylogeneticTree<int> tree;
+	tree.nj_fast(distMat, names);
+	BOOST_CHECK_EQUAL(tree.str() ,"((A:2.000000,B:1.000000):9.000000,C:3.000000,D:1.000000);");
+
+	// random distances, the same tree as nj has to be constructed
+	size_t nTaxa = 50;
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> dist(0, 10);
+	std::vector<std::vector<float> > points(nTaxa, std::vector<float>(4));
+	for (auto &point : points)
+		for (auto &coordinate : point)
+			coordinate = dist(gen);
+	distMat.resize(nTaxa, nTaxa);
+	names.clear();
+	for (size_t i=0; i<nTaxa; ++i)
+	{
+		names.push_back("t" + std::to_string(i));
+		distMat[i][i] = 0;
+		for (size_t j=0; j<i; ++j)
+		{
+			float d = 0;
+			for (size_t k=0; k<4; ++k)
+				d += std::abs(points[i][k] - points[j][k]);
+			distMat[i][j] = distMat[j][i] = d;
+		}
+	}
+	BioSeqDataLib::PhylogeneticTree<int> fastTree, njTree;
+	fastTree.nj_fast(distMat, names);
+	njTree.nj(distMat, names);
+	std::set<std::string> all(names.begin(), names.end());
+	std::set<std::set<std::string> > fastSplits, njSplits;
+	collectSplits(fastTree.root(), fastSplits, all, names[0]);
+	collectSplits(njTree.root(), njSplits, all, names[0]);
+	BOOST_CHECK_EQUAL(fastSplits.size(), 2*nTaxa-3);
+	BOOST_CHECK(fastSplits == njSplits);
+	BOOST_CHECK_EQUAL(fastTree.root().nChildren(), njTree.root().nChildren());
+
+	// few taxa, the last steps often tie and have to be decided like in nj
+	for (size_t round=0; round<400; ++round)
+	{
+		nTaxa = 5 + round % 2;
+		BioSeqDataLib::Matrix<float> smallMat(nTaxa, nTaxa);
+		std::vector<std::string> smallNames;
+		for (size_t i=0; i<nTaxa; ++i)
+		{
+			smallNames.push_back("t" + std::to_string(i));
+			smallMat[i][i] = 0;
+			for (size_t j=0; j<i; ++j)
+				smallMat[i][j] = smallMat[j][i] = dist(gen);
+		}
+		BioSeqDataLib::PhylogeneticTree<int> smallFast, smallNj;
+		smallFast.nj_fast(smallMat, smallNames);
+		smallNj.nj(smallMat, smallNames);
+		BOOST_CHECK_EQUAL(smallFast.str(), smallNj.str());
+	}
+}
+
 BOOST_AUTO_TEST_CASE( stringTest_Test )
 {
 	BioSeqDataLib::PhylogeneticTree<int> tree;
@@ -97,6 +197,54 @@ BOOST_AUTO_TEST_CASE( TreeUPGMA_Test )
 	BOOST_CHECK_EQUAL(tree.str() ,"(F:4.000000,(((A:1.000000,B:1.000000):1.000000,C:2.000000):1.000000,(D:2.000000,E:2.000000):1.000000):1.000000);");
 }
 
+BOOST_AUTO_TEST_CASE( TreeUPGMAFast_Test )
+{
+	BioSeqDataLib::Matrix<float> distMat(6, 6);
+	distMat.fill(0);
+	std::vector<std::string> names = {"A", "B", "C", "D", "E", "F"};
+	float values[] = {2, 4, 6, 6, 8, 4, 6, 6, 8, 6, 6, 8, 4, 8, 8};
+	size_t k = 0;
+	for (size_t i=0; i<6; ++i)
+		for (size_t j=i+1; j<6; ++j, ++k)
+			distMat[i][j] = distMat[j][i] = values[k];
+	BioSeqDataLib::PhylogeneticTree<int> tree;
+	tree.upgma_fast(distMat, names);
+	BOOST_CHECK_EQUAL(tree.str() ,"(F:4.000000,(((A:1.000000,B:1.000000):1.000000,C:2.000000):1.000000,(D:2.000000,E:2.000000):1.000000):1.000000);");
+
+	// WPGMA weights both parts of a cluster equally
+	distMat.resize(4, 4);
+	distMat.fill(0);
+	names = {"A", "B", "C", "D"};
+	distMat[0][1] = distMat[1][0] = 2;
+	distMat[0][2] = distMat[2][0] = 4;
+	distMat[1][2] = distMat[2][1] = 4;
+	distMat[0][3] = distMat[3][0] = 10;
+	distMat[1][3] = distMat[3][1] = 10;
+	distMat[2][3] = distMat[3][2] = 7;
+	tree.upgma_fast(distMat, names);
+	BOOST_CHECK_EQUAL(tree.str() ,"(D:4.500000,((A:1.000000,B:1.000000):1.000000,C:2.000000):2.500000);");
+	tree.upgma_fast(distMat, names, true);
+	BOOST_CHECK_EQUAL(tree.str() ,"(D:4.250000,((A:1.000000,B:1.000000):1.000000,C:2.000000):2.250000);");
+
+	// many ties, the same tree as upgma has to be constructed
+	size_t nTaxa = 60;
+	std::mt19937 gen(7);
+	std::uniform_int_distribution<int> dist(1, 5);
+	distMat.resize(nTaxa, nTaxa);
+	names.clear();
+	for (size_t i=0; i<nTaxa; ++i)
+	{
+		names.push_back("t" + std::to_string(i));
+		distMat[i][i] = 0;
+		for (size_t j=0; j<i; ++j)
+			distMat[i][j] = distMat[j][i] = dist(gen);
+	}
+	BioSeqDataLib::PhylogeneticTree<int> upgmaTree;
+	tree.upgma_fast(distMat, names);
+	upgmaTree.upgma(distMat, names);
+	BOOST_CHECK_EQUAL(tree.str(), upgmaTree.str());
+}
+
 BOOST_AUTO_TEST_CASE( TreeIterator_Test )
 {
 	BioSeqDataLib::Matrix<float> distMat;
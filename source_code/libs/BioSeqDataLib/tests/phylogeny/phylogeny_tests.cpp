@@ -28,6 +28,7 @@
 
 #include "TreeTest.hpp"
 #include "PhylogeneticTreeTest.hpp"
+#include "DistanceMatrixTest.hpp"
 #include "FitchTest.hpp"
 #include "DolloTest.hpp"
 
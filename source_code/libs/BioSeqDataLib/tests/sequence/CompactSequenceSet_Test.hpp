@@ -0,0 +1,102 @@
+/*
+ * CompactSequenceSet_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "../../src/sequence/CompactSequenceSet.hpp"
+#include "../../src/sequence/ParallelFastaReader.hpp"
+#include "../../src/sequence/SequenceSet.hpp"
+
+BOOST_AUTO_TEST_SUITE(CompactSequenceSet_Test)
+
+
+BOOST_AUTO_TEST_CASE( CompactSequenceSet_simple_Test )
+{
+	BioSeqDataLib::CompactSequenceSet set;
+	BOOST_CHECK(set.empty());
+	set.push_back("seq1", "ACGT", "first");
+	set.push_back("seq2", "", "");
+	set.push_back("seq3", "MKV");
+	BOOST_REQUIRE_EQUAL(set.size(), 3);
+	BOOST_CHECK_EQUAL(set.nResidues(), 7);
+	BOOST_CHECK_EQUAL(set[0].name(), "seq1");
+	BOOST_CHECK_EQUAL(set[0].comment(), "first");
+	BOOST_CHECK_EQUAL(set[0].seq(), "ACGT");
+	BOOST_CHECK_EQUAL(set[0][2], 'G');
+	BOOST_CHECK_EQUAL(set[1].size(), 0);
+	BOOST_CHECK_EQUAL(set[2].seq(), "MKV");
+	BOOST_CHECK_EQUAL(set[2].id(), 2);
+	BOOST_CHECK_THROW(set.at(3), std::out_of_range);
+
+	BioSeqDataLib::Sequence<> seq = set.sequence<BioSeqDataLib::Sequence<> >(0);
+	BOOST_CHECK_EQUAL(seq.name(), "seq1");
+	BOOST_CHECK_EQUAL(seq.seq(), "ACGT");
+	BOOST_CHECK_EQUAL(seq.comment(), "first");
+
+	size_t length = 0;
+	for (const BioSeqDataLib::CompactSequenceSet::SequenceView &view : set)
+		length += view.size();
+	BOOST_CHECK_EQUAL(length, 7);
+	BOOST_CHECK_EQUAL(set.end() - set.begin(), 3);
+	BOOST_CHECK_EQUAL((*(set.begin() + 2)).name(), "seq3");
+
+	BioSeqDataLib::CompactSequenceSet set2;
+	set2.push_back("seq4", "WW", "fourth");
+	set.append(set2);
+	BOOST_REQUIRE_EQUAL(set.size(), 4);
+	BOOST_CHECK_EQUAL(set[3].name(), "seq4");
+	BOOST_CHECK_EQUAL(set[3].seq(), "WW");
+	BOOST_CHECK_EQUAL(set[3].comment(), "fourth");
+	BOOST_CHECK_EQUAL(set[2].seq(), "MKV");
+
+	set.clear();
+	BOOST_CHECK(set.empty());
+	BOOST_CHECK_EQUAL(set.nResidues(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( CompactSequenceSet_read_Test )
+{
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > ref("../tests/sequence/data/seqSet2.fa");
+	for (size_t chunkSize : {1, 50, 10000})
+	{
+		BioSeqDataLib::CompactSequenceSet set;
+		set.push_back("seq0", "A", "");
+		BioSeqDataLib::ParallelFastaReader reader(2, chunkSize);
+		reader.read("../tests/sequence/data/seqSet2.fa", set);
+		BOOST_REQUIRE_EQUAL(set.size(), ref.size()+1);
+		BOOST_CHECK_EQUAL(set[0].seq(), "A");
+		for (size_t i=0; i<ref.size(); ++i)
+		{
+			BOOST_CHECK_EQUAL(set[i+1].name(), ref[i].name());
+			BOOST_CHECK_EQUAL(set[i+1].seq(), ref[i].seq());
+		}
+	}
+
+	std::string content = ">seq1 a comment\r\nAC\r\n\r\nGT\r\n>seq2\n>seq3\nMK\nV";
+	BioSeqDataLib::CompactSequenceSet set;
+	BioSeqDataLib::ParallelFastaReader reader(3, 3);
+	reader.parse(content.data(), content.size(), set, std::vector<std::string>{"seq2"}, true);
+	BOOST_REQUIRE_EQUAL(set.size(), 2);
+	BOOST_CHECK_EQUAL(set[0].comment(), "a comment");
+	BOOST_CHECK_EQUAL(set[0].seq(), "ACGT");
+	BOOST_CHECK_EQUAL(set[1].seq(), "MKV");
+	BOOST_CHECK_THROW(reader.parse(content.data(), content.size(), set, std::vector<std::string>{"seq4"}), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,187 @@
+/*
+ * IndexedFasta_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <fstream>
+
+#include "../../src/sequence/IndexedFasta.hpp"
+#include "../../src/sequence/SequenceSet.hpp"
+
+BOOST_AUTO_TEST_SUITE(IndexedFasta_Test)
+
+
+BOOST_AUTO_TEST_CASE( IndexedFasta_build_Test )
+{
+	BioSeqDataLib::IndexedFasta fasta("../tests/sequence/data/indexed.fa");
+	BOOST_REQUIRE_EQUAL(fasta.size(), 4);
+	BOOST_CHECK(fasta.contains("seq2"));
+	BOOST_CHECK(!fasta.contains("seq4"));
+	const BioSeqDataLib::FastaIndexEntry &entry = fasta.entry("seq3");
+	BOOST_CHECK_EQUAL(entry.length, 22);
+	BOOST_CHECK_EQUAL(entry.offset, 84);
+	BOOST_CHECK_EQUAL(entry.lineBases, 10);
+	BOOST_CHECK_EQUAL(entry.lineWidth, 11);
+	BOOST_CHECK_EQUAL(fasta.entries()[2].name, "empty");
+
+	BOOST_CHECK_EQUAL(fasta.fetch("seq1"), "ACGTACGTACACGTAC");
+	BOOST_CHECK_EQUAL(fasta.fetch("seq2"), "MKV");
+	BOOST_CHECK_EQUAL(fasta.fetch("empty"), "");
+	BOOST_CHECK_EQUAL(fasta.fetch("seq3"), "AAAAACCCCCGGGGGTTTTTGG");
+	BOOST_CHECK_EQUAL(fasta.fetch("seq3", 8, 12), "CCGGG");
+	BOOST_CHECK_EQUAL(fasta.fetch("seq3", 21, 21), "G");
+	BOOST_CHECK_THROW(fasta.fetch("seq3", 20, 22), std::out_of_range);
+	BOOST_CHECK_THROW(fasta.fetch("seq4"), std::out_of_range);
+
+	BioSeqDataLib::Sequence<> seq = fasta.sequence<BioSeqDataLib::Sequence<> >("seq1", 5);
+	BOOST_CHECK_EQUAL(seq.name(), "seq1");
+	BOOST_CHECK_EQUAL(seq.comment(), "first sequence");
+	BOOST_CHECK_EQUAL(seq.id(), 5);
+}
+
+BOOST_AUTO_TEST_CASE( IndexedFasta_index_Test )
+{
+	BioSeqDataLib::IndexedFasta fasta("../tests/sequence/data/indexed.fa");
+	fasta.writeIndex("indexed_test.fai");
+	std::ifstream inF("indexed_test.fai");
+	std::string content((std::istreambuf_iterator<char>(inF)), std::istreambuf_iterator<char>());
+	BOOST_CHECK_EQUAL(content, "seq1\t16\t21\t10\t11\nseq2\t3\t45\t3\t4\nempty\t0\t68\t0\t0\nseq3\t22\t84\t10\t11\n");
+
+	BioSeqDataLib::IndexedFasta fasta2("../tests/sequence/data/indexed.fa");
+	fasta2.readIndex("indexed_test.fai");
+	BOOST_CHECK_EQUAL(fasta2.size(), 4);
+	BOOST_CHECK_EQUAL(fasta2.fetch("seq1", 9, 10), "CA");
+	std::remove("indexed_test.fai");
+
+	// an index of a different file is rejected
+	std::ofstream outF("indexed_test.fai");
+	outF << "seq1\t16\t21000\t10\t11\n";
+	outF.close();
+	BOOST_CHECK_THROW(fasta2.readIndex("indexed_test.fai"), BioSeqDataLib::FormatException);
+	std::remove("indexed_test.fai");
+
+	// a broken index keeps the index read before
+	std::ofstream outF3("indexed_test.fai");
+	outF3 << "seq2\t3\t45\t3\t4\nseq1\tx\n";
+	outF3.close();
+	BOOST_CHECK_THROW(fasta2.readIndex("indexed_test.fai"), BioSeqDataLib::FormatException);
+	std::remove("indexed_test.fai");
+	BOOST_CHECK_EQUAL(fasta2.size(), 4);
+	BOOST_CHECK_EQUAL(fasta2.fetch("seq1", 9, 10), "CA");
+	BOOST_CHECK_EQUAL(fasta2.fetch("seq3", 0, 1), "AA");
+
+	// sequences with lines of different length cannot be indexed
+	std::ofstream outF2("indexed_test.fa");
+	outF2 << ">seq1\nACG\nACGT\nA\n";
+	outF2.close();
+	BOOST_CHECK_THROW(BioSeqDataLib::IndexedFasta("indexed_test.fa"), BioSeqDataLib::FormatException);
+	std::remove("indexed_test.fa");
+}
+
+BOOST_AUTO_TEST_CASE( IndexedFasta_SequenceSet_Test )
+{
+	// with an index only the requested sequences are read
+	BioSeqDataLib::IndexedFasta fasta("../tests/sequence/data/indexed.fa");
+	fasta.writeIndex();
+	std::vector<std::string> names = {"seq3", "seq1"};
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+	set.readIndexed("../tests/sequence/data/indexed.fa", names);
+	std::remove("../tests/sequence/data/indexed.fa.fai");
+	BOOST_REQUIRE_EQUAL(set.size(), 2);
+	BOOST_CHECK_EQUAL(set[0].name(), "seq1");
+	BOOST_CHECK_EQUAL(set[0].comment(), "first sequence");
+	BOOST_CHECK_EQUAL(set[1].seq(), "AAAAACCCCCGGGGGTTTTTGG");
+	BOOST_CHECK_EQUAL(set[1].id(), 1);
+
+	// without an index file the index is built in memory
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set2;
+	set2.readIndexed("../tests/sequence/data/indexed.fa", names);
+	BOOST_REQUIRE_EQUAL(set2.size(), 2);
+	BOOST_CHECK_EQUAL(set2[0].seq(), set[0].seq());
+	BOOST_CHECK_EQUAL(set2[1].comment(), set[1].comment());
+	BOOST_CHECK_THROW(set2.readIndexed("../tests/sequence/data/indexed.fa", {"seq4"}), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( IndexedFasta_SequenceSet_read_Test )
+{
+	// the indexed and the streamed reading give the same sequences for duplicated names and tabs in the header, also
+	// when the sequences are removed
+	std::ofstream outF("indexed_test.fa");
+	outF << ">a first copy\nACGTA\nCG\n>b\tx tab\nMKV\n>b other\nGG\n>a second copy\nTTTT\n>c\nCC\n";
+	outF.close();
+	BioSeqDataLib::IndexedFasta("indexed_test.fa").writeIndex();
+	std::vector<std::vector<std::string> > nameSets = {{"a", "b\tx"}, {"b"}, {"c", "a"}, {}};
+	for (const std::vector<std::string> &names : nameSets)
+	{
+		for (bool remove : {false, true})
+		{
+			BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > streamed, indexed;
+			streamed.read("indexed_test.fa", names, remove);
+			indexed.readIndexed("indexed_test.fa", names, remove);
+			BOOST_REQUIRE_EQUAL(indexed.size(), streamed.size());
+			for (size_t i=0; i<streamed.size(); ++i)
+			{
+				BOOST_CHECK_EQUAL(indexed[i].name(), streamed[i].name());
+				BOOST_CHECK_EQUAL(indexed[i].comment(), streamed[i].comment());
+				BOOST_CHECK_EQUAL(indexed[i].seq(), streamed[i].seq());
+				BOOST_CHECK_EQUAL(indexed[i].id(), streamed[i].id());
+			}
+		}
+	}
+	BioSeqDataLib::IndexedFasta fasta("indexed_test.fa");
+	auto entries = fasta.entries("a");
+	BOOST_REQUIRE_EQUAL(entries.size(), 2);
+	BOOST_CHECK_LT(entries[0]->offset, entries[1]->offset);
+	BOOST_CHECK_EQUAL(fasta.entries("b").size(), 2);
+	BOOST_CHECK(fasta.entries("x").empty());
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+	set.readIndexed("indexed_test.fa", {"a"});
+	BOOST_REQUIRE_EQUAL(set.size(), 2);
+	BOOST_CHECK_EQUAL(set[1].comment(), "second copy");
+
+	// the index cuts the name at the tab, read() does not
+	BOOST_CHECK_THROW(set.read("indexed_test.fa", {"b\tx", "x"}), std::runtime_error);
+	BOOST_CHECK_THROW(set.readIndexed("indexed_test.fa", {"b\tx", "x"}), std::runtime_error);
+	std::remove("indexed_test.fa");
+	std::remove("indexed_test.fa.fai");
+}
+
+BOOST_AUTO_TEST_CASE( IndexedFasta_stale_Test )
+{
+	// an index older than the fasta file is not used
+	std::ofstream outF("indexed_test.fa");
+	outF << ">seq1\nACGT\n>seq2\nMKV\n";
+	outF.close();
+	BioSeqDataLib::IndexedFasta("indexed_test.fa").writeIndex();
+	outF.open("indexed_test.fa");
+	outF << ">seq1 longer header\nACGTACGT\n>seq2\nMKVL\n";
+	outF.close();
+	boost::filesystem::last_write_time("indexed_test.fa.fai", boost::filesystem::last_write_time("indexed_test.fa") - 10);
+	BioSeqDataLib::IndexedFasta fasta("indexed_test.fa");
+	BOOST_CHECK_EQUAL(fasta.fetch("seq1"), "ACGTACGT");
+	BOOST_CHECK_EQUAL(fasta.fetch("seq2"), "MKVL");
+
+	// an up to date index is used
+	fasta.writeIndex();
+	BOOST_CHECK_EQUAL(BioSeqDataLib::IndexedFasta("indexed_test.fa").entry("seq2").offset, fasta.entry("seq2").offset);
+	std::remove("indexed_test.fa");
+	std::remove("indexed_test.fa.fai");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,142 @@
+/*
+ * ParallelFastaReader_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../../src/sequence/ParallelFastaReader.hpp"
+#include "../../src/sequence/SequenceSet.hpp"
+
+BOOST_AUTO_TEST_SUITE(ParallelFastaReader_Test)
+
+
+BOOST_AUTO_TEST_CASE( ParallelFastaReader_parse_Test )
+{
+	// every chunk size has to give the same result as SequenceSet::read
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > ref("../tests/sequence/data/seqSet2.fa");
+	for (size_t chunkSize : {1, 5, 100, 10000})
+	{
+		BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+		BioSeqDataLib::ParallelFastaReader reader(3, chunkSize);
+		reader.read("../tests/sequence/data/seqSet2.fa", set);
+		BOOST_REQUIRE_EQUAL(set.size(), ref.size());
+		for (size_t i=0; i<ref.size(); ++i)
+		{
+			BOOST_CHECK_EQUAL(set[i].name(), ref[i].name());
+			BOOST_CHECK_EQUAL(set[i].seq(), ref[i].seq());
+			BOOST_CHECK_EQUAL(set[i].id(), i);
+		}
+	}
+
+	std::string content = "junk\n>seq1 a comment\r\nAC\r\n\r\nGT\r\n>seq2\r\n>seq3\nMK>V\n";
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+	set.emplace_back("seq0", "A", "", "", 0);
+	BioSeqDataLib::ParallelFastaReader reader(2, 4);
+	reader.parse(content.data(), content.size(), set);
+	BOOST_REQUIRE_EQUAL(set.size(), 4);
+	BOOST_CHECK_EQUAL(set[1].name(), "seq1");
+	BOOST_CHECK_EQUAL(set[1].comment(), "a comment");
+	BOOST_CHECK_EQUAL(set[1].seq(), "ACGT");
+	BOOST_CHECK_EQUAL(set[1].id(), 1);
+	BOOST_CHECK_EQUAL(set[2].name(), "seq2");
+	BOOST_CHECK_EQUAL(set[2].seq(), "");
+	BOOST_CHECK_EQUAL(set[3].seq(), "MK>V");
+	BOOST_CHECK_EQUAL(set[3].id(), 3);
+
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set2;
+	reader.parse(content.data(), content.size(), set2, std::vector<std::string>{"seq3", "seq1"});
+	BOOST_REQUIRE_EQUAL(set2.size(), 2);
+	BOOST_CHECK_EQUAL(set2[0].name(), "seq1");
+	BOOST_CHECK_EQUAL(set2[1].name(), "seq3");
+
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set3;
+	reader.parse(content.data(), content.size(), set3, std::vector<std::string>{"seq3", "seq1"}, true);
+	BOOST_REQUIRE_EQUAL(set3.size(), 1);
+	BOOST_CHECK_EQUAL(set3[0].name(), "seq2");
+
+	BOOST_CHECK_THROW(reader.parse(content.data(), content.size(), set3, std::vector<std::string>{"seq4"}), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( ParallelFastaReader_bgzf_Test )
+{
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > ref("../tests/sequence/data/seqSet.fasta");
+	std::ifstream inF("../tests/sequence/data/seqSet.fasta.bgz", std::ios::binary);
+	std::string compressed((std::istreambuf_iterator<char>(inF)), std::istreambuf_iterator<char>());
+	BOOST_CHECK(BioSeqDataLib::ParallelFastaReader::isBgzf(compressed.data(), compressed.size()));
+	BOOST_CHECK(!BioSeqDataLib::ParallelFastaReader::isBgzf(">seq1\nACGT\n", 11));
+
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+	BioSeqDataLib::ParallelFastaReader reader(4, 100);
+	reader.read("../tests/sequence/data/seqSet.fasta.bgz", set);
+	BOOST_REQUIRE_EQUAL(set.size(), ref.size());
+	for (size_t i=0; i<ref.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(set[i].name(), ref[i].name());
+		BOOST_CHECK_EQUAL(set[i].comment(), ref[i].comment());
+		BOOST_CHECK_EQUAL(set[i].seq(), ref[i].seq());
+	}
+
+	// a truncated file is detected
+	std::ofstream outF("truncated.fa.bgz", std::ios::binary);
+	outF.write(compressed.data(), compressed.size()-10);
+	outF.close();
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set2;
+	BOOST_CHECK_THROW(reader.read("truncated.fa.bgz", set2), BioSeqDataLib::FormatException);
+	std::remove("truncated.fa.bgz");
+}
+
+BOOST_AUTO_TEST_CASE( ParallelFastaReader_threads_Test )
+{
+#ifdef _OPENMP
+	size_t nUsed = 0;
+	#pragma omp parallel num_threads(4)
+	{
+		#pragma omp single
+		nUsed = omp_get_num_threads();
+	}
+	BOOST_CHECK_GT(nUsed, 1);
+#endif
+
+	// many small chunks so that every thread splits and parses several of them
+	std::string content;
+	for (size_t i=0; i<2000; ++i)
+		content += ">seq" + std::to_string(i) + " c" + std::to_string(i%7) + "\n" + std::string(1 + i%90, "ACGT"[i%4]) + "\n" + std::string(i%13, 'N') + "\n";
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > ref;
+	BioSeqDataLib::ParallelFastaReader(1, content.size()).parse(content.data(), content.size(), ref);
+	BOOST_REQUIRE_EQUAL(ref.size(), 2000);
+	BioSeqDataLib::SequenceSet<BioSeqDataLib::Sequence<> > set;
+	BioSeqDataLib::ParallelFastaReader reader(4, 256);
+	reader.parse(content.data(), content.size(), set);
+	BOOST_REQUIRE_EQUAL(set.size(), ref.size());
+	for (size_t i=0; i<ref.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(set[i].name(), ref[i].name());
+		BOOST_CHECK_EQUAL(set[i].comment(), ref[i].comment());
+		BOOST_CHECK_EQUAL(set[i].seq(), ref[i].seq());
+		BOOST_CHECK_EQUAL(set[i].id(), i);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,4 +9,7 @@
 #include "../sequence/Sequence_Test.hpp"
 #include "../sequence/SequenceSet_Test.hpp"
 #include "../sequence/Alignment_Test.hpp"
+#include "../sequence/IndexedFasta_Test.hpp"
+#include "../sequence/ParallelFastaReader_Test.hpp"
+#include "../sequence/CompactSequenceSet_Test.hpp"
 
@@ -12,6 +12,12 @@
 #include "../../src/utility/DSM.hpp"
 #include "../../src/domain/PfamDomain.hpp"
 
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 
 
@@ -47,6 +53,54 @@ BOOST_AUTO_TEST_CASE( DSM_Test)
 	BOOST_CHECK_THROW(mat.val("xxx", "xxx"), std::out_of_range);
 }
 
+BOOST_AUTO_TEST_CASE( DSM_id_Test)
+{
+	BioSeqDataLib::DSM mat("../tests/utility/data/DSMtest.mat");
+	BOOST_CHECK_EQUAL(mat.nDomains(), 5);
+	BOOST_CHECK_EQUAL(mat.id("PF00405"), 0);
+	BOOST_CHECK_EQUAL(mat.id("PF12299"), 4);
+	BOOST_CHECK_THROW(mat.id("xxx"), std::out_of_range);
+
+	// the id based lookup returns the same values as the accession based one
+	std::vector<std::string> accs = {"PF00405", "PF02458", "PF02965", "PF12279", "PF12299"};
+	BioSeqDataLib::DSM copy = mat;
+	for (bool negative : {false, true})
+	{
+		copy.useNegative(negative);
+		for (const std::string &acc1 : accs)
+		{
+			for (const std::string &acc2 : accs)
+			{
+				BOOST_CHECK_EQUAL(copy.val(mat.id(acc1), mat.id(acc2)), copy.val(acc1, acc2));
+				BOOST_CHECK_EQUAL(copy.val(mat.id(acc1), mat.id(acc2)), copy.val(mat.id(acc2), mat.id(acc1)));
+			}
+		}
+	}
+	BOOST_CHECK_EQUAL(copy.val(mat.id("PF12279"), mat.id("PF02965")), -78);
+	BOOST_CHECK_EQUAL(mat.val(mat.id("PF12279"), mat.id("PF02965")), 11);
+
+	BOOST_CHECK_THROW(BioSeqDataLib::DSM("../tests/utility/data/nonExisting.mat"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( DSM_truncated_Test)
+{
+	std::ifstream inF("../tests/utility/data/DSMtest.mat", std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(inF)), std::istreambuf_iterator<char>());
+	std::ofstream outF("truncated.mat", std::ios::binary);
+	outF.write(content.data(), content.size()-4);
+	outF.close();
+
+	// a failed read keeps the matrix read before
+	BioSeqDataLib::DSM mat("../tests/utility/data/DSMtest.mat");
+	BOOST_CHECK_THROW(mat.read("truncated.mat"), std::runtime_error);
+	std::remove("truncated.mat");
+	BOOST_CHECK_EQUAL(mat.nDomains(), 5);
+	BOOST_CHECK_EQUAL(mat.threshold(), 10);
+	BOOST_CHECK_EQUAL(mat.val("PF12279","PF02965"), 11);
+	BOOST_CHECK_EQUAL(mat.val("PF02458","PF12279"), 51);
+	BOOST_CHECK_EQUAL(mat.val(mat.id("PF02458"), mat.id("PF02458")), 100);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -55,6 +55,54 @@ BOOST_AUTO_TEST_CASE( SimilarityMatrix_Test)
 	BOOST_CHECK_EQUAL(matrices3[2][6][6], 8);
 }
 
+BOOST_AUTO_TEST_CASE( MatrixStack_storage_Test)
+{
+	// all matrices share a single block of memory
+	BioSeqDataLib::MatrixStack<4, int> matrices(3, 5, 1);
+	BOOST_CHECK_EQUAL(matrices.capacity(), 4*3*5);
+	for (size_t k=1; k<4; ++k)
+		BOOST_CHECK_EQUAL(matrices[k].data(), matrices[k-1].data() + 15);
+	BOOST_CHECK_EQUAL(matrices[3][2][4], 1);
+	matrices[3][2][4] = 5;
+
+	BioSeqDataLib::MatrixStack<4, int> copy(matrices);
+	BOOST_CHECK_EQUAL(copy[3][2][4], 5);
+	copy[3][2][4] = 6;
+	BOOST_CHECK_EQUAL(matrices[3][2][4], 5);
+	BOOST_CHECK_EQUAL(copy[1].data(), copy[0].data() + 15);
+	matrices = copy;
+	BOOST_CHECK_EQUAL(matrices[3][2][4], 6);
+
+	// resizing within the capacity does not reallocate
+	const int *data = matrices[0].data();
+	matrices.resize(7, 2);
+	BOOST_CHECK_EQUAL(matrices.dim1(), 7);
+	BOOST_CHECK_EQUAL(matrices.dim2(), 2);
+	BOOST_CHECK_EQUAL(matrices[0].data(), data);
+	BOOST_CHECK_EQUAL(matrices[3].data(), data + 3*14);
+	BOOST_CHECK_EQUAL(matrices[2].dim1(), 7);
+	matrices.resize(8, 8);
+	BOOST_CHECK_EQUAL(matrices.capacity(), 4*8*8);
+	BOOST_CHECK_EQUAL(matrices[3].dim2(), 8);
+	matrices[3][7][7] = 2;
+	BOOST_CHECK_EQUAL(matrices[3][7][7], 2);
+
+	// reserving memory for a matrix of the stack detaches it and keeps its values
+	matrices[1].fill(4);
+	matrices[1][0][1] = 9;
+	matrices[1].reserve(10, 10);
+	BOOST_CHECK_EQUAL(matrices[1].capacity(), 100);
+	BOOST_CHECK_EQUAL(matrices[1].dim1(), 8);
+	BOOST_CHECK_EQUAL(matrices[1][0][1], 9);
+	BOOST_CHECK_EQUAL(matrices[1][7][7], 4);
+	matrices[1][7][7] = 3;
+	BOOST_CHECK_EQUAL(matrices[3][7][7], 2);
+	matrices[2][5][5] = 7;
+	matrices[2].resize(8, 8);
+	BOOST_CHECK_EQUAL(matrices[2].capacity(), 64);
+	BOOST_CHECK_EQUAL(matrices[2][5][5], 7);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -59,6 +59,59 @@ BOOST_AUTO_TEST_CASE( Matrix_Test)
 
 }
 
+BOOST_AUTO_TEST_CASE( Matrix_storage_Test)
+{
+	BioSeqDataLib::Matrix<int> mat(3, 4);
+	for (size_t i=0; i<3; ++i)
+	{
+		for (size_t j=0; j<4; ++j)
+			mat[i][j] = i*4+j;
+	}
+
+	// rows are stored one after another
+	BOOST_CHECK_EQUAL(mat[0].size(), 4);
+	BOOST_CHECK_EQUAL(&mat[1][0], &mat[0][0] + 4);
+	BOOST_CHECK_EQUAL(mat[2].begin(), mat.data() + 8);
+	BOOST_CHECK_EQUAL(mat.end() - mat.begin(), 12);
+	int expected = 0;
+	for (auto value : mat)
+		BOOST_CHECK_EQUAL(value, expected++);
+	int sum = 0;
+	for (auto value : mat[1])
+		sum += value;
+	BOOST_CHECK_EQUAL(sum, 4+5+6+7);
+
+	// copies are deep
+	BioSeqDataLib::Matrix<int> copy(mat);
+	copy[1][1] = 42;
+	BOOST_CHECK_EQUAL(mat[1][1], 5);
+	const BioSeqDataLib::Matrix<int> &constMat = copy;
+	BOOST_CHECK_EQUAL(constMat[1][1], 42);
+
+	// smaller or equally large matrices reuse the memory
+	const int *data = mat.data();
+	mat.resize(2, 5);
+	BOOST_CHECK_EQUAL(mat.dim1(), 2);
+	BOOST_CHECK_EQUAL(mat.dim2(), 5);
+	BOOST_CHECK_EQUAL(mat.capacity(), 12);
+	BOOST_CHECK_EQUAL(mat.data(), data);
+	BOOST_CHECK_EQUAL(&mat[1][0], &mat[0][0] + 5);
+	mat.resize(6, 2);
+	BOOST_CHECK_EQUAL(mat.data(), data);
+	mat.resize(5, 5);
+	BOOST_CHECK_EQUAL(mat.capacity(), 25);
+	mat.fill(3);
+	BOOST_CHECK_EQUAL(mat[4][4], 3);
+
+	BioSeqDataLib::Matrix<int> reserved;
+	reserved.reserve(10, 10);
+	BOOST_CHECK_EQUAL(reserved.dim1(), 0);
+	BOOST_CHECK_EQUAL(reserved.capacity(), 100);
+	data = reserved.data();
+	reserved.resize(7, 14);
+	BOOST_CHECK_EQUAL(reserved.data(), data);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif /* MATRIX_TEST_HPP_ */
@@ -0,0 +1,76 @@
+/*
+ * PackedMatrix_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PACKEDMATRIX_TEST_HPP_
+#define PACKEDMATRIX_TEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../../src/utility/PackedMatrix.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(PackedMatrix_Test)
+
+
+BOOST_AUTO_TEST_CASE( PackedMatrix_Test)
+{
+	BioSeqDataLib::PackedMatrix<2> mat(3, 7);
+	BOOST_CHECK_EQUAL(mat.dim1(), 3);
+	BOOST_CHECK_EQUAL(mat.dim2(), 7);
+	// two bytes per row
+	BOOST_CHECK_EQUAL(mat.capacity(), 6);
+	BOOST_CHECK_EQUAL(mat.row(1), mat.row(0) + 2);
+	BOOST_CHECK_EQUAL(mat.get(2, 6), 0);
+
+	mat.set(1, 5, 3);
+	mat.set(1, 6, 2);
+	mat.set(1, 5, 1);
+	BOOST_CHECK_EQUAL(mat.get(1, 5), 1);
+	BOOST_CHECK_EQUAL(mat.get(1, 6), 2);
+	BOOST_CHECK_EQUAL(mat.get(1, 4), 0);
+	BOOST_CHECK_EQUAL(mat.get(2, 5), 0);
+
+	BioSeqDataLib::PackedMatrix<2>::RowWriter writer(mat.row(2));
+	for (unsigned int j=0; j<7; ++j)
+		writer.push(j%4);
+	writer.flush();
+	for (unsigned int j=0; j<7; ++j)
+		BOOST_CHECK_EQUAL(mat.get(2, j), j%4);
+	BOOST_CHECK_EQUAL(BioSeqDataLib::PackedMatrix<2>::value(mat.row(2), 6), 2);
+	BOOST_CHECK_EQUAL(mat.get(1, 6), 2);
+
+	// resizing within the capacity does not reallocate
+	const unsigned char *data = mat.row(0);
+	mat.resize(6, 3);
+	BOOST_CHECK_EQUAL(mat.row(0), data);
+	BOOST_CHECK_EQUAL(mat.row(5), data + 5);
+	mat.resize(4, 17);
+	BOOST_CHECK_EQUAL(mat.capacity(), 20);
+
+	BioSeqDataLib::PackedMatrix<4> mat4(2, 3);
+	mat4.set(1, 2, 13);
+	mat4.set(1, 1, 6);
+	BOOST_CHECK_EQUAL(mat4.get(1, 2), 13);
+	BOOST_CHECK_EQUAL(mat4.get(1, 1), 6);
+	BOOST_CHECK_EQUAL(BioSeqDataLib::PackedMatrix<4>::mask, 15);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif /* PACKEDMATRIX_TEST_HPP_ */
@@ -0,0 +1,73 @@
+/*
+ * TriangularMatrix_Test.hpp
+ *
+ *  This file is part of BioSeqDataLib.
+ *
+ *  BioSeqDataLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  BioSeqDataLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with BioSeqDataLib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TRIANGULARMATRIX_TEST_HPP_
+#define TRIANGULARMATRIX_TEST_HPP_
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../../src/utility/TriangularMatrix.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(TriangularMatrix_Test)
+
+
+BOOST_AUTO_TEST_CASE( TriangularMatrix_Test)
+{
+	BioSeqDataLib::TriangularMatrix<int> mat(4, 1);
+	BOOST_CHECK_EQUAL(mat.dim(), 4);
+	BOOST_CHECK_EQUAL(mat.size(), 6);
+	BOOST_CHECK_EQUAL(mat(3, 2), 1);
+
+	mat(1, 3) = 5;
+	BOOST_CHECK_EQUAL(mat(3, 1), 5);
+	BOOST_CHECK_EQUAL(mat.row(3)[1], 5);
+	BOOST_CHECK_EQUAL(mat.data()[BioSeqDataLib::TriangularMatrix<int>::index(1, 3)], 5);
+	BOOST_CHECK_EQUAL(mat.row(2), mat.data() + 1);
+
+	// growing keeps the existing rows
+	mat.resize(5, 7);
+	BOOST_CHECK_EQUAL(mat.size(), 10);
+	BOOST_CHECK_EQUAL(mat(3, 1), 5);
+	BOOST_CHECK_EQUAL(mat(4, 0), 7);
+	BOOST_CHECK_EQUAL(mat(1, 0), 1);
+
+	mat.fill(2);
+	BOOST_CHECK_EQUAL(mat(3, 1), 2);
+
+	BioSeqDataLib::Matrix<int> full(3, 3);
+	for (size_t i=0; i<3; ++i)
+		for (size_t j=0; j<3; ++j)
+			full[i][j] = 10*i + j;
+	BioSeqDataLib::TriangularMatrix<int> lower(full);
+	BOOST_CHECK_EQUAL(lower.dim(), 3);
+	BOOST_CHECK_EQUAL(lower(1, 0), 10);
+	BOOST_CHECK_EQUAL(lower(0, 2), 20);
+	BOOST_CHECK_EQUAL(lower(2, 1), 21);
+
+	BioSeqDataLib::TriangularMatrix<int> moved(std::move(lower));
+	BOOST_CHECK_EQUAL(moved(2, 1), 21);
+	BOOST_CHECK_EQUAL(lower.dim(), 0);
+	BOOST_CHECK_EQUAL(lower.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+#endif /* TRIANGULARMATRIX_TEST_HPP_ */
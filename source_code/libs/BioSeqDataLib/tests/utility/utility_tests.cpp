@@ -31,6 +31,8 @@
 
 #include "Matrix_Test.hpp"
 #include "MatrixStack_Test.hpp"
+#include "PackedMatrix_Test.hpp"
+#include "TriangularMatrix_Test.hpp"
 #include "SimilarityMatrix_Test.hpp"
 #include "Helpers_Test.hpp"
 #include "TwoValues_Test.hpp"
@@ -13,12 +13,15 @@
  * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <set>
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <numeric>
 #include <stdexcept>
 #include <regex>
@@ -36,12 +39,14 @@
 #include "../libs/BioSeqDataLib/src/external/Output.hpp"
 #include "../libs/BioSeqDataLib/src/phylogeny/PhylogeneticTree.hpp"
 #include "../libs/BioSeqDataLib/src/phylogeny/Tree.hpp"
+#include "../libs/BioSeqDataLib/src/phylogeny/MultiLayerTree.hpp"
 #include "../libs/BioSeqDataLib/src/phylogeny/fitch.hpp"
 #include "../libs/BioSeqDataLib/src/phylogeny/dollo.hpp"
 
 //DomRates header
 #include "domRates.hpp"
 #include "helperStructs.hpp"
+#include "profiling.hpp"
 #include "version.hpp"
 
 namespace BSDL = BioSeqDataLib;
@@ -119,6 +124,10 @@ check_fusion(const map<vector<string>,unsigned int> & domorder, const map<unsign
         }
     }
 
+    if (!new_rrgmnt.empty()) {
+        domRatesProfile().counters.fusion_comparisons.fetch_add(new_rrgmnt.size() - 1, std::memory_order_relaxed);
+    }
+
     return std::pair<unsigned int, vector<std::pair<string,string>>>(fus_even, all_fusions);
 }
 
@@ -127,6 +136,7 @@ check_fission_termLoss_event(const map<vector<string>,unsigned int> & domorder,
 {
     unsigned int fission_events = 0;
     unsigned int termLoss_events = 0;
+    unsigned long long comparisons = 0;
     vector<string> act_rrngmnt = posorder.find(posi)->second;
     auto size_act_rrngmnt = act_rrngmnt.size();
 
@@ -134,6 +144,7 @@ check_fission_termLoss_event(const map<vector<string>,unsigned int> & domorder,
     {
         if (pNode[parent_present_pos] == 1)
         {
+            ++comparisons;
             if(posorder.find(parent_present_pos)->second.size() > size_act_rrngmnt)
             {
                 vector<string> subarrangement_front(posorder.find(parent_present_pos)->second.begin(),
@@ -197,6 +208,8 @@ check_fission_termLoss_event(const map<vector<string>,unsigned int> & domorder,
         }
     }
 
+    domRatesProfile().counters.fission_termLoss_comparisons.fetch_add(comparisons, std::memory_order_relaxed);
+
     return {fission_events, termLoss_events};
 }
 
@@ -205,12 +218,15 @@ std::pair<unsigned int, string>
 check_termGain(const map< unsigned int,vector<string>> & posorder, const vector<int> & singleDom_parent_vec, const map<string,unsigned int> & single_domainorder, const vector<int> & parent_states, const unsigned int &posi)
 {
     unsigned int term_gain_eve = 0;
+    unsigned long long comparisons = 0;
     auto size_parent_arrangement = posorder.find(posi)->second.size()-1;
+    std::pair<unsigned int, string> result(term_gain_eve, "");
 
     for(unsigned int k = 0; k<parent_states.size(); ++k)
     {
         if(parent_states[k] == 1)
         {
+            ++comparisons;
             if(posorder.find(k)->second.size() == size_parent_arrangement)
             {
                 vector<string> subarrangement_front(posorder.find(posi)->second.begin(),
@@ -219,21 +235,29 @@ check_termGain(const map< unsigned int,vector<string>> & posorder, const vector<
                                                    posorder.find(posi)->second.end());
                 if(subarrangement_front == posorder.find(k)->second)
                 {
-                    if(singleDom_parent_vec[single_domainorder.find(posorder.find(posi)->second.back())->second] == -1) return std::pair<unsigned int, string>(++term_gain_eve, posorder.find(posi)->second.back());
+                    if(singleDom_parent_vec[single_domainorder.find(posorder.find(posi)->second.back())->second] == -1) {
+                        result = std::pair<unsigned int, string>(++term_gain_eve, posorder.find(posi)->second.back());
+                        break;
+                    }
                 }
                 if(subarrangement_back == posorder.find(k)->second)
                 {
-                    if(singleDom_parent_vec[single_domainorder.find(posorder.find(posi)->second.front())->second] == -1) return std::pair<unsigned int, string>(++term_gain_eve, posorder.find(posi)->second.front());
+                    if(singleDom_parent_vec[single_domainorder.find(posorder.find(posi)->second.front())->second] == -1) {
+                        result = std::pair<unsigned int, string>(++term_gain_eve, posorder.find(posi)->second.front());
+                        break;
+                    }
                 }
             }
         }
     }
 
-    return std::pair<unsigned int, string>(term_gain_eve, "");
+    domRatesProfile().counters.termGain_comparisons.fetch_add(comparisons, std::memory_order_relaxed);
+
+    return result;
 }
 
 unsigned int
-findLCA(const string &lca, const BSDL::PhylogeneticTree<vector<int> > & nTree)
+findLCA(const string &lca, const BSDL::MultiLayerTree & nTree)
 {
 
     string spec1, spec2;
@@ -247,8 +271,8 @@ findLCA(const string &lca, const BSDL::PhylogeneticTree<vector<int> > & nTree)
         throw std::runtime_error("Error (-n option): Please check if exactly two species provided and separated by ':' (e.g.: -n Drosophila_melanogaster:Caenorhabditis_elegans)");
     }
 
-    const BSDL::TreeNodePhylo<vector<int> >* spen1 = nullptr;
-    const BSDL::TreeNodePhylo<vector<int> >* spen2 = nullptr;
+    const BSDL::MultiLayerTree::NodeType* spen1 = nullptr;
+    const BSDL::MultiLayerTree::NodeType* spen2 = nullptr;
     unsigned int lca_specs_f = 0;
 
     for(auto lcaNode=nTree.preorderBegin(); lcaNode!= nTree.preorderEnd(); ++lcaNode) {
@@ -298,92 +322,135 @@ findLCA(const string &lca, const BSDL::PhylogeneticTree<vector<int> > & nTree)
 }
 
 std::pair<posOrderMaps, eventMaps>
-saveDomData(BSDL::PhylogeneticTree<vector<int> > & nTree, BSDL::PhylogeneticTree<vector<int> > & singleDomTree, const fs::path &annotationDirectory, const string &outgroup, const string &ending)
+saveDomData(BSDL::MultiLayerTree & nTree, const fs::path &annotationDirectory, const string &outgroup, const string &ending)
 {
     eventMaps treeEvents;
     posOrderMaps pomaps;
     unsigned int counter = 0;
     unsigned int counter2 = 0;
-
-    auto bNode = singleDomTree.preorderBegin();
+    // known arrangements by the hash of their collapsed accessions, to look them up without building a key first
+    std::unordered_map<size_t, vector<std::pair<unsigned int, const vector<string> *> > > arrangementIndex;
+    vector<string> nDomVec;
+
+    // check if outgroup exists in tree and is located closest to root. The root divides the outgroup branch of the
+    // unrooted tree: for a bifurcating root it consists of the edges to the outgroup and to the ingroup, for a
+    // multifurcating root only of the edge to the outgroup. Events on it would count all differences between outgroup
+    // and ingroup. If no child of the root is a leaf, all edges starting at the root are skipped.
+    const BSDL::MultiLayerTree::NodeType &root = nTree.root();
+    const BSDL::MultiLayerTree::NodeType *outgroupNode = nullptr;
+    bool leafBelowRoot = false;
+    for (size_t i = 0; i < root.nChildren(); ++i) {
+        if (root.child(i)->isLeaf()) {
+            leafBelowRoot = true;
+            if (root.child(i)->name == outgroup) {
+                outgroupNode = root.child(i);
+            }
+        }
+    }
+    if (outgroupNode != nullptr) {
+        treeEvents.outgroup_edges.insert(outgroupNode->id);
+    }
+    else if (leafBelowRoot) {
+        throw std::runtime_error("Error (-g / --outgroup): Please check if an outgroup with this name exists in the tree and if its branch is closest to the root");
+    }
+    if (outgroupNode == nullptr || root.nChildren() == 2) {
+        for (size_t i = 0; i < root.nChildren(); ++i) {
+            treeEvents.outgroup_edges.insert(root.child(i)->id);
+        }
+    }
 
     for (auto aNode=nTree.preorderBegin(); aNode!=nTree.preorderEnd(); ++aNode)
     {
 
-        treeEvents.treemap[aNode->id] = &*aNode;
-        treeEvents.id_to_tree[bNode->id] = &*bNode;
         treeEvents.identities_node[aNode->id] = 0;
         treeEvents.events_per_node[aNode->id].assign(6, 0);
 
         if(aNode->isLeaf())
         {
-            if (!pomaps.domainorder.empty()) {
-                aNode->data.assign(pomaps.domainorder.size(), -1);
-                bNode->data.assign(pomaps.single_domainorder.size(), -1);
-            }
+            vector<int> &arrangementStates = nTree.states(arrangementLayer, aNode->id);
+            vector<int> &singleDomStates = nTree.states(singleDomainLayer, aNode->id);
 
-            // check if outgroup exists in tree and is located closest to root
-            if (aNode->parent()->parent() == nullptr && aNode->name != outgroup) {
-                throw std::runtime_error("Error (-g / --outgroup): Please check if an outgroup with this name exists in the tree and if its branch is closest to the root");
+            if (!pomaps.domainorder.empty()) {
+                arrangementStates.assign(pomaps.domainorder.size(), -1);
+                singleDomStates.assign(pomaps.single_domainorder.size(), -1);
             }
 
             BSDL::DomainArrangementSet<BSDL::Domain> arrangementSet;
             fs::path nafile = aNode->name + ending;
             fs::path filepan = annotationDirectory / nafile;
 
-            arrangementSet.read(filepan);
-            arrangementSet.solveDbOverlaps({BSDL::DomainDB::pfam, BSDL::DomainDB::superfamily, BSDL::DomainDB::gene3d, BSDL::DomainDB::unknown},10,0.1);
+            {
+                phaseTimer timer(domRatesProfile(), "annotation parse");
+                arrangementSet.read(filepan);
+            }
+
+            workCounters &counters = domRatesProfile().counters;
+            ++counters.files_read;
+            counters.proteins_read += arrangementSet.size();
+            for (auto & arrangement : arrangementSet) {
+                counters.hits_parsed += arrangement.second.size();
+            }
 
-            for (auto & arrangement : arrangementSet)
             {
-                auto collapsed_arrangement = arrangement.second;
-                collapsed_arrangement.collapse();
-                vector<string> nDomVec;
-                string sca = collapsed_arrangement.str();
-                boost::split(nDomVec, sca, boost::is_any_of("- "), boost::token_compress_on);
+                phaseTimer timer(domRatesProfile(), "overlap resolution");
+                arrangementSet.solveDbOverlaps({BSDL::DomainDB::pfam, BSDL::DomainDB::superfamily, BSDL::DomainDB::gene3d, BSDL::DomainDB::unknown},10,0.1);
+            }
 
-                if (!pomaps.domainorder.count(nDomVec)) {
+            phaseTimer timer(domRatesProfile(), "arrangement interning");
+            for (auto & arrangement : arrangementSet)
+            {
+                const auto &domArrangement = arrangement.second;
+                auto &candidates = arrangementIndex[domArrangement.collapsedHash()];
+                auto known = std::find_if(candidates.begin(), candidates.end(), [&domArrangement](const std::pair<unsigned int, const vector<string> *> &cand) {
+                    return domArrangement.collapsedEquals(*cand.second);
+                });
+
+                if (known == candidates.end()) {
+                    domArrangement.collapsedAccessions(nDomVec);
                     pomaps.posorder[counter] = nDomVec;
-                    pomaps.domainorder[nDomVec] = counter++;
-                    aNode->data.resize(pomaps.domainorder.size(),1);
+                    pomaps.domainorder[nDomVec] = counter;
+                    candidates.emplace_back(counter, &pomaps.posorder[counter]);
+                    ++counter;
+                    arrangementStates.resize(pomaps.domainorder.size(),1);
                 }
                 else {
-                    aNode->data[pomaps.domainorder[nDomVec]] = 1;
+                    arrangementStates[known->first] = 1;
                 }
 
 
-                for(auto & single_dom : collapsed_arrangement)
+                for(auto & single_dom : domArrangement)
                 {
-                    string ssd = single_dom.accession();
-                    if (!pomaps.single_domainorder.count(ssd)) {
+                    const string &ssd = single_dom.accession();
+                    auto known_dom = pomaps.single_domainorder.find(ssd);
+                    if (known_dom == pomaps.single_domainorder.end()) {
                         pomaps.single_posorder[counter2] = ssd;
                         pomaps.single_domainorder[ssd] = counter2++;
-                        bNode->data.resize(pomaps.single_domainorder.size(),1);
+                        singleDomStates.resize(pomaps.single_domainorder.size(),1);
                     }
                     else {
-                        bNode->data[pomaps.single_domainorder[single_dom.accession()]] = 1;
+                        singleDomStates[known_dom->second] = 1;
                     }
                 }
             }
         }
-        ++bNode;
     }
 
-    bNode = singleDomTree.preorderBegin();
     for (auto aNode=nTree.preorderBegin(); aNode!=nTree.preorderEnd(); ++aNode) {
         if(aNode-> isLeaf()) {
-            aNode->data.resize(pomaps.domainorder.size(), -1);
-            bNode->data.resize(pomaps.single_domainorder.size(), -1);
+            nTree.states(arrangementLayer, aNode->id).resize(pomaps.domainorder.size(), -1);
+            nTree.states(singleDomainLayer, aNode->id).resize(pomaps.single_domainorder.size(), -1);
         }
-        ++bNode;
     }
 
+    domRatesProfile().counters.arrangements_interned = pomaps.domainorder.size();
+    domRatesProfile().counters.single_domains_interned = pomaps.single_domainorder.size();
+
     return std::pair<posOrderMaps, eventMaps>(pomaps, treeEvents);
 }
 
 
 std::pair<solutionTypes, eventTypes>
-eventReconstruction(const posOrderMaps &pomaps, eventMaps &emaps, const unsigned int &nthreads) {
+eventReconstruction(const BSDL::MultiLayerTree &nTree, const posOrderMaps &pomaps, eventMaps &emaps, const unsigned int &nthreads) {
     solutionTypes sTypes;
     eventTypes eTypes;
 
@@ -409,23 +476,23 @@ eventReconstruction(const posOrderMaps &pomaps, eventMaps &emaps, const unsigned
     #pragma omp parallel num_threads(nthreads)
     {
         #pragma omp for reduction(+:fusion, fission, termGain, termLoss, singleDomGain, singleDomLoss, exact_solution, non_ambiguous_solution, ambiguous_solution, complex_solution, identities_total) reduction(merge: event_listing, complex_listing, identities_listing)
-        for (unsigned int ind = 0; ind < emaps.treemap.size(); ++ind) {
+        for (unsigned int ind = 0; ind < nTree.nNodes(); ++ind) {
 
-            BSDL::TreeNodePhylo<vector<int> >* actNode = emaps.treemap.at(ind);
+            const BSDL::MultiLayerTree::NodeType* actNode = &nTree.node(ind);
 
-            // don't count events if current node is outgroup or root or first successor of root
-            // first successor of root would count all differences between outgroup and rest of the tree
-            if (actNode->parent() != nullptr and actNode->parent()->parent() != nullptr) {
+            // don't count events if current node is root or its edge belongs to the outgroup branch
+            // (see saveDomData), it would count all differences between outgroup and rest of the tree
+            if (actNode->parent() != nullptr and !emaps.outgroup_edges.count(actNode->id)) {
 
-                vector<int> parentNode_data = actNode->parent()->data;
-                vector<int> actNode_data = actNode->data;
+                const vector<int> &parentNode_data = nTree.states(arrangementLayer, actNode->parent()->id);
+                const vector<int> &actNode_data = nTree.states(arrangementLayer, actNode->id);
                 set<unsigned int> certain_fission;
                 // helper_nonambig_fissions[pos second fission part] = pair< pos first fission part, vector<fission part positions> >
                 map<unsigned int, std::pair< unsigned int, vector<std::pair<unsigned int, unsigned int> > > > helper_nonambig_fissions;
 
                 // create set with single domains for parent and current node
-                vector<int> singleDom_actNode_vec = emaps.id_to_tree.at(actNode->id)->data;
-                vector<int> singleDom_parent_vec = emaps.id_to_tree.at(actNode->parent()->id)->data;
+                const vector<int> &singleDom_actNode_vec = nTree.states(singleDomainLayer, actNode->id);
+                const vector<int> &singleDom_parent_vec = nTree.states(singleDomainLayer, actNode->parent()->id);
 
                 for (unsigned int i = 0; i < pomaps.domainorder.size(); ++i) {
                     int parental_state = parentNode_data[i];
@@ -799,8 +866,82 @@ eventReconstruction(const posOrderMaps &pomaps, eventMaps &emaps, const unsigned
     return {sTypes, eTypes};
 }
 
+namespace {
+
+/*
+ * events per unit branch length and element at risk, "NA" if the exposure is zero
+ */
+string
+rateStr(const double &events, const double &exposure)
+{
+    if (exposure <= 0) {
+        return "NA";
+    }
+    std::ostringstream rate;
+    rate << fixed << setprecision(6) << events / exposure;
+    return rate.str();
+}
+
+}
+
+void
+writeEdgeRates(const BSDL::MultiLayerTree &nTree, const eventMaps &emaps, const fs::path &ratesOut)
+{
+    // the first four event types change domain arrangements, the last two single domains
+    const unsigned int nEventTypes = 6;
+    const unsigned int nArrangementEvents = 4;
+
+    vector<double> totalEvents(nEventTypes, 0);
+    double totalLength = 0;
+    double arrangementExposure = 0;
+    double singleDomExposure = 0;
+
+    AlgorithmPack::Output rout(ratesOut);
+    rout << fixed << setprecision(6);
+    rout << "# Branch length normalized event rates per edge (all events per unit branch length, and events of each type per unit branch length and per arrangement/single domain present at the parental node)." << "\n";
+    rout << "# Node ID\tBranchLength\tArrangementsAtRisk\tSingleDomainsAtRisk\tEventsPerBranchLength\tFusionRate\tFissionRate\tTerminalLossRate\tTerminalEmergenceRate\tSingleDomainLossRate\tSingleDomainEmergenceRate" << "\n";
+
+    for (auto actNode = nTree.preorderBegin(); actNode != nTree.preorderEnd(); ++actNode) {
+        // events are not reconstructed for the root and the edges of the outgroup branch
+        if (actNode->parent() == nullptr || emaps.outgroup_edges.count(actNode->id)) {
+            continue;
+        }
+
+        const vector<int> &parentArrangements = nTree.states(arrangementLayer, actNode->parent()->id);
+        const vector<int> &parentSingleDoms = nTree.states(singleDomainLayer, actNode->parent()->id);
+        const vector<unsigned int> &events = emaps.events_per_node.at(actNode->id);
+
+        double length = actNode->edgeLength;
+        auto arrangementsAtRisk = std::count(parentArrangements.begin(), parentArrangements.end(), 1);
+        auto singleDomsAtRisk = std::count(parentSingleDoms.begin(), parentSingleDoms.end(), 1);
+
+        totalLength += length;
+        arrangementExposure += length * arrangementsAtRisk;
+        singleDomExposure += length * singleDomsAtRisk;
+
+        // all events of the edge, "NA" for edges of length zero like the tree-wide rates
+        double edgeEvents = std::accumulate(events.begin(), events.end(), 0.0);
+        rout << actNode->id << "\t" << length << "\t" << arrangementsAtRisk << "\t" << singleDomsAtRisk << "\t" << rateStr(edgeEvents, length);
+        for (unsigned int i = 0; i < nEventTypes; ++i) {
+            totalEvents[i] += events[i];
+            rout << "\t" << rateStr(events[i], length * (i < nArrangementEvents ? arrangementsAtRisk : singleDomsAtRisk));
+        }
+        rout << "\n";
+    }
+
+    const vector<string> eventNames = {"Fusion", "Fission", "Terminal Loss", "Terminal Emergence", "Single Domain Loss", "Single Domain Emergence"};
+
+    rout << "# Tree-wide rates (events of all evaluated edges divided by their summed branch length and by the summed branch length times elements at risk)." << "\n";
+    rout << "Evaluated branch length: " << totalLength << "\n";
+    rout << "# Event type\tEventsPerBranchLength\tEventsPerBranchLengthAndElementAtRisk" << "\n";
+    for (unsigned int i = 0; i < nEventTypes; ++i) {
+        rout << eventNames[i] << "\t" << rateStr(totalEvents[i], totalLength) << "\t"
+             << rateStr(totalEvents[i], i < nArrangementEvents ? arrangementExposure : singleDomExposure) << "\n";
+    }
+}
+
 void
-summary(BSDL::PhylogeneticTree<vector<int> > &nTree, const eventMaps &emaps, const solutionTypes &sTypes, const eventTypes &eTypes, const fs::path &outFile, const fs::path &addOut, const string &lca, const unsigned int &lca_id, const bool &detailed, const string &domrates_param_str)
+summary(const BSDL::MultiLayerTree &nTree, const eventMaps &emaps, const solutionTypes &sTypes, const eventTypes &eTypes, const fs::path &outFile, const fs::path &addOut, const string &lca, const unsigned int &lca_id, const bool &detailed, const string &domrates_param_str)
 {
 
     AlgorithmPack::Output out(outFile);
@@ -907,28 +1048,23 @@ summary(BSDL::PhylogeneticTree<vector<int> > &nTree, const eventMaps &emaps, con
         for(auto &el : eventset) {
             asout << el << "\n";
         }
+
+        writeEdgeRates(nTree, emaps, alter_filename(addOut, "_rates"));
     }
 }
 
 void
-analyseDomRates(const string &treeFile, const fs::path &annotationDirectory, const string &outgroup, const string &ending, const fs::path &outFile, const fs::path &addOut, const string &lca, const bool &detailed, const unsigned int &nthreads, const string &domrates_param_str)
+analyseDomRates(const string &treeFile, const fs::path &annotationDirectory, const string &outgroup, const string &ending, const fs::path &outFile, const fs::path &addOut, const string &lca, const bool &detailed, const unsigned int &nthreads, const string &domrates_param_str, const fs::path &profileFile)
 {
 
     // start initialisation
-    BSDL::PhylogeneticTree<vector<int> > nTree;
-    BSDL::PhylogeneticTree<vector<int> > singleDomTree;
+    // one tree topology with separate state layers for domain arrangements and single domains
+    BSDL::MultiLayerTree nTree(nStateLayers);
 
-    // load tree two times (for single domains and for domain arrangements)
     cout << "load tree..." << endl;
-    nTree.read(treeFile);
-    singleDomTree.read(treeFile);
-
-    // check if tree is strictly bifurcating
-    try {
-        BSDL::isBifurcatingTree(nTree, true);
-    }
-    catch (...) {
-        throw;
+    {
+        phaseTimer timer(domRatesProfile(), "tree parse");
+        nTree.read(treeFile);
     }
 
     // find last common ancestor if -n option was specified
@@ -942,11 +1078,11 @@ analyseDomRates(const string &treeFile, const fs::path &annotationDirectory, con
         }
     }
 
-    // save all domain arrangements from annotation files in node->data of species tree (&nTree)
+    // save all domain arrangements and single domains from annotation files in the state layers of the species tree (&nTree)
     cout << "read all arrangements..." << endl;
     std::pair<posOrderMaps, eventMaps> emaps;
     try {
-        emaps = saveDomData(nTree, singleDomTree, annotationDirectory, outgroup, ending);
+        emaps = saveDomData(nTree, annotationDirectory, outgroup, ending);
     }
     catch ( ... ) {
         throw;
@@ -956,14 +1092,31 @@ analyseDomRates(const string &treeFile, const fs::path &annotationDirectory, con
 
     // reconstruction of ancestral domain states
     cout << "reconstructing ancestral states..." << endl;
-    BSDL::fitch(nTree);
-    BSDL::dollo(singleDomTree);
+    {
+        phaseTimer timer(domRatesProfile(), "fitch");
+        BSDL::fitch(nTree, arrangementLayer);
+    }
+    {
+        phaseTimer timer(domRatesProfile(), "dollo");
+        BSDL::dollo(nTree, singleDomainLayer);
+    }
 
     cout << "event reconstruction..." << endl;
-    std::pair<solutionTypes, eventTypes> setypes = eventReconstruction(pomapping, emapping, nthreads);
+    std::pair<solutionTypes, eventTypes> setypes;
+    {
+        phaseTimer timer(domRatesProfile(), "event reconstruction");
+        setypes = eventReconstruction(nTree, pomapping, emapping, nthreads);
+    }
     solutionTypes &nSol = setypes.first;
     eventTypes &nEve = setypes.second;
 
     cout << "write summary..." << endl;
-    summary(nTree, emapping, nSol, nEve, outFile, addOut, lca, lca_id, detailed, domrates_param_str);
+    {
+        phaseTimer timer(domRatesProfile(), "summary");
+        summary(nTree, emapping, nSol, nEve, outFile, addOut, lca, lca_id, detailed, domrates_param_str);
+    }
+
+    if (!profileFile.empty()) {
+        domRatesProfile().writeJson(profileFile);
+    }
 }
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include "../libs/BioSeqDataLib/src/DomainModule.hpp"
 #include "../libs/BioSeqDataLib/src/external/Output.hpp"
 #include "../libs/BioSeqDataLib/src/phylogeny/PhylogeneticTree.hpp"
+#include "../libs/BioSeqDataLib/src/phylogeny/MultiLayerTree.hpp"
 #include "../libs/BioSeqDataLib/src/phylogeny/fitch.hpp"
 #include "../libs/BioSeqDataLib/src/phylogeny/dollo.hpp"
 
@@ -95,18 +96,19 @@ std::pair<unsigned int, std::string> check_termGain(const std::map< unsigned int
  * @param lca two species names separated by a ":" of which the last common ancestor should be found
  * @param nTree phylogenetic tree in which the species can be found
  */
-unsigned int findLCA(const std::string &lca, const BSDL::PhylogeneticTree<std::vector<int> > &nTree);
+unsigned int findLCA(const std::string &lca, const BSDL::MultiLayerTree &nTree);
 
 /**
  * @brief saves presence/absence (1/-1) states for domain arrangements and single domains for every leaf in a given phylogenetic tree
  *
- * @param[in|out] nTree tree to store all domain arrangements
- * @param[in|out] singleDomTree tree to store all single domains
+ * @param[in|out] nTree tree to store all domain arrangements (arrangementLayer) and single domains (singleDomainLayer)
  * @param annotationDirectory directory containing domain annotation data (e.g. PfamScan output files) for all species in the tree
- * @param outgroup the species/group to be used as outgroup (it should be located closest to root (regarding the hirarchy levels in the tree, not branch length))
+ * @param outgroup the species/group to be used as outgroup (a leaf directly below the root, which may be multifurcating; if no
+ * leaf is located directly below the root, all edges starting at the root are treated as outgroup branch)
  * @param ending file extension that has to be added to species names in the tree to read the related annotation file
+ * @return the maps of arrangements and single domains and the event maps, which also store the edges of the outgroup branch
  */
-std::pair<posOrderMaps, eventMaps> saveDomData(BSDL::PhylogeneticTree<std::vector<int> > &nTree, BSDL::PhylogeneticTree<std::vector<int> > &singleDomTree, const fs::path &annotationDirectory, const std::string &outgroup, const std::string &ending);
+std::pair<posOrderMaps, eventMaps> saveDomData(BSDL::MultiLayerTree &nTree, const fs::path &annotationDirectory, const std::string &outgroup, const std::string &ending);
 
 /**
  * @brief infers six domain rearrangement event types and their frequency per node in a given phylogentic tree
@@ -114,11 +116,27 @@ std::pair<posOrderMaps, eventMaps> saveDomData(BSDL::PhylogeneticTree<std::vecto
  * additionally, four solution types are distinguished 1) exact solution 2) non-ambiguous solution 3) ambiguous solution 4) complex solution
  * the different solution types are defined by the amount and types of event types that can explain a new domain arrangement
  *
+ * @param nTree phylogenetic tree with reconstructed states for domain arrangements and single domains
  * @param pomaps data structure storing maps matching domain arrangements/single domains to their related index positions in the data set
- * @param emaps data structure storing information of matching nodeIDs to nodes and reconstructed events per node
+ * @param emaps data structure storing reconstructed events per node
  * @param nthreads number of threads that run event reconstruction in parallel
  */
-std::pair<solutionTypes, eventTypes> eventReconstruction(const posOrderMaps &pomaps, eventMaps &emaps, const unsigned int &nthreads);
+std::pair<solutionTypes, eventTypes> eventReconstruction(const BSDL::MultiLayerTree &nTree, const posOrderMaps &pomaps, eventMaps &emaps, const unsigned int &nthreads);
+
+/**
+ * @brief writes branch length normalized event rates for every edge and for the whole tree
+ * @details every edge is identified by the node-ID of its child node, the edges of the outgroup branch are not evaluated
+ * (same as in the event reconstruction); every edge gets its number of events per unit branch length ("NA" for edges of
+ * length zero) and rates of every event type per unit branch length and per element at risk, i.e. the
+ * number of domain arrangements (fusion, fission, terminal loss, terminal emergence) or single domains (single domain
+ * loss/emergence) present at the parental node; tree-wide rates divide the events of all evaluated edges by the sum of
+ * branch length times elements at risk
+ *
+ * @param nTree phylogenetic tree with reconstructed states for domain arrangements and single domains
+ * @param emaps data structure storing information of reconstructed events per node
+ * @param ratesOut name of the output file
+ */
+void writeEdgeRates(const BSDL::MultiLayerTree &nTree, const eventMaps &emaps, const fs::path &ratesOut);
 
 /**
  * @brief creates human readable output of different statistics and writes them to specified output files
@@ -130,12 +148,12 @@ std::pair<solutionTypes, eventTypes> eventReconstruction(const posOrderMaps &pom
  * @param sTypes data structure storing number of reconstructed solution types
  * @param eTypes data structure storing number of reconstructed event types
  * @param outFile name for an output file the frequency of different event and solution types is written to
- * @param addOut name for an output file containing additional statistics of the event reconstruction
+ * @param addOut name for an output file containing additional statistics of the event reconstruction (branch length normalized rates are written to <addOut>_rates)
  * @param lca two species names separated by ":" for whose last common ancestor reconstruction details are written to output
  * @param lca_id node-ID of last common ancestor of the species defined in the lca parameter
  * @param detailed if set, output contains information about maintained arrangements, which haven't been rearranged
  */
-void summary(BSDL::PhylogeneticTree<std::vector<int> > &nTree, const eventMaps &emaps, const solutionTypes &sTypes, const eventTypes &eTypes, const fs::path &outFile, const fs::path &addOut, const std::string &lca, const unsigned int &lca_id, const bool &detailed, const std::string &domrates_param_str);
+void summary(const BSDL::MultiLayerTree &nTree, const eventMaps &emaps, const solutionTypes &sTypes, const eventTypes &eTypes, const fs::path &outFile, const fs::path &addOut, const std::string &lca, const unsigned int &lca_id, const bool &detailed, const std::string &domrates_param_str);
 
 /**
  * @brief wrapper function called by the main script coordinating all necessary steps for full DomRates analysis
@@ -145,12 +163,13 @@ void summary(BSDL::PhylogeneticTree<std::vector<int> > &nTree, const eventMaps &
  * @param outgroup the species/group to be used as outgroup (it should be located closest to root (regarding the hirarchy levels in the tree, not branch length))
  * @param ending file extension that has to be added to species names in the tree to read the related annotation file
  * @param outFile name for an output file the frequency of different event and solution types is written to
- * @param addOut name for an output file containing additional statistics of the event reconstruction
+ * @param addOut name for an output file containing additional statistics of the event reconstruction (branch length normalized rates are written to <addOut>_rates)
  * @param lca two species names separated by ":" for whose last common ancestor reconstruction details are written to output
  * @param detailed if set, output contains information about maintained arrangements, which haven't been rearranged
  * @param nthreads number of threads that run event reconstruction in parallel
+ * @param profileFile if not empty, time, memory usage and work counters of every phase are written to this file in JSON format
  */
-void analyseDomRates(const std::string &treeFile, const fs::path &annotationDirectory, const std::string &outgroup, const std::string &ending, const fs::path &outFile, const fs::path &addOut, const std::string &lca, const bool &detailed, const unsigned int &nthreads, const std::string &domrates_param_str);
+void analyseDomRates(const std::string &treeFile, const fs::path &annotationDirectory, const std::string &outgroup, const std::string &ending, const fs::path &outFile, const fs::path &addOut, const std::string &lca, const bool &detailed, const unsigned int &nthreads, const std::string &domrates_param_str, const fs::path &profileFile = fs::path());
 
 
 #endif //SRC_DOMRATES_HPP
@@ -67,6 +67,7 @@ main(int argc, char *argv[]) {
     fs::path annotationDirectory;
     fs::path outFile;
     fs::path addOut;
+    fs::path profileFile;
     bool detailed;
     unsigned int nthreads;
 
@@ -96,7 +97,9 @@ main(int argc, char *argv[]) {
             ("detailed,d", po::value<bool>(&detailed)->default_value(false)->zero_tokens(),
              "If this parameter is set, the output files also contain statistics about identical arrangements that have not changed. i.e. the arrangement stays conserved, and complex solutions, i.e. the rearrangement event leading to the new arrangement cannot be determined. (This can heavily increase file size.)")
             ("threads,p", po::value<unsigned int>(&nthreads)->default_value(1),
-             "Number of parallel threads to use for computation.");
+             "Number of parallel threads to use for computation.")
+            ("profile-json", po::value<fs::path>(&profileFile),
+             "File to store wall time, CPU time, peak memory usage and work counters of every phase of the run in JSON format.");
 
     allOpts.add(general);
 
@@ -129,7 +132,7 @@ main(int argc, char *argv[]) {
 
     try {
         domrates_param_str = "domRates -t " + treeFile + " -a " + annotationDirectory.string() + " -g " + outgroup + " -e " + ending + " -o " + outFile.string() + " -s " + addOut.string() + " -n " + lca + " -d " + std::to_string(detailed) + " -p " + std::to_string(nthreads);
-        analyseDomRates(treeFile, annotationDirectory, outgroup, ending, outFile, addOut, lca, detailed, nthreads, domrates_param_str);
+        analyseDomRates(treeFile, annotationDirectory, outgroup, ending, outFile, addOut, lca, detailed, nthreads, domrates_param_str, profileFile);
     }
     catch ( const std::exception& e ) {
         cerr << "An error occured during the DomRates run: \n";
@@ -20,12 +20,23 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 // BioSeqDataLib header
-#include "../libs/BioSeqDataLib/src/phylogeny/PhylogeneticTree.hpp"
+#include "../libs/BioSeqDataLib/src/phylogeny/MultiLayerTree.hpp"
 
 namespace BSDL = BioSeqDataLib;
 
+/**
+ * state layers of the phylogenetic tree used for the reconstruction; every layer stores presence/absence (1/-1)
+ * states for all nodes of the same tree topology
+ */
+enum StateLayer : size_t {
+    arrangementLayer = 0, // domain arrangements, reconstructed with fitch parsimony
+    singleDomainLayer = 1, // single domains, reconstructed with dollo parsimony
+    nStateLayers = 2
+};
+
 /**
  * structure to store for a given domain arrangement data set all arrangements and single domains
  * in a given order with index positions for fast access and mapping later from simple vectors of integers representing
@@ -40,19 +51,16 @@ posOrderMaps {
 };
 
 /**
- * structure to store mapping information of nodes and their corresponding IDs
- * as well as reconstructed events for later output
+ * structure to store reconstructed events per node for later output
  */
 struct
 eventMaps {
-    // domain arrangement annotation for arrangement Tree
-    std::map<unsigned int, BSDL::TreeNodePhylo<std::vector<int> >* > treemap;
-    // single domain annotation for singleDomTree
-    std::map<unsigned int, BSDL::TreeNodePhylo<std::vector<int> >* > id_to_tree;
     // counts identical domain arrangements between node and its parent node
     std::map<unsigned int,unsigned int> identities_node;
     // counts events per node. id -> (#fusion, #fission, #terminal loss, #terminal gain, #single loss, #single gain)
     std::map<unsigned int, std::vector<unsigned int> > events_per_node;
+    // nodes whose edge to the parent belongs to the outgroup branch, no events are counted on these edges
+    std::set<unsigned int> outgroup_edges;
     // summary of all solved events
     std::vector<std::string> event_listing;
     // summary of all identities (arrangements that do not change from one node to the other)
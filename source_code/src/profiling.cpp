@@ -0,0 +1,121 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <iomanip>
+#include <sys/resource.h>
+
+// BioSeqDataLib header
+#include "../libs/BioSeqDataLib/src/external/Output.hpp"
+
+//DomRates header
+#include "profiling.hpp"
+#include "version.hpp"
+
+using std::string;
+
+namespace {
+
+double
+secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double
+cpuSecondsSince(const std::clock_t &start)
+{
+    return static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+}
+
+long
+peakRssKb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    // ru_maxrss is given in kilobytes on Linux
+    return usage.ru_maxrss;
+}
+
+runProfile&
+domRatesProfile()
+{
+    static runProfile profile;
+    return profile;
+}
+
+runProfile::runProfile() : start_wall_(std::chrono::steady_clock::now()), start_cpu_(std::clock())
+{}
+
+phaseStats&
+runProfile::phase(const string &name)
+{
+    for (auto &ph : phases_) {
+        if (ph.name == name) {
+            return ph;
+        }
+    }
+    phases_.emplace_back();
+    phases_.back().name = name;
+    return phases_.back();
+}
+
+void
+runProfile::writeJson(const fs::path &outFile) const
+{
+    AlgorithmPack::Output out(outFile);
+    out << std::fixed << std::setprecision(6);
+
+    out << "{\n";
+    out << "  \"domrates_version\": \"" << string(STR(MAJOR_VERSION)) + "." + string(STR(MINOR_VERSION)) + "." + string(STR(PATCH_VERSION)) << "\",\n";
+    out << "  \"total\": {\"wall_seconds\": " << secondsSince(start_wall_) << ", \"cpu_seconds\": " << cpuSecondsSince(start_cpu_)
+        << ", \"peak_rss_kb\": " << peakRssKb() << "},\n";
+
+    out << "  \"phases\": [";
+    for (unsigned int i = 0; i < phases_.size(); ++i) {
+        const phaseStats &ph = phases_[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": \"" << ph.name << "\", \"calls\": " << ph.calls << ", \"wall_seconds\": " << ph.wall_seconds
+            << ", \"cpu_seconds\": " << ph.cpu_seconds << ", \"peak_rss_kb\": " << ph.peak_rss_kb << "}";
+    }
+    out << "\n  ],\n";
+
+    out << "  \"counters\": {\n";
+    out << "    \"files_read\": " << counters.files_read.load() << ",\n";
+    out << "    \"hits_parsed\": " << counters.hits_parsed.load() << ",\n";
+    out << "    \"proteins_read\": " << counters.proteins_read.load() << ",\n";
+    out << "    \"arrangements_interned\": " << counters.arrangements_interned.load() << ",\n";
+    out << "    \"single_domains_interned\": " << counters.single_domains_interned.load() << ",\n";
+    out << "    \"fusion_comparisons\": " << counters.fusion_comparisons.load() << ",\n";
+    out << "    \"fission_termLoss_comparisons\": " << counters.fission_termLoss_comparisons.load() << ",\n";
+    out << "    \"termGain_comparisons\": " << counters.termGain_comparisons.load() << "\n";
+    out << "  }\n";
+    out << "}\n";
+}
+
+phaseTimer::phaseTimer(runProfile &profile, const string &name) : stats_(profile.phase(name)), start_wall_(std::chrono::steady_clock::now()), start_cpu_(std::clock())
+{}
+
+phaseTimer::~phaseTimer()
+{
+    ++stats_.calls;
+    stats_.wall_seconds += secondsSince(start_wall_);
+    stats_.cpu_seconds += cpuSecondsSince(start_cpu_);
+    stats_.peak_rss_kb = peakRssKb();
+}
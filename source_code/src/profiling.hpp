@@ -0,0 +1,123 @@
+/*
+ * DomRates is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DomRates is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DomRates.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_PROFILING_HPP
+#define SRC_PROFILING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <string>
+
+// boost header
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+/**
+ * structure to accumulate resource usage of one phase of a DomRates run
+ */
+struct
+phaseStats {
+    std::string name;
+    unsigned int calls = 0;
+    double wall_seconds = 0.0;
+    double cpu_seconds = 0.0; // summed over all threads
+    long peak_rss_kb = 0; // peak resident set size of the process at the end of the phase
+};
+
+/**
+ * structure to count the amount of work done during a DomRates run;
+ * counters can be increased from several threads at once
+ */
+struct
+workCounters {
+    std::atomic<unsigned long long> files_read{0};
+    std::atomic<unsigned long long> hits_parsed{0}; // domain hits before overlap resolution
+    std::atomic<unsigned long long> proteins_read{0};
+    std::atomic<unsigned long long> arrangements_interned{0};
+    std::atomic<unsigned long long> single_domains_interned{0};
+    std::atomic<unsigned long long> fusion_comparisons{0}; // split points tested in check_fusion
+    std::atomic<unsigned long long> fission_termLoss_comparisons{0}; // parental arrangements tested in check_fission_termLoss_event
+    std::atomic<unsigned long long> termGain_comparisons{0}; // parental arrangements tested in check_termGain
+};
+
+/**
+ * @brief records wall time, CPU time and peak memory per phase as well as work counters of a DomRates run
+ * @details phases are kept in the order in which they are first entered; entering a phase several times
+ * accumulates its times
+ */
+class
+runProfile {
+private:
+    std::deque<phaseStats> phases_; // deque keeps references to phases valid while new ones are added
+    std::chrono::steady_clock::time_point start_wall_;
+    std::clock_t start_cpu_;
+
+public:
+    workCounters counters;
+
+    runProfile();
+
+    /**
+     * @brief returns the statistics of a phase, creating it if it does not exist yet
+     *
+     * @param name name of the phase
+     */
+    phaseStats& phase(const std::string &name);
+
+    /**
+     * @brief returns all recorded phases in the order they were first entered
+     */
+    const std::deque<phaseStats>& phases() const { return phases_; }
+
+    /**
+     * @brief writes all phases, totals and counters in JSON format
+     *
+     * @param outFile file the JSON output is written to
+     */
+    void writeJson(const fs::path &outFile) const;
+};
+
+/**
+ * @brief scope guard adding the resources used between its construction and destruction to a phase of a runProfile
+ */
+class
+phaseTimer {
+private:
+    phaseStats &stats_;
+    std::chrono::steady_clock::time_point start_wall_;
+    std::clock_t start_cpu_;
+
+public:
+    phaseTimer(runProfile &profile, const std::string &name);
+    ~phaseTimer();
+
+    phaseTimer(const phaseTimer&) = delete;
+    phaseTimer& operator=(const phaseTimer&) = delete;
+};
+
+/**
+ * @brief returns the peak resident set size of the current process in kilobytes (0 if unavailable)
+ */
+long peakRssKb();
+
+/**
+ * @brief returns the profile of the current DomRates run
+ */
+runProfile& domRatesProfile();
+
+#endif //SRC_PROFILING_HPP
@@ -11,6 +11,8 @@
 	[ $status == 0 ]
 	run diff results/compare_out_stats_epd.txt results/test_out_stats_epd.txt
 	[ $status == 0 ]
+	run diff results/compare_out_stats_rates.txt results/test_out_stats_rates.txt
+	[ $status == 0 ]
 
     	# run parallelization test with 4 threads
     	#run ../../build/domRates -t ../data/test_tree.nwk -a ../data -g OG -o results/test_out.txt -p 4
@@ -27,6 +29,8 @@
 	[ $status == 0 ]
 	run diff results/compare_ident_out_stats_epd.txt results/test_ident_out_stats_epd.txt
         [ $status == 0 ]
+	run diff results/compare_ident_out_stats_rates.txt results/test_ident_out_stats_rates.txt
+        [ $status == 0 ]
 
 	# test run with detailed output (-d parameter) and statistics for LCA node of A and B (-n parameter)
 	run ../../build/domRates -t ../data/test_tree.nwk -a ../data/ -g OG -o results/test_nident_out.txt -s results/test_nident_out_stats.txt -d -n A:B
@@ -37,6 +41,8 @@
 	[ $status == 0 ]
 	run diff results/compare_nident_out_stats_epd.txt results/test_nident_out_stats_epd.txt
 	[ $status == 0 ]
+	run diff results/compare_nident_out_stats_rates.txt results/test_nident_out_stats_rates.txt
+	[ $status == 0 ]
 
 	
 	# test run without output file (rates printed in console)
@@ -50,13 +56,16 @@
 	rm results/test_out.txt
 	rm results/test_out_stats.txt
 	rm results/test_out_stats_epd.txt
+	rm results/test_out_stats_rates.txt
 
 	rm results/test_ident_out.txt
         rm results/test_ident_out_stats.txt
         rm results/test_ident_out_stats_epd.txt
+        rm results/test_ident_out_stats_rates.txt
 
 	rm results/test_nident_out.txt
 	rm results/test_nident_out_stats.txt
 	rm results/test_nident_out_stats_epd.txt
+	rm results/test_nident_out_stats_rates.txt
 }
 
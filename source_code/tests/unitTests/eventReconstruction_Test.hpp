@@ -0,0 +1,165 @@
+#ifndef DOMRATES_EVENTRECONSTRUCTION_TEST_HPP
+#define DOMRATES_EVENTRECONSTRUCTION_TEST_HPP
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/filesystem.hpp>
+
+#include "../../src/domRates.hpp"
+
+BOOST_AUTO_TEST_SUITE(EventReconstruction_Test)
+
+    // writes a minimal pfam_scan.pl file for every species, every protein has a single domain
+    fs::path
+    writeAnnotations(const std::map<std::string, std::vector<std::string> > &species)
+    {
+        fs::path dir = fs::temp_directory_path() / fs::unique_path("domrates_events_%%%%%%");
+        fs::create_directories(dir);
+        for (const auto &spec : species) {
+            std::ofstream outS((dir / (spec.first + ".dom")).string());
+            outS << "# pfam_scan.pl\n";
+            for (size_t i = 0; i < spec.second.size(); ++i) {
+                outS << spec.first << i << " 1 10 1 10 " << spec.second[i] << " dom Family 1 10 10 20.0 1e-05 1 No_clan\n";
+            }
+        }
+        return dir;
+    }
+
+    std::pair<posOrderMaps, eventMaps>
+    reconstruct(BSDL::MultiLayerTree &nTree, const std::string &newick, const fs::path &dir, const std::string &outgroup = "OG")
+    {
+        fs::path treeFile = dir / "tree.nwk";
+        std::ofstream(treeFile.string()) << newick << "\n";
+        nTree.read(treeFile.string());
+        std::pair<posOrderMaps, eventMaps> maps = saveDomData(nTree, dir, outgroup, ".dom");
+        BSDL::fitch(nTree, arrangementLayer);
+        BSDL::dollo(nTree, singleDomainLayer);
+        eventReconstruction(nTree, maps.first, maps.second, 2);
+        return maps;
+    }
+
+    unsigned int
+    nEvents(const eventMaps &emaps, unsigned int id)
+    {
+        unsigned int sum = 0;
+        for (unsigned int count : emaps.events_per_node.at(id)) {
+            sum += count;
+        }
+        return sum;
+    }
+
+    // PF00002 emerges in the clade of A, B and C, PF00003 in the clade of D and E
+    const std::map<std::string, std::vector<std::string> > annotations = {
+        {"A", {"PF00001", "PF00002"}}, {"B", {"PF00001", "PF00002"}}, {"C", {"PF00001", "PF00002"}},
+        {"D", {"PF00001", "PF00003"}}, {"E", {"PF00001", "PF00003"}}, {"OG", {"PF00001"}}
+    };
+
+    BOOST_AUTO_TEST_CASE(cladesBelowMultifurcatingRoot)
+    {
+        fs::path dir = writeAnnotations(annotations);
+        BSDL::MultiLayerTree nTree(nStateLayers);
+        // node ids: 0 root, 1 (C,(A,B)), 2 C, 3 (A,B), 4 A, 5 B, 6 (D,E), 7 D, 8 E, 9 OG
+        std::pair<posOrderMaps, eventMaps> maps = reconstruct(nTree, "((C:1,(A:1,B:1):1):1,(D:1,E:1):1,OG:1);", dir);
+        const eventMaps &emaps = maps.second;
+        BOOST_CHECK_EQUAL(emaps.outgroup_edges.size(), 1);
+        BOOST_CHECK_EQUAL(emaps.outgroup_edges.count(9), 1);
+        BOOST_CHECK_EQUAL(emaps.events_per_node.at(1)[5], 1);
+        BOOST_CHECK_EQUAL(emaps.events_per_node.at(6)[5], 1);
+        BOOST_CHECK_EQUAL(nEvents(emaps, 1), 1);
+        BOOST_CHECK_EQUAL(nEvents(emaps, 6), 1);
+        BOOST_CHECK_EQUAL(nEvents(emaps, 9), 0);
+        for (unsigned int leaf : {2, 4, 5, 7, 8}) {
+            BOOST_CHECK_EQUAL(nEvents(emaps, leaf), 0);
+        }
+
+        // a bifurcating root splits the outgroup branch, the edge to the ingroup is not evaluated either
+        maps = reconstruct(nTree, "(((C:1,(A:1,B:1):1):1,(D:1,E:1):1):1,OG:1);", dir);
+        BOOST_CHECK_EQUAL(maps.second.outgroup_edges.size(), 2);
+        BOOST_CHECK_EQUAL(nEvents(maps.second, 1), 0);
+        BOOST_CHECK_EQUAL(maps.second.events_per_node.at(2)[5], 1);
+        BOOST_CHECK_EQUAL(maps.second.events_per_node.at(7)[5], 1);
+        fs::remove_all(dir);
+    }
+
+    BOOST_AUTO_TEST_CASE(leavesBelowMultifurcatingRoot)
+    {
+        fs::path dir = writeAnnotations(annotations);
+        BSDL::MultiLayerTree nTree(nStateLayers);
+        // node ids: 0 root, 1 C, 2 A, 3 (D,E), 4 D, 5 E, 6 B, 7 OG
+        std::pair<posOrderMaps, eventMaps> maps;
+        BOOST_REQUIRE_NO_THROW(maps = reconstruct(nTree, "(C:2,A:1,(D:1,E:1.5):1,B:1,OG:1);", dir));
+        const eventMaps &emaps = maps.second;
+        BOOST_CHECK_EQUAL(emaps.outgroup_edges.size(), 1);
+        BOOST_CHECK_EQUAL(emaps.outgroup_edges.count(7), 1);
+        // PF00002 is present at the root, it is lost and PF00003 emerges on the edge to (D,E)
+        BOOST_CHECK_EQUAL(emaps.events_per_node.at(3)[4], 1);
+        BOOST_CHECK_EQUAL(emaps.events_per_node.at(3)[5], 1);
+        BOOST_CHECK_EQUAL(nEvents(emaps, 3), 2);
+        for (unsigned int leaf : {1, 2, 4, 5, 6, 7}) {
+            BOOST_CHECK_EQUAL(nEvents(emaps, leaf), 0);
+        }
+
+        // the outgroup has to be a leaf directly below the root
+        BOOST_CHECK_THROW(reconstruct(nTree, "(C:2,A:1,(D:1,OG:1.5):1,B:1,E:1);", dir), std::runtime_error);
+        fs::remove_all(dir);
+    }
+
+    BOOST_AUTO_TEST_CASE(cladesBelowRoot)
+    {
+        fs::path dir = writeAnnotations(annotations);
+        BSDL::MultiLayerTree nTree(nStateLayers);
+        // no leaf below the root, the outgroup cannot be placed and all edges starting at the root are skipped
+        // node ids: 0 root, 1 (A,B), 2 A, 3 B, 4 (D,E), 5 D, 6 E
+        std::pair<posOrderMaps, eventMaps> maps;
+        BOOST_REQUIRE_NO_THROW(maps = reconstruct(nTree, "((A:1,B:1):1,(D:1,E:1):1);", dir, "A"));
+        const eventMaps &emaps = maps.second;
+        BOOST_CHECK_EQUAL(emaps.outgroup_edges.size(), 2);
+        BOOST_CHECK_EQUAL(emaps.outgroup_edges.count(1), 1);
+        BOOST_CHECK_EQUAL(emaps.outgroup_edges.count(4), 1);
+        BOOST_CHECK_EQUAL(nEvents(emaps, 1), 0);
+        BOOST_CHECK_EQUAL(nEvents(emaps, 4), 0);
+
+        maps = reconstruct(nTree, "((A:1,B:1):1,(C:1,D:1):1,E:1);", dir, "E");
+        BOOST_CHECK_EQUAL(maps.second.outgroup_edges.size(), 1);
+        BOOST_CHECK_THROW(reconstruct(nTree, "((A:1,B:1):1,(C:1,D:1):1,E:1);", dir, "A"), std::runtime_error);
+        fs::remove_all(dir);
+    }
+
+    BOOST_AUTO_TEST_CASE(edgeRates)
+    {
+        fs::path dir = writeAnnotations(annotations);
+        BSDL::MultiLayerTree nTree(nStateLayers);
+        // the edge to (C,(A,B)) has length zero
+        std::pair<posOrderMaps, eventMaps> maps = reconstruct(nTree, "((C:1,(A:1,B:1):1):0,(D:1,E:2):2,OG:1);", dir);
+        writeEdgeRates(nTree, maps.second, dir / "rates.txt");
+
+        std::ifstream inS((dir / "rates.txt").string());
+        std::map<std::string, std::vector<std::string> > rows;
+        std::string line;
+        while (std::getline(inS, line)) {
+            std::vector<std::string> fields;
+            boost::algorithm::split(fields, line, boost::is_any_of("\t"));
+            if (fields.size() == 11 && line[0] != '#') {
+                rows[fields[0]] = fields;
+            }
+        }
+        fs::remove_all(dir);
+
+        BOOST_REQUIRE_EQUAL(rows.size(), 8);
+        BOOST_CHECK_EQUAL(rows.count("9"), 0);
+        BOOST_CHECK_EQUAL(rows["1"][4], "NA");
+        BOOST_CHECK_EQUAL(rows["1"][10], "NA");
+        BOOST_CHECK_EQUAL(rows["6"][1], "2.000000");
+        BOOST_CHECK_EQUAL(rows["6"][4], "0.500000");
+        BOOST_CHECK_EQUAL(rows["8"][4], "0.000000");
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif //DOMRATES_EVENTRECONSTRUCTION_TEST_HPP
@@ -0,0 +1,66 @@
+#ifndef DOMRATES_PROFILING_TEST_HPP
+#define DOMRATES_PROFILING_TEST_HPP
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "../../src/profiling.hpp"
+
+BOOST_AUTO_TEST_SUITE(Profiling_Test)
+
+    BOOST_AUTO_TEST_CASE(phaseAccumulation)
+    {
+        runProfile profile;
+        {
+            phaseTimer tree(profile, "tree parse");
+        }
+        {
+            phaseTimer outer(profile, "annotation parse");
+            phaseTimer inner(profile, "overlap resolution");
+        }
+        {
+            phaseTimer again(profile, "annotation parse");
+        }
+
+        BOOST_REQUIRE_EQUAL(profile.phases().size(), 3);
+        BOOST_CHECK_EQUAL(profile.phases()[0].name, "tree parse");
+        BOOST_CHECK_EQUAL(profile.phases()[0].calls, 1);
+        BOOST_CHECK_EQUAL(profile.phases()[1].name, "annotation parse");
+        BOOST_CHECK_EQUAL(profile.phases()[1].calls, 2);
+        BOOST_CHECK_EQUAL(profile.phases()[2].name, "overlap resolution");
+        BOOST_CHECK_EQUAL(profile.phases()[2].calls, 1);
+        BOOST_CHECK(profile.phases()[0].wall_seconds >= 0.0);
+        BOOST_CHECK(profile.phases()[0].peak_rss_kb > 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(jsonOutput)
+    {
+        runProfile profile;
+        {
+            phaseTimer timer(profile, "fitch");
+        }
+        profile.counters.files_read += 3;
+        profile.counters.fusion_comparisons += 42;
+
+        fs::path jsonFile = fs::temp_directory_path() / fs::unique_path("domrates_profile_%%%%%%.json");
+        profile.writeJson(jsonFile);
+
+        std::ifstream inS(jsonFile.string());
+        std::stringstream content;
+        content << inS.rdbuf();
+        fs::remove(jsonFile);
+
+        std::string json = content.str();
+        BOOST_CHECK(json.find("\"name\": \"fitch\", \"calls\": 1") != std::string::npos);
+        BOOST_CHECK(json.find("\"files_read\": 3,") != std::string::npos);
+        BOOST_CHECK(json.find("\"fusion_comparisons\": 42,") != std::string::npos);
+        BOOST_CHECK_EQUAL(json.front(), '{');
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif //DOMRATES_PROFILING_TEST_HPP
@@ -5,6 +5,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include "filehandling_Test.hpp"
+#include "profiling_Test.hpp"
+#include "eventReconstruction_Test.hpp"
 
 
 